@@ -12,6 +12,7 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <filesystem>
 #include <fstream>
@@ -22,7 +23,21 @@
 #include <fpdf_formfill.h>
 #include <fpdf_edit.h>
 #include <fpdf_text.h>
+#include "../platform/shared/async_log.h"
+#include "../platform/shared/frame_pacing.h"
+#include "../platform/shared/hit_map.h"
+#include "../platform/shared/image_cache.h"
+#include "../platform/shared/image_catalog.h"
+#include "../platform/shared/image_extract.h"
+#include "../platform/shared/metrics.h"
+#include "../platform/shared/outline.h"
 #include "../platform/shared/pdf_utils.h"
+#include "../platform/shared/render_cost.h"
+#include "../platform/shared/session_recorder.h"
+#include "../platform/shared/text_export.h"
+#include "../platform/shared/text_geometry.h"
+#include "../platform/shared/text_search.h"
+#include "../platform/shared/trace.h"
 
 // 直接使用公共头中的 API：FPDFDest_GetDestPageIndex
 
@@ -55,14 +70,19 @@ static HWND g_hUpDown = nullptr;
 // 已取消主窗口内的日志工具栏，避免主界面出现"日志"字样
 static bool g_savingImageNow = false;
 static bool g_inFileDialog = false;
+static bool g_extractingImages = false; // 批量导出图片进行中（期间会泵消息）
+static bool g_exportingText = false;    // 导出全文文本进行中（期间会泵消息）
 static std::wstring g_currentDocPath; // 当前文档完整路径，仅用于标题栏显示
 static bool g_comInited = false;
 static bool g_dragging = false;       // 鼠标左键拖拽平移
 static POINT g_lastDragPt{};
 static HWND g_hToc = nullptr;         // 书签树
+static HWND g_hTocFilter = nullptr;   // 书签筛选框
 static int g_sidebarPx = 0;           // 左侧书签面板宽度（像素）
 static int g_contentOriginX = 0;      // 内容绘制与命中测试的 X 偏移
 static int g_contentOriginY = 0;      // 顶部偏移（不使用工具栏时为 0）
+static bool g_showRenderCost = false; // 渲染耗时热力图（诊断模式）
+static RenderCostProfile g_renderCost; // 当前页的图块/对象耗时，页码或缩放变化后重算
 
 
 static std::vector<std::wstring> g_recent;
@@ -76,14 +96,22 @@ static const UINT ID_NAV_NEXT = 2002;
 static const UINT ID_NAV_FIRST = 2003;
 static const UINT ID_NAV_LAST = 2004;
 static const UINT ID_NAV_GOTO = 2005;
+static const UINT ID_NAV_FIND = 2006;
 static const UINT ID_EDIT_PAGE = 3001;
 static const UINT ID_UPDOWN = 3002;
+static const UINT ID_EDIT_TOC_FILTER = 3003;
 static const UINT ID_CTX_EXPORT_PNG = 4001;
 static const UINT ID_CTX_SAVE_IMAGE = 4002;
 static const UINT ID_CTX_PROPERTIES = 4003;
 static const UINT ID_CTX_COPY_TEXT = 4004;
+static const UINT ID_CTX_EXTRACT_ALL_IMAGES = 4005;
+static const UINT ID_CTX_EXPORT_IMAGE_LIST = 4006;
+static const UINT ID_CTX_EXPORT_TEXT = 4007;
+static const UINT_PTR kImageCatalogTimerId = 7001; // 后台建立图片目录（主线程分片，PDFium 非线程安全）
 static const UINT ID_SETTINGS_OPEN = 5001;
 static const UINT ID_VIEW_LOG = 9001;
+static const UINT ID_VIEW_RECORD_SESSION = 9002;
+static const UINT ID_VIEW_RENDER_COST = 9003;
 
 // Forward declarations for functions used before their definitions
 static void RecalcPagePixelSize(HWND hWnd);
@@ -107,9 +135,13 @@ static void ClampScroll(HWND hWnd);
 static void FitWindowToPage(HWND hWnd);
 static void JumpToPageFromEdit(HWND hWnd);
 static void SetPageAndRefresh(HWND hWnd, int newIndex);
+static void UpdateFindCount();
+static void RecordSessionViewport(HWND hWnd, const char* source);
 static bool OpenDocumentFromPath(HWND hWnd, const std::wstring& path);
 // 前向声明：在 OpenDocumentFromPath 中会用到
 static std::string WideToUTF8(const std::wstring& w);
+static std::wstring UTF8ToWide(const std::string& s);
+static std::wstring GetSidecarPath(const std::wstring& docPath, const char* suffix);
 static void AddRecent(const std::wstring& path);
 static void UpdateRecentMenu(HWND hWnd);
 static void EnsureGdiplus();
@@ -125,11 +157,13 @@ static std::wstring SaveDialogWithExt(HWND hWnd, const wchar_t* defName, const w
 static void EnsureCOM();
 static void UninitCOM();
 static bool SaveImageFromObject(HWND hWnd, FPDF_PAGE page, FPDF_PAGEOBJECT imgObj);
+static bool ExtractAllImages(HWND hWnd);
+static bool ExportImageList(HWND hWnd);
+static bool ExportAllText(HWND hWnd);
 // 书签面板与跳转
 static void BuildBookmarks(HWND hWnd);
 static void ClearBookmarks();
 static void LayoutSidebarAndContent(HWND hWnd);
-struct TocItemData;
 
 // 简易 COM 智能指针（最小实现）
 template <typename T>
@@ -152,30 +186,31 @@ struct CoTaskMemDeleter {
 	void operator()(wchar_t* p) const { if (p) CoTaskMemFree(p); }
 };
 
-// 文本选择与复制
+// 文本选择与复制：选区是文本流中的一段 [锚点, 活动端)，拖动时只查缓存的字符几何
 static bool g_selecting = false;          // 是否正在拖拽选择
 static bool g_hasSelection = false;       // 是否已有选区
-static POINT g_selStart{};                // 选区起点（客户区坐标）
-static POINT g_selEnd{};                  // 选区终点（客户区坐标）
+static POINT g_selStart{};                // 选区起点（客户区坐标，仅用于会话录制）
+static POINT g_selEnd{};                  // 选区终点（客户区坐标，仅用于会话录制）
+static PdfTextGeometryRef g_selGeometry;  // 当前页字符几何
+static double g_selPageHeightPt = 0;      // 当前页高度（点），避免拖动时查询 PDFium
+static int g_selAnchor = -1;              // 选区锚点（字符插入位置）
+static int g_selFocus = -1;               // 选区活动端（字符插入位置）
 static std::wstring g_selectedText;       // 最近一次选中的文本
 static bool g_mouseDown = false;          // 是否按下左键
 static bool g_movedSinceDown = false;     // 从按下以来是否移动过（用于区分点击/拖动）
 static POINT g_mouseDownPt{};             // 记录按下位置
 
-static void ClearSelection(HWND hWnd) {
+static void ResetSelectionState() {
 	g_selecting = false;
 	g_hasSelection = false;
+	g_selGeometry.reset();
+	g_selAnchor = g_selFocus = -1;
 	g_selectedText.clear();
-	InvalidateRect(hWnd, nullptr, TRUE);
 }
 
-static RECT GetNormalizedClientRect(POINT a, POINT b) {
-	RECT r{};
-	r.left = std::min(a.x, b.x);
-	r.right = std::max(a.x, b.x);
-	r.top = std::min(a.y, b.y);
-	r.bottom = std::max(a.y, b.y);
-	return r;
+static void ClearSelection(HWND hWnd) {
+	ResetSelectionState();
+	InvalidateRect(hWnd, nullptr, TRUE);
 }
 
 // 将客户区坐标转换为 PDF 页面坐标（原点在左下）
@@ -188,49 +223,27 @@ static void ClientToPdfPageXY(POINT client, double& outPageX, double& outPageY,
 	outPageY = std::max(0.0, pageHeightPt - pageYTopDown);
 }
 
-static bool ExtractSelectedTextOnCurrentPage(HWND hWnd, std::wstring& outText) {
-	outText.clear();
-	if (!g_doc) return false;
-	RECT rcClient = GetNormalizedClientRect(g_selStart, g_selEnd);
-	// 限制在内容区域内
-	int cw = 0, ch = 0; GetContentClientSize(hWnd, cw, ch);
-	int contentLeft = g_contentOriginX;
-	int contentRight = g_contentOriginX + cw;
-	RECT rcLimit{ contentLeft, 0, contentRight, ch };
-	RECT rc = rcClient;
-	if (!IntersectRect(&rc, &rcClient, &rcLimit)) return false;
-
-	double w_pt = 0, h_pt = 0; if (!FPDF_GetPageSizeByIndex(g_doc, g_page_index, &w_pt, &h_pt)) return false;
-	// 将两角转换为 PDF 页面坐标
-	POINT p1{ rc.left, rc.top };
-	POINT p2{ rc.right, rc.bottom };
-	double x1=0, y1=0, x2=0, y2=0;
-	ClientToPdfPageXY(p1, x1, y1, h_pt);
-	ClientToPdfPageXY(p2, x2, y2, h_pt);
-	double left = std::min(x1, x2);
-	double right = std::max(x1, x2);
-	double bottom = std::min(y1, y2);
-	double top = std::max(y1, y2);
+// 准备当前页字符几何（首次访问该页时构建），记下页高供坐标换算
+static bool BeginTextSelection() {
+	g_selGeometry = PdfTextGeometry_Get(g_doc, g_page_index);
+	double w_pt = 0;
+	if (!g_selGeometry || !FPDF_GetPageSizeByIndex(g_doc, g_page_index, &w_pt, &g_selPageHeightPt)) { g_selGeometry.reset(); return false; }
+	return true;
+}
 
-	FPDF_PAGE page = FPDF_LoadPage(g_doc, g_page_index);
-	if (!page) return false;
-	FPDF_TEXTPAGE textpage = FPDFText_LoadPage(page);
-	if (!textpage) { FPDF_ClosePage(page); return false; }
+// 客户区坐标 → 最近的字符插入位置；页面无文本时返回 -1
+static int SelectionCaretAt(POINT client) {
+	if (!g_selGeometry) return -1;
+	double px = 0, py = 0; ClientToPdfPageXY(client, px, py, g_selPageHeightPt);
+	return g_selGeometry->CaretAt((float)px, (float)py);
+}
 
-	int chars = FPDFText_GetBoundedText(textpage, left, top, right, bottom, nullptr, 0);
-	bool ok = false;
-	if (chars > 0) {
-		std::vector<unsigned short> buf((size_t)chars + 1u);
-		int got = FPDFText_GetBoundedText(textpage, left, top, right, bottom, reinterpret_cast<FPDF_WCHAR*>(buf.data()), chars);
-		if (got > 0) {
-			buf[(size_t)got] = 0;
-			outText.assign(reinterpret_cast<wchar_t*>(buf.data()));
-			ok = !outText.empty();
-		}
-	}
-	FPDFText_ClosePage(textpage);
-	FPDF_ClosePage(page);
-	return ok;
+static bool ExtractSelectedText(std::wstring& outText) {
+	outText.clear();
+	if (!g_selGeometry || g_selAnchor < 0 || g_selFocus < 0) return false;
+	const std::u16string text = g_selGeometry->Text(std::min(g_selAnchor, g_selFocus), std::max(g_selAnchor, g_selFocus));
+	outText.assign(text.begin(), text.end());
+	return !outText.empty();
 }
 
 static void CopyTextToClipboard(HWND hWnd, const std::wstring& text) {
@@ -253,28 +266,75 @@ static void CopyTextToClipboard(HWND hWnd, const std::wstring& text) {
 	CloseClipboard();
 }
 
+// 链接/注释命中：每页的命中表在渲染时顺带建好，悬停与点击只查表，不再调用 PDFium
+static PdfHitMapRef g_hoverMap;                  // 持有悬停所在页的命中表，保证 g_hoverEntry 有效
+static const PdfHitEntry* g_hoverEntry = nullptr; // 鼠标下的链接或注释
+
+static void ClearHover() {
+	g_hoverEntry = nullptr;
+	g_hoverMap.reset();
+}
+
+static const PdfHitEntry* HitEntryAtPoint(POINT clientPt, PdfHitMapRef& map, double& px, double& py) {
+	map = PdfHitMap_Get(g_doc, g_page_index);
+	if (!map) return nullptr;
+	ClientToPdfPageXY(clientPt, px, py, map->pageHeight);
+	return map->HitTest((float)px, (float)py);
+}
+
+// 状态栏上的悬停提示
+static std::wstring DescribeHitEntry(const PdfHitEntry& e) {
+	wchar_t buf[64];
+	switch (e.kind) {
+	case PdfHitEntry::Kind::GoTo: swprintf(buf, 64, L"链接：第 %d 页", e.destPage + 1); return buf;
+	case PdfHitEntry::Kind::Uri: return L"链接：" + UTF8ToWide(e.target);
+	case PdfHitEntry::Kind::External: return L"外部文件：" + UTF8ToWide(e.target);
+	case PdfHitEntry::Kind::Unsupported: return L"链接（不支持的动作）";
+	default: return std::wstring(e.contents.begin(), e.contents.end());
+	}
+}
+
+// 只打开网页/邮件链接，不执行文档里指定的任意程序或文件
+static bool IsOpenableUri(const std::string& uri) {
+	for (const char* scheme : { "http://", "https://", "mailto:" }) {
+		if (_strnicmp(uri.c_str(), scheme, strlen(scheme)) == 0) return true;
+	}
+	return false;
+}
+
+static void UpdateHover(HWND hWnd, POINT clientPt) {
+	PdfHitMapRef map; double px = 0, py = 0;
+	const PdfHitEntry* e = g_doc ? HitEntryAtPoint(clientPt, map, px, py) : nullptr;
+	if (e == g_hoverEntry) return;
+	g_hoverEntry = e;
+	g_hoverMap = e ? map : nullptr;
+	if (e) { TRACKMOUSEEVENT tme{ sizeof(tme), TME_LEAVE, hWnd, 0 }; TrackMouseEvent(&tme); }
+	UpdateStatusBarInfo(hWnd);
+}
+
 static void TryNavigateLinkAtPoint(HWND hWnd, POINT clientPt) {
 	if (!g_doc) return;
-	// 将点击位置转换到 PDF 页面坐标
-	double w_pt = 0, h_pt = 0; if (!FPDF_GetPageSizeByIndex(g_doc, g_page_index, &w_pt, &h_pt)) return;
-	double px = 0, py = 0; ClientToPdfPageXY(clientPt, px, py, h_pt);
-	// FPDFLink_GetLinkAtPoint 需要 PDF 页面坐标（原点左下）
-	FPDF_PAGE page = FPDF_LoadPage(g_doc, g_page_index);
-	if (!page) return;
-	FPDF_LINK link = FPDFLink_GetLinkAtPoint(page, px, py);
-	if (link) {
-		// 优先取 Dest
-		FPDF_DEST dest = FPDFLink_GetDest(g_doc, link);
-		if (!dest) {
-			FPDF_ACTION act = FPDFLink_GetAction(link);
-			if (act) dest = FPDFAction_GetDest(g_doc, act);
-		}
-		if (dest) {
-			int pageIndex = FPDFDest_GetDestPageIndex(g_doc, dest);
-			if (pageIndex >= 0) SetPageAndRefresh(hWnd, pageIndex);
-		}
+	PdfHitMapRef map; double px = 0, py = 0;
+	const PdfHitEntry* e = HitEntryAtPoint(clientPt, map, px, py);
+	const bool isLink = e && e->IsLink();
+	Session_RecordHitTest("WM_LBUTTONUP", "link", g_page_index, px, map ? map->pageHeight - py : 0.0, isLink);
+	if (!isLink) return;
+	if (e->kind == PdfHitEntry::Kind::Uri) {
+		if (IsOpenableUri(e->target)) ShellExecuteW(nullptr, L"open", UTF8ToWide(e->target).c_str(), nullptr, nullptr, SW_SHOWNORMAL);
+		else MessageBeep(MB_ICONWARNING);
+		return;
+	}
+	if (e->kind != PdfHitEntry::Kind::GoTo) { MessageBeep(MB_ICONWARNING); return; }
+	SetPageAndRefresh(hWnd, e->destPage);
+	// 目标带纵坐标时滚动到该位置（PDF 坐标原点在左下）
+	double w_pt = 0, h_pt = 0;
+	if (e->hasDestY && FPDF_GetPageSizeByIndex(g_doc, e->destPage, &w_pt, &h_pt)) {
+		g_scrollY = std::max(0, (int)((h_pt - e->destY) * g_zoom * g_dpiY / 72.0));
+		ClampScroll(hWnd);
+		UpdateScrollBars(hWnd);
+		InvalidateRect(hWnd, nullptr, TRUE);
+		RecordSessionViewport(hWnd, "TryNavigateLinkAtPoint");
 	}
-	FPDF_ClosePage(page);
 }
 
 // ========== 设置持久化 ==========
@@ -607,6 +667,8 @@ struct Log {
     static void Clear();
     static void Attach(HWND hRichEdit);
     static void AppendHeader();
+    static void StartAsync();
+    static void StopAsync();
 };
 
 #if PDFWV_ENABLE_LOGGING
@@ -620,6 +682,15 @@ struct Log {
 static HWND g_hLogWnd=nullptr, g_hLogEdit=nullptr, g_hLogChk=nullptr, g_hLogAuto=nullptr; // legacy
 static HWND g_hLogList=nullptr; // ListView (table mode)
 static HWND g_hLogTip=nullptr;
+static HWND g_hLogMetrics=nullptr; // 指标摘要（p50/p90/p99/max）与分类内存（当前/峰值），每秒刷新
+static const int LOG_METRICS_H = 200;
+static void RefreshLogMetrics() {
+    if (!g_hLogMetrics) return;
+    std::wstring text = AsyncLog_Utf8ToWide(Metrics_FormatSummary());
+    std::wstring crlf; crlf.reserve(text.size() + 32);
+    for (wchar_t c : text) { if (c == L'\n') crlf += L'\r'; crlf += c; }
+    SetWindowTextW(g_hLogMetrics, crlf.c_str());
+}
 static void AdjustLogColumns();
 static LARGE_INTEGER g_qpcFreq{}; static LARGE_INTEGER g_appStartQpc{};
 static void InitTimingOnce() { static bool inited=false; if (!inited) { QueryPerformanceFrequency(&g_qpcFreq); QueryPerformanceCounter(&g_appStartQpc); inited=true; } }
@@ -651,18 +722,89 @@ static void AppendColored(HWND hEdit, LogLevel lv, const std::wstring& s, bool a
     ++g_logLineIndex;
 }
 
+// 异步日志：调用点只写入无锁环形缓冲；日志线程格式化整批记录后投递到日志窗口
+struct LogRowW {
+    bool perf = false;
+    LogLevel lv = LogLevel::Trace;
+    std::wstring cols[8]; // perf: Elapsed..Remarks；文本：cols[0] 为整行
+};
+static const UINT WM_APP_LOG_BATCH = WM_APP + 0x40;
+static std::atomic<HWND> g_logSinkWnd{nullptr}; // 日志窗口创建后才接收批次
+
+// 运行在日志线程：完成全部 swprintf 格式化，UI 线程只负责插入
+static void DeliverLogBatch(std::vector<AsyncLogEntry>&& batch) {
+    HWND target = g_logSinkWnd.load();
+    if (!target) return;
+    auto rows = std::make_unique<std::vector<LogRowW>>();
+    rows->reserve(batch.size());
+    for (const AsyncLogEntry& e : batch) {
+        const AsyncLogRecord& r = e.record;
+        if (r.flags & kAsyncLogFileOnly) continue;
+        LogRowW row; row.lv = (LogLevel)r.level;
+        const double el = r.timestampNs / 1e9;
+        if (r.kind == AsyncLogKind::Perf) {
+            row.perf = true;
+            wchar_t buf[64];
+            swprintf(buf, 63, L"%7.3f s", el); row.cols[0] = buf;
+            swprintf(buf, 63, L"%ls:%ls", LevelToLabel(LogLevel::Debug), LevelToDesc(LogLevel::Debug)); row.cols[1] = buf;
+            swprintf(buf, 63, L"%d", r.page); row.cols[2] = buf;
+            swprintf(buf, 63, L"%.0f%%", (double)r.zoomPct); row.cols[3] = buf;
+            swprintf(buf, 63, L"%.2f", r.timeMs); row.cols[4] = buf;
+            swprintf(buf, 63, L"%.2f", r.memMB); row.cols[5] = buf;
+            swprintf(buf, 63, L"%+.2f", r.deltaMB); row.cols[6] = buf;
+            if (const AsyncLogSite* site = AsyncLog_GetSite(r.siteId)) {
+                std::wstring rel = MakeProjectRelativePath(NarrowToWideAcp(site->file));
+                wchar_t src[256]; swprintf(src, 255, L"%ls:%d %ls", rel.c_str(), site->line, NarrowToWideAcp(site->func).c_str());
+                std::wstring rem = AsyncLog_Utf8ToWide(site->remarks);
+                row.cols[7] = rem.empty() ? std::wstring(src) : rem + L" | " + src;
+            }
+        } else {
+            wchar_t head[32]; swprintf(head, 31, L"[+%.3fs] ", el);
+            row.cols[0] = head + AsyncLog_Utf8ToWide(e.text);
+        }
+        rows->push_back(std::move(row));
+    }
+    if (rows->empty()) return;
+    if (PostMessageW(target, WM_APP_LOG_BATCH, 0, (LPARAM)rows.get())) rows.release();
+}
+
+// 运行在 UI 线程：整批插入，期间关闭重绘
+static void AppendLogRows(const std::vector<LogRowW>& rows) {
+    bool autoScroll = (g_hLogAuto && BST_CHECKED==SendMessageW(g_hLogAuto,BM_GETCHECK,0,0));
+    bool haveList = g_hLogList && IsWindow(g_hLogList);
+    if (haveList) SendMessageW(g_hLogList, WM_SETREDRAW, FALSE, 0);
+    int lastRow = -1;
+    for (const LogRowW& row : rows) {
+        if (!row.perf || !haveList) {
+            std::wstring line = row.perf ? (row.cols[0] + L" " + row.cols[1] + L" p=" + row.cols[2] + L" z=" + row.cols[3] + L" t=" + row.cols[4] + L" mem=" + row.cols[5] + L" dmem=" + row.cols[6] + L" | " + row.cols[7]) : row.cols[0];
+            if (IsWindow(LogRich())) AppendColored(LogRich(), row.perf ? LogLevel::Debug : row.lv, line, autoScroll);
+            continue;
+        }
+        LVITEMW it{}; it.mask = LVIF_TEXT; it.iItem = ListView_GetItemCount(g_hLogList); it.iSubItem = 0; it.pszText = (LPWSTR)row.cols[0].c_str();
+        lastRow = ListView_InsertItem(g_hLogList, &it);
+        for (int c = 1; c < 8; ++c) ListView_SetItemText(g_hLogList, lastRow, c, (LPWSTR)row.cols[c].c_str());
+    }
+    if (haveList) {
+        SendMessageW(g_hLogList, WM_SETREDRAW, TRUE, 0);
+        if (lastRow >= 0 && g_hLogTip) {
+            TOOLINFOW ti{}; ti.cbSize=sizeof(ti); ti.uFlags = TTF_SUBCLASS; ti.hwnd = g_hLogList; ti.uId = 2; ti.lpszText = (LPWSTR)rows.back().cols[7].c_str(); GetClientRect(g_hLogList, &ti.rect); SendMessageW(g_hLogTip, TTM_ADDTOOL, 0, (LPARAM)&ti);
+        }
+        if (lastRow >= 0 && autoScroll) ListView_EnsureVisible(g_hLogList, lastRow, FALSE);
+        InvalidateRect(g_hLogList, nullptr, FALSE);
+    }
+}
+
+void Log::StartAsync() { AsyncLog_Start(nullptr, DeliverLogBatch); }
+void Log::StopAsync() { g_logSinkWnd.store(nullptr); AsyncLog_Stop(); }
+
 void Log::WriteF(LogLevel lv, const wchar_t* fmt, ...) {
-    if (!IsWindow(LogRich())) return;
-    InitTimingOnce();
-    LARGE_INTEGER now{}; QueryPerformanceCounter(&now);
-    double elapsedMs = (now.QuadPart - g_appStartQpc.QuadPart) * 1000.0 / (double)g_qpcFreq.QuadPart;
-    wchar_t line[1200]; wchar_t payload[1024];
+    if (!g_logSinkWnd.load()) return;
+    wchar_t payload[1024];
     va_list ap; va_start(ap, fmt);
     _vsnwprintf(payload, 1023, fmt, ap);
     va_end(ap); payload[1023]=0;
-    swprintf(line, 1199, L"[+%.3fs] %s", elapsedMs/1000.0, payload);
-    bool autoScroll = (g_hLogAuto && BST_CHECKED==SendMessageW(g_hLogAuto,BM_GETCHECK,0,0));
-    AppendColored(LogRich(), lv, line, autoScroll);
+    std::string utf8 = AsyncLog_WideToUtf8(payload);
+    AsyncLog_Text((uint8_t)lv, 0, 0, utf8.data(), utf8.size());
 }
 
 void Log::Clear() {
@@ -694,59 +836,9 @@ void Log::AppendHeader() {
 }
 
 void Log::WritePerfEx(int page, double zoomPct, double timeMs, double memMB, double deltaMB, const wchar_t* remarks, const char* file, int line, const char* func) {
-    if (g_hLogList && IsWindow(g_hLogList)) {
-        LARGE_INTEGER now{}; QueryPerformanceCounter(&now); if (!g_qpcFreq.QuadPart) InitTimingOnce();
-        double elapsedMs = (now.QuadPart - g_appStartQpc.QuadPart) * 1000.0 / (double)g_qpcFreq.QuadPart;
-        wchar_t elapsed[32]; swprintf(elapsed, 31, L"%7.3f s", elapsedMs/1000.0);
-        wchar_t lvlcol[48]; swprintf(lvlcol, 47, L"%ls:%ls", LevelToLabel(LogLevel::Debug), LevelToDesc(LogLevel::Debug));
-        wchar_t zoom[16];  swprintf(zoom, 15, L"%.0f%%", zoomPct);
-        wchar_t tms[32];   swprintf(tms, 31, L"%.2f", timeMs);
-        wchar_t mem[32];   swprintf(mem, 31, L"%.2f", memMB);
-        wchar_t dmem[32];  swprintf(dmem, 31, L"%+.2f", deltaMB);
-        std::wstring rel = MakeProjectRelativePath(NarrowToWideAcp(file));
-        wchar_t src[256]; swprintf(src, 255, L"%ls:%d %ls", rel.c_str(), line, NarrowToWideAcp(func).c_str());
-        wchar_t rem[512]; swprintf(rem, 511, L"%ls%ls%ls", (remarks?remarks:L""), (remarks&&remarks[0]?L" | ":L""), src);
-        LVITEMW it{}; it.mask = LVIF_TEXT; it.iItem = ListView_GetItemCount(g_hLogList); it.iSubItem = 0; it.pszText = elapsed; int row = ListView_InsertItem(g_hLogList, &it);
-        ListView_SetItemText(g_hLogList, row, 1, lvlcol);
-        wchar_t bufPage[16]; swprintf(bufPage, 15, L"%d", page); ListView_SetItemText(g_hLogList, row, 2, bufPage);
-        ListView_SetItemText(g_hLogList, row, 3, zoom);
-        ListView_SetItemText(g_hLogList, row, 4, tms);
-        ListView_SetItemText(g_hLogList, row, 5, mem);
-        ListView_SetItemText(g_hLogList, row, 6, dmem);
-        ListView_SetItemText(g_hLogList, row, 7, rem);
-        if (g_hLogTip) {
-            TOOLINFOW ti{}; ti.cbSize=sizeof(ti); ti.uFlags = TTF_SUBCLASS; ti.hwnd = g_hLogList; ti.uId = 2; ti.lpszText = rem; GetClientRect(g_hLogList, &ti.rect); SendMessageW(g_hLogTip, TTM_ADDTOOL, 0, (LPARAM)&ti);
-        }
-        if (g_hLogAuto && BST_CHECKED==SendMessageW(g_hLogAuto,BM_GETCHECK,0,0)) ListView_EnsureVisible(g_hLogList, row, FALSE);
-        return;
-    }
-    // fallback to RichEdit
-    if (!IsWindow(LogRich())) return;
-    InitTimingOnce();
-    LARGE_INTEGER now{}; QueryPerformanceCounter(&now);
-    double elapsedMs = (now.QuadPart - g_appStartQpc.QuadPart) * 1000.0 / (double)g_qpcFreq.QuadPart;
-    wchar_t elapsed[32]; swprintf(elapsed, 31, L"[+%7.3fs]", elapsedMs/1000.0);
-    const wchar_t* lvl = LevelToLabel(LogLevel::Debug);
-    const wchar_t* desc = LevelToDesc(LogLevel::Debug);
-    wchar_t lvlcol2[48]; swprintf(lvlcol2, 47, L"%ls:%ls", lvl, desc);
-    std::wstring filew = NarrowToWideAcp(file);
-    std::wstring funcw = NarrowToWideAcp(func);
-    std::wstring rel = MakeProjectRelativePath(filew);
-    wchar_t src2[256]; swprintf(src2, 255, L"%ls:%d %ls", rel.c_str(), line, funcw.c_str());
-    wchar_t rem2[512]; swprintf(rem2, 511, L"%ls%ls%ls", (remarks?remarks:L""), (remarks&&remarks[0]?L" | ":L""), src2);
-    std::wstring remView = rem2; if ((int)remView.size() > W_REMARKS) { remView.resize(W_REMARKS-3); remView += L"..."; }
-    wchar_t linebuf[768];
-    swprintf(linebuf, 767, L"%-*ls %-*ls %-*d %-*.*lf%% %-*.*lf %-*.*lf %-*.*lf %-*ls",
-             W_ELAPSED, elapsed,
-             W_LVL,     lvlcol2,
-             W_PAGE,    page,
-             W_ZOOM,    0, zoomPct,
-             W_TIME,    2, timeMs,
-             W_MEM,     2, memMB,
-             W_DMEM,    2, deltaMB,
-             W_REMARKS, remView.c_str());
-    bool autoScroll = (g_hLogAuto && BST_CHECKED==SendMessageW(g_hLogAuto,BM_GETCHECK,0,0));
-    AppendColored(LogRich(), LogLevel::Debug, linebuf, autoScroll);
+    // 热路径：仅写入二进制记录（约几十纳秒），不做格式化、不触碰 ListView
+    if (!g_logSinkWnd.load()) return;
+    AsyncLog_Perf((uint8_t)LogLevel::Debug, AsyncLog_SiteId(file, line, func, remarks), page, zoomPct, timeMs, memMB, deltaMB);
 }
 
 void Log::WritePerf(int page, double zoomPct, double timeMs, double memMB, double deltaMB) {
@@ -768,6 +860,7 @@ static void ShowLogWindow(HWND owner) {
                 SendMessageW(g_hLogChk, BM_SETCHECK, Log::IsEnabled()?BST_CHECKED:BST_UNCHECKED, 0);
                 CreateWindowW(L"BUTTON", L"Clear", WS_CHILD|WS_VISIBLE, x+170,y,80,24, hwnd,(HMENU)8002,nullptr,nullptr);
                 g_hLogAuto = CreateWindowW(L"BUTTON", L"Auto-scroll", WS_CHILD|WS_VISIBLE|BS_AUTOCHECKBOX, x+260,y,120,24, hwnd,(HMENU)8003,nullptr,nullptr);
+                CreateWindowW(L"BUTTON", L"Export trace...", WS_CHILD|WS_VISIBLE, x+390,y,120,24, hwnd,(HMENU)8005,nullptr,nullptr);
                 SendMessageW(g_hLogAuto, BM_SETCHECK, BST_CHECKED, 0);
                 // 新：ListView 表格
                 INITCOMMONCONTROLSEX icc{sizeof(icc), ICC_LISTVIEW_CLASSES}; InitCommonControlsEx(&icc);
@@ -789,6 +882,18 @@ static void ShowLogWindow(HWND owner) {
                 ShowWindow(g_hLogEdit, SW_HIDE);
                 Log::Attach(g_hLogEdit);
                 Log::AppendHeader();
+                g_hLogMetrics = CreateWindowExW(WS_EX_CLIENTEDGE, L"EDIT", L"", WS_CHILD|WS_VISIBLE|WS_VSCROLL|ES_MULTILINE|ES_READONLY|ES_AUTOVSCROLL, 8, 568, 780, LOG_METRICS_H, hwnd, (HMENU)8006, nullptr, nullptr);
+                SendMessageW(g_hLogMetrics, WM_SETFONT, (WPARAM)GetStockObject(ANSI_FIXED_FONT), TRUE);
+                RefreshLogMetrics();
+                SetTimer(hwnd, 1, 1000, nullptr);
+                g_logSinkWnd.store(hwnd);
+                return 0; }
+            case WM_TIMER: {
+                if (w == 1 && IsWindowVisible(hwnd)) RefreshLogMetrics();
+                return 0; }
+            case WM_APP_LOG_BATCH: {
+                std::unique_ptr<std::vector<LogRowW>> rows((std::vector<LogRowW>*)l);
+                if (rows) AppendLogRows(*rows);
                 return 0; }
             case WM_ERASEBKGND: {
                 HDC hdc = (HDC)w;
@@ -813,7 +918,8 @@ static void ShowLogWindow(HWND owner) {
                 return 0; }
             case WM_SIZE: {
                 RECT rc; GetClientRect(hwnd,&rc);
-                SetWindowPos(g_hLogList,nullptr,8,40,rc.right-16,rc.bottom-48,SWP_NOZORDER);
+                SetWindowPos(g_hLogList,nullptr,8,40,rc.right-16,rc.bottom-56-LOG_METRICS_H,SWP_NOZORDER);
+                if (g_hLogMetrics) SetWindowPos(g_hLogMetrics,nullptr,8,rc.bottom-8-LOG_METRICS_H,rc.right-16,LOG_METRICS_H,SWP_NOZORDER);
                 AdjustLogColumns();
                 InvalidateRect(g_hLogList, nullptr, TRUE);
                 return 0; }
@@ -821,6 +927,15 @@ static void ShowLogWindow(HWND owner) {
                 UINT id=LOWORD(w);
                 if (id==8001) Log::SetEnabled(BST_CHECKED==SendMessageW(g_hLogChk,BM_GETCHECK,0,0));
                 if (id==8002) Log::Clear();
+                if (id==8005) {
+                    // 导出 Chrome trace-event JSON（chrome://tracing 或 ui.perfetto.dev 打开）
+                    wchar_t file[MAX_PATH] = L"pdfwv_trace.json";
+                    OPENFILENAMEW ofn{}; ofn.lStructSize = sizeof(ofn); ofn.hwndOwner = hwnd;
+                    ofn.lpstrFilter = L"Chrome Trace (*.json)\0*.json\0All Files\0*.*\0\0";
+                    ofn.lpstrFile = file; ofn.nMaxFile = MAX_PATH; ofn.lpstrDefExt = L"json";
+                    ofn.Flags = OFN_OVERWRITEPROMPT | OFN_PATHMUSTEXIST;
+                    if (GetSaveFileNameW(&ofn) && !Trace_ExportChromeJson(AsyncLog_WideToUtf8(file).c_str())) MessageBeep(MB_ICONWARNING);
+                }
                 return 0; }
             case WM_NOTIFY: {
                 LPNMHDR hdr = (LPNMHDR)l;
@@ -861,62 +976,121 @@ static void ShowLogWindow(HWND owner) {
 #endif
 }
 
-// TreeView item param
-struct TocItemData { int pageIndex; FPDF_DEST dest; };
+// 书签树：大纲一次性扁平化到 g_outline，树节点按需创建（展开时才插入子节点），
+// 标题通过 TVN_GETDISPINFO 按需提供；节点 lParam 为大纲条目下标
+static PdfOutline g_outline;
+static std::vector<HTREEITEM> g_outlineItems;   // 条目对应的树节点，未创建为 nullptr
+// 书签筛选：标题三元组索引在首次筛选时建立，筛选时只显示匹配项及其祖先
+static PdfOutlineFilter g_outlineFilter;
+static bool g_outlineFilterBuilt = false;
+static std::vector<uint8_t> g_outlineFlags;     // 每个条目的 kPdfOutline* 标志
+static bool g_outlineFiltering = false;
+static bool g_outlineSyncing = false;           // 增量更新中，忽略选中变化
+
+static bool OutlineVisible(int entry) {
+    return !g_outlineFiltering || g_outlineFlags[entry] != 0;
+}
+
+static bool OutlineHasChildren(int entry) {
+    return g_outlineFiltering ? (g_outlineFlags[entry] & kPdfOutlineAncestor) != 0 : g_outline.entries[entry].childCount > 0;
+}
 
 static void ClearBookmarks() {
-    if (!g_hToc) return;
-    // 交给 TVN_DELETEITEM 逐个释放
-    TreeView_DeleteAllItems(g_hToc);
-}
-
-static void AddBookmarkRecursive(HWND hTree, HTREEITEM hParent, FPDF_DOCUMENT doc, FPDF_BOOKMARK bm) {
-    while (bm) {
-        // 标题
-        wchar_t textW[256]{};
-        unsigned long len = FPDFBookmark_GetTitle(bm, nullptr, 0);
-        std::vector<wchar_t> wbuf; wbuf.resize((len + 1) / 2 + 1);
-        if (len > 0) FPDFBookmark_GetTitle(bm, reinterpret_cast<FPDF_WCHAR*>(wbuf.data()), len);
-        if (!wbuf.empty()) wbuf[wbuf.size()-1] = 0;
-        const wchar_t* title = wbuf.empty()? L"(书签)" : wbuf.data();
-
-        // 目标页
-        int pageIndex = -1;
-        FPDF_DEST dest = FPDFBookmark_GetDest(doc, bm);
-        if (!dest) {
-            FPDF_ACTION act = FPDFBookmark_GetAction(bm);
-            if (act) dest = FPDFAction_GetDest(doc, act);
+    if (g_hToc) TreeView_DeleteAllItems(g_hToc);
+    g_outline = PdfOutline();
+    g_outlineItems.clear();
+    g_outlineFilter = PdfOutlineFilter();
+    g_outlineFilterBuilt = false;
+    g_outlineFlags.clear();
+    g_outlineFiltering = false;
+}
+
+static HTREEITEM InsertOutlineItem(HTREEITEM hParent, HTREEITEM hAfter, int entry) {
+    TVINSERTSTRUCTW ins{};
+    ins.hParent = hParent; ins.hInsertAfter = hAfter;
+    ins.item.mask = TVIF_TEXT | TVIF_PARAM | TVIF_CHILDREN;
+    ins.item.pszText = LPSTR_TEXTCALLBACKW;
+    ins.item.cChildren = OutlineHasChildren(entry) ? 1 : 0;
+    ins.item.lParam = (LPARAM)entry;
+    return g_outlineItems[entry] = TreeView_InsertItem(g_hToc, &ins);
+}
+
+static void InsertOutlineChildren(HTREEITEM hParent, int entry) {
+    const int count = g_outline.ChildCount(entry);
+    for (int i = 0; i < count; ++i) {
+        const int child = g_outline.Child(entry, i);
+        if (OutlineVisible(child)) InsertOutlineItem(hParent, TVI_LAST, child);
+    }
+}
+
+// 筛选变化后增量更新书签树：删除不再可见的节点，在展开过的父节点下按序补插新可见的节点，
+// 并展开匹配项的祖先。同一父节点的子条目在大纲中连续且下标大于父条目，按下标一遍即可
+static void SyncOutlineTree() {
+    SendMessageW(g_hToc, WM_SETREDRAW, FALSE, 0);
+    int block = -2;                 // 当前这组兄弟条目的父条目
+    HTREEITEM parentItem = nullptr, prev = TVI_FIRST;
+    bool populated = false;         // 父节点的子节点是否已插入过
+    for (int e = 0; e < (int)g_outline.entries.size(); ++e) {
+        const int parent = g_outline.entries[e].parent;
+        if (parent != block) {
+            block = parent;
+            parentItem = parent < 0 ? TVI_ROOT : g_outlineItems[parent];
+            populated = parent < 0 || (parentItem && (TreeView_GetItemState(g_hToc, parentItem, TVIS_EXPANDEDONCE) & TVIS_EXPANDEDONCE));
+            prev = TVI_FIRST;
         }
-        if (dest) {
-            pageIndex = FPDFDest_GetDestPageIndex(doc, dest);
+        if (!OutlineVisible(e)) {
+            // 子树随之删除，TVN_DELETEITEM 清空对应记录
+            if (g_outlineItems[e]) TreeView_DeleteItem(g_hToc, g_outlineItems[e]);
+            continue;
         }
-
-        // 使用 unique_ptr 管理，再将所有权交给 TreeView（TVITEM.lParam 为长生命周期存储）
-        auto dataPtr = std::make_unique<TocItemData>();
-        dataPtr->pageIndex = pageIndex;
-        dataPtr->dest = dest;
-        TocItemData* data = dataPtr.release();
-        TVINSERTSTRUCTW ins{};
-        ins.hParent = hParent; ins.hInsertAfter = TVI_LAST;
-        ins.item.mask = TVIF_TEXT | TVIF_PARAM;
-        ins.item.pszText = const_cast<wchar_t*>(title);
-        ins.item.lParam = reinterpret_cast<LPARAM>(data);
-        HTREEITEM hNode = TreeView_InsertItem(hTree, &ins);
-
-        // 子节点
-        FPDF_BOOKMARK child = FPDFBookmark_GetFirstChild(doc, bm);
-        if (child) AddBookmarkRecursive(hTree, hNode, doc, child);
-
-        bm = FPDFBookmark_GetNextSibling(doc, bm);
+        if (g_outlineItems[e]) {
+            TVITEMW it{}; it.mask = TVIF_CHILDREN; it.hItem = g_outlineItems[e]; it.cChildren = OutlineHasChildren(e) ? 1 : 0;
+            TreeView_SetItem(g_hToc, &it);
+        } else if (populated) {
+            InsertOutlineItem(parentItem, prev, e);
+        }
+        if (!g_outlineItems[e]) continue;
+        prev = g_outlineItems[e];
+        if (g_outlineFiltering && (g_outlineFlags[e] & kPdfOutlineAncestor)) TreeView_Expand(g_hToc, prev, TVE_EXPAND);
     }
+    SendMessageW(g_hToc, WM_SETREDRAW, TRUE, 0);
+    InvalidateRect(g_hToc, nullptr, TRUE);
+}
+
+static void ApplyOutlineFilter() {
+    if (!g_hTocFilter || g_outline.Empty()) return;
+    wchar_t buf[256]{};
+    GetWindowTextW(g_hTocFilter, buf, 256);
+    const std::u16string query(buf, buf + wcslen(buf));
+    if (query.empty() && !g_outlineFiltering) return;
+    if (!query.empty()) {
+        if (!g_outlineFilterBuilt) { g_outlineFilter = PdfOutlineFilter_Build(g_outline); g_outlineFilterBuilt = true; }
+        PdfOutlineFilter_Match(g_outline, g_outlineFilter, query, g_outlineFlags);
+    }
+    g_outlineFiltering = !query.empty();
+    g_outlineSyncing = true;
+    SyncOutlineTree();
+    g_outlineSyncing = false;
 }
 
 static void BuildBookmarks(HWND hWnd) {
     if (!g_hToc) return;
+    PDFWV_TRACE_SCOPE("ui", "outline_build");
     ClearBookmarks();
     if (!g_doc) return;
-    FPDF_BOOKMARK root = FPDFBookmark_GetFirstChild(g_doc, nullptr);
-    AddBookmarkRecursive(g_hToc, TVI_ROOT, g_doc, root);
+    g_outline = PdfOutline_Build(g_doc);
+    g_outlineItems.assign(g_outline.entries.size(), nullptr);
+    SendMessageW(g_hToc, WM_SETREDRAW, FALSE, 0);
+    InsertOutlineChildren(TVI_ROOT, -1);
+    SendMessageW(g_hToc, WM_SETREDRAW, TRUE, 0);
+    // 筛选框保留内容时对新文档同样生效
+    ApplyOutlineFilter();
+}
+
+// 书签节点对应的目标页，-1 表示无跳转
+static int OutlineItemPage(LPARAM param) {
+    const int entry = (int)param;
+    return (entry >= 0 && entry < (int)g_outline.entries.size()) ? g_outline.entries[entry].pageIndex : -1;
 }
 
 static void LayoutStatusBarChildren(HWND hWnd) {
@@ -1033,7 +1207,9 @@ static void UpdateStatusBarInfo(HWND hWnd) {
 	swprintf(buf, 64, L"%d", cur);
 	if (g_hPageEdit) SetWindowTextW(g_hPageEdit, buf);
 	swprintf(buf, 64, L"/ %d", total);
-	if (g_hPageTotal) SetWindowTextW(g_hPageTotal, buf);
+	std::wstring totalText = buf;
+	if (g_hoverEntry) totalText += L"    " + DescribeHitEntry(*g_hoverEntry);
+	if (g_hPageTotal) SetWindowTextW(g_hPageTotal, totalText.c_str());
     // 移除右侧重复的大号文本
 }
 
@@ -1105,6 +1281,112 @@ static LRESULT CALLBACK TocSubclassProc(HWND hwnd, UINT msg, WPARAM wParam, LPAR
     return DefSubclassProc(hwnd, msg, wParam, lParam);
 }
 
+// 交互会话录制：记录输入事件处理后的视口状态（设备像素），供 pdfwv_replay 回放
+static void RecordSessionViewport(HWND hWnd, const char* source) {
+	if (!g_doc || !Session_IsRecording()) return;
+	SessionViewport v;
+	v.page = g_page_index;
+	v.zoom = g_zoom;
+	v.scrollX = g_scrollX;
+	v.scrollY = g_scrollY;
+	GetContentClientSize(hWnd, v.viewW, v.viewH);
+	v.pxPerPt = g_dpiX / 72.0;
+	v.fullPage = false;
+	Session_RecordViewport(source, v);
+}
+
+// 选区以页面点坐标（原点左上）记录起点与当前点，与缩放/DPI 无关
+static void RecordSessionSelection(const char* source, bool final) {
+	if (!g_doc || !Session_IsRecording()) return;
+	auto toPageX = [](LONG x) { return (x - g_contentOriginX + g_scrollX) * (72.0 / g_dpiX) / g_zoom; };
+	auto toPageY = [](LONG y) { return (y - g_contentOriginY + g_scrollY) * (72.0 / g_dpiY) / g_zoom; };
+	Session_RecordSelection(source, g_page_index, toPageX(g_selStart.x), toPageY(g_selStart.y), toPageX(g_selEnd.x), toPageY(g_selEnd.y), final);
+}
+
+static void ToggleSessionRecording(HWND hWnd) {
+	if (Session_IsRecording()) {
+		Session_Stop();
+		CheckMenuItem(g_hSettingsMenu, ID_VIEW_RECORD_SESSION, MF_BYCOMMAND | MF_UNCHECKED);
+		return;
+	}
+	std::wstring path = SaveDialogWithExt(hWnd, L"pdfwv_session.ndjson", L"Session (*.ndjson)\0*.ndjson\0All Files\0*.*\0\0", L"ndjson");
+	if (path.empty()) return;
+	if (!Session_Start(WideToUTF8(path).c_str(), WideToUTF8(g_currentDocPath).c_str())) { MessageBeep(MB_ICONWARNING); return; }
+	CheckMenuItem(g_hSettingsMenu, ID_VIEW_RECORD_SESSION, MF_BYCOMMAND | MF_CHECKED);
+	RecordSessionViewport(hWnd, "start");
+}
+
+// 热力图模式下，页码或缩放变化后在绘制前重算；最慢的对象写入日志窗口
+static void EnsureRenderCostProfile() {
+	if (!g_showRenderCost || !g_doc || g_pagePxW <= 0 || g_pagePxH <= 0) return;
+	if (g_renderCost.pageIndex == g_page_index && g_renderCost.pagePxW == g_pagePxW && g_renderCost.pagePxH == g_pagePxH) return;
+	HCURSOR oldCursor = SetCursor(LoadCursor(nullptr, IDC_WAIT));
+	const bool ok = PdfProfileRenderCost(g_doc, g_page_index, g_pagePxW, g_pagePxH, MulDiv(64, g_dpiX, 96), FPDF_ANNOT | FPDF_LCD_TEXT, g_renderCost);
+	SetCursor(oldCursor);
+	if (!ok) { g_renderCost.pageIndex = g_page_index; return; }
+	LOGF(LogLevel::Debug, "Render cost page %d: full %.1f ms, %dx%d tiles %.2f..%.2f ms, %d objects",
+		g_page_index + 1, g_renderCost.fullMs, g_renderCost.cols, g_renderCost.rows, g_renderCost.minTileMs, g_renderCost.maxTileMs, (int)g_renderCost.objects.size());
+	for (size_t i = 0; i < g_renderCost.objects.size() && i < 10; ++i) {
+		const RenderObjectCost& o = g_renderCost.objects[i];
+		LOGF(LogLevel::Debug, "  #%d object %d (%hs) %.2f ms, bounds [%.1f %.1f %.1f %.1f]",
+			(int)i + 1, o.index, PdfPageObjectTypeName(o.type), o.ms, o.left, o.bottom, o.right, o.top);
+	}
+}
+
+static void ToggleRenderCostHeatmap(HWND hWnd) {
+	g_showRenderCost = !g_showRenderCost;
+	g_renderCost = RenderCostProfile{};
+	CheckMenuItem(g_hSettingsMenu, ID_VIEW_RENDER_COST, MF_BYCOMMAND | (g_showRenderCost ? MF_CHECKED : MF_UNCHECKED));
+	InvalidateRect(hWnd, nullptr, FALSE);
+}
+
+static bool RenderCostProfileIsCurrent() {
+	return g_showRenderCost && g_renderCost.pageIndex == g_page_index && g_renderCost.pagePxW == g_pagePxW && g_renderCost.pagePxH == g_pagePxH;
+}
+
+// 图块按耗时叠加红色（直接混合进渲染缓冲，BGRA）；bitmap 从页面像素 (g_scrollX, g_scrollY) 开始
+static void BlendRenderCostTiles(uint8_t* bgra, int stride, int cw, int ch) {
+	for (const RenderTileCost& t : g_renderCost.tiles) {
+		const int alpha = (int)std::lround(g_renderCost.TileHeat(t) * 150.0);
+		if (alpha <= 0) continue;
+		const int x0 = std::max(0, t.x - g_scrollX), x1 = std::min(cw, t.x + t.w - g_scrollX);
+		const int y0 = std::max(0, t.y - g_scrollY), y1 = std::min(ch, t.y + t.h - g_scrollY);
+		for (int y = y0; y < y1; ++y) {
+			uint8_t* px = bgra + (size_t)y * stride + (size_t)x0 * 4;
+			for (int x = x0; x < x1; ++x, px += 4) {
+				px[0] = (uint8_t)(px[0] * (255 - alpha) / 255);
+				px[1] = (uint8_t)(px[1] * (255 - alpha) / 255);
+				px[2] = (uint8_t)((px[2] * (255 - alpha) + 255 * alpha) / 255);
+			}
+		}
+	}
+}
+
+// 最慢的 5 个对象：描边并标注名次
+static void DrawRenderCostObjects(HDC hdc, double pageHeightPt) {
+	const double k = g_dpiX / 72.0 * g_zoom;
+	HPEN pen = CreatePen(PS_SOLID, 2, RGB(255, 128, 0));
+	HGDIOBJ oldPen = SelectObject(hdc, pen);
+	HGDIOBJ oldBrush = SelectObject(hdc, GetStockObject(NULL_BRUSH));
+	SetBkMode(hdc, TRANSPARENT);
+	SetTextColor(hdc, RGB(255, 128, 0));
+	for (size_t i = 0; i < g_renderCost.objects.size() && i < 5; ++i) {
+		const RenderObjectCost& o = g_renderCost.objects[i];
+		if (o.ms <= 0.0) break;
+		const int l = (int)std::lround(o.left * k) - g_scrollX + g_contentOriginX;
+		const int r = (int)std::lround(o.right * k) - g_scrollX + g_contentOriginX;
+		const int t = (int)std::lround((pageHeightPt - o.top) * k) - g_scrollY + g_contentOriginY;
+		const int b = (int)std::lround((pageHeightPt - o.bottom) * k) - g_scrollY + g_contentOriginY;
+		Rectangle(hdc, l, t, r, b);
+		wchar_t label[48];
+		swprintf(label, 48, L"#%d %.1f ms", (int)i + 1, o.ms);
+		TextOutW(hdc, l + 3, t + 2, label, (int)wcslen(label));
+	}
+	SelectObject(hdc, oldBrush);
+	SelectObject(hdc, oldPen);
+	DeleteObject(pen);
+}
+
 static void SetZoom(HWND hWnd, double newZoom, POINT* anchorClient) {
 	newZoom = std::min(8.0, std::max(0.1, newZoom));
 	if (!g_doc) { g_zoom = newZoom; return; }
@@ -1130,30 +1412,70 @@ static void SetZoom(HWND hWnd, double newZoom, POINT* anchorClient) {
 	InvalidateRect(hWnd, nullptr, TRUE);
 }
 
+// 上一帧的视口位图。拖选、改查找词时画面只有叠加层在变，直接复用，不再加载页面重新光栅化
+struct PageFrame {
+	FPDF_BITMAP bmp = nullptr;
+	int page = -1, pagePxW = 0, pagePxH = 0, scrollX = 0, scrollY = 0, cw = 0, ch = 0;
+	bool costOverlay = false;
+	double pageHeightPt = 0;
+};
+static PageFrame g_frame;
+static bool g_paintOverlayOnly = false;   // 下一次 WM_PAINT 只更新叠加层（选区/查找高亮）
+
+static void ReleasePageFrame() {
+	if (g_frame.bmp) {
+		FPDFBitmap_Destroy(g_frame.bmp);
+		Metrics_MemoryAdd(MemCategory::RenderBitmap, -(int64_t)g_frame.cw * g_frame.ch * 4);
+	}
+	g_frame = PageFrame{};
+}
+
+static bool PageFrameIsCurrent(int cw, int ch, bool costOverlay) {
+	return g_frame.bmp && g_frame.page == g_page_index && g_frame.pagePxW == g_pagePxW && g_frame.pagePxH == g_pagePxH &&
+		g_frame.scrollX == g_scrollX && g_frame.scrollY == g_scrollY && g_frame.cw == cw && g_frame.ch == ch && g_frame.costOverlay == costOverlay;
+}
+
+static void BlitPageFrame(HDC hdc) {
+	BITMAPINFO bmi{}; bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	bmi.bmiHeader.biWidth = g_frame.cw; bmi.bmiHeader.biHeight = -g_frame.ch; bmi.bmiHeader.biPlanes = 1;
+	bmi.bmiHeader.biBitCount = 32; bmi.bmiHeader.biCompression = BI_RGB;
+	{ PDFWV_TRACE_SCOPE("render", "blit"); StretchDIBits(hdc, g_contentOriginX, g_contentOriginY, g_frame.cw, g_frame.ch, 0, 0, g_frame.cw, g_frame.ch, FPDFBitmap_GetBuffer(g_frame.bmp), &bmi, DIB_RGB_COLORS, SRCCOPY); }
+	if (g_frame.costOverlay) DrawRenderCostObjects(hdc, g_frame.pageHeightPt);
+}
+
 static void RenderPageToDC(HWND hWnd, HDC hdc) {
 	if (!g_doc) return;
 	int page_count = FPDF_GetPageCount(g_doc);
 	if (g_page_index < 0) g_page_index = 0;
 	if (g_page_index >= page_count) g_page_index = page_count - 1;
 	int cw = 0, ch = 0; GetContentClientSize(hWnd, cw, ch);
+	const bool costOverlay = RenderCostProfileIsCurrent();
+	if ((g_selecting || g_paintOverlayOnly) && PageFrameIsCurrent(cw, ch, costOverlay)) {
+		BlitPageFrame(hdc);
+		return;
+	}
+	PDFWV_TRACE_SCOPE_PAGE("render", "paint", g_page_index);
+	MetricTimer renderTimer(Metrics_RenderLatency(g_zoom * 100.0));
 	// 性能计时开始
 	#if PDFWV_ENABLE_LOGGING
 	LARGE_INTEGER _pf, _t0, _t1; QueryPerformanceFrequency(&_pf); QueryPerformanceCounter(&_t0);
 	#endif
-	FPDF_PAGE page = FPDF_LoadPage(g_doc, g_page_index);
+	FPDF_PAGE page = nullptr;
+	{ PDFWV_TRACE_SCOPE_PAGE("page", "page_load", g_page_index); MetricTimer loadTimer(Metrics_PageLoadLatency()); page = FPDF_LoadPage(g_doc, g_page_index); }
 	if (!page) return;
-	FPDF_BITMAP bmp = FPDFBitmap_Create(cw, ch, 1);
+	int flags = FPDF_ANNOT | FPDF_LCD_TEXT;
+	FPDF_BITMAP bmp = nullptr;
+	// 与 pdfwv_replay 共用同一渲染路径，回放会话时测到的就是这里的开销
+	{ PDFWV_TRACE_SCOPE_PAGE("render", "render_bitmap", g_page_index); bmp = PdfRenderPageRegion(page, g_pagePxW, g_pagePxH, g_scrollX, g_scrollY, cw, ch, flags); }
 	if (bmp) {
-		FPDFBitmap_FillRect(bmp, 0, 0, cw, ch, 0xFFFFFFFF);
-		int flags = FPDF_ANNOT | FPDF_LCD_TEXT;
-		FPDF_RenderPageBitmap(bmp, page, -g_scrollX, -g_scrollY, g_pagePxW, g_pagePxH, 0, flags);
-		void* buffer = FPDFBitmap_GetBuffer(bmp);
-		BITMAPINFO bmi{}; bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-		bmi.bmiHeader.biWidth = cw; bmi.bmiHeader.biHeight = -ch; bmi.bmiHeader.biPlanes = 1;
-		bmi.bmiHeader.biBitCount = 32; bmi.bmiHeader.biCompression = BI_RGB;
-		StretchDIBits(hdc, g_contentOriginX, g_contentOriginY, cw, ch, 0, 0, cw, ch, buffer, &bmi, DIB_RGB_COLORS, SRCCOPY);
-		FPDFBitmap_Destroy(bmp);
-	}
+		if (costOverlay) BlendRenderCostTiles((uint8_t*)FPDFBitmap_GetBuffer(bmp), FPDFBitmap_GetStride(bmp), cw, ch);
+		ReleasePageFrame();
+		g_frame = PageFrame{ bmp, g_page_index, g_pagePxW, g_pagePxH, g_scrollX, g_scrollY, cw, ch, costOverlay, FPDF_GetPageHeightF(page) };
+		Metrics_MemoryAdd(MemCategory::RenderBitmap, (int64_t)cw * ch * 4);
+		BlitPageFrame(hdc);
+	}
+	// 页面已加载，顺带建好命中表，悬停/点击时无需再加载页面
+	PdfHitMap_Get(g_doc, g_page_index, page);
 	FPDF_ClosePage(page);
 	#if PDFWV_ENABLE_LOGGING
 	QueryPerformanceCounter(&_t1);
@@ -1179,6 +1501,21 @@ static void RenderPageToDC(HWND hWnd, HDC hdc) {
 	#endif
 }
 
+// 输入→上屏延迟超过 16/33ms 的帧写入日志窗口，附带当时的页码与缩放
+static void ReportFramePresent(const FramePresent& f) {
+	#if PDFWV_ENABLE_LOGGING
+	if (f.jankLevel == 0 || !Log::IsEnabled()) return;
+	PROCESS_MEMORY_COUNTERS_EX pmc{};
+	double curMB = 0.0;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS*)&pmc, sizeof(pmc))) curMB = pmc.PrivateUsage / (1024.0*1024.0);
+	if (f.jankLevel >= 2) Log::WritePerfEx(g_page_index+1, g_zoom*100.0, f.inputToPresentMs, curMB, 0.0, L"卡顿帧 >33ms：输入→上屏", __FILE__, __LINE__, __FUNCTION__);
+	else Log::WritePerfEx(g_page_index+1, g_zoom*100.0, f.inputToPresentMs, curMB, 0.0, L"卡顿帧 >16ms：输入→上屏", __FILE__, __LINE__, __FUNCTION__);
+	LOGF(LogLevel::Warning, "Jank frame: %hs -> present %.1f ms (page %d, zoom %.0f%%)", f.source ? f.source : "?", f.inputToPresentMs, g_page_index + 1, g_zoom * 100.0);
+	#else
+	(void)f;
+	#endif
+}
+
 static void EnsureGdiplus() {
     if (g_gdiplusToken == 0) {
         Gdiplus::GdiplusStartupInput si{};
@@ -1232,6 +1569,7 @@ static bool ExportCurrentPageAsPNG(HWND hWnd) {
     if (!page) return false;
     FPDF_BITMAP bmp = FPDFBitmap_Create(g_pagePxW, g_pagePxH, 1);
     if (!bmp) { FPDF_ClosePage(page); return false; }
+    MemoryCharge bmpMem(MemCategory::RenderBitmap, (int64_t)g_pagePxW * g_pagePxH * 4);
     FPDFBitmap_FillRect(bmp, 0, 0, g_pagePxW, g_pagePxH, 0xFFFFFFFF);
     int flags = FPDF_ANNOT | FPDF_LCD_TEXT;
     FPDF_RenderPageBitmap(bmp, page, 0, 0, g_pagePxW, g_pagePxH, 0, flags);
@@ -1386,9 +1724,27 @@ static bool SaveImageFromObject(HWND hWnd, FPDF_PAGE page, FPDF_PAGEOBJECT imgOb
 	if (!page || !imgObj) return false;
 	EnsureCOM();
 	
-	// 使用共享的 pdf_utils 模块获取位图
-	FPDF_BITMAP hold = PdfAcquireBitmapForImage(g_doc, page, imgObj);
-	if (!hold) {
+	// JPEG / JPEG 2000 直接写出嵌入的码流：不解码、不重新编码，扫描件保存即字节拷贝
+	PdfRawImage raw;
+	if (PdfExtractRawImage(page, imgObj, raw)) {
+		std::wstring ext = AsyncLog_Utf8ToWide(raw.extension);
+		std::wstring defName = L"image." + ext;
+		std::wstring path = ext == L"jpg" ? SaveDialogWithExt(hWnd, defName.c_str(), L"JPEG Image (*.jpg)\0*.jpg\0\0", L"jpg")
+							 : SaveDialogWithExt(hWnd, defName.c_str(), L"JPEG 2000 Image (*.jp2;*.j2k)\0*.jp2;*.j2k\0\0", ext.c_str());
+		if (path.empty() || g_inFileDialog) return false;
+		g_inFileDialog = true;
+		bool ok = SaveBinaryToFile(path.c_str(), raw.data.data(), raw.data.size());
+		g_inFileDialog = false;
+		#if PDFWV_ENABLE_LOGGING
+		LOGF(LogLevel::Debug, "Saved %hs stream as-is: %zu bytes", raw.filter, raw.data.size());
+		#endif
+		return ok;
+	}
+	
+	// 其他编码（JBIG2、CCITT、Flate 像素等）解码后再编码。经共享图片缓存获取，但 Windows 版读不到
+	// 图像对象号和解码参数，无法安全区分流字节相同的图片，缓存不保留结果，每次保存都会重新解码
+	PdfDecodedImageRef image = PdfImageCache_Acquire(g_doc, page, imgObj);
+	if (!image) {
 		// 调试日志：获取位图失败
 		#if PDFWV_ENABLE_LOGGING
 		LOGF(LogLevel::Warning, "Failed to acquire bitmap for image object");
@@ -1396,14 +1752,13 @@ static bool SaveImageFromObject(HWND hWnd, FPDF_PAGE page, FPDF_PAGEOBJECT imgOb
 		return false;
 	}
 	
-	void* buffer = FPDFBitmap_GetBuffer(hold);
-	int width = FPDFBitmap_GetWidth(hold);
-	int height = FPDFBitmap_GetHeight(hold);
-	int stride = FPDFBitmap_GetStride(hold);
-	int fmt = FPDFBitmap_GetFormat(hold);
+	const void* buffer = image->Buffer();
+	int width = image->width;
+	int height = image->height;
+	int stride = image->stride;
+	int fmt = image->format;
 	
 	if (!buffer || width <= 0 || height <= 0) {
-		FPDFBitmap_Destroy(hold);
 		#if PDFWV_ENABLE_LOGGING
 		LOGF(LogLevel::Warning, "Invalid bitmap data: buffer=%p, size=%dx%d", buffer, width, height);
 		#endif
@@ -1423,10 +1778,9 @@ static bool SaveImageFromObject(HWND hWnd, FPDF_PAGE page, FPDF_PAGEOBJECT imgOb
 		}
 	}
 	
-	// 如果不是 BGRA 格式，需要转换
-	static std::vector<unsigned char> convBuffer;
+	// 如果不是 BGRA 格式，需要转换（缓存保留解码原格式，转换缓冲随本次保存释放）
+	std::vector<unsigned char> convBuffer;
 	if (fmt != FPDFBitmap_BGRA && fmt != FPDFBitmap_BGRA_Premul) {
-		convBuffer.clear();
 		ConvertAnyToBGRA(buffer, width, height, stride, fmt, convBuffer);
 		buffer = convBuffer.data();
 		stride = width * 4;
@@ -1439,8 +1793,8 @@ static bool SaveImageFromObject(HWND hWnd, FPDF_PAGE page, FPDF_PAGEOBJECT imgOb
 	std::wstring defName = preferJpeg ? L"image.jpg" : L"image.png";
 	std::wstring path = preferJpeg ? SaveDialogWithExt(hWnd, defName.c_str(), L"JPEG Image (*.jpg)\0*.jpg\0\0", L"jpg")
 						 : SaveDialogWithExt(hWnd, defName.c_str(), L"PNG Image (*.png)\0*.png\0\0", L"png");
-	if (path.empty()) { if (hold) FPDFBitmap_Destroy(hold); return false; }
-	if (g_inFileDialog) { if (hold) FPDFBitmap_Destroy(hold); return false; }
+	if (path.empty()) return false;
+	if (g_inFileDialog) return false;
 	g_inFileDialog = true;
 	bool ok = preferJpeg ? SaveBufferAsJpeg(path.c_str(), buffer, width, height, stride, 90)
 						 : SaveBufferAsPng(path.c_str(), buffer, width, height, stride);
@@ -1457,7 +1811,6 @@ static bool SaveImageFromObject(HWND hWnd, FPDF_PAGE page, FPDF_PAGEOBJECT imgOb
 	// 反馈保存结果（临时诊断用）
 	// wchar_t msg[512]; swprintf(msg, 512, L"Save image %s\nSize: %dx%d\nPath: %s", ok?L"OK":L"FAILED", width, height, (ok? path.c_str(): L"(see fallback/unknown)"));
 	// MessageBoxW(hWnd, msg, L"SaveImageFromObject", ok? MB_ICONINFORMATION : MB_ICONERROR);
-	if (hold) FPDFBitmap_Destroy(hold);
 	return ok;
 }
 
@@ -1498,40 +1851,136 @@ static std::wstring SaveImageDialog(HWND hWnd, const wchar_t* baseName) {
 	if (GetSaveFileNameW(&ofn)) return file; return L"";
 }
 
-static void CollectImagesFlat(FPDF_PAGE page, FPDF_PAGEOBJECT obj, std::vector<FPDF_PAGEOBJECT>& out) {
-	int type = FPDFPageObj_GetType(obj);
-	if (type == FPDF_PAGEOBJ_IMAGE) { out.push_back(obj); return; }
-	if (type == FPDF_PAGEOBJ_FORM) {
-		int n = FPDFFormObj_CountObjects(obj);
-		for (int i=0;i<n;++i) {
-			FPDF_PAGEOBJECT child = FPDFFormObj_GetObject(obj, (unsigned long)i);
-			if (child) CollectImagesFlat(page, child, out);
+static std::wstring PickFolderDialog(HWND owner) {
+	EnsureCOM();
+	ComPtr<IFileDialog> pfd;
+	HRESULT hr = CoCreateInstance(CLSID_FileOpenDialog, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&pfd));
+	if (FAILED(hr) || !pfd) return L"";
+	DWORD opt = 0; pfd->GetOptions(&opt); pfd->SetOptions(opt | FOS_PICKFOLDERS | FOS_FORCEFILESYSTEM);
+	if (FAILED(pfd->Show(owner))) return L"";
+	ComPtr<IShellItem> it;
+	if (FAILED(pfd->GetResult(&it)) || !it) return L"";
+	PWSTR pszRaw = nullptr;
+	if (FAILED(it->GetDisplayName(SIGDN_FILESYSPATH, &pszRaw)) || !pszRaw) return L"";
+	std::unique_ptr<wchar_t, CoTaskMemDeleter> psz(pszRaw);
+	return psz.get();
+}
+
+// 导出文档中的全部图片：PDFium 工作在本线程（独立的文档实例），编码与写盘在工作线程；
+// 进度显示在标题栏，期间泵消息保持界面响应，Esc 取消
+static bool ExtractAllImages(HWND hWnd) {
+	if (!g_doc || g_currentDocPath.empty() || g_extractingImages) return false;
+	std::wstring dir = PickFolderDialog(hWnd);
+	if (dir.empty()) return false;
+	EnsureGdiplus(); // 工作线程并发编码前完成 GDI+ 初始化
+	g_extractingImages = true;
+
+	ImageExtractOptions options;
+	options.outDir = WideToUTF8(dir);
+	auto encode = [](const std::string& path, const uint8_t* bgra, int width, int height, int stride) -> uint64_t {
+		std::wstring wpath = AsyncLog_Utf8ToWide(path);
+		if (!SaveBufferAsPng(wpath.c_str(), bgra, width, height, stride)) return 0;
+		WIN32_FILE_ATTRIBUTE_DATA fad{};
+		if (!GetFileAttributesExW(wpath.c_str(), GetFileExInfoStandard, &fad)) return 0;
+		return ((uint64_t)fad.nFileSizeHigh << 32) | fad.nFileSizeLow;
+	};
+	bool cancel = false;
+	auto progress = [&](const ImageExtractProgress& p) {
+		wchar_t title[256];
+		swprintf(title, 256, L"导出图片 %d/%d 页 · %d 张 · %.1f 张/秒 · %.1f MB/s（Esc 取消）",
+			p.pagesDone, p.pageCount, p.imagesWritten, p.ImagesPerSecond(), p.MegabytesPerSecond());
+		SetWindowTextW(hWnd, title);
+		MSG msg;
+		while (PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE)) {
+			if (msg.message == WM_QUIT) { PostQuitMessage((int)msg.wParam); cancel = true; break; }
+			if (msg.message == WM_KEYDOWN && msg.wParam == VK_ESCAPE) { cancel = true; continue; }
+			TranslateMessage(&msg);
+			DispatchMessageW(&msg);
 		}
-	}
+		return !cancel;
+	};
+	ImageExtractProgress result;
+	std::string error;
+	bool ok = PdfExtractAllImages(WideToUTF8(g_currentDocPath), options, encode, progress, result, error);
+	g_extractingImages = false;
+	UpdateWindowTitle(hWnd);
+	#if PDFWV_ENABLE_LOGGING
+	LOGF(LogLevel::Debug, "Extract all images: %d written (%d as-is), %d duplicates (%d after decoding), %d failed, %.1f MB in %.0f ms (%.1f img/s)%hs",
+		result.imagesWritten, result.passthrough, result.duplicates, result.decodedDuplicates, result.failed, result.bytesWritten / 1048576.0,
+		result.elapsedMs, result.ImagesPerSecond(), result.cancelled ? ", cancelled" : "");
+	#endif
+	// Windows 版链接 pdfium.dll，公开接口读不到图像对象号和 /Decode 等参数：
+	// 需解码的共享图片每次出现都要解码一遍，解码后按像素去重，只省去编码和写盘
+	wchar_t msg[640];
+	if (!ok) swprintf(msg, 640, L"无法打开文档：%hs", error.c_str());
+	else swprintf(msg, 640, L"%s导出 %d 张图片（%d 张原样写出 JPEG/JPEG 2000），跳过重复 %d 张，失败 %d 张\n%.1f MB，用时 %.1f 秒，%.1f 张/秒\n%s%s",
+		result.cancelled ? L"已取消。" : L"", result.imagesWritten, result.passthrough, result.duplicates, result.failed,
+		result.bytesWritten / 1048576.0, result.elapsedMs / 1000.0, result.ImagesPerSecond(), dir.c_str(),
+		result.decodedDuplicates ? L"\n\n注意：Windows 版无法识别同一图像对象，重复出现的图片仍会逐次解码（解码后按像素去重），文档中共享图片较多时导出较慢。" : L"");
+	MessageBoxW(hWnd, msg, L"导出全部图片", MB_OK | ((ok && !result.failed) ? MB_ICONINFORMATION : MB_ICONWARNING));
+	return ok;
 }
-static bool PageHasAnyImage(FPDF_PAGE page) {
-	int count = FPDFPage_CountObjects(page);
-	for (int i=0;i<count;++i) {
-		FPDF_PAGEOBJECT obj = FPDFPage_GetObject(page, i);
-		if (!obj) continue;
-		int t = FPDFPageObj_GetType(obj);
-		if (t == FPDF_PAGEOBJ_IMAGE) return true;
-		if (t == FPDF_PAGEOBJ_FORM) {
-			std::vector<FPDF_PAGEOBJECT> tmp; CollectImagesFlat(page, obj, tmp);
-			if (!tmp.empty()) return true;
-		}
-	}
-	return false;
+
+// 图片清单来自后台建立的图片目录（image_catalog），无需逐页加载
+static bool ExportImageList(HWND hWnd) {
+	if (!g_doc || !PdfImageCatalog_Status().complete) return false;
+	std::wstring path = SaveDialogWithExt(hWnd, L"images.csv", L"CSV (*.csv)\0*.csv\0\0", L"csv");
+	if (path.empty()) return false;
+	bool ok = PdfImageCatalog_WriteCsv(WideToUTF8(path));
+	if (!ok) MessageBoxW(hWnd, path.c_str(), L"无法写入图片清单", MB_OK | MB_ICONWARNING);
+	return ok;
 }
-static FPDF_PAGEOBJECT FindLargestImage(FPDF_PAGE page) {
-	std::vector<FPDF_PAGEOBJECT> all;
-	int count = FPDFPage_CountObjects(page);
-	for (int i=0;i<count;++i) { FPDF_PAGEOBJECT obj = FPDFPage_GetObject(page, i); if (obj) CollectImagesFlat(page, obj, all); }
-	FPDF_PAGEOBJECT best=nullptr; unsigned int bestPixels=0;
-	for (auto obj : all) {
-		unsigned int w=0,h=0; if (FPDFImageObj_GetImagePixelSize(obj,&w,&h)) { unsigned int p=w*h; if (p>bestPixels) { bestPixels=p; best=obj; } }
-	}
-	return best;
+
+// 导出全文文本：PDFium 工作在本线程（独立的文档实例），行拼接与编码在工作线程，按页序流式写入；
+// 保存为 .tsv 时每行附带包围盒。进度显示在标题栏，期间泵消息保持界面响应，Esc 取消
+static bool ExportAllText(HWND hWnd) {
+	if (!g_doc || g_currentDocPath.empty() || g_exportingText) return false;
+	std::wstring defName = PathFindFileNameW(g_currentDocPath.c_str());
+	PathRemoveExtensionW(defName.data()); defName.resize(wcslen(defName.c_str()));
+	defName += L".txt";
+	std::wstring path = SaveDialogWithExt(hWnd, defName.c_str(),
+		L"Text (*.txt)\0*.txt\0Text with line boxes (*.tsv)\0*.tsv\0\0", L"txt");
+	if (path.empty()) return false;
+	FILE* out = _wfopen(path.c_str(), L"wb");
+	if (!out) { MessageBoxW(hWnd, path.c_str(), L"无法写入文件", MB_OK | MB_ICONWARNING); return false; }
+	g_exportingText = true;
+
+	TextExportOptions options;
+	options.lineBoxes = _wcsicmp(PathFindExtensionW(path.c_str()), L".tsv") == 0;
+	auto write = [out](const char* data, size_t size) { return fwrite(data, 1, size, out) == size; };
+	bool cancel = false;
+	auto progress = [&](const TextExportProgress& p) {
+		wchar_t title[256];
+		swprintf(title, 256, L"导出文本 %d/%d 页 · %.1f 页/秒 · %.1f MB/s（Esc 取消）",
+			p.pagesRead, p.pageCount, p.PagesPerSecond(), p.MegabytesPerSecond());
+		SetWindowTextW(hWnd, title);
+		MSG msg;
+		while (PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE)) {
+			if (msg.message == WM_QUIT) { PostQuitMessage((int)msg.wParam); cancel = true; break; }
+			if (msg.message == WM_KEYDOWN && msg.wParam == VK_ESCAPE) { cancel = true; continue; }
+			TranslateMessage(&msg);
+			DispatchMessageW(&msg);
+		}
+		return !cancel;
+	};
+	TextExportProgress result;
+	std::string error;
+	bool ok = PdfExportText(WideToUTF8(g_currentDocPath), options, write, progress, result, error);
+	if (fclose(out) != 0 && ok) { ok = false; error = "writing the output failed"; }
+	g_exportingText = false;
+	UpdateWindowTitle(hWnd);
+	#if PDFWV_ENABLE_LOGGING
+	LOGF(LogLevel::Debug, "Export text: %d pages (%d unreadable), %llu chars, %.1f MB in %.0f ms (%.1f pages/s)%hs",
+		result.pagesWritten, result.failedPages, (unsigned long long)result.chars, result.bytesWritten / 1048576.0,
+		result.elapsedMs, result.PagesPerSecond(), result.cancelled ? ", cancelled" : "");
+	#endif
+	wchar_t msg[512];
+	if (!ok) swprintf(msg, 512, L"导出失败：%hs", error.c_str());
+	else swprintf(msg, 512, L"%s导出 %d 页文本%s，无法读取 %d 页\n%.1f MB，用时 %.1f 秒，%.1f 页/秒\n%s",
+		result.cancelled ? L"已取消。" : L"", result.pagesWritten, options.lineBoxes ? L"（含行包围盒）" : L"",
+		result.failedPages, result.bytesWritten / 1048576.0, result.elapsedMs / 1000.0, result.PagesPerSecond(), path.c_str());
+	MessageBoxW(hWnd, msg, L"导出文本", MB_OK | ((ok && !result.failedPages) ? MB_ICONINFORMATION : MB_ICONWARNING));
+	return ok;
 }
 
 static void SetPageAndRefresh(HWND hWnd, int newIndex) {
@@ -1542,11 +1991,15 @@ static void SetPageAndRefresh(HWND hWnd, int newIndex) {
 	if (newIndex >= page_count) newIndex = page_count - 1;
 	g_page_index = newIndex;
 	g_scrollX = g_scrollY = 0;
+	FramePacing_MarkInput("SetPageAndRefresh");
 	ClearSelection(hWnd);
+	ClearHover();
 	RecalcPagePixelSize(hWnd);
 	UpdateScrollBars(hWnd);
 	InvalidateRect(hWnd, nullptr, TRUE);
 	UpdateStatusBarInfo(hWnd);
+	UpdateFindCount();
+	RecordSessionViewport(hWnd, "SetPageAndRefresh");
 }
 
 
@@ -1609,6 +2062,131 @@ static int PromptGotoPage(HWND owner, int maxPage) {
 	return ctx.result;
 }
 
+// 查找：输入即高亮当前页全部匹配（结果按页缓存，只重画叠加层），Enter/F3 跳到下一处
+static HWND g_hFindWnd = nullptr;
+static HWND g_hFindEdit = nullptr, g_hFindCase = nullptr, g_hFindCount = nullptr;
+static int g_searchPage = -1;             // 当前匹配所在页
+static int g_searchMatch = -1;            // 当前匹配在该页中的序号，-1 表示无
+
+// 页面矩形（PDF 坐标，点）→ 客户区矩形
+static Gdiplus::RectF PageRectToClient(const PdfTextRect& r, double pageHeightPt) {
+	const double sx = g_zoom * g_dpiX / 72.0, sy = g_zoom * g_dpiY / 72.0;
+	return Gdiplus::RectF((Gdiplus::REAL)(r.left * sx - g_scrollX + g_contentOriginX), (Gdiplus::REAL)((pageHeightPt - r.top) * sy - g_scrollY + g_contentOriginY),
+		(Gdiplus::REAL)((r.right - r.left) * sx), (Gdiplus::REAL)((r.top - r.bottom) * sy));
+}
+
+static void UpdateFindCount() {
+	if (!g_hFindCount) return;
+	wchar_t buf[64] = L"";
+	PdfPageSearchHitsRef hits = g_doc ? PdfTextSearch_PageHits(g_doc, g_page_index) : nullptr;
+	if (hits) {
+		const int n = (int)hits->matches.size();
+		if (g_searchPage == g_page_index && g_searchMatch >= 0 && g_searchMatch < n) swprintf(buf, 64, L"%d / %d on this page", g_searchMatch + 1, n);
+		else swprintf(buf, 64, L"%d on this page", n);
+	}
+	SetWindowTextW(g_hFindCount, buf);
+}
+
+static void ApplySearchQuery(HWND hWnd) {
+	const int len = GetWindowTextLengthW(g_hFindEdit);
+	std::wstring text((size_t)len + 1, L'\0');
+	text.resize((size_t)GetWindowTextW(g_hFindEdit, text.data(), len + 1));
+	const unsigned long flags = (SendMessageW(g_hFindCase, BM_GETCHECK, 0, 0) == BST_CHECKED) ? FPDF_MATCHCASE : 0;
+	if (!PdfTextSearch_SetQuery(std::u16string(text.begin(), text.end()), flags)) return;
+	g_searchPage = g_searchMatch = -1;
+	UpdateFindCount();
+	g_paintOverlayOnly = true;
+	InvalidateRect(hWnd, nullptr, FALSE);
+}
+
+// 跳到下一处/上一处匹配，必要时翻页并滚动到可见
+static void StepSearch(HWND hWnd, bool backward) {
+	if (!g_doc) return;
+	int page = (g_searchPage == g_page_index) ? g_searchPage : g_page_index;
+	int match = (g_searchPage == g_page_index) ? g_searchMatch : -1;
+	if (!PdfTextSearch_Step(g_doc, page, match, backward)) { MessageBeep(MB_ICONWARNING); return; }
+	if (page != g_page_index) SetPageAndRefresh(hWnd, page);
+	g_searchPage = page;
+	g_searchMatch = match;
+	PdfPageSearchHitsRef hits = PdfTextSearch_PageHits(g_doc, page);
+	double w_pt = 0, h_pt = 0;
+	if (hits && match < (int)hits->matches.size() && hits->matches[match].rectCount > 0 && FPDF_GetPageSizeByIndex(g_doc, page, &w_pt, &h_pt)) {
+		const PdfTextRect& r = hits->rects[hits->matches[match].firstRect];
+		const int x = (int)std::lround(r.left * g_zoom * g_dpiX / 72.0), y = (int)std::lround((h_pt - r.top) * g_zoom * g_dpiY / 72.0);
+		int cw = 0, ch = 0; GetContentClientSize(hWnd, cw, ch);
+		const int oldX = g_scrollX, oldY = g_scrollY;
+		if (x < g_scrollX || x > g_scrollX + cw - 40) g_scrollX = std::max(0, x - cw / 3);
+		if (y < g_scrollY || y > g_scrollY + ch - 40) g_scrollY = std::max(0, y - ch / 3);
+		ClampScroll(hWnd);
+		if (g_scrollX != oldX || g_scrollY != oldY) { UpdateScrollBars(hWnd); InvalidateRect(hWnd, nullptr, TRUE); }
+	}
+	UpdateFindCount();
+	g_paintOverlayOnly = true;
+	InvalidateRect(hWnd, nullptr, FALSE);
+}
+
+static void DrawSearchHighlights(HDC hdc, int cw, int ch, double pageHeightPt) {
+	PdfPageSearchHitsRef hits = PdfTextSearch_PageHits(g_doc, g_page_index);
+	if (!hits || hits->rects.empty()) return;
+	EnsureGdiplus();
+	Gdiplus::Graphics g(hdc);
+	g.SetClip(Gdiplus::Rect(g_contentOriginX, g_contentOriginY, cw, ch));
+	Gdiplus::SolidBrush all(Gdiplus::Color(90, 255, 210, 0));      // 半透明黄
+	Gdiplus::SolidBrush current(Gdiplus::Color(130, 255, 120, 0)); // 当前匹配：橙
+	for (int m = 0; m < (int)hits->matches.size(); ++m) {
+		const PdfSearchMatch& match = hits->matches[m];
+		const bool isCurrent = g_searchPage == g_page_index && g_searchMatch == m;
+		for (int i = match.firstRect; i < match.firstRect + match.rectCount; ++i)
+			g.FillRectangle(isCurrent ? &current : &all, PageRectToClient(hits->rects[i], pageHeightPt));
+	}
+}
+
+static LRESULT CALLBACK FindWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+	HWND owner = GetWindow(hwnd, GW_OWNER);
+	switch (msg) {
+	case WM_CREATE: {
+		g_hFindEdit = CreateWindowExW(WS_EX_CLIENTEDGE, L"EDIT", L"", WS_CHILD | WS_VISIBLE | WS_TABSTOP | ES_AUTOHSCROLL, 10, 10, 220, 24, hwnd, (HMENU)100, nullptr, nullptr);
+		CreateWindowW(L"BUTTON", L"Next", WS_CHILD | WS_VISIBLE | WS_TABSTOP | BS_DEFPUSHBUTTON, 240, 9, 70, 26, hwnd, (HMENU)IDOK, nullptr, nullptr);
+		CreateWindowW(L"BUTTON", L"Previous", WS_CHILD | WS_VISIBLE | WS_TABSTOP, 240, 40, 70, 26, hwnd, (HMENU)102, nullptr, nullptr);
+		g_hFindCase = CreateWindowW(L"BUTTON", L"Match case", WS_CHILD | WS_VISIBLE | WS_TABSTOP | BS_AUTOCHECKBOX, 10, 42, 110, 20, hwnd, (HMENU)101, nullptr, nullptr);
+		g_hFindCount = CreateWindowW(L"STATIC", L"", WS_CHILD | WS_VISIBLE, 125, 44, 110, 18, hwnd, (HMENU)103, nullptr, nullptr);
+		HFONT font = (HFONT)GetStockObject(DEFAULT_GUI_FONT);
+		for (HWND c = GetWindow(hwnd, GW_CHILD); c; c = GetWindow(c, GW_HWNDNEXT)) SendMessageW(c, WM_SETFONT, (WPARAM)font, TRUE);
+		return 0;
+	}
+	case WM_COMMAND: {
+		UINT id = LOWORD(wParam);
+		if ((id == 100 && HIWORD(wParam) == EN_CHANGE) || id == 101) { ApplySearchQuery(owner); return 0; }
+		if (id == IDOK) { StepSearch(owner, (GetKeyState(VK_SHIFT) & 0x8000) != 0); return 0; }
+		if (id == 102) { StepSearch(owner, true); return 0; }
+		if (id == IDCANCEL) { SendMessageW(hwnd, WM_CLOSE, 0, 0); return 0; }
+		break;
+	}
+	case WM_CLOSE:
+		// 关闭即结束查找：清除高亮
+		SetWindowTextW(g_hFindEdit, L"");
+		ShowWindow(hwnd, SW_HIDE);
+		SetForegroundWindow(owner);
+		return 0;
+	}
+	return DefWindowProcW(hwnd, msg, wParam, lParam);
+}
+
+static void ShowFindWindow(HWND owner) {
+	if (!g_hFindWnd) {
+		WNDCLASSW wc{}; wc.lpfnWndProc = FindWndProc; wc.hInstance = GetModuleHandleW(nullptr); wc.lpszClassName = L"PdfWinViewerFindWnd"; wc.hCursor = LoadCursor(nullptr, IDC_ARROW); wc.hbrBackground = (HBRUSH)(COLOR_BTNFACE + 1);
+		RegisterClassW(&wc);
+		RECT prc{}; GetWindowRect(owner, &prc);
+		const int w = 340, h = 115;
+		g_hFindWnd = CreateWindowExW(WS_EX_TOOLWINDOW, wc.lpszClassName, L"Find", WS_CAPTION | WS_SYSMENU | WS_POPUP, prc.right - w - 30, prc.top + 80, w, h, owner, nullptr, wc.hInstance, nullptr);
+		if (!g_hFindWnd) return;
+	}
+	ShowWindow(g_hFindWnd, SW_SHOW);
+	SetForegroundWindow(g_hFindWnd);
+	SetFocus(g_hFindEdit);
+	SendMessageW(g_hFindEdit, EM_SETSEL, 0, -1);
+}
+
 static void EnableDPIAwareness() {
 	auto pSetCtx = (BOOL(WINAPI*)(HANDLE))GetProcAddress(GetModuleHandleW(L"user32.dll"), "SetProcessDpiAwarenessContext");
 	if (pSetCtx) {
@@ -1633,17 +2211,21 @@ static std::wstring OpenPDFDialog(HWND hWnd) {
 
 static bool OpenDocumentFromPath(HWND hWnd, const std::wstring& path) {
     if (path.empty()) return false;
+    PDFWV_TRACE_SCOPE("doc", "open");
     CloseDoc();
     QueryPerformanceCounter(&g_openStartQpc); g_firstRenderAfterOpen = true;
     std::string u8 = WideToUTF8(path);
-    g_doc = FPDF_LoadDocument(u8.c_str(), nullptr);
+    { PDFWV_TRACE_SCOPE("doc", "load_document"); g_doc = FPDF_LoadDocument(u8.c_str(), nullptr); }
     if (!g_doc) return false;
     g_currentDocPath = path; // 记录当前文档路径用于标题栏
     int form_type = FPDF_GetFormType(g_doc);
     if (form_type == FORMTYPE_XFA_FULL || form_type == FORMTYPE_XFA_FOREGROUND) {
+        PDFWV_TRACE_SCOPE("doc", "xfa_load");
         FPDF_LoadXFA(g_doc);
     }
     InitFormEnv(hWnd);
+    PdfImageCatalog_Open(g_doc, u8, WideToUTF8(GetSidecarPath(path, ".images")));
+    if (!PdfImageCatalog_Status().complete) SetTimer(hWnd, kImageCatalogTimerId, 15, nullptr);
     RecalcPagePixelSize(hWnd);
     UpdateScrollBars(hWnd);
     BuildBookmarks(hWnd);
@@ -1653,6 +2235,10 @@ static bool OpenDocumentFromPath(HWND hWnd, const std::wstring& path) {
     AddRecent(path);
     UpdateRecentMenu(hWnd);
     UpdateWindowTitle(hWnd);
+    if (Session_IsRecording()) {
+        Session_RecordDocument(u8.c_str());
+        RecordSessionViewport(hWnd, "open");
+    }
     if (g_hPageEdit) SetFocus(g_hPageEdit);
     return true;
 }
@@ -1686,6 +2272,13 @@ static std::filesystem::path GetRecentFilePath() {
 	return pth / L"recent.txt";
 }
 
+// 按文档保存的附属数据（图片目录等）放在 recent.txt 同目录的 sidecar 子目录
+static std::wstring GetSidecarPath(const std::wstring& docPath, const char* suffix) {
+	std::filesystem::path dir = GetRecentFilePath().parent_path() / L"sidecar";
+	std::error_code ec; std::filesystem::create_directories(dir, ec);
+	return (dir / UTF8ToWide(PdfSidecarFileName(WideToUTF8(docPath), suffix))).wstring();
+}
+
 static void LoadRecent() {
 	g_recent.clear();
 	auto file = GetRecentFilePath();
@@ -1773,15 +2366,26 @@ static void CloseDoc() {
         ZeroMemory(&g_ffi, sizeof(g_ffi));
     }
     if (g_doc) {
+        PdfImageCache_InvalidateDocument(g_doc);
+        PdfImageCatalog_Close();
+        PdfTextGeometry_InvalidateDocument(g_doc);
+        PdfTextSearch_InvalidateDocument(g_doc);
+        ClearHover();
+        PdfHitMap_InvalidateDocument(g_doc);
         FPDF_CloseDocument(g_doc);
         g_doc = nullptr;
     }
     ClearBookmarks();
+    ResetSelectionState();
+    ReleasePageFrame();
+    g_searchPage = g_searchMatch = -1;
     g_page_index = 0; g_scrollX = g_scrollY = 0; g_zoom = 1.0; g_pagePxW = g_pagePxH = 0;
+    g_renderCost.pageIndex = -1; // 热力图随文档失效（本函数含 __try，不构造临时对象）
     g_currentDocPath.clear();
 }
 
 static void InitFormEnv(HWND hWnd) {
+	PDFWV_TRACE_SCOPE("doc", "form_init");
 	ZeroMemory(&g_ffi, sizeof(g_ffi));
 	g_ffi.version = 2;
 	g_form = FPDFDOC_InitFormFillEnvironment(g_doc, &g_ffi);
@@ -1817,8 +2421,13 @@ static void LayoutSidebarAndContent(HWND hWnd) {
     }
     ch = std::max(1, ch - statusH);
     int sidebar = (g_sidebarPx > 0) ? g_sidebarPx : MulDiv(220, g_dpiX, 96);
+    // 书签筛选框在上，书签树在下
+    int filterH = g_hTocFilter ? MulDiv(24, g_dpiY, 96) : 0;
+    if (g_hTocFilter) {
+        SetWindowPos(g_hTocFilter, nullptr, 0, 0, sidebar, filterH, SWP_NOZORDER | SWP_SHOWWINDOW);
+    }
     if (g_hToc) {
-        SetWindowPos(g_hToc, nullptr, 0, 0, sidebar, ch, SWP_NOZORDER | SWP_SHOWWINDOW);
+        SetWindowPos(g_hToc, nullptr, 0, filterH, sidebar, std::max(1, ch - filterH), SWP_NOZORDER | SWP_SHOWWINDOW);
     }
 }
 
@@ -1866,9 +2475,17 @@ static void OnScroll(HWND hWnd, int bar, UINT code, UINT pos) {
 
 LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 	switch (msg) {
+	case WM_TIMER: {
+		if (wParam != kImageCatalogTimerId) break;
+		// 每次只占用主线程约 8ms，避免影响交互
+		if (!PdfImageCatalog_Step(8.0)) KillTimer(hWnd, kImageCatalogTimerId);
+		return 0;
+	}
 	case WM_CREATE: {
 		EnableDPIAwareness();
 		FPDF_LIBRARY_CONFIG config{}; config.version = 3; FPDF_InitLibraryWithConfig(&config);
+		Log::StartAsync();
+		PDFWV_TRACE_THREAD_NAME("main");
 		GetDPI(hWnd);
 		// 菜单构建 + 最近文件 + 导航
 		g_hMenu = CreateMenu(); g_hFileMenu = CreatePopupMenu(); g_hNavMenu = CreatePopupMenu();
@@ -1881,12 +2498,15 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 		AppendMenuW(g_hNavMenu, MF_STRING, ID_NAV_LAST, L"Last Page\tEnd");
 		AppendMenuW(g_hNavMenu, MF_SEPARATOR, 0, nullptr);
 		AppendMenuW(g_hNavMenu, MF_STRING, ID_NAV_GOTO, L"Go to Page...\tCtrl+G");
+		AppendMenuW(g_hNavMenu, MF_STRING, ID_NAV_FIND, L"Find...\tCtrl+F");
 		AppendMenuW(g_hMenu, MF_POPUP, (UINT_PTR)g_hNavMenu, L"Navigate");
 		// Settings 顶级菜单项，点击直接打开设置窗口
 		AppendMenuW(g_hMenu, MF_STRING, ID_SETTINGS_OPEN, L"Settings...");
 		// 视图菜单（可选）：日志窗口
 		g_hSettingsMenu = CreatePopupMenu();
 		AppendMenuW(g_hSettingsMenu, MF_STRING, ID_VIEW_LOG, L"Log Window");
+		AppendMenuW(g_hSettingsMenu, MF_STRING, ID_VIEW_RECORD_SESSION, L"Record Session...");
+		AppendMenuW(g_hSettingsMenu, MF_STRING, ID_VIEW_RENDER_COST, L"Render Cost Heatmap");
 		AppendMenuW(g_hMenu, MF_POPUP, (UINT_PTR)g_hSettingsMenu, L"View");
 		SetMenu(hWnd, g_hMenu);
 		DrawMenuBar(hWnd);
@@ -1898,6 +2518,11 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 			0, 0, 200, 100, hWnd, (HMENU)(INT_PTR)20001, GetModuleHandleW(nullptr), nullptr);
 		// 拦截书签树上的翻页快捷键，转发到主窗口
 		SetWindowSubclass(g_hToc, TocSubclassProc, 0, (DWORD_PTR)hWnd);
+		// 书签筛选框：输入即筛选
+		g_hTocFilter = CreateWindowExW(WS_EX_CLIENTEDGE, L"EDIT", L"", WS_CHILD | WS_VISIBLE | WS_TABSTOP | ES_AUTOHSCROLL,
+			0, 0, 200, 24, hWnd, (HMENU)(INT_PTR)ID_EDIT_TOC_FILTER, GetModuleHandleW(nullptr), nullptr);
+		SendMessageW(g_hTocFilter, WM_SETFONT, (WPARAM)GetStockObject(DEFAULT_GUI_FONT), TRUE);
+		SendMessageW(g_hTocFilter, EM_SETCUEBANNER, TRUE, (LPARAM)L"筛选书签");
 		// 状态栏与页码控件（不创建主窗口内的工具栏）
 		INITCOMMONCONTROLSEX icc{ sizeof(icc), ICC_BAR_CLASSES };
 		InitCommonControlsEx(&icc);
@@ -1931,15 +2556,18 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 		POINT clientPt = pt; ScreenToClient(hWnd, &clientPt);
 		bool enableSave = false;
 		if (g_doc) {
-			FPDF_PAGE pg = FPDF_LoadPage(g_doc, g_page_index);
+			double pageX = (clientPt.x + g_scrollX) * (72.0 / g_dpiX) / g_zoom;
+			double pageY = (clientPt.y + g_scrollY) * (72.0 / g_dpiY) / g_zoom;
+			double w_pt = 0, h_pt = 0; FPDF_GetPageSizeByIndex(g_doc, g_page_index, &w_pt, &h_pt);
+			// 图片目录已确认该处没有图片时不必加载页面
+			FPDF_PAGE pg = PdfImageCatalog_MayHitImage(g_page_index, (float)pageX, (float)(h_pt - pageY), 2.0f)
+				? FPDF_LoadPage(g_doc, g_page_index) : nullptr;
+			if (!pg) Session_RecordHitTest("WM_CONTEXTMENU", "image", g_page_index, pageX, pageY, false);
 			if (pg) {
-				double pageX = (clientPt.x + g_scrollX) * (72.0 / g_dpiX) / g_zoom;
-				double pageY = (clientPt.y + g_scrollY) * (72.0 / g_dpiY) / g_zoom;
-				double w_pt = 0, h_pt = 0; FPDF_GetPageSizeByIndex(g_doc, g_page_index, &w_pt, &h_pt);
-				
 				// 使用共享的 pdf_utils 模块进行命中检测
 				PdfHitImageResult hitResult = PdfHitImageAt(pg, pageX, pageY, h_pt);
 				enableSave = (hitResult.imageObj != nullptr);
+				Session_RecordHitTest("WM_CONTEXTMENU", "image", g_page_index, pageX, pageY, enableSave);
 				
 				#if PDFWV_ENABLE_LOGGING
 				LOGF(LogLevel::Debug, "Right-click at client(%d,%d) -> page(%.2f,%.2f), hit=%s", 
@@ -1953,6 +2581,9 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 		AppendMenuW(hPopup, MF_STRING | (g_doc ? 0 : MF_GRAYED), ID_CTX_EXPORT_PNG, L"导出当前页为 PNG...");
 		// 仅当点击位置命中图片时可用；不再提供"回退最大图片"
 		AppendMenuW(hPopup, MF_STRING | ((g_doc && enableSave) ? 0 : MF_GRAYED), ID_CTX_SAVE_IMAGE, L"保存图片...");
+		AppendMenuW(hPopup, MF_STRING | ((g_doc && !g_extractingImages) ? 0 : MF_GRAYED), ID_CTX_EXTRACT_ALL_IMAGES, L"导出全部图片...");
+		AppendMenuW(hPopup, MF_STRING | ((g_doc && PdfImageCatalog_Status().complete) ? 0 : MF_GRAYED), ID_CTX_EXPORT_IMAGE_LIST, L"导出图片清单 (CSV)...");
+		AppendMenuW(hPopup, MF_STRING | ((g_doc && !g_exportingText) ? 0 : MF_GRAYED), ID_CTX_EXPORT_TEXT, L"导出全部文本...");
 		AppendMenuW(hPopup, MF_STRING | ((g_doc && g_hasSelection) ? 0 : MF_GRAYED), ID_CTX_COPY_TEXT, L"复制文本");
 		AppendMenuW(hPopup, MF_SEPARATOR, 0, nullptr);
 		AppendMenuW(hPopup, MF_STRING | (g_doc ? 0 : MF_GRAYED), ID_CTX_PROPERTIES, L"属性...");
@@ -1997,6 +2628,9 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 				g_savingImageNow = false;
 			}
 		}
+		else if (cmd == ID_CTX_EXTRACT_ALL_IMAGES) { ExtractAllImages(hWnd); }
+		else if (cmd == ID_CTX_EXPORT_IMAGE_LIST) { ExportImageList(hWnd); }
+		else if (cmd == ID_CTX_EXPORT_TEXT) { ExportAllText(hWnd); }
 		else if (cmd == ID_CTX_COPY_TEXT) {
 			if (g_doc && g_hasSelection && !g_selectedText.empty()) {
 				CopyTextToClipboard(hWnd, g_selectedText);
@@ -2006,8 +2640,10 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 			if (g_doc) {
 				int pages = FPDF_GetPageCount(g_doc);
 				std::wstring name = g_currentDocPath.empty()? L"(未命名)": PathFindFileNameW(g_currentDocPath.c_str());
+				PdfImageCatalogStatus images = PdfImageCatalog_Status();
 				wchar_t buf[1024];
-				swprintf(buf, 1024, L"文件: %s\n路径: %s\n页数: %d", name.c_str(), g_currentDocPath.c_str(), pages);
+				swprintf(buf, 1024, L"文件: %s\n路径: %s\n页数: %d\n图片: %d 张%s", name.c_str(), g_currentDocPath.c_str(), pages,
+					images.images, images.complete ? L"" : L"（图片目录建立中）");
 				MessageBoxW(hWnd, buf, L"文档属性", MB_OK | MB_ICONINFORMATION);
 			}
 		}
@@ -2029,6 +2665,8 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 		}
 		if (id == ID_SETTINGS_OPEN) { ShowSettingsDialog(hWnd); return 0; }
 		if (id == ID_VIEW_LOG) { ShowLogWindow(hWnd); return 0; }
+		if (id == ID_VIEW_RECORD_SESSION) { ToggleSessionRecording(hWnd); return 0; }
+		if (id == ID_VIEW_RENDER_COST) { ToggleRenderCostHeatmap(hWnd); return 0; }
 		// TreeView 通知处理：点击书签跳页
 		if (HIWORD(wParam) == 0 && (HWND)lParam == g_hToc) {
 			// no-op
@@ -2043,6 +2681,7 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 			if (idx >= 0) SetPageAndRefresh(hWnd, idx);
 			return 0;
 		}
+		if (id == ID_NAV_FIND && g_doc) { ShowFindWindow(hWnd); return 0; }
 		if (id == ID_RECENT_CLEAR) { g_recent.clear(); SaveRecent(); UpdateRecentMenu(hWnd); return 0; }
 		if (id >= ID_RECENT_BASE && id < ID_RECENT_BASE + kMaxRecent) {
 			UINT idx = id - ID_RECENT_BASE; if (idx < g_recent.size()) {
@@ -2055,9 +2694,11 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 		}
 		// 编辑框失焦→尝试跳页
 		if (id == ID_EDIT_PAGE && HIWORD(wParam) == EN_KILLFOCUS) { JumpToPageFromEdit(hWnd); return 0; }
+		if (id == ID_EDIT_TOC_FILTER && HIWORD(wParam) == EN_CHANGE) { ApplyOutlineFilter(); return 0; }
 		break; }
 	case WM_KEYDOWN: {
 		if (!g_doc) break;
+		if (wParam == VK_PRIOR || wParam == VK_NEXT || wParam == VK_HOME || wParam == VK_END) FramePacing_MarkInput("WM_KEYDOWN");
 		switch (wParam) {
 		case VK_PRIOR: // PgUp
 			SetPageAndRefresh(hWnd, g_page_index - 1); return 0;
@@ -2071,6 +2712,13 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 			if (GetKeyState(VK_CONTROL) & 0x8000) { int pc = FPDF_GetPageCount(g_doc); int idx = PromptGotoPage(hWnd, pc); if (idx >= 0) SetPageAndRefresh(hWnd, idx); return 0; }
 			break;
 		}
+		case 'F': {
+			if (GetKeyState(VK_CONTROL) & 0x8000) { ShowFindWindow(hWnd); return 0; }
+			break;
+		}
+		case VK_F3:
+			if (!PdfTextSearch_Query().empty()) { StepSearch(hWnd, (GetKeyState(VK_SHIFT) & 0x8000) != 0); return 0; }
+			break;
 		case 'C': {
 			if ((GetKeyState(VK_CONTROL) & 0x8000) && g_hasSelection && !g_selectedText.empty()) {
 				CopyTextToClipboard(hWnd, g_selectedText);
@@ -2087,18 +2735,24 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 		if (g_hStatus) { SendMessageW(g_hStatus, WM_SIZE, 0, 0); LayoutStatusBarChildren(hWnd); UpdateStatusBarInfo(hWnd); }
 		LayoutSidebarAndContent(hWnd);
 		InvalidateRect(hWnd, nullptr, TRUE);
+		RecordSessionViewport(hWnd, "WM_SIZE");
 		return 0;
 	}
 	case WM_HSCROLL: {
+		FramePacing_MarkInput("WM_HSCROLL");
 		OnScroll(hWnd, SB_HORZ, LOWORD(wParam), HIWORD(wParam));
+		RecordSessionViewport(hWnd, "WM_HSCROLL");
 		return 0;
 	}
 	case WM_VSCROLL: {
+		FramePacing_MarkInput("WM_VSCROLL");
 		OnScroll(hWnd, SB_VERT, LOWORD(wParam), HIWORD(wParam));
+		RecordSessionViewport(hWnd, "WM_VSCROLL");
 		return 0;
 	}
 	case WM_MOUSEWHEEL: {
 		short delta = GET_WHEEL_DELTA_WPARAM(wParam);
+		if (g_doc) FramePacing_MarkInput("WM_MOUSEWHEEL");
 		if (GET_KEYSTATE_WPARAM(wParam) & MK_CONTROL) {
 			POINT pt{ GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam) };
 			ScreenToClient(hWnd, &pt);
@@ -2107,6 +2761,7 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 		} else {
 			OnScroll(hWnd, SB_VERT, (delta > 0) ? SB_LINEUP : SB_LINEDOWN, 0);
 		}
+		RecordSessionViewport(hWnd, "WM_MOUSEWHEEL");
 		return 0;
 	}
 	case WM_LBUTTONDOWN: {
@@ -2118,14 +2773,29 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 			// Ctrl + 左键：平移拖动
 			g_dragging = true;
 		} else {
-			// 仅左键：框选文本
+			// 仅左键：沿文本流选择
+			if (g_hasSelection) InvalidateRect(hWnd, nullptr, FALSE);
 			g_selecting = true;
+			g_hasSelection = false;
 			g_selStart = g_mouseDownPt;
 			g_selEnd = g_mouseDownPt;
+			g_selAnchor = g_selFocus = (g_doc && BeginTextSelection()) ? SelectionCaretAt(g_mouseDownPt) : -1;
 		}
 		SetCapture(hWnd);
 		return 0;
 	}
+	case WM_LBUTTONDBLCLK: {
+		// 双击选中一个词；随后的 WM_LBUTTONUP 不再当作点击
+		g_mouseDown = true; g_movedSinceDown = true; g_dragging = false; g_selecting = false;
+		POINT pt{ GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam) };
+		if (!g_doc || (GetKeyState(VK_CONTROL) & 0x8000) || !BeginTextSelection()) return 0;
+		const int caret = SelectionCaretAt(pt);
+		if (caret < 0) return 0;
+		g_selGeometry->WordAt(caret, g_selAnchor, g_selFocus);
+		g_hasSelection = ExtractSelectedText(g_selectedText);
+		InvalidateRect(hWnd, nullptr, FALSE);
+		return 0;
+	}
 	case WM_MOUSEMOVE: {
 		POINT cur; cur.x = GET_X_LPARAM(lParam); cur.y = GET_Y_LPARAM(lParam);
 		int dx = cur.x - g_lastDragPt.x;
@@ -2136,6 +2806,7 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 				return 0;
 			}
 			g_lastDragPt = cur;
+			FramePacing_MarkInput("WM_MOUSEMOVE");
 			// 鼠标向右移动，内容应向右跟随 => 滚动条减少
 			g_scrollX = std::max(0, g_scrollX - dx);
 			g_scrollY = std::max(0, g_scrollY - dy);
@@ -2143,31 +2814,65 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 			UpdateScrollBars(hWnd);
 			InvalidateRect(hWnd, nullptr, TRUE);
 			if (std::abs(dx) + std::abs(dy) > 0) g_movedSinceDown = true;
+			RecordSessionViewport(hWnd, "WM_MOUSEMOVE");
 			return 0;
 		}
 		if (g_selecting) {
 			g_selEnd = cur;
 			g_movedSinceDown = true;
-			InvalidateRect(hWnd, nullptr, TRUE);
+			RecordSessionSelection("WM_MOUSEMOVE", false);
+			// 插入位置不变则高亮不变，不必重绘；重绘时复用上一帧位图，只重画高亮
+			const int focus = SelectionCaretAt(cur);
+			if (focus == g_selFocus) return 0;
+			g_selFocus = focus;
+			FramePacing_MarkInput("WM_MOUSEMOVE");
+			InvalidateRect(hWnd, nullptr, FALSE);
 			return 0;
 		}
+		UpdateHover(hWnd, cur);
+		break;
+	}
+	case WM_MOUSELEAVE: {
+		if (g_hoverEntry) { ClearHover(); UpdateStatusBarInfo(hWnd); }
+		return 0;
+	}
+	case WM_SETCURSOR: {
+		// 悬停在链接上时显示手形光标
+		if ((HWND)wParam == hWnd && LOWORD(lParam) == HTCLIENT && g_hoverEntry && g_hoverEntry->IsLink()) {
+			SetCursor(LoadCursor(nullptr, IDC_HAND));
+			return TRUE;
+		}
 		break;
 	}
 	case WM_NOTIFY: {
 		LPNMHDR hdr = (LPNMHDR)lParam;
 		if (hdr && hdr->hwndFrom == g_hToc) {
 			if (hdr->code == TVN_DELETEITEMW) {
-				LPNMTREEVIEWW tv = (LPNMTREEVIEWW)lParam;
-				TocItemData* d = (TocItemData*)tv->itemOld.lParam;
-				if (d) delete d;
+				const int entry = (int)((LPNMTREEVIEWW)lParam)->itemOld.lParam;
+				if (entry >= 0 && entry < (int)g_outlineItems.size()) g_outlineItems[entry] = nullptr;
+				return 0;
+			}
+			if (hdr->code == TVN_GETDISPINFOW) {
+				LPNMTVDISPINFOW di = (LPNMTVDISPINFOW)lParam;
+				const int entry = (int)di->item.lParam;
+				if ((di->item.mask & TVIF_TEXT) && di->item.cchTextMax > 0 && entry >= 0 && entry < (int)g_outline.entries.size()) {
+					const std::u16string_view title = g_outline.Title(entry);
+					const std::wstring text = title.empty() ? std::wstring(L"(书签)") : std::wstring(title.begin(), title.end());
+					wcsncpy_s(di->item.pszText, di->item.cchTextMax, text.c_str(), _TRUNCATE);
+				}
 				return 0;
 			}
+			if (hdr->code == TVN_ITEMEXPANDINGW) {
+				// 首次展开时才插入子节点
+				LPNMTREEVIEWW tv = (LPNMTREEVIEWW)lParam;
+				if (tv->action == TVE_EXPAND && !TreeView_GetChild(g_hToc, tv->itemNew.hItem))
+					InsertOutlineChildren(tv->itemNew.hItem, (int)tv->itemNew.lParam);
+				return FALSE;
+			}
 			if (hdr->code == TVN_SELCHANGEDW) {
 				LPNMTREEVIEWW tv = (LPNMTREEVIEWW)lParam;
-				TocItemData* data = (TocItemData*)(tv->itemNew.lParam);
-				if (data && g_doc) {
-					int idx = data->pageIndex;
-					if (idx < 0 && data->dest) idx = FPDFDest_GetDestPageIndex(g_doc, data->dest);
+				if (g_doc && tv->itemNew.hItem && !g_outlineSyncing) {
+					const int idx = OutlineItemPage(tv->itemNew.lParam);
 					if (idx >= 0) SetPageAndRefresh(hWnd, idx);
 					else MessageBeep(MB_ICONWARNING);
 				}
@@ -2177,13 +2882,9 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 				HTREEITEM sel = TreeView_GetSelection(g_hToc);
 				if (sel && g_doc) {
 					TVITEMW it{}; it.mask = TVIF_PARAM; it.hItem = sel; if (TreeView_GetItem(g_hToc, &it)) {
-						TocItemData* data = (TocItemData*)it.lParam;
-						if (data) {
-							int idx = data->pageIndex;
-							if (idx < 0 && data->dest) idx = FPDFDest_GetDestPageIndex(g_doc, data->dest);
-							if (idx >= 0) SetPageAndRefresh(hWnd, idx);
-							else MessageBeep(MB_ICONWARNING);
-						}
+						const int idx = OutlineItemPage(it.lParam);
+						if (idx >= 0) SetPageAndRefresh(hWnd, idx);
+						else MessageBeep(MB_ICONWARNING);
 					}
 				}
 				return 0;
@@ -2201,8 +2902,9 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 		}
 		if (wasSelecting) {
 			if (g_movedSinceDown) {
-				// 完成一次选择并尝试提取文本
-				g_hasSelection = ExtractSelectedTextOnCurrentPage(hWnd, g_selectedText);
+				// 完成一次选择并提取文本
+				g_hasSelection = ExtractSelectedText(g_selectedText);
+				RecordSessionSelection("WM_LBUTTONUP", true);
 				InvalidateRect(hWnd, nullptr, TRUE);
 				return 0;
 			}
@@ -2224,29 +2926,38 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 		return 0;
 	}
 	case WM_PAINT: {
+		EnsureRenderCostProfile();
 		PAINTSTRUCT ps; HDC hdc = BeginPaint(hWnd, &ps);
 		RenderPageToDC(hWnd, hdc);
-		// 绘制选区高亮
-		if ((g_selecting || g_hasSelection) && g_doc) {
+		g_paintOverlayOnly = false;
+		// 查找高亮：缓存的匹配矩形叠加在页面位图之上
+		if (g_doc && g_frame.page == g_page_index && !PdfTextSearch_Query().empty()) {
+			int cw = 0, ch = 0; GetContentClientSize(hWnd, cw, ch);
+			DrawSearchHighlights(hdc, cw, ch, g_frame.pageHeightPt);
+		}
+		// 绘制选区高亮：每行一个矩形，覆盖选中的字形
+		if ((g_selecting || g_hasSelection) && g_doc && g_selGeometry && g_selGeometry->pageIndex == g_page_index && g_selAnchor != g_selFocus) {
+			std::vector<PdfTextRect> rects;
+			g_selGeometry->SelectionRects(std::min(g_selAnchor, g_selFocus), std::max(g_selAnchor, g_selFocus), rects);
 			EnsureGdiplus();
-			RECT r = GetNormalizedClientRect(g_selStart, g_selEnd);
 			// 限制在内容区域内
 			int cw = 0, ch = 0; GetContentClientSize(hWnd, cw, ch);
-			RECT content{ g_contentOriginX, 0, g_contentOriginX + cw, ch };
-			RECT drawRc{};
-			if (IntersectRect(&drawRc, &r, &content)) {
-				Gdiplus::Graphics g(hdc);
-				Gdiplus::SolidBrush br(Gdiplus::Color(80, 30, 144, 255)); // 半透明蓝
-				Gdiplus::Rect gr(drawRc.left, drawRc.top, drawRc.right - drawRc.left, drawRc.bottom - drawRc.top);
-				g.FillRectangle(&br, gr);
-			}
+			Gdiplus::Graphics g(hdc);
+			g.SetClip(Gdiplus::Rect(g_contentOriginX, g_contentOriginY, cw, ch));
+			Gdiplus::SolidBrush br(Gdiplus::Color(80, 30, 144, 255)); // 半透明蓝
+			for (const PdfTextRect& r : rects) g.FillRectangle(&br, PageRectToClient(r, g_selPageHeightPt));
 		}
 		EndPaint(hWnd, &ps);
+		if (g_doc) ReportFramePresent(FramePacing_Present());
 		return 0; }
 	case WM_DESTROY: {
+		Session_Stop();
 		if (g_gdiplusToken) { Gdiplus::GdiplusShutdown(g_gdiplusToken); g_gdiplusToken = 0; }
 		CloseDoc();
 		FPDF_DestroyLibrary();
+		// 退出时导出指标 JSON（与 recent.txt 同目录）
+		Metrics_DumpJson(AsyncLog_WideToUtf8((GetRecentFilePath().parent_path() / L"metrics.json").c_str()).c_str());
+		Log::StopAsync();
 		UninitCOM();
 		PostQuitMessage(0);
 		return 0;
@@ -2257,13 +2968,16 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 
 int APIENTRY wWinMain(HINSTANCE hInst, HINSTANCE, LPWSTR, int nCmdShow) {
 	const wchar_t* cls = L"PdfWinViewerWnd";
-	WNDCLASSW wc{}; wc.lpfnWndProc = WndProc; wc.hInstance = hInst; wc.lpszClassName = cls; wc.hCursor = LoadCursor(nullptr, IDC_ARROW);
+	WNDCLASSW wc{}; wc.style = CS_DBLCLKS; wc.lpfnWndProc = WndProc; wc.hInstance = hInst; wc.lpszClassName = cls; wc.hCursor = LoadCursor(nullptr, IDC_ARROW);
 	RegisterClassW(&wc);
 	HWND hWnd = CreateWindowW(cls, L"PDFium Win32 Viewer", WS_OVERLAPPEDWINDOW | WS_HSCROLL | WS_VSCROLL, CW_USEDEFAULT, CW_USEDEFAULT, 1024, 768, nullptr, nullptr, hInst, nullptr);
 	
 	ShowWindow(hWnd, nCmdShow);
 	UpdateWindow(hWnd);
-	MSG msg; while (GetMessageW(&msg, nullptr, 0, 0)) { TranslateMessage(&msg); DispatchMessageW(&msg); }
+	MSG msg; while (GetMessageW(&msg, nullptr, 0, 0)) {
+		if (g_hFindWnd && IsDialogMessageW(g_hFindWnd, &msg)) continue;
+		TranslateMessage(&msg); DispatchMessageW(&msg);
+	}
 	return 0;
 }
 
@@ -3,7 +3,21 @@
 // - 启动后弹出选择 PDF，渲染到窗口
 // - 支持 Home/End 翻页、PgUp/PgDn、Cmd +/- 缩放
 //
+#include "../shared/async_log.h"
+#include "../shared/frame_pacing.h"
+#include "../shared/hit_map.h"
+#include "../shared/image_cache.h"
+#include "../shared/image_catalog.h"
+#include "../shared/image_extract.h"
+#include "../shared/metrics.h"
+#include "../shared/outline.h"
 #include "../shared/pdf_utils.h"
+#include "../shared/render_cost.h"
+#include "../shared/session_recorder.h"
+#include "../shared/text_export.h"
+#include "../shared/text_geometry.h"
+#include "../shared/text_search.h"
+#include "../shared/trace.h"
 #include "pdfium_object_info.h"
 #import <Cocoa/Cocoa.h>
 #import <UniformTypeIdentifiers/UniformTypeIdentifiers.h>
@@ -13,6 +27,7 @@
 #include <fpdfview.h>
 #include <mach/mach.h>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 // ================= 界面布局常量 =================
@@ -20,6 +35,7 @@ static const CGFloat kBookmarkCollapsedWidth = 20.0;
 static const CGFloat kBookmarkExpandedWidth = 260.0;
 static const CGFloat kInspectorWidth = 300.0;
 static const CGFloat kControlBarHeight = 30.0;
+static const CGFloat kTocFilterHeight = 28.0; // 书签筛选框所在行高度
 static const CGFloat kScrollBarWidth = 15.0; // 垂直滚动条宽度
 
 // ================= 日志子系统（与 Windows 对齐） =================
@@ -54,6 +70,20 @@ static inline double GetProcessMemMB() {
   return 0.0;
 }
 
+// pdfium_ex 自行统计其持有的内存（含峰值），同步到分类内存指标
+static void SyncPdfiumExMemory() {
+  PDFIUM_EX_MEMORY_STATS m{};
+  PdfiumEx_GetMemoryStats(&m);
+  Metrics_MemorySet(MemCategory::ObjectInfo, m.object_info_bytes,
+                    m.object_info_peak);
+  Metrics_MemorySet(MemCategory::ObjectTree, m.object_tree_bytes,
+                    m.object_tree_peak);
+  Metrics_MemorySet(MemCategory::MappingCache, m.mapping_cache_bytes,
+                    m.mapping_cache_peak);
+  Metrics_MemorySet(MemCategory::ReferenceGraph, m.reference_graph_bytes,
+                    m.reference_graph_peak);
+}
+
 // 将 wchar_t* 安全转换为 NSString（兼容 macOS 上 4 字节 wchar_t）
 static inline NSString *NSStringFromWChar(const wchar_t *ws) {
   if (!ws)
@@ -86,6 +116,8 @@ static _LogWindowController *_gLogCtrl = nil;
 @property(nonatomic, strong) NSTableView *table;
 @property(nonatomic, strong) NSMutableArray<NSDictionary *> *rows;
 @property(nonatomic, strong) NSPopUpButton *filter;
+@property(nonatomic, strong) NSTextField *metricsLabel; // 指标摘要 p50/p90/p99/max 与分类内存（当前/峰值）
+@property(nonatomic, strong) NSTimer *metricsTimer;
 // NSWindowDelegate
 - (void)windowWillClose:(NSNotification *)notification;
 @end
@@ -129,9 +161,20 @@ static void MacLog_SetEnabled(bool on);
     [c addSubview:filt];
     _filter = filt;
 
-    NSScrollView *sv =
-        [[NSScrollView alloc] initWithFrame:NSMakeRect(8, 8, rc.size.width - 16,
-                                                       rc.size.height - 56)];
+    // 底部：实时指标摘要（每秒刷新）
+    const CGFloat kMetricsH = 200;
+    NSTextField *ml = [NSTextField wrappingLabelWithString:@""];
+    ml.frame = NSMakeRect(8, 8, rc.size.width - 16, kMetricsH);
+    ml.font = [NSFont monospacedSystemFontOfSize:11
+                                          weight:NSFontWeightRegular];
+    ml.selectable = YES;
+    ml.autoresizingMask = NSViewWidthSizable | NSViewMaxYMargin;
+    [c addSubview:ml];
+    self.metricsLabel = ml;
+
+    NSScrollView *sv = [[NSScrollView alloc]
+        initWithFrame:NSMakeRect(8, 16 + kMetricsH, rc.size.width - 16,
+                                 rc.size.height - 64 - kMetricsH)];
     sv.autoresizingMask = NSViewWidthSizable | NSViewHeightSizable;
     NSTableView *tv = [[NSTableView alloc] initWithFrame:sv.bounds];
     tv.usesAlternatingRowBackgroundColors = YES;
@@ -156,10 +199,24 @@ static void MacLog_SetEnabled(bool on);
     sv.hasHorizontalScroller = YES;
     [c addSubview:sv];
     self.table = tv;
+    [self refreshMetrics:nil];
+    self.metricsTimer =
+        [NSTimer scheduledTimerWithTimeInterval:1.0
+                                         target:self
+                                       selector:@selector(refreshMetrics:)
+                                       userInfo:nil
+                                        repeats:YES];
   }
   return self;
 }
 
+- (void)refreshMetrics:(NSTimer *)timer {
+  SyncPdfiumExMemory();
+  std::string summary = Metrics_FormatSummary();
+  self.metricsLabel.stringValue =
+      [NSString stringWithUTF8String:summary.c_str()] ?: @"";
+}
+
 - (NSInteger)numberOfRowsInTableView:(NSTableView *)tableView {
   if (_filter.indexOfSelectedItem == 0)
     return (NSInteger)self.rows.count;
@@ -216,7 +273,12 @@ static void MacLog_SetEnabled(bool on);
 }
 
 - (void)appendRow:(NSDictionary *)row {
-  [self.rows addObject:row];
+  [self appendRows:@[ row ]];
+}
+
+// 批量追加（日志线程整批投递），一次 reloadData
+- (void)appendRows:(NSArray<NSDictionary *> *)rows {
+  [self.rows addObjectsFromArray:rows];
   [self.table reloadData];
   NSInteger last = (NSInteger)self.rows.count - 1;
   if (last >= 0)
@@ -235,6 +297,8 @@ static void MacLog_SetEnabled(bool on);
 }
 // 关闭窗口即停止日志并释放控制器
 - (void)windowWillClose:(NSNotification *)notification {
+  [self.metricsTimer invalidate];
+  self.metricsTimer = nil;
   MacLog_SetEnabled(false);
   _gLogCtrl = nil;
 }
@@ -257,14 +321,6 @@ static inline void MacLog_ShowWindow() {
       MacLog_IsEnabled() ? NSControlStateValueOn : NSControlStateValueOff;
 }
 
-static inline NSString *WFormat(const wchar_t *fmt, va_list ap) {
-  wchar_t buf[1200];
-  vswprintf(buf, 1199, fmt, ap);
-  buf[1199] = 0;
-  return [[NSString alloc] initWithCharacters:(const unichar *)buf
-                                       length:wcslen(buf)];
-}
-
 static inline NSString *ToNSString(double v, int prec) {
   return [NSString
       stringWithFormat:(prec >= 0 ? [NSString stringWithFormat:@"%%.%df", prec]
@@ -284,58 +340,98 @@ static NSString *MacLog_FilePath() {
   NSString *dir = [exec stringByDeletingLastPathComponent];
   return [dir stringByAppendingPathComponent:@"debug.log"];
 }
-static void MacLog_ResetFileOnStartup() {
-  NSString *path = MacLog_FilePath();
-  [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
-  [@"" writeToFile:path atomically:YES encoding:NSUTF8StringEncoding error:nil];
-}
-static void MacLog_AppendLine(NSString *line) {
-  if (!line)
-    return;
-  NSString *s = [line stringByAppendingString:@"\n"];
-  NSData *data = [s dataUsingEncoding:NSUTF8StringEncoding];
-  NSFileHandle *fh =
-      [NSFileHandle fileHandleForWritingAtPath:MacLog_FilePath()];
-  if (!fh) {
-    [[NSFileManager defaultManager] createFileAtPath:MacLog_FilePath()
-                                            contents:nil
-                                          attributes:nil];
-    fh = [NSFileHandle fileHandleForWritingAtPath:MacLog_FilePath()];
-  }
-  [fh seekToEndOfFile];
-  [fh writeData:data];
-  [fh closeFile];
+// 按文档保存的附属数据（图片目录等）放在 debug.log 同目录的 sidecar 子目录
+static std::string MacSidecarPath(const std::string &docPathUtf8,
+                                  const char *suffix) {
+  NSString *dir = [[MacLog_FilePath() stringByDeletingLastPathComponent]
+      stringByAppendingPathComponent:@"sidecar"];
+  [[NSFileManager defaultManager] createDirectoryAtPath:dir
+                            withIntermediateDirectories:YES
+                                             attributes:nil
+                                                  error:nil];
+  NSString *name = @(PdfSidecarFileName(docPathUtf8, suffix).c_str());
+  return [dir stringByAppendingPathComponent:name].UTF8String;
+}
+// 启动异步日志：文件写入与窗口刷新都在后台线程批量完成，调用点只写入环形缓冲
+static void MacLog_DeliverBatch(std::vector<AsyncLogEntry> &&batch);
+static void MacLog_StartOnLaunch() {
+  AsyncLog_Start(MacLog_FilePath().UTF8String, MacLog_DeliverBatch);
 }
 static void MacLog_DebugNS(NSString *msg) {
   if (!msg)
     return;
-  MacLog_AppendLine([@"[DBG] " stringByAppendingString:msg]);
+  const char *utf8 = msg.UTF8String;
+  AsyncLog_Text((uint8_t)LogLevel::Trace, kAsyncLogFileOnly, 0, utf8,
+                strlen(utf8));
+}
+
+// 后台日志线程回调：在日志线程上生成表格行，再整批投递到主线程
+static void MacLog_DeliverBatch(std::vector<AsyncLogEntry> &&batch) {
+  @autoreleasepool {
+    NSMutableArray<NSDictionary *> *rows =
+        [NSMutableArray arrayWithCapacity:batch.size()];
+    for (const AsyncLogEntry &e : batch) {
+      const AsyncLogRecord &r = e.record;
+      if (r.flags & kAsyncLogFileOnly)
+        continue;
+      NSString *el =
+          [NSString stringWithFormat:@"%7.3f s", r.timestampNs / 1e9];
+      if (r.kind == AsyncLogKind::Perf) {
+        NSString *rem = @"";
+        if (const AsyncLogSite *site = AsyncLog_GetSite(r.siteId)) {
+          // %s 按系统 C 字符串编码解码，中文备注须先按 UTF-8 转成 NSString
+          auto utf8 = [](const char *s) -> NSString * {
+            return (s ? [NSString stringWithUTF8String:s] : nil) ?: @"";
+          };
+          rem = [NSString
+              stringWithFormat:@"%@%@%@:%d %@", utf8(site->remarks.c_str()),
+                               site->remarks.empty() ? @"" : @" | ",
+                               utf8(site->file), site->line, utf8(site->func)];
+        }
+        [rows addObject:@{
+          @"Elapsed" : el,
+          @"Level" : @"Debug:渲染性能",
+          @"Page" : ToNSStringI(r.page),
+          @"Zoom" : [NSString stringWithFormat:@"%.0f%%", r.zoomPct],
+          @"Time" : ToNSString(r.timeMs, 2),
+          @"Mem" : ToNSString(r.memMB, 2),
+          @"DMem" : ToNSString(r.deltaMB, 2),
+          @"Remarks" : rem
+        }];
+      } else {
+        [rows addObject:@{
+          @"Elapsed" : el,
+          @"Level" : @"Debug:跟踪",
+          @"Page" : @"",
+          @"Zoom" : @"",
+          @"Time" : @"",
+          @"Mem" : @"",
+          @"DMem" : @"",
+          @"Remarks" : [NSString stringWithUTF8String:e.text.c_str()] ?: @""
+        }];
+      }
+    }
+    if (rows.count == 0)
+      return;
+    dispatch_async(dispatch_get_main_queue(), ^{
+      if (_gLogCtrl)
+        [_gLogCtrl appendRows:rows];
+    });
+  }
 }
 
 static void Log_WriteF(LogLevel lv, const wchar_t *fmt, ...) {
 #if PDFWV_ENABLE_LOGGING
   if (!MacLog_IsEnabled())
     return;
+  wchar_t buf[1024];
   va_list ap;
   va_start(ap, fmt);
-  NSString *msg = WFormat(fmt, ap);
+  vswprintf(buf, 1023, fmt, ap);
   va_end(ap);
-  double el = NowSeconds();
-  MacLog_AppendLine(
-      [NSString stringWithFormat:@"[DBG] [+%7.3fs] %@", el, msg ?: @""]);
-  if (_gLogCtrl) {
-    NSDictionary *row = @{
-      @"Elapsed" : [NSString stringWithFormat:@"%7.3f s", el],
-      @"Level" : @"Debug:跟踪",
-      @"Page" : @"",
-      @"Zoom" : @"",
-      @"Time" : @"",
-      @"Mem" : @"",
-      @"DMem" : @"",
-      @"Remarks" : msg ?: @""
-    };
-    [_gLogCtrl appendRow:row];
-  }
+  buf[1023] = 0;
+  std::string utf8 = AsyncLog_WideToUtf8(buf);
+  AsyncLog_Text((uint8_t)lv, 0, 0, utf8.data(), utf8.size());
 #else
   (void)lv;
   (void)fmt;
@@ -349,33 +445,10 @@ static void Log_WritePerfEx(int page, double zoomPct, double timeMs,
 #if PDFWV_ENABLE_LOGGING
   if (!MacLog_IsEnabled())
     return;
-  double el = NowSeconds();
-  NSString *lvl = @"Debug:渲染性能";
-  NSString *zoom = [NSString stringWithFormat:@"%.0f%%", zoomPct];
-  NSString *tms = ToNSString(timeMs, 2);
-  NSString *mem = ToNSString(memMB, 2);
-  NSString *dmem = ToNSString(deltaMB, 2);
-  NSString *src = [NSString
-      stringWithFormat:@"%s:%d %s", file ? file : "", line, func ? func : ""];
-  NSString *rem = [NSString
-      stringWithFormat:@"%@%@%s", NSStringFromWChar(remarks),
-                       (remarks && remarks[0] ? @" | " : @""), src.UTF8String];
-  MacLog_AppendLine([NSString
-      stringWithFormat:@"[PERF] [+%7.3fs] p=%d z=%@ t=%@ mem=%@ dmem=%@ | %@",
-                       el, page, zoom, tms, mem, dmem, rem]);
-  if (_gLogCtrl) {
-    NSDictionary *row = @{
-      @"Elapsed" : [NSString stringWithFormat:@"%7.3f s", el],
-      @"Level" : lvl,
-      @"Page" : ToNSStringI(page),
-      @"Zoom" : zoom,
-      @"Time" : tms,
-      @"Mem" : mem,
-      @"DMem" : dmem,
-      @"Remarks" : rem
-    };
-    [_gLogCtrl appendRow:row];
-  }
+  // 只写入二进制记录，格式化与 I/O 在后台日志线程完成
+  AsyncLog_Perf((uint8_t)LogLevel::Debug,
+                AsyncLog_SiteId(file, line, func, remarks), page, zoomPct,
+                timeMs, memMB, deltaMB);
 #else
   (void)page;
   (void)zoomPct;
@@ -395,6 +468,25 @@ static void Log_WritePerf(int page, double zoomPct, double timeMs, double memMB,
                   __FILE__, __LINE__, __FUNCTION__);
 }
 
+// 输入→上屏延迟超过 16/33ms 的帧写入日志窗口，附带当时的页码与缩放
+static void ReportFramePresent(const FramePresent &f, int page, double zoom) {
+  if (f.jankLevel == 0)
+    return;
+  const double curMB = GetProcessMemMB();
+  if (f.jankLevel >= 2)
+    Log_WritePerfEx(page + 1, zoom * 100.0, f.inputToPresentMs, curMB, 0.0,
+                    L"卡顿帧 >33ms：输入→上屏", __FILE__, __LINE__,
+                    __FUNCTION__);
+  else
+    Log_WritePerfEx(page + 1, zoom * 100.0, f.inputToPresentMs, curMB, 0.0,
+                    L"卡顿帧 >16ms：输入→上屏", __FILE__, __LINE__,
+                    __FUNCTION__);
+  Log_WriteF(LogLevel::Warning,
+             L"Jank frame: %s -> present %.1f ms (page %d, zoom %.0f%%)",
+             f.source ? f.source : "?", f.inputToPresentMs, page + 1,
+             zoom * 100.0);
+}
+
 #if PDFWV_ENABLE_LOGGING
 #define LOGF(lv, fmt, ...)                                                     \
   do {                                                                         \
@@ -462,6 +554,7 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
 @optional
 - (void)pdfViewDidChangePage:(id)sender;
 - (void)pdfViewDidClickObject:(NSValue *)objectValue atIndex:(NSNumber *)index;
+- (void)pdfViewDidUpdateRenderCost:(id)sender;
 @end
 
 @interface PdfView : NSView
@@ -473,20 +566,54 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
 - (NSSize)currentPageSizePt;     // 当前页 PDF 尺寸（pt）
 - (void)updateViewSizeToFitPage; // 根据页尺寸与缩放调整自身 frame
                                  // 大小（供滚动容器使用）
-- (BOOL)findText:(NSString *)searchText
-       fromIndex:(NSNumber *)startIndex; // 文本查找功能
+// 文本查找：当前页全部匹配以叠加层高亮，改查找词不重新渲染页面
+- (void)setSearchQuery:(NSString *)query matchCase:(BOOL)matchCase;
+- (BOOL)findNextMatchBackward:(BOOL)backward; // 跳到下一处/上一处，必要时翻页
+- (NSString *)searchCountText;                // 当前页匹配数，供查找面板显示
+- (void)recordSessionViewport:(const char *)source; // 交互会话录制
+// 渲染耗时热力图（诊断模式）
+- (void)setRenderCostHeatmap:(BOOL)on;
+- (const RenderCostProfile *)renderCostProfile; // 未开启或尚未算完时为 nullptr
+- (void)inspectRenderCostObjectAtIndex:(int)objIndex;
 @end
 
 @implementation PdfView {
   FPDF_DOCUMENT _doc;
   int _pageIndex;
   double _zoom;
-  // 选择与交互
+  // 选择与交互：选区是文本流中的一段 [锚点, 活动端)，拖动时只查缓存的字符几何
   bool _selecting;
-  NSPoint _selStart;
+  NSPoint _selStart; // 视图坐标，仅用于会话录制
   NSPoint _selEnd;
+  PdfTextGeometryRef _selGeometry;
+  double _selPageHeightPt;
+  int _selAnchor; // 字符插入位置，-1 表示无
+  int _selFocus;
+  // 上一帧整页位图（BGRA）；拖选期间只有选区高亮在变，直接复用
+  std::vector<unsigned char> _frameBuffer;
+  int _framePage;
+  int _framePxW;
+  int _framePxH;
+  BOOL _overlayOnly; // 下一次 drawRect 只更新叠加层（选区/查找高亮）
+  // 查找：当前匹配所在页与页内序号，-1 表示无
+  int _searchPage;
+  int _searchMatch;
+  // 链接/注释命中：命中表在渲染时顺带建好，悬停与点击只查表
+  PdfHitMapRef _hoverMap; // 持有悬停所在页的命中表，保证 _hoverEntry 有效
+  const PdfHitEntry *_hoverEntry;
+  NSTrackingArea *_trackingArea;
   NSPoint _lastContextPt;    // 最近一次右键菜单触发位置（视图坐标）
   BOOL _lastContextHitImage; // 最近一次右键是否命中图片
+  // 渲染耗时热力图
+  BOOL _showRenderCost;
+  BOOL _renderCostPending;     // 已排队重算
+  RenderCostProfile _renderCost;
+  int _renderCostSelected;     // 列表中选中的对象下标，-1 表示无
+  // 图片目录：主线程定时分片建立（PDFium 非线程安全）
+  NSTimer *_imageCatalogTimer;
+  // 对象引用图：同样在主线程分片建立，供检查器查询反向引用
+  NSTimer *_refGraphTimer;
+  double _refGraphStartSec;
 }
 - (NSPoint)toPagePxFromView:(NSPoint)viewPt {
   // Convert view coordinates to page coordinates (in points)
@@ -511,6 +638,173 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
   return NSMakePoint(vx, vy);
 }
 
+// 交互会话录制：记录输入事件处理后的可见区域（设备像素）。
+// drawRect 每次渲染整页位图，因此 render 模式记为整页，回放时按同样方式计时。
+- (void)recordSessionViewport:(const char *)source {
+  if (!_doc || !Session_IsRecording())
+    return;
+  double scale = [[self window] backingScaleFactor] ?: 1.0;
+  NSRect visible = self.enclosingScrollView ? self.enclosingScrollView.contentView.bounds
+                                            : self.bounds;
+  SessionViewport v;
+  v.page = _pageIndex;
+  v.zoom = _zoom;
+  v.scrollX = (int)llround(visible.origin.x * scale);
+  v.scrollY = (int)llround(visible.origin.y * scale);
+  v.viewW = (int)llround(visible.size.width * scale);
+  v.viewH = (int)llround(visible.size.height * scale);
+  v.pxPerPt = scale;
+  v.fullPage = true;
+  Session_RecordViewport(source, v);
+}
+
+// 选区以页面点坐标（原点左上）记录起点与当前点
+- (void)recordSessionSelection:(const char *)source final:(bool)final {
+  if (!_doc || !Session_IsRecording())
+    return;
+  NSPoint a = [self toPagePxFromView:_selStart];
+  NSPoint b = [self toPagePxFromView:_selEnd];
+  Session_RecordSelection(source, _pageIndex, a.x, a.y, b.x, b.y, final);
+}
+
+#pragma mark - Text selection
+
+// 准备当前页字符几何（首次访问该页时构建），记下页高供坐标换算
+- (BOOL)beginTextSelection {
+  _selGeometry = PdfTextGeometry_Get(_doc, _pageIndex);
+  double wpt = 0;
+  if (!_selGeometry ||
+      !FPDF_GetPageSizeByIndex(_doc, _pageIndex, &wpt, &_selPageHeightPt)) {
+    _selGeometry.reset();
+    return NO;
+  }
+  return YES;
+}
+
+// 视图坐标（flipped，原点在页面左上）→ 最近的字符插入位置；无文本时为 -1
+- (int)selectionCaretAtViewPoint:(NSPoint)viewPt {
+  if (!_selGeometry)
+    return -1;
+  return _selGeometry->CaretAt((float)(viewPt.x / _zoom),
+                               (float)(_selPageHeightPt - viewPt.y / _zoom));
+}
+
+- (BOOL)hasTextSelection {
+  return _selGeometry && _selGeometry->pageIndex == _pageIndex &&
+         _selAnchor >= 0 && _selFocus >= 0 && _selAnchor != _selFocus;
+}
+
+#pragma mark - Render cost heatmap
+
+- (void)setRenderCostHeatmap:(BOOL)on {
+  _showRenderCost = on;
+  _renderCost = RenderCostProfile{};
+  _renderCostSelected = -1;
+  [self setNeedsDisplay:YES];
+}
+
+- (const RenderCostProfile *)renderCostProfile {
+  return (_showRenderCost && _renderCost.pageIndex == _pageIndex)
+             ? &_renderCost
+             : nullptr;
+}
+
+// 页码或缩放变化后由 drawRect 排队调用；逐图块、逐对象渲染，耗时较长
+- (void)refreshRenderCostWithPxW:(int)pxW pxH:(int)pxH {
+  _renderCostPending = NO;
+  if (!_showRenderCost || !_doc)
+    return;
+  double scale = [[self window] backingScaleFactor] ?: 1.0;
+  PdfProfileRenderCost(_doc, _pageIndex, pxW, pxH, (int)llround(64 * scale),
+                       FPDF_ANNOT | FPDF_LCD_TEXT, _renderCost);
+  _renderCostSelected = -1;
+  LOGF(LogLevel::Debug,
+       "Render cost page %d: full %.1f ms, %dx%d tiles %.2f..%.2f ms, %d objects",
+       _pageIndex + 1, _renderCost.fullMs, _renderCost.cols, _renderCost.rows,
+       _renderCost.minTileMs, _renderCost.maxTileMs,
+       (int)_renderCost.objects.size());
+  [self setNeedsDisplay:YES];
+  if ([self.delegate respondsToSelector:@selector(pdfViewDidUpdateRenderCost:)])
+    [self.delegate pdfViewDidUpdateRenderCost:self];
+}
+
+// 图块按耗时叠加红色，最慢的 5 个对象（及列表中选中的对象）描边并标注名次
+- (void)drawRenderCostOverlayWithPxW:(int)pxW
+                                 pxH:(int)pxH
+                               scale:(double)scale
+                        pageHeightPt:(double)hpt {
+  if (_renderCost.pageIndex != _pageIndex || _renderCost.pagePxW != pxW ||
+      _renderCost.pagePxH != pxH) {
+    if (!_renderCostPending) {
+      _renderCostPending = YES;
+      dispatch_async(dispatch_get_main_queue(), ^{
+        [self refreshRenderCostWithPxW:pxW pxH:pxH];
+      });
+    }
+    return;
+  }
+  for (const RenderTileCost &t : _renderCost.tiles) {
+    double heat = _renderCost.TileHeat(t);
+    if (heat <= 0.0)
+      continue;
+    [[NSColor colorWithCalibratedRed:1 green:0 blue:0 alpha:0.6 * heat]
+        setFill];
+    NSRectFillUsingOperation(
+        NSMakeRect(t.x / scale, t.y / scale, t.w / scale, t.h / scale),
+        NSCompositingOperationSourceOver);
+  }
+  NSDictionary *labelAttrs = @{
+    NSFontAttributeName : [NSFont boldSystemFontOfSize:11],
+    NSForegroundColorAttributeName : [NSColor orangeColor]
+  };
+  for (size_t i = 0; i < _renderCost.objects.size(); ++i) {
+    const RenderObjectCost &o = _renderCost.objects[i];
+    bool selected = o.index == _renderCostSelected;
+    if (!selected && (i >= 5 || o.ms <= 0.0))
+      continue;
+    NSRect r = NSMakeRect(o.left * _zoom, (hpt - o.top) * _zoom,
+                          (o.right - o.left) * _zoom,
+                          (o.top - o.bottom) * _zoom);
+    [(selected ? [NSColor systemBlueColor] : [NSColor orangeColor]) setStroke];
+    NSFrameRectWithWidth(r, selected ? 3.0 : 2.0);
+    NSString *label = [NSString
+        stringWithFormat:@"#%zu %.1f ms", i + 1, o.ms];
+    [label drawAtPoint:NSMakePoint(NSMinX(r) + 3, NSMinY(r) + 2)
+        withAttributes:labelAttrs];
+  }
+}
+
+// 在热力图列表中选中对象：高亮并跳转到检查器中的对应对象
+- (void)inspectRenderCostObjectAtIndex:(int)objIndex {
+  if (!_doc)
+    return;
+  _renderCostSelected = objIndex;
+  [self setNeedsDisplay:YES];
+  FPDF_PAGE page = FPDF_LoadPage(_doc, _pageIndex);
+  if (!page)
+    return;
+  FPDF_PAGEOBJECT obj = FPDFPage_GetObject(page, objIndex);
+  float left, bottom, right, top;
+  if (obj && FPDFPageObj_GetBounds(obj, &left, &bottom, &right, &top)) {
+    double hpt = FPDF_GetPageHeightF(page);
+    [self scrollRectToVisible:NSMakeRect(left * _zoom, (hpt - top) * _zoom,
+                                         (right - left) * _zoom,
+                                         (top - bottom) * _zoom)];
+  }
+  if (obj) {
+    // 建立页面对象索引，检查器随后 O(1) 查询对象号
+    PDFIUM_EX_CONTENT_SOURCE src;
+    PdfiumEx_GetPageObjectSource(page, obj, &src);
+    if ([self.delegate respondsToSelector:@selector(pdfViewDidClickObject:
+                                                                  atIndex:)])
+      [self.delegate pdfViewDidClickObject:[NSValue valueWithPointer:obj]
+                                   atIndex:@(objIndex)];
+  }
+  PdfiumEx_InvalidatePageCache(page);
+  SyncPdfiumExMemory();
+  FPDF_ClosePage(page);
+}
+
 - (FPDF_DOCUMENT)document {
   return _doc;
 }
@@ -528,7 +822,10 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
       index = pc - 1;
     int oldIndex = _pageIndex;
     _pageIndex = index;
+    [self clearHover];
+    FramePacing_MarkInput("goToPage:");
     [self setNeedsDisplay:YES];
+    [self recordSessionViewport:"goToPage:"];
     // 如果页面真的发生了变化，通知delegate
     if (oldIndex != _pageIndex &&
         [self.delegate respondsToSelector:@selector(pdfViewDidChangePage:)]) {
@@ -543,6 +840,10 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
     _pageIndex = 0;
     _zoom = 1.0;
     _selecting = false;
+    _selAnchor = _selFocus = -1;
+    _framePage = -1;
+    _searchPage = _searchMatch = -1;
+    _renderCostSelected = -1;
     [self.window setAcceptsMouseMovedEvents:YES];
   }
   return self;
@@ -554,23 +855,63 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
 
 - (BOOL)openPDFAtPath:(NSString *)path {
   NSLog(@"[PdfWinViewer] openPDFAtPath: %@", path);
+  PDFWV_TRACE_SCOPE("doc", "open");
   if (_doc) {
+    PdfiumEx_InvalidateDocumentCache(_doc);
+    PdfImageCache_InvalidateDocument(_doc);
+    [_imageCatalogTimer invalidate];
+    _imageCatalogTimer = nil;
+    [_refGraphTimer invalidate];
+    _refGraphTimer = nil;
+    PdfImageCatalog_Close();
+    PdfTextGeometry_InvalidateDocument(_doc);
+    PdfTextSearch_InvalidateDocument(_doc);
+    _searchPage = _searchMatch = -1;
+    [self clearHover];
+    PdfHitMap_InvalidateDocument(_doc);
+    _selGeometry.reset();
+    _selAnchor = _selFocus = -1;
+    Metrics_MemoryAdd(MemCategory::RenderBitmap, -(int64_t)_frameBuffer.size());
+    std::vector<unsigned char>().swap(_frameBuffer);
+    _framePage = -1;
     FPDF_CloseDocument(_doc);
     _doc = nullptr;
     _pageIndex = 0;
     _zoom = 1.0;
+    _renderCost.pageIndex = -1;
+    _renderCostSelected = -1;
   }
   std::string u8 = NSStringToUTF8(path);
   FPDF_LIBRARY_CONFIG cfg{};
   cfg.version = 3;
   FPDF_InitLibraryWithConfig(&cfg);
-  _doc = FPDF_LoadDocument(u8.c_str(), nullptr);
+  {
+    PDFWV_TRACE_SCOPE("doc", "load_document");
+    _doc = FPDF_LoadDocument(u8.c_str(), nullptr);
+  }
   if (!_doc) {
     LogFPDFLastError("FPDF_LoadDocument");
     return NO;
   }
   int pc = FPDF_GetPageCount(_doc);
   NSLog(@"[PdfWinViewer] document loaded. pageCount=%d", pc);
+  PdfImageCatalog_Open(_doc, u8, MacSidecarPath(u8, ".images"),
+                       PdfiumEx_GetImageObjectNumber);
+  if (!PdfImageCatalog_Status().complete) {
+    _imageCatalogTimer =
+        [NSTimer scheduledTimerWithTimeInterval:0.015
+                                         target:self
+                                       selector:@selector(imageCatalogTick:)
+                                       userInfo:nil
+                                        repeats:YES];
+  }
+  _refGraphStartSec = NowSeconds();
+  _refGraphTimer =
+      [NSTimer scheduledTimerWithTimeInterval:0.02
+                                       target:self
+                                     selector:@selector(refGraphTick:)
+                                     userInfo:nil
+                                      repeats:YES];
 // 首次渲染计时起点（只要编译时启用日志就记录，运行时再判断是否输出）
 #if PDFWV_ENABLE_LOGGING
   _openStartSec = NowSeconds();
@@ -579,9 +920,48 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
 #endif
   [self updateViewSizeToFitPage];
   [self setNeedsDisplay:YES];
+  if (Session_IsRecording()) {
+    Session_RecordDocument(u8.c_str());
+    [self recordSessionViewport:"open"];
+  }
   return YES;
 }
 
+// 每次只占用主线程约 8ms，避免影响交互
+- (void)imageCatalogTick:(NSTimer *)timer {
+  if (PdfImageCatalog_Step(8.0))
+    return;
+  [timer invalidate];
+  if (_imageCatalogTimer == timer)
+    _imageCatalogTimer = nil;
+  PdfImageCatalogStatus s = PdfImageCatalog_Status();
+  LOGF(LogLevel::Debug, "[ImageCatalog] %d images on %d pages", s.images,
+       s.pageCount);
+}
+
+// 引用图分片构建：每次约 6ms，与图片目录交替占用主线程
+- (void)refGraphTick:(NSTimer *)timer {
+  static MetricHistogram &stepMs = Metrics_Histogram("reference_graph.step_ms");
+  uint32_t done = 0, total = 0;
+  int state;
+  {
+    PDFWV_TRACE_SCOPE("doc", "reference_graph_step");
+    MetricTimer t(stepMs);
+    state = _doc ? PdfiumEx_BuildReferenceGraphStep(_doc, 6.0, &done, &total)
+                 : -1;
+  }
+  if (state == 0)
+    return;
+  [timer invalidate];
+  if (_refGraphTimer == timer)
+    _refGraphTimer = nil;
+  static MetricHistogram &buildMs =
+      Metrics_Histogram("reference_graph.build_ms");
+  const double ms = (NowSeconds() - _refGraphStartSec) * 1000.0;
+  buildMs.Record(ms);
+  LOGF(LogLevel::Debug, "[RefGraph] %u objects in %.0f ms (wall)", total, ms);
+}
+
 - (NSSize)currentPageSizePt {
   if (!_doc)
     return NSMakeSize(0, 0);
@@ -601,6 +981,7 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
 - (void)keyDown:(NSEvent *)event {
   if (!_doc)
     return;
+  FramePacing_MarkInput("keyDown:");
   NSString *chars = [event charactersIgnoringModifiers];
   unichar c = chars.length ? [chars characterAtIndex:0] : 0;
   NSEventModifierFlags mods =
@@ -611,18 +992,21 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
       _zoom = std::min(8.0, _zoom * 1.1);
       [self updateViewSizeToFitPage];
       [self setNeedsDisplay:YES];
+      [self recordSessionViewport:"keyDown:"];
       return;
     }
     if (c == '-') {
       _zoom = std::max(0.1, _zoom / 1.1);
       [self updateViewSizeToFitPage];
       [self setNeedsDisplay:YES];
+      [self recordSessionViewport:"keyDown:"];
       return;
     }
     if (c == '0') {
       _zoom = 1.0;
       [self updateViewSizeToFitPage];
       [self setNeedsDisplay:YES];
+      [self recordSessionViewport:"keyDown:"];
       return;
     }
     if (c == 'g' || c == 'G') {
@@ -662,6 +1046,8 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
     break;
   }
   [self setNeedsDisplay:YES];
+  if (oldIndex != _pageIndex)
+    [self recordSessionViewport:"keyDown:"];
   // 如果页面发生了变化，通知delegate
   if (oldIndex != _pageIndex &&
       [self.delegate respondsToSelector:@selector(pdfViewDidChangePage:)]) {
@@ -681,23 +1067,31 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
 - (IBAction)zoomIn:(id)sender {
   _zoom = std::min(8.0, _zoom * 1.1);
   [self updateViewSizeToFitPage];
+  FramePacing_MarkInput("zoomIn:");
   [self setNeedsDisplay:YES];
+  [self recordSessionViewport:"zoomIn:"];
 }
 - (IBAction)zoomOut:(id)sender {
   _zoom = std::max(0.1, _zoom / 1.1);
   [self updateViewSizeToFitPage];
+  FramePacing_MarkInput("zoomOut:");
   [self setNeedsDisplay:YES];
+  [self recordSessionViewport:"zoomOut:"];
 }
 - (IBAction)zoomActual:(id)sender {
   _zoom = 1.0;
   [self updateViewSizeToFitPage];
+  FramePacing_MarkInput("zoomActual:");
   [self setNeedsDisplay:YES];
+  [self recordSessionViewport:"zoomActual:"];
 }
 - (IBAction)goHome:(id)sender {
   if (_doc) {
     int oldIndex = _pageIndex;
     _pageIndex = 0;
+    FramePacing_MarkInput("goHome:");
     [self setNeedsDisplay:YES];
+    [self recordSessionViewport:"goHome:"];
     if (oldIndex != _pageIndex &&
         [self.delegate respondsToSelector:@selector(pdfViewDidChangePage:)]) {
       [self.delegate pdfViewDidChangePage:self];
@@ -710,7 +1104,9 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
     if (pc > 0) {
       int oldIndex = _pageIndex;
       _pageIndex = pc - 1;
+      FramePacing_MarkInput("goEnd:");
       [self setNeedsDisplay:YES];
+      [self recordSessionViewport:"goEnd:"];
       if (oldIndex != _pageIndex &&
           [self.delegate respondsToSelector:@selector(pdfViewDidChangePage:)]) {
         [self.delegate pdfViewDidChangePage:self];
@@ -723,7 +1119,9 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
     if (_pageIndex > 0) {
       int oldIndex = _pageIndex;
       _pageIndex--;
+      FramePacing_MarkInput("goPrevPage:");
       [self setNeedsDisplay:YES];
+      [self recordSessionViewport:"goPrevPage:"];
       if (oldIndex != _pageIndex &&
           [self.delegate respondsToSelector:@selector(pdfViewDidChangePage:)]) {
         [self.delegate pdfViewDidChangePage:self];
@@ -737,7 +1135,9 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
     if (pc > 0 && _pageIndex < pc - 1) {
       int oldIndex = _pageIndex;
       _pageIndex++;
+      FramePacing_MarkInput("goNextPage:");
       [self setNeedsDisplay:YES];
+      [self recordSessionViewport:"goNextPage:"];
       if (oldIndex != _pageIndex &&
           [self.delegate respondsToSelector:@selector(pdfViewDidChangePage:)]) {
         [self.delegate pdfViewDidChangePage:self];
@@ -754,9 +1154,11 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
 
 - (void)magnifyWithEvent:(NSEvent *)event {
   // 触控板捏合缩放
+  FramePacing_MarkInput("magnifyWithEvent:");
   _zoom = std::max(0.1, std::min(8.0, _zoom * (1.0 + event.magnification)));
   [self updateViewSizeToFitPage];
   [self setNeedsDisplay:YES];
+  [self recordSessionViewport:"magnifyWithEvent:"];
 }
 
 - (void)drawRect:(NSRect)dirtyRect {
@@ -773,11 +1175,7 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
   if (_pageIndex >= pageCount)
     _pageIndex = pageCount - 1;
 
-  FPDF_PAGE page = FPDF_LoadPage(_doc, _pageIndex);
-  if (!page) {
-    LogFPDFLastError("FPDF_LoadPage");
-    return;
-  }
+  PDFWV_TRACE_SCOPE_PAGE("render", "paint", _pageIndex);
 #if PDFWV_ENABLE_LOGGING
   bool _logActive = MacLog_IsEnabled();
   double t0 = _logActive ? NowSeconds() : 0.0;
@@ -789,17 +1187,17 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
   int pxW = std::max(1, (int)llround(wpt * _zoom * scale));
   int pxH = std::max(1, (int)llround(hpt * _zoom * scale));
 
-  std::vector<unsigned char> buffer((size_t)pxW * pxH * 4, 255);
-  FPDF_BITMAP bmp =
-      FPDFBitmap_CreateEx(pxW, pxH, FPDFBitmap_BGRA, buffer.data(), pxW * 4);
-  if (bmp) {
-    FPDFBitmap_FillRect(bmp, 0, 0, pxW, pxH, 0xFFFFFFFF);
-    int flags = FPDF_ANNOT | FPDF_LCD_TEXT;
-    FPDF_RenderPageBitmap(bmp, page, 0, 0, pxW, pxH, 0, flags);
-
+  // 拖选、改查找词时只有叠加层在变：复用上一帧位图，不再加载页面重新光栅化
+  const bool reuseFrame = (_selecting || _overlayOnly) &&
+                          _framePage == _pageIndex && _framePxW == pxW &&
+                          _framePxH == pxH;
+  _overlayOnly = NO;
+  if (!reuseFrame && ![self renderFrameWithPxW:pxW pxH:pxH])
+    return;
+  {
     CGColorSpaceRef cs = CGColorSpaceCreateDeviceRGB();
     CGDataProviderRef dp = CGDataProviderCreateWithData(
-        NULL, buffer.data(), (size_t)buffer.size(), NULL);
+        NULL, _frameBuffer.data(), (size_t)_frameBuffer.size(), NULL);
     CGBitmapInfo bi =
         (CGBitmapInfo)((uint32_t)kCGBitmapByteOrder32Little |
                        (uint32_t)kCGImageAlphaPremultipliedFirst); // BGRA
@@ -820,25 +1218,51 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
     // 绘制统一的白色背景（随缩放变化），避免缩放后背景与内容不同步
     CGContextSetFillColorWithColor(ctx, [NSColor whiteColor].CGColor);
     CGContextFillRect(ctx, CGRectMake(0, 0, destWpt, destHpt));
-    CGContextDrawImage(ctx, CGRectMake(0, 0, destWpt, destHpt), img);
+    {
+      PDFWV_TRACE_SCOPE("render", "blit");
+      CGContextDrawImage(ctx, CGRectMake(0, 0, destWpt, destHpt), img);
+    }
     CGContextRestoreGState(ctx);
     CGImageRelease(img);
     CGDataProviderRelease(dp);
     CGColorSpaceRelease(cs);
-
-    FPDFBitmap_Destroy(bmp);
   }
-  // 绘制选择框
-  if (_selecting || !NSEqualPoints(_selStart, _selEnd)) {
-    NSRect sel = NSMakeRect(
-        std::min(_selStart.x, _selEnd.x), std::min(_selStart.y, _selEnd.y),
-        fabs(_selStart.x - _selEnd.x), fabs(_selStart.y - _selEnd.y));
-    [[NSColor colorWithCalibratedRed:0 green:0.4 blue:1 alpha:0.2] setFill];
-    NSRectFillUsingOperation(sel, NSCompositingOperationSourceOver);
-    [[NSColor colorWithCalibratedRed:0 green:0.4 blue:1 alpha:0.8] setStroke];
-    NSFrameRectWithWidth(sel, 1.0);
+  if (_showRenderCost)
+    [self drawRenderCostOverlayWithPxW:pxW
+                                   pxH:pxH
+                                 scale:scale
+                          pageHeightPt:hpt];
+  // 查找高亮：缓存的匹配矩形，当前匹配用橙色
+  if (PdfPageSearchHitsRef hits = PdfTextSearch_PageHits(_doc, _pageIndex)) {
+    NSColor *all = [NSColor colorWithCalibratedRed:1 green:0.82 blue:0 alpha:0.35];
+    NSColor *current = [NSColor colorWithCalibratedRed:1 green:0.47 blue:0 alpha:0.5];
+    for (int m = 0; m < (int)hits->matches.size(); ++m) {
+      const PdfSearchMatch &match = hits->matches[m];
+      [(_searchPage == _pageIndex && _searchMatch == m ? current : all) setFill];
+      for (int i = match.firstRect; i < match.firstRect + match.rectCount; ++i) {
+        const PdfTextRect &r = hits->rects[i];
+        NSRectFillUsingOperation(
+            NSMakeRect(r.left * _zoom, (hpt - r.top) * _zoom,
+                       (r.right - r.left) * _zoom, (r.top - r.bottom) * _zoom),
+            NSCompositingOperationSourceOver);
+      }
+    }
   }
-  FPDF_ClosePage(page);
+  // 绘制选区高亮：每行一个矩形，覆盖选中的字形
+  if ([self hasTextSelection]) {
+    std::vector<PdfTextRect> rects;
+    _selGeometry->SelectionRects(std::min(_selAnchor, _selFocus),
+                                 std::max(_selAnchor, _selFocus), rects);
+    [[NSColor colorWithCalibratedRed:0 green:0.4 blue:1 alpha:0.3] setFill];
+    for (const PdfTextRect &r : rects) {
+      NSRect sel = NSMakeRect(r.left * _zoom, (hpt - r.top) * _zoom,
+                              (r.right - r.left) * _zoom,
+                              (r.top - r.bottom) * _zoom);
+      NSRectFillUsingOperation(sel, NSCompositingOperationSourceOver);
+    }
+  }
+  // 帧已交给窗口合成：结束本帧的输入→上屏计时
+  ReportFramePresent(FramePacing_Present(), _pageIndex, _zoom);
 #if PDFWV_ENABLE_LOGGING
   if (_logActive) {
     double t1 = NowSeconds();
@@ -858,14 +1282,60 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
 #endif
 }
 
+// 整页光栅化到 _frameBuffer（BGRA），记下帧参数供拖选时复用
+- (BOOL)renderFrameWithPxW:(int)pxW pxH:(int)pxH {
+  MetricTimer renderTimer(Metrics_RenderLatency(_zoom * 100.0));
+  FPDF_PAGE page = nullptr;
+  {
+    PDFWV_TRACE_SCOPE_PAGE("page", "page_load", _pageIndex);
+    MetricTimer loadTimer(Metrics_PageLoadLatency());
+    page = FPDF_LoadPage(_doc, _pageIndex);
+  }
+  if (!page) {
+    LogFPDFLastError("FPDF_LoadPage");
+    return NO;
+  }
+  const size_t bytes = (size_t)pxW * pxH * 4;
+  Metrics_MemoryAdd(MemCategory::RenderBitmap,
+                    (int64_t)bytes - (int64_t)_frameBuffer.size());
+  _frameBuffer.assign(bytes, 255);
+  _framePage = -1;
+  FPDF_BITMAP bmp =
+      FPDFBitmap_CreateEx(pxW, pxH, FPDFBitmap_BGRA, _frameBuffer.data(), pxW * 4);
+  if (bmp) {
+    FPDFBitmap_FillRect(bmp, 0, 0, pxW, pxH, 0xFFFFFFFF);
+    int flags = FPDF_ANNOT | FPDF_LCD_TEXT;
+    {
+      PDFWV_TRACE_SCOPE_PAGE("render", "render_bitmap", _pageIndex);
+      FPDF_RenderPageBitmap(bmp, page, 0, 0, pxW, pxH, 0, flags);
+    }
+    FPDFBitmap_Destroy(bmp);
+    _framePage = _pageIndex;
+    _framePxW = pxW;
+    _framePxH = pxH;
+  }
+  // 页面已加载，顺带建好命中表，悬停/点击时无需再加载页面
+  PdfHitMap_Get(_doc, _pageIndex, page);
+  FPDF_ClosePage(page);
+  return YES;
+}
+
 #pragma mark - Mouse events for selection and link navigation
 
 - (void)mouseDown:(NSEvent *)event {
   if (!_doc)
     return;
-  _selecting = true;
   _selStart = [self convertPoint:event.locationInWindow fromView:nil];
   _selEnd = _selStart;
+  _selAnchor = _selFocus =
+      [self beginTextSelection] ? [self selectionCaretAtViewPoint:_selStart] : -1;
+  if (event.clickCount == 2 && _selAnchor >= 0) {
+    // 双击选中一个词
+    _selGeometry->WordAt(_selAnchor, _selAnchor, _selFocus);
+    _selecting = false;
+  } else {
+    _selecting = true;
+  }
   [self setNeedsDisplay:YES];
 }
 
@@ -873,6 +1343,13 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
   if (!_doc || !_selecting)
     return;
   _selEnd = [self convertPoint:event.locationInWindow fromView:nil];
+  [self recordSessionSelection:"mouseDragged:" final:false];
+  // 插入位置不变则高亮不变，不必重绘
+  const int focus = [self selectionCaretAtViewPoint:_selEnd];
+  if (focus == _selFocus)
+    return;
+  _selFocus = focus;
+  FramePacing_MarkInput("mouseDragged:");
   [self setNeedsDisplay:YES];
 }
 
@@ -880,12 +1357,15 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
   if (!_doc)
     return;
   NSPoint up = [self convertPoint:event.locationInWindow fromView:nil];
-  if (_selecting) {
+  const bool wasSelecting = _selecting;
+  _selecting = false;
+  if (wasSelecting && !NSEqualPoints(up, _selStart)) {
     _selEnd = up;
-    _selecting = false;
+    _selFocus = [self selectionCaretAtViewPoint:up];
     [self setNeedsDisplay:YES];
-  } else {
-    // 非选择：尝试链接跳转
+    [self recordSessionSelection:"mouseUp:" final:true];
+  } else if (event.clickCount < 2) {
+    // 未拖动，当作点击：尝试链接跳转
     [self tryNavigateLinkAtPoint:up];
 
     // 检测点击的PDF对象并通知检查器
@@ -893,6 +1373,77 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
   }
 }
 
+#pragma mark - Link/annotation hover
+
+- (void)updateTrackingAreas {
+  [super updateTrackingAreas];
+  if (!_trackingArea) {
+    _trackingArea = [[NSTrackingArea alloc]
+        initWithRect:NSZeroRect
+             options:NSTrackingMouseMoved | NSTrackingMouseEnteredAndExited |
+                     NSTrackingActiveInKeyWindow | NSTrackingInVisibleRect
+               owner:self
+            userInfo:nil];
+    [self addTrackingArea:_trackingArea];
+  }
+}
+
+- (const PdfHitEntry *)hitEntryAtViewPoint:(NSPoint)viewPt map:(PdfHitMapRef &)map {
+  map = PdfHitMap_Get(_doc, _pageIndex);
+  if (!map)
+    return nullptr;
+  return map->HitTest((float)(viewPt.x / _zoom),
+                      (float)(map->pageHeight - viewPt.y / _zoom));
+}
+
+- (NSString *)describeHitEntry:(const PdfHitEntry &)e {
+  switch (e.kind) {
+  case PdfHitEntry::Kind::GoTo:
+    return [NSString stringWithFormat:@"跳转到第 %d 页", e.destPage + 1];
+  case PdfHitEntry::Kind::Uri:
+  case PdfHitEntry::Kind::External:
+    return [NSString stringWithUTF8String:e.target.c_str()];
+  case PdfHitEntry::Kind::Unsupported:
+    return @"链接（不支持的动作）";
+  default:
+    return e.contents.empty()
+               ? nil
+               : [[NSString alloc] initWithCharacters:(const unichar *)e.contents.data()
+                                               length:(NSUInteger)e.contents.size()];
+  }
+}
+
+- (void)clearHover {
+  if (!_hoverEntry)
+    return;
+  _hoverEntry = nullptr;
+  _hoverMap.reset();
+  self.toolTip = nil;
+  [[NSCursor arrowCursor] set];
+}
+
+- (void)mouseMoved:(NSEvent *)event {
+  if (!_doc || _selecting)
+    return;
+  NSPoint pt = [self convertPoint:event.locationInWindow fromView:nil];
+  PdfHitMapRef map;
+  const PdfHitEntry *e = [self hitEntryAtViewPoint:pt map:map];
+  if (e == _hoverEntry)
+    return;
+  if (!e) {
+    [self clearHover];
+    return;
+  }
+  _hoverEntry = e;
+  _hoverMap = map;
+  [(e->IsLink() ? [NSCursor pointingHandCursor] : [NSCursor arrowCursor]) set];
+  self.toolTip = [self describeHitEntry:*e];
+}
+
+- (void)mouseExited:(NSEvent *)event {
+  [self clearHover];
+}
+
 - (void)rightMouseDown:(NSEvent *)event {
   if (!_doc) {
     MacLog_DebugNS(@"[context] blocked: no document");
@@ -909,7 +1460,13 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
   double px = pageXY.x, py = pageXY.y;
   double wpt = 0, hpt = 0;
   FPDF_GetPageSizeByIndex(_doc, _pageIndex, &wpt, &hpt);
-  FPDF_PAGE page = FPDF_LoadPage(_doc, _pageIndex);
+  // 图片目录已确认该处没有图片时不必加载页面
+  FPDF_PAGE page =
+      PdfImageCatalog_MayHitImage(_pageIndex, (float)px, (float)(hpt - py), 2.0f)
+          ? FPDF_LoadPage(_doc, _pageIndex)
+          : nullptr;
+  if (!page)
+    Session_RecordHitTest("rightMouseDown:", "image", _pageIndex, px, py, false);
   MacLog_DebugNS(
       [NSString stringWithFormat:@"[context] pageXY=(%.1f,%.1f) pageIndex=%d",
                                  px, py, _pageIndex]);
@@ -969,6 +1526,8 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
     PdfHitImageResult r = PdfHitImageAt(page, px, py, hpt, 2.0f);
     hitObj = r.imageObj;
     hitImage = (hitObj != nullptr);
+    Session_RecordHitTest("rightMouseDown:", "image", _pageIndex, px, py,
+                          hitImage);
 
     if (hitImage) {
       unsigned int iw = 0, ih = 0;
@@ -1014,6 +1573,8 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
 }
 
 - (void)scrollWheel:(NSEvent *)event {
+  if (_doc)
+    FramePacing_MarkInput("scrollWheel:");
   NSEventModifierFlags mods =
       event.modifierFlags & NSEventModifierFlagDeviceIndependentFlagsMask;
   if ((mods & NSEventModifierFlagCommand) != 0) {
@@ -1033,14 +1594,15 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
       [super scrollWheel:event];
     }
   }
+  [self recordSessionViewport:"scrollWheel:"];
 }
 
 - (BOOL)validateMenuItem:(NSMenuItem *)menuItem {
   if (menuItem.action == @selector(copySelectionToPasteboard)) {
-    return !NSEqualPoints(_selStart, _selEnd);
+    return [self hasTextSelection];
   }
   if (menuItem.action == @selector(copy:)) {
-    return _doc && !NSEqualPoints(_selStart, _selEnd);
+    return _doc && [self hasTextSelection];
   }
   if (menuItem.action == @selector(exportPNG:)) {
     return _doc != nullptr;
@@ -1060,73 +1622,45 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
 }
 
 - (NSString *)extractSelectedText {
-  if (!_doc || NSEqualPoints(_selStart, _selEnd))
+  if (!_doc || ![self hasTextSelection])
     return @"";
-  FPDF_PAGE page = FPDF_LoadPage(_doc, _pageIndex);
-  if (!page)
-    return @"";
-  double wpt = 0, hpt = 0;
-  FPDF_GetPageSizeByIndex(_doc, _pageIndex, &wpt, &hpt);
-  // 视图坐标 -> 页面像素坐标（与渲染一致）
-  int dpi = 72 * (int)ceil([self.window backingScaleFactor] ?: 2.0);
-  auto toPagePx = ^(NSPoint p) {
-    double x = p.x * (dpi / 72.0) / _zoom;
-    double yTopDown = p.y * (dpi / 72.0) / _zoom;
-    double y = std::max(0.0, hpt - yTopDown);
-    return NSMakePoint(x, y);
-  };
-  NSPoint a = toPagePx(_selStart), b = toPagePx(_selEnd);
-  double left = std::min(a.x, b.x), right = std::max(a.x, b.x);
-  double bottom = std::min(a.y, b.y), top = std::max(a.y, b.y);
-  FPDF_TEXTPAGE tp = FPDFText_LoadPage(page);
-  if (!tp) {
-    FPDF_ClosePage(page);
-    return @"";
-  }
-  int n = FPDFText_GetBoundedText(tp, left, top, right, bottom, nullptr, 0);
-  if (n <= 0) {
-    FPDFText_ClosePage(tp);
-    FPDF_ClosePage(page);
-    return @"";
-  }
-  std::vector<unsigned short> wbuf((size_t)n + 1, 0);
-  FPDFText_GetBoundedText(tp, left, top, right, bottom,
-                          (unsigned short *)wbuf.data(), n);
-  FPDFText_ClosePage(tp);
-  FPDF_ClosePage(page);
-  NSString *s = [[NSString alloc] initWithCharacters:(unichar *)wbuf.data()
-                                              length:(NSUInteger)n];
+  const std::u16string text = _selGeometry->Text(
+      std::min(_selAnchor, _selFocus), std::max(_selAnchor, _selFocus));
+  NSString *s = [[NSString alloc] initWithCharacters:(const unichar *)text.data()
+                                              length:(NSUInteger)text.size()];
   return s ?: @"";
 }
 
 - (void)tryNavigateLinkAtPoint:(NSPoint)viewPt {
   if (!_doc)
     return;
-  FPDF_PAGE page = FPDF_LoadPage(_doc, _pageIndex);
-  if (!page)
+  PdfHitMapRef map;
+  const PdfHitEntry *e = [self hitEntryAtViewPoint:viewPt map:map];
+  const bool isLink = e && e->IsLink();
+  Session_RecordHitTest("mouseUp:", "link", _pageIndex, viewPt.x / _zoom,
+                        viewPt.y / _zoom, isLink);
+  if (!isLink)
+    return;
+  if (e->kind == PdfHitEntry::Kind::Uri) {
+    // 只打开网页/邮件链接，不执行文档里指定的任意程序或文件
+    NSURL *url = [NSURL URLWithString:[NSString stringWithUTF8String:e->target.c_str()]];
+    NSString *scheme = url.scheme.lowercaseString;
+    if ([scheme isEqualToString:@"http"] || [scheme isEqualToString:@"https"] ||
+        [scheme isEqualToString:@"mailto"])
+      [[NSWorkspace sharedWorkspace] openURL:url];
+    else
+      NSBeep();
     return;
-  double wpt = 0, hpt = 0;
-  FPDF_GetPageSizeByIndex(_doc, _pageIndex, &wpt, &hpt);
-  int dpi = 72 * (int)ceil([self.window backingScaleFactor] ?: 2.0);
-  double px = viewPt.x * (dpi / 72.0) / _zoom;
-  double py = std::max(0.0, hpt - viewPt.y * (dpi / 72.0) / _zoom);
-  FPDF_LINK link = FPDFLink_GetLinkAtPoint(page, px, py);
-  if (link) {
-    FPDF_DEST dest = FPDFLink_GetDest(_doc, link);
-    if (!dest) {
-      FPDF_ACTION act = FPDFLink_GetAction(link);
-      if (act)
-        dest = FPDFAction_GetDest(_doc, act);
-    }
-    if (dest) {
-      int pageIndex = FPDFDest_GetDestPageIndex(_doc, dest);
-      if (pageIndex >= 0) {
-        _pageIndex = pageIndex;
-        [self setNeedsDisplay:YES];
-      }
-    }
   }
-  FPDF_ClosePage(page);
+  if (e->kind != PdfHitEntry::Kind::GoTo) {
+    NSBeep();
+    return;
+  }
+  [self goToPage:e->destPage];
+  // 目标带纵坐标时滚动到该位置（PDF 坐标原点在左下，视图已翻转）
+  double wpt = 0, hpt = 0;
+  if (e->hasDestY && FPDF_GetPageSizeByIndex(_doc, e->destPage, &wpt, &hpt))
+    [self scrollPoint:NSMakePoint(self.visibleRect.origin.x, (hpt - e->destY) * _zoom)];
 }
 
 - (void)promptGotoPage {
@@ -1182,6 +1716,7 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
   int pxW = std::max(1, (int)llround(wpt / 72.0 * dpiX * z));
   int pxH = std::max(1, (int)llround(hpt / 72.0 * dpiY * z));
   std::vector<unsigned char> buffer((size_t)pxW * pxH * 4, 255);
+  MemoryCharge bufferMem(MemCategory::RenderBitmap, (int64_t)buffer.size());
   FPDF_BITMAP bmp =
       FPDFBitmap_CreateEx(pxW, pxH, FPDFBitmap_BGRA, buffer.data(), pxW * 4);
   if (!bmp) {
@@ -1260,20 +1795,37 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
     FPDF_ClosePage(page);
     return;
   }
-  // 优先原始像素，如失败回退渲染位图（抽到 shared 模块）
-  bool needDestroy = false;
-  FPDF_BITMAP useBmp = PdfAcquireBitmapForImage(_doc, page, hit, needDestroy);
+  // JPEG / JPEG 2000 直接写出嵌入的码流，不解码也不重新编码
+  PdfRawImage raw;
+  if (PdfExtractRawImage(page, hit, raw, PdfiumEx_IsImageParamsPlain)) {
+    FPDF_ClosePage(page);
+    NSString *ext = [NSString stringWithUTF8String:raw.extension];
+    NSSavePanel *sp = [NSSavePanel savePanel];
+    [sp setNameFieldStringValue:[@"image." stringByAppendingString:ext]];
+    if ([sp runModal] != NSModalResponseOK)
+      return;
+    NSData *data = [NSData dataWithBytesNoCopy:raw.data.data()
+                                        length:raw.data.size()
+                                  freeWhenDone:NO];
+    BOOL ok = [data writeToURL:sp.URL atomically:YES];
+    LOGF(LogLevel::Debug, "[saveImage] %s stream saved as-is: %zu bytes (%s)",
+         raw.filter, raw.data.size(), ok ? "ok" : "failed");
+    return;
+  }
+  // 其他编码：优先原始像素，如失败回退渲染位图；解码结果来自共享图片缓存
+  PdfDecodedImageRef image = PdfImageCache_Acquire(_doc, page, hit);
   MacLog_DebugNS([NSString
-      stringWithFormat:@"[saveImage] bitmap acquired: %p, needDestroy: %@",
-                       useBmp, needDestroy ? @"YES" : @"NO"]);
+      stringWithFormat:@"[saveImage] bitmap acquired: %p, rendered: %@",
+                       image ? image->bitmap : nullptr,
+                       (image && image->rendered) ? @"YES" : @"NO"]);
 
-  void *buf = nullptr;
+  const void *buf = nullptr;
   int w = 0, h = 0, stride = 0;
-  if (useBmp) {
-    buf = FPDFBitmap_GetBuffer(useBmp);
-    w = FPDFBitmap_GetWidth(useBmp);
-    h = FPDFBitmap_GetHeight(useBmp);
-    stride = FPDFBitmap_GetStride(useBmp);
+  if (image) {
+    buf = image->Buffer();
+    w = image->width;
+    h = image->height;
+    stride = image->stride;
     MacLog_DebugNS([NSString
         stringWithFormat:@"[saveImage] bitmap info: %dx%d, stride=%d, buf=%p",
                          w, h, stride, buf]);
@@ -1281,8 +1833,6 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
   if (!buf || w <= 0 || h <= 0) {
     NSLog(@"[PdfWinViewer][saveImage] no bitmap available");
     MacLog_DebugNS(@"[saveImage] bitmap acquisition failed");
-    if (needDestroy && useBmp)
-      FPDFBitmap_Destroy(useBmp);
     FPDF_ClosePage(page);
     return;
   }
@@ -1292,15 +1842,13 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
   NSInteger resp = [sp runModal];
   NSLog(@"[PdfWinViewer][saveImage] save panel resp=%ld", (long)resp);
   if (resp != NSModalResponseOK) {
-    if (needDestroy) { /* release rendered */
-    }
     FPDF_ClosePage(page);
     return;
   }
   NSURL *url = sp.URL;
 
   // 获取 PDFium 位图格式
-  int pdfFormat = FPDFBitmap_GetFormat(useBmp);
+  int pdfFormat = image->format;
   MacLog_DebugNS(
       [NSString stringWithFormat:@"[saveImage] PDFium format: %d", pdfFormat]);
 
@@ -1313,8 +1861,8 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
   int bitsPerPixel = 32;
   int finalStride = stride;
 
-  // BGR 24位格式的转换缓冲区（需要在作用域外保持）
-  static std::vector<unsigned char> rgbBuffer;
+  // BGR 24位格式的转换缓冲区（需要活到 CGImage 编码结束）
+  std::vector<unsigned char> rgbBuffer;
 
   if (pdfFormat == FPDFBitmap_BGRA) {
     // BGRA 格式
@@ -1398,12 +1946,6 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
   if (cs)
     CGColorSpaceRelease(cs);
 
-  // 释放 PDFium 位图
-  if (needDestroy && useBmp) {
-    FPDFBitmap_Destroy(useBmp);
-    MacLog_DebugNS(@"[saveImage] bitmap destroyed");
-  }
-
   FPDF_ClosePage(page);
 
   NSLog(@"[PdfWinViewer][saveImage] save completed: %@, path: %@",
@@ -1424,11 +1966,13 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
   FPDF_PAGE page = FPDF_LoadPage(_doc, _pageIndex);
   if (!page)
     return;
+  MetricTimer hitTimer(Metrics_HitTestLatency());
 
   // 遍历页面上的所有对象
   int totalObjs = FPDFPage_CountObjects(page);
   NSLog(@"[PdfView] 检测点击位置 (%.1f, %.1f)，页面共有 %d 个对象", px, py,
         totalObjs);
+  bool hitAny = false;
 
   for (int i = 0; i < totalObjs; i++) {
     FPDF_PAGEOBJECT obj = FPDFPage_GetObject(page, i);
@@ -1445,6 +1989,16 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
             @"[PdfView] 点击命中对象 %d，类型: %d，边界: (%.1f,%.1f,%.1f,%.1f)",
             i, objType, left, bottom, right, top);
 
+        // 通过内容流索引解析对象来源（每页只扫描一次；页面重新加载后按对象
+        // 序号重新绑定，不再扫描）
+        PDFIUM_EX_CONTENT_SOURCE src;
+        if (PdfiumEx_GetPageObjectSource(page, obj, &src)) {
+          NSLog(@"[PdfView] 对象来源: %u 0 R, 内容流 %u 0 R [%u, %u) op=%s "
+                @"res=/%s (%u 0 R)",
+                src.obj_num, src.stream_obj_num, src.op_begin, src.op_end,
+                src.op, src.resource_name, src.resource_obj_num);
+        }
+
         // 通知AppDelegate跳转到检查器中的对应对象
         if (self.delegate && [self.delegate respondsToSelector:@selector
                                             (pdfViewDidClickObject:atIndex:)]) {
@@ -1455,147 +2009,425 @@ static inline std::string NSStringToUTF8(NSObject *obj) {
                               withObject:objValue
                               withObject:@(i)];
         }
+        hitAny = true;
         break; // 只处理第一个命中的对象
       }
     }
   }
+  Session_RecordHitTest("mouseUp:", "object", _pageIndex, px, py, hitAny);
 
+  PDFIUM_EX_MAPPING_CACHE_STATS cacheStats{};
+  if (PdfiumEx_GetMappingCacheStats(_doc, &cacheStats))
+    Metrics_SetCacheTotals("object_mapping", cacheStats.hits,
+                           cacheStats.misses);
+  PdfiumEx_InvalidatePageCache(page);
+  SyncPdfiumExMemory();
   FPDF_ClosePage(page);
 }
 
-// 文本查找功能
-- (BOOL)findText:(NSString *)searchText fromIndex:(NSNumber *)startIndex {
-  if (!_doc || !searchText || searchText.length == 0) {
-    NSLog(@"[PdfView] 查找失败：无效的文档或搜索文本");
-    return NO;
-  }
+#pragma mark - Text search
 
-  FPDF_PAGE page = FPDF_LoadPage(_doc, _pageIndex);
-  if (!page) {
-    NSLog(@"[PdfView] 查找失败：无法加载页面 %d", _pageIndex);
-    return NO;
+- (void)setSearchQuery:(NSString *)query matchCase:(BOOL)matchCase {
+  std::u16string q;
+  if (query.length) {
+    q.resize(query.length);
+    [query getCharacters:(unichar *)q.data() range:NSMakeRange(0, query.length)];
   }
+  if (!PdfTextSearch_SetQuery(q, matchCase ? FPDF_MATCHCASE : 0))
+    return;
+  _searchPage = _searchMatch = -1;
+  _overlayOnly = YES;
+  [self setNeedsDisplay:YES];
+}
 
-  // 加载文本页面
-  FPDF_TEXTPAGE textPage = FPDFText_LoadPage(page);
-  if (!textPage) {
-    NSLog(@"[PdfView] 查找失败：无法加载文本页面");
-    FPDF_ClosePage(page);
+- (BOOL)findNextMatchBackward:(BOOL)backward {
+  if (!_doc)
+    return NO;
+  int page = _pageIndex;
+  int match = (_searchPage == _pageIndex) ? _searchMatch : -1;
+  if (!PdfTextSearch_Step(_doc, page, match, backward))
     return NO;
+  if (page != _pageIndex)
+    [self goToPage:page];
+  _searchPage = page;
+  _searchMatch = match;
+  PdfPageSearchHitsRef hits = PdfTextSearch_PageHits(_doc, page);
+  double wpt = 0, hpt = 0;
+  if (hits && match < (int)hits->matches.size() &&
+      hits->matches[match].rectCount > 0 &&
+      FPDF_GetPageSizeByIndex(_doc, page, &wpt, &hpt)) {
+    const PdfTextRect &r = hits->rects[hits->matches[match].firstRect];
+    [self scrollRectToVisible:NSMakeRect(r.left * _zoom - 40,
+                                         (hpt - r.top) * _zoom - 40,
+                                         (r.right - r.left) * _zoom + 80,
+                                         (r.top - r.bottom) * _zoom + 80)];
+  }
+  _overlayOnly = YES;
+  [self setNeedsDisplay:YES];
+  return YES;
+}
+
+- (NSString *)searchCountText {
+  PdfPageSearchHitsRef hits =
+      _doc ? PdfTextSearch_PageHits(_doc, _pageIndex) : nullptr;
+  if (!hits)
+    return @"";
+  const int n = (int)hits->matches.size();
+  if (_searchPage == _pageIndex && _searchMatch >= 0 && _searchMatch < n)
+    return [NSString stringWithFormat:@"本页 %d / %d", _searchMatch + 1, n];
+  return [NSString stringWithFormat:@"本页 %d 处", n];
+}
+
+@end
+
+// 书签模型：大纲一次性扁平化到共享的 PdfOutline，节点对象按需创建，
+// 只有展开过的层级才有对象；当前页所属书签由页区间索引二分查找。
+// 筛选时只显示命中条目及其祖先，可见子项按父节点懒缓存
+@interface TocNode : NSObject
+@property(nonatomic, assign) int entry; // PdfOutline 条目下标
+@end
+
+@implementation TocNode
+@end
+
+@interface TocModel : NSObject
+- (instancetype)initWithDocument:(FPDF_DOCUMENT)doc;
+- (NSInteger)childCountOf:(TocNode *)node; // nil 表示顶层
+- (TocNode *)child:(NSInteger)index of:(TocNode *)node;
+- (NSString *)titleOf:(TocNode *)node;
+- (int)pageOf:(TocNode *)node; // -1 表示无跳转
+- (TocNode *)parentOf:(TocNode *)node;
+- (TocNode *)nodeForPage:(int)pageIndex;
+- (BOOL)isFiltering;
+// 应用筛选词（空串取消筛选）。对根与已展开且筛选前后都可见的父节点，
+// 以 update 回调给出旧列表中移除的下标、新列表中插入的下标；reload
+// 为可展开性发生变化的已加载折叠节点
+- (void)setFilter:(NSString *)query
+       isExpanded:(BOOL (^)(TocNode *node))isExpanded
+           update:(void (^)(TocNode *parent, NSIndexSet *removed,
+                            NSIndexSet *inserted))update
+           reload:(NSMutableArray<TocNode *> *)reload;
+- (NSArray<TocNode *> *)filterAncestors; // 按下标（自顶向下）排列
+@end
+
+// 'parent'（-1 为顶层）在给定筛选状态下的可见子条目，升序
+static void TocVisibleChildren(const PdfOutline &outline, bool filtering,
+                               const std::vector<uint8_t> &flags, int parent,
+                               std::vector<int> &out) {
+  out.clear();
+  const int n = outline.ChildCount(parent);
+  for (int i = 0; i < n; ++i) {
+    const int c = outline.Child(parent, i);
+    if (!filtering || flags[c])
+      out.push_back(c);
   }
+}
 
-  // 将NSString转换为FPDF_WIDESTRING
-  NSData *utf16Data =
-      [searchText dataUsingEncoding:NSUTF16LittleEndianStringEncoding];
-  FPDF_WIDESTRING wideString = (FPDF_WIDESTRING)utf16Data.bytes;
+@implementation TocModel {
+  PdfOutline _outline;
+  std::vector<TocNode *> _nodes; // 按条目下标缓存，未创建的为 nil
+  PdfOutlineFilter _filter;      // 首次输入筛选词时构建
+  bool _filterBuilt;
+  bool _filtering;
+  std::vector<uint8_t> _flags; // kPdfOutline* 位，按条目下标
+  std::unordered_map<int, std::vector<int>> _visible; // 筛选时的可见子项
+}
 
-  int startIdx = startIndex ? [startIndex intValue] : 0;
-  NSLog(@"[PdfView] 开始查找文本: '%@'，起始索引: %d", searchText, startIdx);
+- (instancetype)initWithDocument:(FPDF_DOCUMENT)doc {
+  if (self = [super init]) {
+    _outline = PdfOutline_Build(doc);
+    _nodes.resize(_outline.entries.size());
+  }
+  return self;
+}
 
-  // 开始搜索
-  FPDF_SCHHANDLE searchHandle =
-      FPDFText_FindStart(textPage, wideString, 0, startIdx);
-  if (!searchHandle) {
-    NSLog(@"[PdfView] 查找失败：无法创建搜索句柄");
-    FPDFText_ClosePage(textPage);
-    FPDF_ClosePage(page);
-    return NO;
+- (TocNode *)nodeAt:(int)entry {
+  if (entry < 0 || entry >= (int)_nodes.size())
+    return nil;
+  if (!_nodes[entry]) {
+    TocNode *n = [TocNode new];
+    n.entry = entry;
+    _nodes[entry] = n;
   }
+  return _nodes[entry];
+}
 
-  // 查找下一个匹配
-  BOOL found = FPDFText_FindNext(searchHandle);
-  if (found) {
-    int resultIndex = FPDFText_GetSchResultIndex(searchHandle);
-    int resultCount = FPDFText_GetSchCount(searchHandle);
-    NSLog(@"[PdfView] 找到匹配文本，位置: %d，长度: %d", resultIndex,
-          resultCount);
-
-    // 获取匹配文本的边界框以便高亮显示
-    double left, top, right, bottom;
-    if (FPDFText_GetCharBox(textPage, resultIndex, &left, &bottom, &right,
-                            &top)) {
-      NSLog(@"[PdfView] 匹配文本边界: (%.1f, %.1f, %.1f, %.1f)", left, bottom,
-            right, top);
-
-      // 将PDF坐标转换为视图坐标并滚动到可见区域
-      NSPoint viewPoint = [self toViewFromPagePx:NSMakePoint(left, top)];
-      NSRect visibleRect =
-          NSMakeRect(viewPoint.x - 50, viewPoint.y - 50, 100, 100);
-      [self scrollRectToVisible:visibleRect];
-
-      // 标记需要重绘以显示高亮
-      [self setNeedsDisplay:YES];
-    }
-  } else {
-    NSLog(@"[PdfView] 未找到匹配的文本");
+- (const std::vector<int> *)visibleChildrenOf:(int)parent {
+  auto [it, inserted] = _visible.try_emplace(parent);
+  if (inserted)
+    TocVisibleChildren(_outline, true, _flags, parent, it->second);
+  return &it->second;
+}
+
+- (NSInteger)childCountOf:(TocNode *)node {
+  const int parent = node ? node.entry : -1;
+  if (!_filtering)
+    return _outline.ChildCount(parent);
+  return (NSInteger)[self visibleChildrenOf:parent]->size();
+}
+
+- (TocNode *)child:(NSInteger)index of:(TocNode *)node {
+  const int parent = node ? node.entry : -1;
+  if (_filtering) {
+    const std::vector<int> *visible = [self visibleChildrenOf:parent];
+    if (index < 0 || index >= (NSInteger)visible->size())
+      return nil;
+    return [self nodeAt:(*visible)[index]];
   }
+  if (index < 0 || index >= _outline.ChildCount(parent))
+    return nil;
+  return [self nodeAt:_outline.Child(parent, (int)index)];
+}
 
-  // 清理资源
-  FPDFText_FindClose(searchHandle);
-  FPDFText_ClosePage(textPage);
-  FPDF_ClosePage(page);
+- (NSString *)titleOf:(TocNode *)node {
+  if (!node)
+    return @"";
+  const std::u16string_view t = _outline.Title(node.entry);
+  return [[NSString alloc] initWithCharacters:(const unichar *)t.data()
+                                       length:(NSUInteger)t.size()];
+}
 
-  return found;
+- (int)pageOf:(TocNode *)node {
+  return node ? _outline.entries[node.entry].pageIndex : -1;
 }
 
-@end
+- (TocNode *)parentOf:(TocNode *)node {
+  return node ? [self nodeAt:_outline.entries[node.entry].parent] : nil;
+}
 
-// 书签节点模型
-@interface TocNode : NSObject
-@property(nonatomic, strong) NSString *title;
-@property(nonatomic, assign) int pageIndex; // -1 表示无跳转
-@property(nonatomic, strong) NSMutableArray<TocNode *> *children;
+- (TocNode *)nodeForPage:(int)pageIndex {
+  return [self nodeAt:_outline.EntryForPage(pageIndex)];
+}
+
+- (BOOL)isFiltering {
+  return _filtering;
+}
+
+- (void)setFilter:(NSString *)query
+       isExpanded:(BOOL (^)(TocNode *node))isExpanded
+           update:(void (^)(TocNode *parent, NSIndexSet *removed,
+                            NSIndexSet *inserted))update
+           reload:(NSMutableArray<TocNode *> *)reload {
+  std::u16string q(query.length, u'\0');
+  [query getCharacters:(unichar *)q.data() range:NSMakeRange(0, q.size())];
+  const bool oldFiltering = _filtering;
+  std::vector<uint8_t> oldFlags = std::move(_flags);
+  if (!q.empty() && !_filterBuilt) {
+    _filter = PdfOutlineFilter_Build(_outline);
+    _filterBuilt = true;
+  }
+  PdfOutlineFilter_Match(_outline, _filter, q, _flags);
+  _filtering = !q.empty();
+  _visible.clear();
+  auto visibleIn = [&](bool filtering, const std::vector<uint8_t> &flags,
+                       int entry) {
+    return !filtering || (flags[entry] != 0);
+  };
+  auto expandable = [&](bool filtering, const std::vector<uint8_t> &flags,
+                        int entry) {
+    const PdfOutlineEntry &e = _outline.entries[entry];
+    for (int c = e.firstChild; c < e.firstChild + e.childCount; ++c)
+      if (visibleIn(filtering, flags, c))
+        return true;
+    return false;
+  };
+
+  // 只比较视图已加载的层级：根，以及前后都可见且已展开的节点
+  struct Change {
+    int parent;
+    NSMutableIndexSet *removed;
+    NSMutableIndexSet *inserted;
+  };
+  std::vector<Change> changes;
+  std::vector<int> pending{-1}, oldKids, newKids;
+  while (!pending.empty()) {
+    const int parent = pending.back();
+    pending.pop_back();
+    TocVisibleChildren(_outline, oldFiltering, oldFlags, parent, oldKids);
+    TocVisibleChildren(_outline, _filtering, _flags, parent, newKids);
+    Change ch{parent, [NSMutableIndexSet indexSet],
+              [NSMutableIndexSet indexSet]};
+    size_t i = 0, j = 0;
+    while (i < oldKids.size() || j < newKids.size()) {
+      if (j == newKids.size() ||
+          (i < oldKids.size() && oldKids[i] < newKids[j])) {
+        [ch.removed addIndex:i++];
+      } else if (i == oldKids.size() || newKids[j] < oldKids[i]) {
+        [ch.inserted addIndex:j++];
+      } else {
+        const int c = oldKids[i];
+        TocNode *n = _nodes[c];
+        if (n && isExpanded(n))
+          pending.push_back(c);
+        else if (n && expandable(oldFiltering, oldFlags, c) !=
+                          expandable(_filtering, _flags, c))
+          [reload addObject:n];
+        ++i, ++j;
+      }
+    }
+    if (ch.removed.count || ch.inserted.count)
+      changes.push_back(ch);
+  }
+  for (const Change &ch : changes)
+    update([self nodeAt:ch.parent], ch.removed, ch.inserted);
+}
+
+- (NSArray<TocNode *> *)filterAncestors {
+  NSMutableArray<TocNode *> *out = [NSMutableArray array];
+  if (!_filtering)
+    return out;
+  // 子条目总排在父条目之后，下标顺序即自顶向下
+  for (int e = 0; e < (int)_flags.size(); ++e)
+    if (_flags[e] & kPdfOutlineAncestor)
+      [out addObject:[self nodeAt:e]];
+  return out;
+}
 @end
 
-@implementation TocNode
+// 渲染耗时热力图：最慢对象排行，选中一行即在检查器中定位该对象
+@class _RenderCostWindowController;
+static _RenderCostWindowController *_gRenderCostCtrl = nil;
+
+@interface _RenderCostWindowController
+    : NSWindowController <NSTableViewDataSource, NSTableViewDelegate,
+                          NSWindowDelegate>
+@property(nonatomic, weak) PdfView *pdfView;
+@property(nonatomic, weak) NSMenuItem *menuItem;
+@property(nonatomic, strong) NSTextField *summaryLabel;
+@property(nonatomic, strong) NSTableView *table;
+- (void)reloadFromView;
 @end
 
-static NSString *BookmarkTitle(FPDF_DOCUMENT doc, FPDF_BOOKMARK bm) {
-  int len = FPDFBookmark_GetTitle(bm, nullptr, 0);
-  if (len <= 0)
-    return @"";
-  std::vector<unsigned short> w((size_t)len + 1, 0);
-  FPDFBookmark_GetTitle(bm, (unsigned short *)w.data(), len);
-  return [[NSString alloc] initWithCharacters:(unichar *)w.data()
-                                       length:(NSUInteger)len];
+@implementation _RenderCostWindowController {
+  std::vector<RenderObjectCost> _objects;
+  double _objectsTotalMs;
+}
+
+- (instancetype)initWithView:(PdfView *)view {
+  NSRect rc = NSMakeRect(260, 260, 620, 420);
+  NSWindow *w = [[NSWindow alloc]
+      initWithContentRect:rc
+                styleMask:(NSWindowStyleMaskTitled | NSWindowStyleMaskClosable |
+                           NSWindowStyleMaskResizable)
+                  backing:NSBackingStoreBuffered
+                    defer:NO];
+  w.title = @"渲染耗时热力图";
+  if (self = [super initWithWindow:w]) {
+    w.delegate = (id<NSWindowDelegate>)self;
+    self.pdfView = view;
+    NSView *c = w.contentView;
+    NSTextField *summary = [NSTextField wrappingLabelWithString:@"正在计算…"];
+    summary.frame = NSMakeRect(12, rc.size.height - 52, rc.size.width - 24, 40);
+    summary.autoresizingMask = NSViewWidthSizable | NSViewMinYMargin;
+    [c addSubview:summary];
+    self.summaryLabel = summary;
+
+    NSScrollView *sv = [[NSScrollView alloc]
+        initWithFrame:NSMakeRect(8, 8, rc.size.width - 16,
+                                 rc.size.height - 68)];
+    sv.autoresizingMask = NSViewWidthSizable | NSViewHeightSizable;
+    NSTableView *tv = [[NSTableView alloc] initWithFrame:sv.bounds];
+    tv.dataSource = self;
+    tv.delegate = self;
+    tv.usesAlternatingRowBackgroundColors = YES;
+    auto addCol = ^(NSString *ident, NSString *title, CGFloat width) {
+      NSTableColumn *col = [[NSTableColumn alloc] initWithIdentifier:ident];
+      col.title = title;
+      col.width = width;
+      [tv addTableColumn:col];
+    };
+    addCol(@"Rank", @"排名", 50);
+    addCol(@"Index", @"对象序号", 70);
+    addCol(@"Type", @"类型", 70);
+    addCol(@"Ms", @"耗时(ms)", 80);
+    addCol(@"Share", @"占比", 60);
+    addCol(@"Bounds", @"边界 (pt)", 240);
+    sv.documentView = tv;
+    sv.hasVerticalScroller = YES;
+    [c addSubview:sv];
+    self.table = tv;
+    [self reloadFromView];
+  }
+  return self;
 }
 
-static int BookmarkPage(FPDF_DOCUMENT doc, FPDF_BOOKMARK bm) {
-  FPDF_DEST dest = FPDFBookmark_GetDest(doc, bm);
-  if (!dest) {
-    FPDF_ACTION act = FPDFBookmark_GetAction(bm);
-    if (act)
-      dest = FPDFAction_GetDest(doc, act);
+- (void)reloadFromView {
+  const RenderCostProfile *p = [self.pdfView renderCostProfile];
+  _objects.clear();
+  _objectsTotalMs = 0.0;
+  if (!p) {
+    self.summaryLabel.stringValue = @"正在计算…";
+  } else {
+    _objects = p->objects;
+    for (const RenderObjectCost &o : _objects)
+      _objectsTotalMs += o.ms;
+    self.summaryLabel.stringValue = [NSString
+        stringWithFormat:@"第 %d 页：整页渲染 %.1f ms；%d×%d 图块 %.2f–%.2f "
+                         @"ms；%zu 个顶层对象，单独渲染合计 %.1f ms",
+                         p->pageIndex + 1, p->fullMs, p->cols, p->rows,
+                         p->minTileMs, p->maxTileMs, _objects.size(),
+                         _objectsTotalMs];
   }
-  if (!dest)
-    return -1;
-  return FPDFDest_GetDestPageIndex(doc, dest);
+  [self.table reloadData];
 }
 
-static void BuildBookmarkChildren(FPDF_DOCUMENT doc, FPDF_BOOKMARK parentBm,
-                                  TocNode *parentNode) {
-  FPDF_BOOKMARK child = FPDFBookmark_GetFirstChild(doc, parentBm);
-  while (child) {
-    TocNode *node = [TocNode new];
-    node.title = BookmarkTitle(doc, child);
-    node.pageIndex = BookmarkPage(doc, child);
-    node.children = [NSMutableArray new];
-    [parentNode.children addObject:node];
-    // 递归
-    BuildBookmarkChildren(doc, child, node);
-    child = FPDFBookmark_GetNextSibling(doc, child);
+- (NSInteger)numberOfRowsInTableView:(NSTableView *)tableView {
+  return (NSInteger)_objects.size();
+}
+
+- (NSView *)tableView:(NSTableView *)tableView
+    viewForTableColumn:(NSTableColumn *)tableColumn
+                   row:(NSInteger)row {
+  NSTableCellView *cell =
+      [tableView makeViewWithIdentifier:tableColumn.identifier owner:self];
+  if (!cell) {
+    cell = [[NSTableCellView alloc]
+        initWithFrame:NSMakeRect(0, 0, tableColumn.width, 20)];
+    cell.identifier = tableColumn.identifier;
+    NSTextField *tf = [NSTextField labelWithString:@""];
+    tf.frame = cell.bounds;
+    tf.autoresizingMask = NSViewWidthSizable | NSViewHeightSizable;
+    cell.textField = tf;
+    [cell addSubview:tf];
   }
+  const RenderObjectCost &o = _objects[(size_t)row];
+  NSString *ident = tableColumn.identifier;
+  NSString *text = @"";
+  if ([ident isEqualToString:@"Rank"])
+    text = ToNSStringI((int)row + 1);
+  else if ([ident isEqualToString:@"Index"])
+    text = ToNSStringI(o.index);
+  else if ([ident isEqualToString:@"Type"])
+    text = [NSString stringWithUTF8String:PdfPageObjectTypeName(o.type)];
+  else if ([ident isEqualToString:@"Ms"])
+    text = ToNSString(o.ms, 2);
+  else if ([ident isEqualToString:@"Share"])
+    text = [NSString
+        stringWithFormat:@"%.1f%%",
+                         _objectsTotalMs > 0 ? 100.0 * o.ms / _objectsTotalMs
+                                             : 0.0];
+  else if ([ident isEqualToString:@"Bounds"])
+    text = [NSString stringWithFormat:@"[%.1f %.1f %.1f %.1f]", o.left,
+                                      o.bottom, o.right, o.top];
+  cell.textField.stringValue = text;
+  return cell;
 }
 
-static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
-  TocNode *root = [TocNode new];
-  root.title = @"ROOT";
-  root.pageIndex = -1;
-  root.children = [NSMutableArray new];
-  BuildBookmarkChildren(doc, nullptr, root);
-  return root;
+- (void)tableViewSelectionDidChange:(NSNotification *)notification {
+  NSInteger row = self.table.selectedRow;
+  if (row < 0 || (size_t)row >= _objects.size())
+    return;
+  [self.pdfView inspectRenderCostObjectAtIndex:_objects[(size_t)row].index];
 }
 
+// 关闭窗口即退出热力图模式
+- (void)windowWillClose:(NSNotification *)notification {
+  [self.pdfView setRenderCostHeatmap:NO];
+  self.menuItem.state = NSControlStateValueOff;
+  _gRenderCostCtrl = nil;
+}
+@end
+
 @interface AppDelegate
     : NSObject <NSApplicationDelegate, NSOutlineViewDataSource,
                 NSOutlineViewDelegate, PdfViewDelegate, NSSplitViewDelegate,
@@ -1605,7 +2437,9 @@ static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
 @property(nonatomic, strong) NSOutlineView *outline;
 @property(nonatomic, strong) NSScrollView *outlineScroll;
 @property(nonatomic, strong) PdfView *view;
-@property(nonatomic, strong) TocNode *tocRoot;
+@property(nonatomic, strong) TocModel *toc;
+@property(nonatomic, assign) BOOL tocSyncing; // 正在按当前页程序化选中书签
+@property(nonatomic, strong) NSSearchField *tocFilterField;
 @property(nonatomic, strong) NSMutableArray<NSString *> *recentPaths;
 @property(nonatomic, strong) NSMenu *recentMenu;
 @property(nonatomic, strong) NSMenuItem *recentMenuItem;
@@ -1649,12 +2483,25 @@ static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
 @property(nonatomic, strong) NSTextField *findTextField;   // 查找输入框
 @property(nonatomic, strong) NSString *lastSearchTerm;     // 上次查找的内容
 @property(nonatomic, assign) NSInteger currentSearchIndex; // 当前查找结果索引
+// 文档文本查找（高亮全部匹配）
+@property(nonatomic, strong) NSPanel *pageFindPanel;
+@property(nonatomic, strong) NSSearchField *pageFindField;
+@property(nonatomic, strong) NSButton *pageFindCaseButton;
+@property(nonatomic, strong) NSTextField *pageFindCountLabel;
 @end
 
 // 为在主实现中调用分类方法提供前置声明（命名分类，避免"primary
 // class"重复实现告警）
 @interface AppDelegate (ForwardDecls)
 - (void)loadSettingsJSON;
+- (IBAction)exportDocumentAnalysis:(id)sender;
+- (IBAction)exportImageList:(id)sender;
+- (IBAction)showPageFindPanel:(id)sender;
+- (IBAction)exportAllImages:(id)sender;
+- (IBAction)exportAllText:(id)sender;
+- (IBAction)exportTrace:(id)sender;
+- (IBAction)toggleSessionRecording:(id)sender;
+- (IBAction)toggleRenderCostHeatmap:(id)sender;
 - (void)extractRecentFromSettings;
 - (void)rebuildRecentMenu;
 - (void)persistRecentIntoSettings;
@@ -1670,11 +2517,8 @@ static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
 - (void)expandAllBookmarks:(id)sender;
 - (void)collapseAllBookmarks:(id)sender;
 - (void)highlightCurrentBookmark;
-- (TocNode *)findBookmarkForPage:(int)pageIndex inNode:(TocNode *)node;
 - (void)expandParentsOfItem:(TocNode *)item;
-- (BOOL)findParentPathForItem:(TocNode *)targetItem
-                       inNode:(TocNode *)currentNode
-                   parentPath:(NSMutableArray *)path;
+- (void)tocFilterChanged:(id)sender;
 - (void)createExpandedBookmarkControls;
 - (void)removeExpandedBookmarkControls;
 - (void)updateBookmarkScrollView;
@@ -1696,10 +2540,13 @@ static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
 
 @implementation AppDelegate
 - (void)applicationDidFinishLaunching:(NSNotification *)notification {
-// 启动清空文件日志
-#if PDFWV_ENABLE_LOGGING
-  MacLog_ResetFileOnStartup();
-#endif
+  // 启动异步日志（清空文件日志；[DBG] 文件日志不受 PDFWV_ENABLE_LOGGING 影响）
+  MacLog_StartOnLaunch();
+  PDFWV_TRACE_THREAD_NAME("main");
+  // 图片缓存按 XObject 对象号去重（多页共享同一图片只解码一次）；
+  // 内联图像按流字节加解码参数哈希
+  PdfImageCache_SetObjectNumberFn(PdfiumEx_GetImageObjectNumber);
+  PdfImageCache_SetParamsHashFn(PdfiumEx_GetImageParamsHash);
   NSRect rect = NSMakeRect(200, 200, 1200, 800);
   self.window = [[NSWindow alloc]
       initWithContentRect:rect
@@ -1770,7 +2617,8 @@ static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
       kBookmarkExpandedWidth - kScrollBarWidth; // 为滚动条预留空间
   NSRect outlineFrame =
       NSMakeRect(0, 0, outlineWidth,
-                 self.leftPanel.bounds.size.height - kControlBarHeight);
+                 self.leftPanel.bounds.size.height - kControlBarHeight -
+                     kTocFilterHeight);
   NSLog(@"[ScrollDebug] outline宽度: %.1f (预留滚动条空间: %.1f)", outlineWidth,
         kScrollBarWidth);
 
@@ -1797,7 +2645,8 @@ static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
   // 滚动视图应该占据整个展开宽度，为滚动条提供空间
   NSRect scrollFrame =
       NSMakeRect(0, 0, kBookmarkExpandedWidth,
-                 self.leftPanel.bounds.size.height - kControlBarHeight);
+                 self.leftPanel.bounds.size.height - kControlBarHeight -
+                     kTocFilterHeight);
   NSLog(@"[ScrollDebug] scrollFrame: %@", NSStringFromRect(scrollFrame));
 
   self.outlineScroll = [[NSScrollView alloc] initWithFrame:scrollFrame];
@@ -1858,6 +2707,21 @@ static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
   [self.leftPanel addSubview:self.outlineScroll];
   NSLog(@"[ScrollDebug] 滚动视图已添加到左侧面板");
 
+  // 书签筛选框：位于控制栏与书签列表之间，随输入即时筛选
+  self.tocFilterField = [[NSSearchField alloc]
+      initWithFrame:NSMakeRect(4,
+                               self.leftPanel.bounds.size.height -
+                                   kControlBarHeight - kTocFilterHeight + 3,
+                               kBookmarkExpandedWidth - 8, 22)];
+  self.tocFilterField.placeholderString = @"筛选书签";
+  self.tocFilterField.controlSize = NSControlSizeSmall;
+  self.tocFilterField.font = [NSFont systemFontOfSize:12];
+  self.tocFilterField.sendsSearchStringImmediately = YES;
+  self.tocFilterField.target = self;
+  self.tocFilterField.action = @selector(tocFilterChanged:);
+  self.tocFilterField.autoresizingMask = NSViewWidthSizable | NSViewMinYMargin;
+  [self.leftPanel addSubview:self.tocFilterField];
+
   // 检查视图层次结构
   NSLog(@"[ScrollDebug] leftPanel frame: %@",
         NSStringFromRect(self.leftPanel.frame));
@@ -1974,6 +2838,36 @@ static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
   exportItem.target = self;
   exportItem.tag = 9901; // 用于后续查找
   [exportItem setEnabled:NO];
+  NSMenuItem *analyzeItem =
+      [fileMenu addItemWithTitle:@"导出文档分析报告 (JSON)…"
+                          action:@selector(exportDocumentAnalysis:)
+                   keyEquivalent:@""];
+  analyzeItem.target = self;
+  NSMenuItem *imagesItem =
+      [fileMenu addItemWithTitle:@"导出全部图片…"
+                          action:@selector(exportAllImages:)
+                   keyEquivalent:@""];
+  imagesItem.target = self;
+  NSMenuItem *imageListItem =
+      [fileMenu addItemWithTitle:@"导出图片清单 (CSV)…"
+                          action:@selector(exportImageList:)
+                   keyEquivalent:@""];
+  imageListItem.target = self;
+  NSMenuItem *textItem =
+      [fileMenu addItemWithTitle:@"导出全部文本…"
+                          action:@selector(exportAllText:)
+                   keyEquivalent:@""];
+  textItem.target = self;
+  NSMenuItem *traceItem =
+      [fileMenu addItemWithTitle:@"导出性能跟踪 (Chrome Trace JSON)…"
+                          action:@selector(exportTrace:)
+                   keyEquivalent:@""];
+  traceItem.target = self;
+  NSMenuItem *sessionItem =
+      [fileMenu addItemWithTitle:@"录制交互会话…"
+                          action:@selector(toggleSessionRecording:)
+                   keyEquivalent:@""];
+  sessionItem.target = self;
   [fileMenu addItem:[NSMenuItem separatorItem]];
   // 最近浏览子菜单
   self.recentMenuItem = [[NSMenuItem alloc] initWithTitle:@"最近浏览"
@@ -2004,6 +2898,13 @@ static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
   [editMenu addItemWithTitle:@"复制"
                       action:@selector(copy:)
                keyEquivalent:@"c"];
+  NSMenuItem *pageFindItem =
+      [editMenu addItemWithTitle:@"在文档中查找…"
+                          action:@selector(showPageFindPanel:)
+                   keyEquivalent:@"f"];
+  pageFindItem.keyEquivalentModifierMask =
+      NSEventModifierFlagCommand | NSEventModifierFlagShift;
+  pageFindItem.target = self;
   [editItem setSubmenu:editMenu];
   [mainMenu addItem:editItem];
 
@@ -2052,6 +2953,11 @@ static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
                                      keyEquivalent:@"l"];
   logItem.keyEquivalentModifierMask = NSEventModifierFlagCommand;
   logItem.target = self;
+  NSMenuItem *costItem =
+      [viewMenu addItemWithTitle:@"渲染耗时热力图"
+                          action:@selector(toggleRenderCostHeatmap:)
+                   keyEquivalent:@""];
+  costItem.target = self;
   [viewItem setSubmenu:viewMenu];
   [mainMenu addItem:viewItem];
 
@@ -2099,7 +3005,14 @@ static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
 
 - (NSApplicationTerminateReply)applicationShouldTerminate:
     (NSApplication *)sender {
+  Session_Stop();
   FPDF_DestroyLibrary();
+  // 退出时导出指标（与 debug.log 同目录）
+  NSString *metricsPath = [[MacLog_FilePath() stringByDeletingLastPathComponent]
+      stringByAppendingPathComponent:@"metrics.json"];
+  Metrics_DumpJson(metricsPath.UTF8String);
+  // 写完队列中剩余的日志再退出
+  AsyncLog_Stop();
   return NSTerminateNow;
 }
 
@@ -2284,6 +3197,85 @@ static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
   NSLog(@"[Find] 在检查器中未找到文本: %@", searchTerm);
 }
 
+#pragma mark - Document Text Find
+
+// 文档文本查找面板：输入即高亮当前页全部匹配，回车跳到下一处（Shift+回车上一处）
+- (IBAction)showPageFindPanel:(id)sender {
+  if (!self.pageFindPanel) {
+    self.pageFindPanel =
+        [[NSPanel alloc] initWithContentRect:NSMakeRect(0, 0, 360, 80)
+                                   styleMask:(NSWindowStyleMaskTitled |
+                                              NSWindowStyleMaskClosable)
+                                     backing:NSBackingStoreBuffered
+                                       defer:NO];
+    self.pageFindPanel.title = @"在文档中查找";
+    self.pageFindPanel.level = NSFloatingWindowLevel;
+    self.pageFindPanel.releasedWhenClosed = NO;
+    [[NSNotificationCenter defaultCenter]
+        addObserver:self
+           selector:@selector(pageFindPanelWillClose:)
+               name:NSWindowWillCloseNotification
+             object:self.pageFindPanel];
+
+    self.pageFindField =
+        [[NSSearchField alloc] initWithFrame:NSMakeRect(20, 42, 230, 25)];
+    self.pageFindField.placeholderString = @"查找文本";
+    self.pageFindField.sendsSearchStringImmediately = YES;
+    self.pageFindField.target = self;
+    self.pageFindField.action = @selector(pageFindQueryChanged:);
+
+    NSButton *next = [NSButton buttonWithTitle:@"下一处"
+                                        target:self
+                                        action:@selector(pageFindNext:)];
+    next.frame = NSMakeRect(260, 40, 80, 28);
+    next.keyEquivalent = @"\r";
+    NSButton *prev = [NSButton buttonWithTitle:@"上一处"
+                                        target:self
+                                        action:@selector(pageFindPrevious:)];
+    prev.frame = NSMakeRect(260, 10, 80, 28);
+    prev.keyEquivalent = @"\r";
+    prev.keyEquivalentModifierMask = NSEventModifierFlagShift;
+
+    self.pageFindCaseButton =
+        [NSButton checkboxWithTitle:@"区分大小写"
+                             target:self
+                             action:@selector(pageFindQueryChanged:)];
+    self.pageFindCaseButton.frame = NSMakeRect(18, 12, 110, 22);
+    self.pageFindCountLabel = [NSTextField labelWithString:@""];
+    self.pageFindCountLabel.frame = NSMakeRect(130, 14, 120, 18);
+
+    for (NSView *v in @[ self.pageFindField, next, prev, self.pageFindCaseButton,
+                         self.pageFindCountLabel ])
+      [self.pageFindPanel.contentView addSubview:v];
+    [self.pageFindPanel center];
+  }
+  [self.pageFindPanel makeKeyAndOrderFront:nil];
+  [self.pageFindPanel makeFirstResponder:self.pageFindField];
+}
+
+- (void)pageFindQueryChanged:(id)sender {
+  [self.view setSearchQuery:self.pageFindField.stringValue
+                  matchCase:self.pageFindCaseButton.state == NSControlStateValueOn];
+  self.pageFindCountLabel.stringValue = [self.view searchCountText];
+}
+
+- (void)pageFindNext:(id)sender {
+  if (![self.view findNextMatchBackward:NO])
+    NSBeep();
+  self.pageFindCountLabel.stringValue = [self.view searchCountText];
+}
+
+- (void)pageFindPrevious:(id)sender {
+  if (![self.view findNextMatchBackward:YES])
+    NSBeep();
+  self.pageFindCountLabel.stringValue = [self.view searchCountText];
+}
+
+// 关闭面板即结束查找：清除高亮
+- (void)pageFindPanelWillClose:(NSNotification *)note {
+  [self.view setSearchQuery:@"" matchCase:NO];
+}
+
 // 为对象引用着色的辅助方法
 - (NSMutableAttributedString *)colorizeObjectReferences:(NSString *)text
                                             normalAttrs:
@@ -2324,6 +3316,11 @@ static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
   return result;
 }
 
+// 渲染耗时分析完成，刷新排行窗口
+- (void)pdfViewDidUpdateRenderCost:(id)sender {
+  [_gRenderCostCtrl reloadFromView];
+}
+
 // PDF视图对象点击处理
 - (void)pdfViewDidClickObject:(NSValue *)objectValue atIndex:(NSNumber *)index {
   NSLog(@"[Inspector] PDF视图点击了对象，索引: %@", index);
@@ -2331,12 +3328,27 @@ static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
   // 从NSValue中提取FPDF_PAGEOBJECT
   FPDF_PAGEOBJECT object = (FPDF_PAGEOBJECT)[objectValue pointerValue];
 
-  // 这里我们需要将FPDF_PAGEOBJECT映射到实际的PDF对象号
-  // 由于这比较复杂，我们先简单地刷新检查器内容，然后尝试跳转到相关对象
+  // 页面索引已在 detectObjectAtPoint: 中建立，这里直接 O(1) 查询对象号
+  uint32_t objNum = PdfiumEx_GetPageObjectNumber(object);
   [self updateInspectorContent];
 
-  // TODO: 实现更精确的对象映射和跳转
-  NSLog(@"[Inspector] 已刷新检查器内容以响应PDF对象点击");
+  if (objNum == 0) {
+    NSLog(@"[Inspector] 对象未映射到间接对象（内联对象）");
+    return;
+  }
+  // 检查器文本在主队列异步刷新，排在其后再跳转
+  dispatch_async(dispatch_get_main_queue(), ^{
+    NSNumber *position = self.objectPositions[[NSString
+        stringWithFormat:@"%u", objNum]];
+    if (!position) {
+      NSLog(@"[Inspector] 对象 %u 不在当前对象树中", objNum);
+      return;
+    }
+    NSUInteger targetPos = [position unsignedIntegerValue];
+    [self.inspectorTextView scrollRangeToVisible:NSMakeRange(targetPos, 0)];
+    [self.inspectorTextView setSelectedRange:NSMakeRange(targetPos, 20)];
+    NSLog(@"[Inspector] 已跳转到对象 %u", objNum);
+  });
 }
 
 @end
@@ -2348,21 +3360,56 @@ static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
 - (void)rebuildToc {
   FPDF_DOCUMENT doc = [self.view document];
   if (!doc) {
-    self.tocRoot = nil;
+    self.toc = nil;
     [self.outline reloadData];
     return;
   }
-  self.tocRoot = BuildBookmarksTree(doc);
+  PDFWV_TRACE_SCOPE("ui", "outline_build");
+  self.toc = [[TocModel alloc] initWithDocument:doc];
   [self.outline reloadData];
   // 默认折叠所有顶层书签
   [self.outline collapseItem:nil collapseChildren:YES];
   NSLog(@"[BookmarkControl] 书签重建完成，默认折叠所有顶层书签");
+  // 换文档后沿用筛选框中的筛选词
+  if (self.tocFilterField.stringValue.length)
+    [self tocFilterChanged:self.tocFilterField];
 
   // 确保滚动条正确更新
   [self updateBookmarkScrollView];
   [self ensureBookmarkScrollBarVisible];
 }
 
+// 筛选书签：按父节点增量插入/移除行，不重建整棵树；筛选时展开命中条目的祖先
+- (void)tocFilterChanged:(id)sender {
+  if (!self.toc)
+    return;
+  NSOutlineView *ov = self.outline;
+  NSMutableArray<TocNode *> *reload = [NSMutableArray array];
+  self.tocSyncing = YES;
+  [ov beginUpdates];
+  [self.toc setFilter:self.tocFilterField.stringValue ?: @""
+      isExpanded:^BOOL(TocNode *node) {
+        return [ov isItemExpanded:node];
+      }
+      update:^(TocNode *parent, NSIndexSet *removed, NSIndexSet *inserted) {
+        if (removed.count)
+          [ov removeItemsAtIndexes:removed
+                          inParent:parent
+                     withAnimation:NSTableViewAnimationEffectNone];
+        if (inserted.count)
+          [ov insertItemsAtIndexes:inserted
+                          inParent:parent
+                     withAnimation:NSTableViewAnimationEffectNone];
+      }
+      reload:reload];
+  [ov endUpdates];
+  for (TocNode *node in reload)
+    [ov reloadItem:node];
+  for (TocNode *node in [self.toc filterAncestors])
+    [ov expandItem:node];
+  self.tocSyncing = NO;
+}
+
 - (void)updateBookmarkScrollView {
   NSLog(@"[ScrollDebug] ========== updateBookmarkScrollView 开始 ==========");
 
@@ -2699,7 +3746,8 @@ static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
   if (self.bookmarkVisible && self.outlineScroll) {
     NSRect expectedScrollFrame =
         NSMakeRect(0, 0, kBookmarkExpandedWidth,
-                   self.leftPanel.bounds.size.height - kControlBarHeight);
+                   self.leftPanel.bounds.size.height - kControlBarHeight -
+                       kTocFilterHeight);
     NSRect currentScrollFrame = self.outlineScroll.frame;
 
     NSLog(@"[ScrollDebug] 滚动视图当前frame: %@",
@@ -2817,20 +3865,15 @@ static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
 // DataSource
 - (NSInteger)outlineView:(NSOutlineView *)outlineView
     numberOfChildrenOfItem:(id)item {
-  TocNode *n = item ?: self.tocRoot;
-  return n ? (NSInteger)n.children.count : 0;
+  return [self.toc childCountOf:(TocNode *)item];
 }
 - (id)outlineView:(NSOutlineView *)outlineView
             child:(NSInteger)index
            ofItem:(id)item {
-  TocNode *n = item ?: self.tocRoot;
-  return (index >= 0 && index < (NSInteger)n.children.count)
-             ? n.children[(NSUInteger)index]
-             : nil;
+  return [self.toc child:index of:(TocNode *)item];
 }
 - (BOOL)outlineView:(NSOutlineView *)outlineView isItemExpandable:(id)item {
-  TocNode *n = (TocNode *)item;
-  return n.children.count > 0;
+  return item && [self.toc childCountOf:(TocNode *)item] > 0;
 }
 - (NSView *)outlineView:(NSOutlineView *)outlineView
      viewForTableColumn:(NSTableColumn *)tableColumn
@@ -2850,8 +3893,7 @@ static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
     cell.textField = text;
     [cell addSubview:text];
   }
-  TocNode *n = (TocNode *)item;
-  cell.textField.stringValue = n.title ?: @"";
+  cell.textField.stringValue = [self.toc titleOf:(TocNode *)item] ?: @"";
   return cell;
 }
 
@@ -2864,9 +3906,13 @@ static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
   if (row < 0)
     return;
   id item = [self.outline itemAtRow:row];
+  // 高亮当前书签时的程序化选中不跳页，否则会跳回书签起始页
+  if (self.tocSyncing)
+    return;
   TocNode *n = (TocNode *)item;
-  if (n.pageIndex >= 0) {
-    [self.view goToPage:n.pageIndex];
+  const int page = [self.toc pageOf:n];
+  if (page >= 0) {
+    [self.view goToPage:page];
   }
 }
 
@@ -2968,6 +4014,15 @@ static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
           enable ? @"YES" : @"NO");
     return enable;
   }
+  if (menuItem.action == @selector(exportDocumentAnalysis:) ||
+      menuItem.action == @selector(exportAllImages:) ||
+      menuItem.action == @selector(exportAllText:)) {
+    return [self.view document] != nullptr;
+  }
+  if (menuItem.action == @selector(exportImageList:)) {
+    return [self.view document] != nullptr &&
+           PdfImageCatalog_Status().complete;
+  }
   return YES;
 }
 
@@ -2996,6 +4051,327 @@ static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
   }
 }
 
+- (IBAction)exportDocumentAnalysis:(id)sender {
+  FPDF_DOCUMENT doc = [self.view document];
+  if (!doc)
+    return;
+  NSSavePanel *panel = [NSSavePanel savePanel];
+  NSString *base = [self.window.title hasPrefix:@"PdfWinViewer - "]
+                       ? [[self.window.title substringFromIndex:15]
+                             stringByDeletingPathExtension]
+                       : @"document";
+  panel.nameFieldStringValue =
+      [base stringByAppendingString:@".analysis.json"];
+  if ([panel runModal] != NSModalResponseOK)
+    return;
+  // PDFium 非线程安全，与渲染共用同一文档，因此在主线程同步分析
+  CFAbsoluteTime t0 = CFAbsoluteTimeGetCurrent();
+  char *json = PdfiumEx_AnalyzeDocument(doc, 0);
+  if (!json) {
+    NSLog(@"[Analyze] 文档分析失败");
+    return;
+  }
+  const size_t jsonLen = strlen(json);
+  Metrics_MemoryAdd(MemCategory::PdfiumExString, (int64_t)jsonLen + 1);
+  NSData *data = [NSData dataWithBytes:json length:jsonLen];
+  free(json);
+  Metrics_MemoryAdd(MemCategory::PdfiumExString, -((int64_t)jsonLen + 1));
+  NSError *err = nil;
+  if (![data writeToURL:panel.URL options:NSDataWritingAtomic error:&err]) {
+    NSAlert *alert = [NSAlert alertWithError:err];
+    [alert runModal];
+    return;
+  }
+  NSLog(@"[Analyze] 已导出分析报告 %@ (%lu 字节, %.1f ms)", panel.URL.path,
+        (unsigned long)data.length,
+        (CFAbsoluteTimeGetCurrent() - t0) * 1000.0);
+}
+
+// 导出文档中的全部图片：PDFium 在主线程用独立的文档实例解码，编码与写盘在工作线程；
+// 进度面板运行模态会话，保持界面响应并可取消
+- (IBAction)exportAllImages:(id)sender {
+  NSString *docPath = [self.recentPaths firstObject];
+  if (![self.view document] || !docPath)
+    return;
+  NSOpenPanel *openPanel = [NSOpenPanel openPanel];
+  openPanel.canChooseFiles = NO;
+  openPanel.canChooseDirectories = YES;
+  openPanel.canCreateDirectories = YES;
+  openPanel.prompt = @"导出";
+  if ([openPanel runModal] != NSModalResponseOK)
+    return;
+  NSString *dir = openPanel.URL.path;
+
+  NSPanel *panel =
+      [[NSPanel alloc] initWithContentRect:NSMakeRect(0, 0, 440, 110)
+                                 styleMask:NSWindowStyleMaskTitled
+                                   backing:NSBackingStoreBuffered
+                                     defer:NO];
+  panel.title = @"导出全部图片";
+  NSTextField *label = [NSTextField labelWithString:@"正在打开文档…"];
+  label.frame = NSMakeRect(16, 74, 408, 20);
+  [panel.contentView addSubview:label];
+  NSProgressIndicator *bar =
+      [[NSProgressIndicator alloc] initWithFrame:NSMakeRect(16, 50, 408, 16)];
+  bar.indeterminate = NO;
+  bar.minValue = 0.0;
+  bar.maxValue = 1.0;
+  [panel.contentView addSubview:bar];
+  NSButton *cancelButton = [NSButton buttonWithTitle:@"取消"
+                                              target:NSApp
+                                              action:@selector(stopModal)];
+  cancelButton.frame = NSMakeRect(344, 10, 80, 30);
+  [panel.contentView addSubview:cancelButton];
+  [panel center];
+  NSModalSession session = [NSApp beginModalSessionForWindow:panel];
+
+  ImageExtractOptions options;
+  options.outDir = dir.UTF8String;
+  options.objectNumber = PdfiumEx_GetImageObjectNumber;
+  options.paramsHash = PdfiumEx_GetImageParamsHash;
+  options.paramsPlain = PdfiumEx_IsImageParamsPlain;
+  auto encode = [](const std::string &path, const uint8_t *bgra, int width,
+                   int height, int stride) -> uint64_t {
+    @autoreleasepool {
+      CGColorSpaceRef cs = CGColorSpaceCreateDeviceRGB();
+      CGDataProviderRef dp = CGDataProviderCreateWithData(
+          NULL, bgra, (size_t)stride * height, NULL);
+      CGImageRef img = CGImageCreate(
+          width, height, 8, 32, stride, cs,
+          (CGBitmapInfo)((uint32_t)kCGBitmapByteOrder32Little |
+                         (uint32_t)kCGImageAlphaFirst),
+          dp, NULL, false, kCGRenderingIntentDefault);
+      NSURL *url = [NSURL fileURLWithPath:@(path.c_str())];
+      CGImageDestinationRef dst = CGImageDestinationCreateWithURL(
+          (__bridge CFURLRef)url, (__bridge CFStringRef)UTTypePNG.identifier,
+          1, NULL);
+      bool ok = false;
+      if (dst && img) {
+        CGImageDestinationAddImage(dst, img, NULL);
+        ok = CGImageDestinationFinalize(dst);
+      }
+      if (dst)
+        CFRelease(dst);
+      if (img)
+        CGImageRelease(img);
+      CGDataProviderRelease(dp);
+      CGColorSpaceRelease(cs);
+      if (!ok)
+        return 0;
+      NSDictionary *attrs =
+          [[NSFileManager defaultManager] attributesOfItemAtPath:url.path
+                                                           error:nil];
+      return attrs ? (uint64_t)attrs.fileSize : 0;
+    }
+  };
+  bool cancelled = false;
+  auto progress = [&](const ImageExtractProgress &p) {
+    bar.doubleValue =
+        p.pageCount > 0 ? (double)p.pagesDone / p.pageCount : 1.0;
+    label.stringValue = [NSString
+        stringWithFormat:@"%d/%d 页 · %d 张 · %.1f 张/秒 · %.1f MB/s",
+                         p.pagesDone, p.pageCount, p.imagesWritten,
+                         p.ImagesPerSecond(), p.MegabytesPerSecond()];
+    if ([NSApp runModalSession:session] != NSModalResponseContinue)
+      cancelled = true;
+    return !cancelled;
+  };
+  ImageExtractProgress result;
+  std::string error;
+  bool ok = PdfExtractAllImages(docPath.UTF8String, options, encode, progress,
+                                result, error);
+  [NSApp endModalSession:session];
+  [panel orderOut:nil];
+
+  NSLog(@"[ExtractImages] %d 张（原样 %d）重复 %d 失败 %d，%.1f MB，%.0f ms，%.1f "
+        @"张/秒%@",
+        result.imagesWritten, result.passthrough, result.duplicates,
+        result.failed, result.bytesWritten / 1048576.0, result.elapsedMs,
+        result.ImagesPerSecond(), result.cancelled ? @"（已取消）" : @"");
+  NSAlert *alert = [NSAlert new];
+  alert.messageText = !ok               ? @"无法打开文档"
+                      : result.cancelled ? @"导出已取消"
+                                         : @"导出完成";
+  alert.informativeText =
+      !ok ? @(error.c_str())
+          : [NSString
+                stringWithFormat:
+                    @"导出 %d 张图片（%d 张原样写出 JPEG/JPEG 2000），跳过重复 %d "
+                    @"张，失败 %d 张\n%.1f MB，用时 %.1f 秒，%.1f 张/秒\n%@",
+                    result.imagesWritten, result.passthrough,
+                    result.duplicates, result.failed,
+                    result.bytesWritten / 1048576.0, result.elapsedMs / 1000.0,
+                    result.ImagesPerSecond(), dir];
+  [alert runModal];
+}
+
+// 图片清单来自后台建立的图片目录（image_catalog），无需逐页加载
+- (IBAction)exportImageList:(id)sender {
+  if (![self.view document] || !PdfImageCatalog_Status().complete)
+    return;
+  NSSavePanel *panel = [NSSavePanel savePanel];
+  panel.nameFieldStringValue = @"images.csv";
+  if ([panel runModal] != NSModalResponseOK)
+    return;
+  if (!PdfImageCatalog_WriteCsv(panel.URL.path.UTF8String)) {
+    NSLog(@"[ImageCatalog] 导出失败: %@", panel.URL.path);
+    NSBeep();
+  }
+}
+
+// 导出全文文本：PDFium 在主线程用独立的文档实例逐页取文本，行拼接与 UTF-8
+// 编码在工作线程，按页序流式写入文件；可选每行附带包围盒（TSV）
+- (IBAction)exportAllText:(id)sender {
+  NSString *docPath = [self.recentPaths firstObject];
+  if (![self.view document] || !docPath)
+    return;
+  NSSavePanel *savePanel = [NSSavePanel savePanel];
+  savePanel.nameFieldStringValue = [[docPath.lastPathComponent
+      stringByDeletingPathExtension] stringByAppendingPathExtension:@"txt"];
+  NSButton *boxesCheck =
+      [NSButton checkboxWithTitle:@"每行附带包围盒（页、左、下、右、上、文本，TSV）"
+                           target:nil
+                           action:nil];
+  [boxesCheck sizeToFit];
+  savePanel.accessoryView = boxesCheck;
+  if ([savePanel runModal] != NSModalResponseOK)
+    return;
+  NSString *path = savePanel.URL.path;
+  FILE *out = fopen(path.fileSystemRepresentation, "wb");
+  if (!out) {
+    NSLog(@"[ExportText] 无法写入: %@", path);
+    NSBeep();
+    return;
+  }
+
+  NSPanel *panel =
+      [[NSPanel alloc] initWithContentRect:NSMakeRect(0, 0, 440, 110)
+                                 styleMask:NSWindowStyleMaskTitled
+                                   backing:NSBackingStoreBuffered
+                                     defer:NO];
+  panel.title = @"导出全部文本";
+  NSTextField *label = [NSTextField labelWithString:@"正在打开文档…"];
+  label.frame = NSMakeRect(16, 74, 408, 20);
+  [panel.contentView addSubview:label];
+  NSProgressIndicator *bar =
+      [[NSProgressIndicator alloc] initWithFrame:NSMakeRect(16, 50, 408, 16)];
+  bar.indeterminate = NO;
+  bar.minValue = 0.0;
+  bar.maxValue = 1.0;
+  [panel.contentView addSubview:bar];
+  NSButton *cancelButton = [NSButton buttonWithTitle:@"取消"
+                                              target:NSApp
+                                              action:@selector(stopModal)];
+  cancelButton.frame = NSMakeRect(344, 10, 80, 30);
+  [panel.contentView addSubview:cancelButton];
+  [panel center];
+  NSModalSession session = [NSApp beginModalSessionForWindow:panel];
+
+  TextExportOptions options;
+  options.lineBoxes = boxesCheck.state == NSControlStateValueOn;
+  auto write = [out](const char *data, size_t size) {
+    return fwrite(data, 1, size, out) == size;
+  };
+  bool cancelled = false;
+  auto progress = [&](const TextExportProgress &p) {
+    bar.doubleValue =
+        p.pageCount > 0 ? (double)p.pagesRead / p.pageCount : 1.0;
+    label.stringValue =
+        [NSString stringWithFormat:@"%d/%d 页 · %.1f 页/秒 · %.1f MB/s",
+                                   p.pagesRead, p.pageCount,
+                                   p.PagesPerSecond(), p.MegabytesPerSecond()];
+    if ([NSApp runModalSession:session] != NSModalResponseContinue)
+      cancelled = true;
+    return !cancelled;
+  };
+  TextExportProgress result;
+  std::string error;
+  bool ok = PdfExportText(docPath.UTF8String, options, write, progress, result,
+                          error);
+  if (fclose(out) != 0 && ok) {
+    ok = false;
+    error = "writing the output failed";
+  }
+  [NSApp endModalSession:session];
+  [panel orderOut:nil];
+
+  NSLog(@"[ExportText] %d 页（无法读取 %d），%llu 字符，%.1f MB，%.0f ms，%.1f "
+        @"页/秒%@",
+        result.pagesWritten, result.failedPages,
+        (unsigned long long)result.chars, result.bytesWritten / 1048576.0,
+        result.elapsedMs, result.PagesPerSecond(),
+        result.cancelled ? @"（已取消）" : @"");
+  NSAlert *alert = [NSAlert new];
+  alert.messageText = !ok               ? @"导出失败"
+                      : result.cancelled ? @"导出已取消"
+                                         : @"导出完成";
+  alert.informativeText =
+      !ok ? @(error.c_str())
+          : [NSString
+                stringWithFormat:
+                    @"导出 %d 页文本%@，无法读取 %d 页\n%.1f MB，用时 %.1f "
+                    @"秒，%.1f 页/秒\n%@",
+                    result.pagesWritten,
+                    options.lineBoxes ? @"（含行包围盒）" : @"",
+                    result.failedPages, result.bytesWritten / 1048576.0,
+                    result.elapsedMs / 1000.0, result.PagesPerSecond(), path];
+  [alert runModal];
+}
+
+// 导出最近的跟踪区间，可在 chrome://tracing 或 ui.perfetto.dev 中打开
+- (IBAction)exportTrace:(id)sender {
+  NSSavePanel *panel = [NSSavePanel savePanel];
+  panel.nameFieldStringValue = @"pdfwv_trace.json";
+  if ([panel runModal] != NSModalResponseOK)
+    return;
+  if (!Trace_ExportChromeJson(panel.URL.path.UTF8String)) {
+    NSLog(@"[Trace] 导出失败: %@", panel.URL.path);
+    NSBeep();
+    return;
+  }
+  NSLog(@"[Trace] 已导出 %@", panel.URL.path);
+}
+
+// 录制交互会话（视口/选区/命中测试），用 pdfwv_replay 无界面回放
+- (IBAction)toggleSessionRecording:(id)sender {
+  NSMenuItem *item = [sender isKindOfClass:[NSMenuItem class]] ? sender : nil;
+  if (Session_IsRecording()) {
+    Session_Stop();
+    item.state = NSControlStateValueOff;
+    NSLog(@"[Session] 录制已停止");
+    return;
+  }
+  NSSavePanel *panel = [NSSavePanel savePanel];
+  panel.nameFieldStringValue = @"pdfwv_session.ndjson";
+  if ([panel runModal] != NSModalResponseOK)
+    return;
+  NSString *docPath = [self.recentPaths firstObject];
+  if (!Session_Start(panel.URL.path.UTF8String,
+                     [self.view document] ? docPath.UTF8String : nullptr)) {
+    NSLog(@"[Session] 无法开始录制: %@", panel.URL.path);
+    NSBeep();
+    return;
+  }
+  item.state = NSControlStateValueOn;
+  [self.view recordSessionViewport:"start"];
+  NSLog(@"[Session] 开始录制 %@", panel.URL.path);
+}
+
+// 渲染耗时热力图：当前页分块计时叠加 + 最慢对象排行窗口
+- (IBAction)toggleRenderCostHeatmap:(id)sender {
+  NSMenuItem *item = [sender isKindOfClass:[NSMenuItem class]] ? sender : nil;
+  if (_gRenderCostCtrl) {
+    [_gRenderCostCtrl close]; // windowWillClose 中关闭叠加层
+    return;
+  }
+  _gRenderCostCtrl =
+      [[_RenderCostWindowController alloc] initWithView:self.view];
+  _gRenderCostCtrl.menuItem = item;
+  item.state = NSControlStateValueOn;
+  [self.view setRenderCostHeatmap:YES];
+  [_gRenderCostCtrl showWindow:nil];
+}
+
 - (IBAction)openLogWindow:(id)sender {
   // 日志记录默认已启用，这里只是显示窗口
   Log_ShowWindow();
@@ -3446,51 +4822,9 @@ static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
       });
 }
 
-- (TocNode *)findBookmarkForPage:(int)pageIndex inNode:(TocNode *)node {
-  if (!node)
-    return nil;
-
-  NSLog(@"[BookmarkSearch] 搜索页面 %d，检查节点: %@ (页面: %d)", pageIndex,
-        node.title, node.pageIndex);
-
-  // 检查当前节点是否精确匹配
-  if (node.pageIndex == pageIndex) {
-    NSLog(@"[BookmarkSearch] 找到精确匹配: %@", node.title);
-    return node;
-  }
-
-  // 查找最接近的书签（页面索引小于等于当前页面的最大值）
-  TocNode *bestMatch = nil;
-  if (node.pageIndex >= 0 && node.pageIndex <= pageIndex) {
-    bestMatch = node;
-    NSLog(@"[BookmarkSearch] 当前最佳匹配: %@ (页面: %d)", bestMatch.title,
-          bestMatch.pageIndex);
-  }
-
-  // 递归搜索子节点
-  for (TocNode *child in node.children) {
-    TocNode *childMatch = [self findBookmarkForPage:pageIndex inNode:child];
-    if (childMatch) {
-      // 如果找到精确匹配，直接返回
-      if (childMatch.pageIndex == pageIndex) {
-        NSLog(@"[BookmarkSearch] 子节点中找到精确匹配: %@", childMatch.title);
-        return childMatch;
-      }
-      // 否则选择页面索引更接近的那个
-      if (!bestMatch || childMatch.pageIndex > bestMatch.pageIndex) {
-        bestMatch = childMatch;
-        NSLog(@"[BookmarkSearch] 更新最佳匹配: %@ (页面: %d)", bestMatch.title,
-              bestMatch.pageIndex);
-      }
-    }
-  }
-
-  return bestMatch;
-}
-
 - (void)highlightCurrentBookmark {
-  if (!self.tocRoot || !self.view) {
-    NSLog(@"[BookmarkHighlight] tocRoot或view为空，跳过高亮");
+  if (!self.toc || !self.view) {
+    NSLog(@"[BookmarkHighlight] toc或view为空，跳过高亮");
     return;
   }
 
@@ -3498,11 +4832,11 @@ static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
   NSLog(@"[BookmarkHighlight] 当前页面: %d", currentPage);
 
   // 查找对应的书签
-  TocNode *targetBookmark = [self findBookmarkForPage:currentPage
-                                               inNode:self.tocRoot];
+  // 页区间索引二分查找
+  TocNode *targetBookmark = [self.toc nodeForPage:currentPage];
   if (targetBookmark) {
     NSLog(@"[BookmarkHighlight] 找到匹配书签: %@ (页面 %d)",
-          targetBookmark.title, targetBookmark.pageIndex);
+          [self.toc titleOf:targetBookmark], [self.toc pageOf:targetBookmark]);
 
     // 确保书签的父节点都是展开的，这样才能看到目标书签
     [self expandParentsOfItem:targetBookmark];
@@ -3510,8 +4844,10 @@ static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
     // 在outline view中选中该书签
     NSInteger row = [self.outline rowForItem:targetBookmark];
     if (row >= 0) {
+      self.tocSyncing = YES;
       [self.outline selectRowIndexes:[NSIndexSet indexSetWithIndex:row]
                 byExtendingSelection:NO];
+      self.tocSyncing = NO;
 
       // 平滑滚动到选中的书签，确保其可见
       [NSAnimationContext
@@ -3533,53 +4869,25 @@ static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
   } else {
     NSLog(@"[BookmarkHighlight] 未找到匹配的书签");
     // 清除选择
+    self.tocSyncing = YES;
     [self.outline deselectAll:nil];
+    self.tocSyncing = NO;
   }
 }
 
 - (void)expandParentsOfItem:(TocNode *)item {
-  if (!item || !self.tocRoot)
+  if (!item || !self.toc)
     return;
 
-  // 查找item的父节点路径
-  NSMutableArray *parentPath = [NSMutableArray array];
-  [self findParentPathForItem:item inNode:self.tocRoot parentPath:parentPath];
-
-  // 展开所有父节点
+  // 自顶向下展开祖先节点，子节点对象在展开时才创建
+  NSMutableArray<TocNode *> *parentPath = [NSMutableArray array];
+  for (TocNode *p = [self.toc parentOf:item]; p; p = [self.toc parentOf:p])
+    [parentPath insertObject:p atIndex:0];
   for (TocNode *parent in parentPath) {
-    if (parent != self.tocRoot) { // 不展开根节点
-      [self.outline expandItem:parent];
-      NSLog(@"[BookmarkHighlight] 展开父节点: %@", parent.title);
-    }
+    [self.outline expandItem:parent];
   }
 }
 
-- (BOOL)findParentPathForItem:(TocNode *)targetItem
-                       inNode:(TocNode *)currentNode
-                   parentPath:(NSMutableArray *)path {
-  if (!currentNode)
-    return NO;
-
-  // 将当前节点加入路径
-  [path addObject:currentNode];
-
-  // 检查是否找到目标项
-  if (currentNode == targetItem) {
-    return YES;
-  }
-
-  // 在子节点中搜索
-  for (TocNode *child in currentNode.children) {
-    if ([self findParentPathForItem:targetItem inNode:child parentPath:path]) {
-      return YES;
-    }
-  }
-
-  // 如果在这个分支中没找到，从路径中移除当前节点
-  [path removeLastObject];
-  return NO;
-}
-
 - (void)createExpandedBookmarkControls {
   NSLog(@"[BookmarkControl] 创建展开状态的书签控件");
 
@@ -3684,6 +4992,7 @@ static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
         NSStringFromRect(self.leftPanel.bounds));
 
   self.outlineScroll.hidden = NO;
+  self.tocFilterField.hidden = NO;
 
   NSLog(@"[ScrollDebug] 显示后 outlineScroll hidden: %@",
         self.outlineScroll.hidden ? @"YES" : @"NO");
@@ -3721,6 +5030,7 @@ static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
 
   // 隐藏书签列表
   self.outlineScroll.hidden = YES;
+  self.tocFilterField.hidden = YES;
 }
 
 - (void)updateStatusBar {
@@ -3834,6 +5144,8 @@ static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
 
 - (void)pdfViewDidChangePage:(id)sender {
   NSLog(@"[StatusBar] pdfViewDidChangePage被调用");
+  if (self.pageFindPanel.visible)
+    self.pageFindCountLabel.stringValue = [self.view searchCountText];
   if (self.statusBar) {
     [self updateStatusBar];
   } else {
@@ -4050,6 +5362,22 @@ static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
                                                initWithString:objNumStr
                                                    attributes:objNumAttrs]];
   }
+  // 反向引用计数（引用图在打开文档后分片构建，完成前只显示进度，不同步构建）
+  FPDF_DOCUMENT doc = [self.view document];
+  if (doc) {
+    uint32_t done = 0, total = 0;
+    NSString *refStr;
+    if (PdfiumEx_BuildReferenceGraphStep(doc, 0, &done, &total) == 1) {
+      int referrers = PdfiumEx_GetObjectReferrers(doc, node->obj_num, nullptr);
+      refStr = [NSString stringWithFormat:@"  %% 被 %d 个对象引用", referrers];
+    } else {
+      refStr = [NSString
+          stringWithFormat:@"  %% 引用图构建中 %u/%u", done, total];
+    }
+    [attributedInfo appendAttributedString:[[NSAttributedString alloc]
+                                               initWithString:refStr
+                                                   attributes:normalAttrs]];
+  }
   [attributedInfo appendAttributedString:[[NSAttributedString alloc]
                                              initWithString:@"\n<<\n"
                                                  attributes:normalAttrs]];
@@ -4089,6 +5417,7 @@ static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
 - (void)updateInspectorContent {
   if (!self.inspectorVisible || !self.inspectorTextView || !self.view)
     return;
+  PDFWV_TRACE_SCOPE("ui", "inspector_build");
 
   FPDF_DOCUMENT doc = [self.view document];
   if (!doc) {
@@ -4156,6 +5485,7 @@ static TocNode *BuildBookmarksTree(FPDF_DOCUMENT doc) {
                     normalAttrs:normalAttrs
                     objNumAttrs:objNumAttrs];
 
+    SyncPdfiumExMemory();
     PdfiumEx_ReleaseObjectTree(object_tree);
   }
 
@@ -0,0 +1,436 @@
+#include "async_log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <cwchar>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+constexpr size_t kRingCapacity = 1u << 14;   // cells, power of two
+constexpr size_t kMaxBatch = 4096;           // records handed to the sink at once
+constexpr size_t kMaxTextCells = 16;         // longest text: 16 * 72 bytes
+constexpr size_t kMaxSites = 4096;
+constexpr size_t kSiteSlots = kMaxSites * 2; // open-addressing table
+constexpr auto kIdleWait = std::chrono::milliseconds(10);
+
+using Clock = std::chrono::steady_clock;
+
+const Clock::time_point& ProcessStart() {
+    static const Clock::time_point t = Clock::now();
+    return t;
+}
+
+// Bounded MPSC ring (Vyukov-style per-cell sequence numbers). Producers claim
+// one or more consecutive cells with a single CAS; the only consumer releases
+// cells strictly in order, so checking the last claimed cell is sufficient.
+struct alignas(64) Cell {
+    std::atomic<uint64_t> seq {0};
+    AsyncLogRecord rec;
+};
+
+class Ring {
+public:
+    Ring() : cells_(new Cell[kRingCapacity]) {
+        for (size_t i = 0; i < kRingCapacity; ++i) cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    // Claim 'n' consecutive cells; returns the first position or UINT64_MAX when full.
+    uint64_t Claim(size_t n) {
+        uint64_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        for (;;) {
+            const uint64_t lastPos = pos + n - 1;
+            const uint64_t seq = cells_[lastPos & kMask].seq.load(std::memory_order_acquire);
+            const int64_t dif = (int64_t)seq - (int64_t)lastPos;
+            if (dif == 0) {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed)) return pos;
+            } else if (dif < 0) {
+                return UINT64_MAX;
+            } else {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    AsyncLogRecord& Slot(uint64_t pos) { return cells_[pos & kMask].rec; }
+    void Publish(uint64_t pos) { cells_[pos & kMask].seq.store(pos + 1, std::memory_order_release); }
+
+    // Consumer side.
+    bool Ready(uint64_t pos) const { return cells_[pos & kMask].seq.load(std::memory_order_acquire) == pos + 1; }
+    void Release(uint64_t pos) { cells_[pos & kMask].seq.store(pos + kRingCapacity, std::memory_order_release); }
+
+    uint64_t EnqueuePos() const { return enqueuePos_.load(std::memory_order_acquire); }
+
+private:
+    static constexpr uint64_t kMask = kRingCapacity - 1;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(64) std::atomic<uint64_t> enqueuePos_ {0};
+};
+
+struct SiteTable {
+    std::mutex mutex;
+    std::atomic<uint64_t> keys[kSiteSlots] {};
+    uint16_t ids[kSiteSlots] {};
+    AsyncLogSite sites[kMaxSites];
+    std::atomic<uint32_t> count {1}; // id 0 = unknown
+};
+
+SiteTable& Sites() {
+    static SiteTable* t = new SiteTable(); // intentionally leaked: used until process exit
+    return *t;
+}
+
+struct Logger {
+    Ring ring;
+    std::atomic<bool> running {false};
+    std::atomic<uint64_t> dropped {0};
+    std::atomic<uint64_t> consumedPos {0};
+
+    std::mutex mutex;              // guards wake-ups only, never taken by producers
+    std::condition_variable wake;  // consumer idle wait / flush request
+    std::condition_variable drained;
+    bool stopRequested = false;
+    uint64_t flushTarget = 0;
+
+    std::thread worker;
+    FILE* file = nullptr;
+    AsyncLogSink sink;
+};
+
+Logger& Instance() {
+    static Logger* l = new Logger(); // intentionally leaked: producers may outlive static destruction
+    return *l;
+}
+
+uint64_t HashRemarks(const wchar_t* ws) {
+    uint64_t h = 1469598103934665603ull; // FNV-1a
+    if (ws) {
+        for (; *ws; ++ws) { h ^= (uint64_t)*ws; h *= 1099511628211ull; }
+    }
+    return h;
+}
+
+uint64_t SiteKey(const char* file, int line, const char* func, const wchar_t* remarks) {
+    uint64_t k = HashRemarks(remarks);
+    k ^= (uint64_t)(uintptr_t)file * 0x9E3779B97F4A7C15ull;
+    k ^= (uint64_t)(uintptr_t)func * 0xC2B2AE3D27D4EB4Full;
+    k ^= (uint64_t)(uint32_t)line * 0x165667B19E3779F9ull;
+    k ^= k >> 29;
+    return k ? k : 1; // 0 marks an empty slot
+}
+
+// Nudge the consumer each time another quarter of the ring fills up, so bursts
+// do not wait for the idle timeout. notify_one() without the mutex may be missed;
+// the timed wait covers that.
+void MaybeWake(Logger& lg, uint64_t pos, size_t n) {
+    if (((pos + n) & (kRingCapacity / 4 - 1)) < n) lg.wake.notify_one();
+}
+
+void FillHeader(AsyncLogRecord& r, uint8_t level, AsyncLogKind kind, uint8_t flags, uint16_t siteId) {
+    r.timestampNs = AsyncLog_NowNs();
+    r.threadId = AsyncLog_ThreadId();
+    r.siteId = siteId;
+    r.level = level;
+    r.kind = kind;
+    r.flags = flags;
+    r.textLen = 0;
+    r.contCount = 0;
+    r.reserved = 0;
+}
+
+// Drain up to kMaxBatch records. Returns the number of cells consumed.
+size_t DrainBatch(Logger& lg, uint64_t& pos, std::vector<AsyncLogEntry>& out) {
+    size_t cells = 0;
+    while (out.size() < kMaxBatch && lg.ring.Ready(pos)) {
+        AsyncLogEntry e;
+        e.record = lg.ring.Slot(pos);
+        e.text.assign(e.record.text, e.record.textLen);
+        const size_t cont = e.record.contCount;
+        lg.ring.Release(pos);
+        ++pos; ++cells;
+        for (size_t i = 0; i < cont; ++i) {
+            // The producer claimed these cells together; it is at most a few stores behind.
+            while (!lg.ring.Ready(pos)) std::this_thread::yield();
+            const AsyncLogRecord& c = lg.ring.Slot(pos);
+            e.text.append(c.text, c.textLen);
+            lg.ring.Release(pos);
+            ++pos; ++cells;
+        }
+        out.push_back(std::move(e));
+    }
+    lg.consumedPos.store(pos, std::memory_order_release);
+    return cells;
+}
+
+void WorkerMain(Logger* lg) {
+    uint64_t pos = lg->consumedPos.load(std::memory_order_relaxed);
+    std::vector<AsyncLogEntry> batch;
+    std::string buf;
+    batch.reserve(kMaxBatch);
+    for (;;) {
+        batch.clear();
+        DrainBatch(*lg, pos, batch);
+        if (!batch.empty()) {
+            if (lg->file) {
+                buf.clear();
+                for (const auto& e : batch) {
+                    buf += AsyncLog_FormatLine(e);
+                    buf += '\n';
+                }
+                fwrite(buf.data(), 1, buf.size(), lg->file);
+                fflush(lg->file);
+            }
+            if (lg->sink) lg->sink(std::move(batch));
+            batch = std::vector<AsyncLogEntry>();
+            batch.reserve(kMaxBatch);
+            std::lock_guard<std::mutex> lk(lg->mutex);
+            lg->drained.notify_all();
+            continue;
+        }
+        std::unique_lock<std::mutex> lk(lg->mutex);
+        lg->drained.notify_all();
+        if (lg->stopRequested && !lg->ring.Ready(pos)) break;
+        lg->wake.wait_for(lk, kIdleWait, [&] {
+            return lg->stopRequested || lg->flushTarget > pos || lg->ring.Ready(pos);
+        });
+    }
+}
+
+void AppendUtf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out += (char)cp;
+    } else if (cp < 0x800) {
+        out += (char)(0xC0 | (cp >> 6));
+        out += (char)(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += (char)(0xE0 | (cp >> 12));
+        out += (char)(0x80 | ((cp >> 6) & 0x3F));
+        out += (char)(0x80 | (cp & 0x3F));
+    } else {
+        out += (char)(0xF0 | (cp >> 18));
+        out += (char)(0x80 | ((cp >> 12) & 0x3F));
+        out += (char)(0x80 | ((cp >> 6) & 0x3F));
+        out += (char)(0x80 | (cp & 0x3F));
+    }
+}
+
+} // namespace
+
+bool AsyncLog_Start(const char* filePathUtf8, AsyncLogSink sink) {
+    Logger& lg = Instance();
+    if (lg.running.exchange(true)) return false;
+    ProcessStart();
+    if (filePathUtf8 && filePathUtf8[0]) {
+#if defined(_WIN32)
+        std::wstring wpath = AsyncLog_Utf8ToWide(filePathUtf8);
+        lg.file = _wfopen(wpath.c_str(), L"wb");
+#else
+        lg.file = fopen(filePathUtf8, "wb");
+#endif
+    }
+    lg.sink = std::move(sink);
+    {
+        std::lock_guard<std::mutex> lk(lg.mutex);
+        lg.stopRequested = false;
+    }
+    lg.worker = std::thread(WorkerMain, &lg);
+    return true;
+}
+
+void AsyncLog_Stop() {
+    Logger& lg = Instance();
+    if (!lg.running.load()) return;
+    {
+        std::lock_guard<std::mutex> lk(lg.mutex);
+        lg.stopRequested = true;
+    }
+    lg.wake.notify_all();
+    if (lg.worker.joinable()) lg.worker.join();
+    if (lg.file) {
+        fclose(lg.file);
+        lg.file = nullptr;
+    }
+    lg.sink = nullptr;
+    lg.running.store(false);
+}
+
+void AsyncLog_Flush() {
+    Logger& lg = Instance();
+    if (!lg.running.load()) return;
+    const uint64_t target = lg.ring.EnqueuePos();
+    std::unique_lock<std::mutex> lk(lg.mutex);
+    lg.flushTarget = std::max(lg.flushTarget, target);
+    lg.wake.notify_all();
+    lg.drained.wait(lk, [&] {
+        return lg.consumedPos.load(std::memory_order_acquire) >= target || lg.stopRequested;
+    });
+}
+
+bool AsyncLog_IsRunning() { return Instance().running.load(std::memory_order_relaxed); }
+
+uint16_t AsyncLog_SiteId(const char* file, int line, const char* func, const wchar_t* remarks) {
+    SiteTable& t = Sites();
+    const uint64_t key = SiteKey(file, line, func, remarks);
+    size_t slot = (size_t)(key % kSiteSlots);
+    for (size_t probe = 0; probe < kSiteSlots; ++probe, slot = (slot + 1) % kSiteSlots) {
+        const uint64_t k = t.keys[slot].load(std::memory_order_acquire);
+        if (k == key) return t.ids[slot];
+        if (k == 0) break;
+    }
+    // Slow path: first call from this site.
+    std::lock_guard<std::mutex> lk(t.mutex);
+    slot = (size_t)(key % kSiteSlots);
+    for (size_t probe = 0; probe < kSiteSlots; ++probe, slot = (slot + 1) % kSiteSlots) {
+        const uint64_t k = t.keys[slot].load(std::memory_order_relaxed);
+        if (k == key) return t.ids[slot];
+        if (k == 0) break;
+    }
+    const uint32_t id = t.count.load(std::memory_order_relaxed);
+    if (id >= kMaxSites) return 0;
+    AsyncLogSite& s = t.sites[id];
+    s.file = file;
+    s.func = func;
+    s.line = line;
+    s.remarks = AsyncLog_WideToUtf8(remarks);
+    t.count.store(id + 1, std::memory_order_release);
+    t.ids[slot] = (uint16_t)id;
+    t.keys[slot].store(key, std::memory_order_release);
+    return (uint16_t)id;
+}
+
+const AsyncLogSite* AsyncLog_GetSite(uint16_t siteId) {
+    SiteTable& t = Sites();
+    if (siteId == 0 || siteId >= t.count.load(std::memory_order_acquire)) return nullptr;
+    return &t.sites[siteId];
+}
+
+bool AsyncLog_Perf(uint8_t level, uint16_t siteId, int page, double zoomPct, double timeMs, double memMB, double deltaMB) {
+    Logger& lg = Instance();
+    if (!lg.running.load(std::memory_order_relaxed)) return false;
+    const uint64_t pos = lg.ring.Claim(1);
+    if (pos == UINT64_MAX) {
+        lg.dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    AsyncLogRecord& r = lg.ring.Slot(pos);
+    FillHeader(r, level, AsyncLogKind::Perf, 0, siteId);
+    r.page = page;
+    r.zoomPct = (float)zoomPct;
+    r.timeMs = timeMs;
+    r.memMB = memMB;
+    r.deltaMB = deltaMB;
+    lg.ring.Publish(pos);
+    MaybeWake(lg, pos, 1);
+    return true;
+}
+
+bool AsyncLog_Text(uint8_t level, uint8_t flags, uint16_t siteId, const char* utf8, size_t len) {
+    Logger& lg = Instance();
+    if (!lg.running.load(std::memory_order_relaxed)) return false;
+    if (!utf8) len = 0;
+    constexpr size_t kCellText = sizeof(AsyncLogRecord::text);
+    len = std::min(len, kCellText * kMaxTextCells);
+    const size_t cells = len <= kCellText ? 1 : (len + kCellText - 1) / kCellText;
+    const uint64_t pos = lg.ring.Claim(cells);
+    if (pos == UINT64_MAX) {
+        lg.dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    for (size_t i = 0; i < cells; ++i) {
+        AsyncLogRecord& r = lg.ring.Slot(pos + i);
+        FillHeader(r, level, i == 0 ? AsyncLogKind::Text : AsyncLogKind::Continuation, flags, siteId);
+        if (i == 0) r.contCount = (uint8_t)(cells - 1);
+        r.page = 0;
+        r.zoomPct = 0.f;
+        r.timeMs = r.memMB = r.deltaMB = 0.0;
+        const size_t off = i * kCellText;
+        const size_t n = std::min(kCellText, len - off);
+        if (n) memcpy(r.text, utf8 + off, n);
+        r.textLen = (uint8_t)n;
+    }
+    // Publish in order so the consumer never sees a continuation before its head.
+    for (size_t i = 0; i < cells; ++i) lg.ring.Publish(pos + i);
+    MaybeWake(lg, pos, cells);
+    return true;
+}
+
+uint64_t AsyncLog_DroppedCount() { return Instance().dropped.load(std::memory_order_relaxed); }
+
+uint64_t AsyncLog_NowNs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - ProcessStart()).count();
+}
+
+uint32_t AsyncLog_ThreadId() {
+    static std::atomic<uint32_t> next {1};
+    thread_local const uint32_t id = next.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+std::string AsyncLog_FormatLine(const AsyncLogEntry& entry) {
+    const AsyncLogRecord& r = entry.record;
+    const double el = r.timestampNs / 1e9;
+    char head[256];
+    if (r.kind == AsyncLogKind::Perf) {
+        snprintf(head, sizeof(head), "[PERF] [+%7.3fs] p=%d z=%.0f%% t=%.2f mem=%.2f dmem=%.2f", el, r.page,
+                 (double)r.zoomPct, r.timeMs, r.memMB, r.deltaMB);
+        std::string line = head;
+        if (const AsyncLogSite* s = AsyncLog_GetSite(r.siteId)) {
+            char src[64];
+            snprintf(src, sizeof(src), ":%d ", s->line);
+            line += " | ";
+            if (!s->remarks.empty()) line += s->remarks + " | ";
+            line += s->file ? s->file : "";
+            line += src;
+            line += s->func ? s->func : "";
+        }
+        return line;
+    }
+    snprintf(head, sizeof(head), "[DBG] [+%7.3fs] [T%u] ", el, r.threadId);
+    return head + entry.text;
+}
+
+std::string AsyncLog_WideToUtf8(const wchar_t* ws) {
+    std::string out;
+    if (!ws) return out;
+    for (; *ws; ++ws) {
+        uint32_t cp = (uint32_t)*ws;
+        if (sizeof(wchar_t) == 2 && cp >= 0xD800 && cp <= 0xDBFF && ws[1] >= 0xDC00 && ws[1] <= 0xDFFF) {
+            cp = 0x10000 + ((cp - 0xD800) << 10) + ((uint32_t)ws[1] - 0xDC00);
+            ++ws;
+        }
+        AppendUtf8(out, cp);
+    }
+    return out;
+}
+
+std::wstring AsyncLog_Utf8ToWide(const std::string& s) {
+    std::wstring out;
+    out.reserve(s.size());
+    for (size_t i = 0; i < s.size();) {
+        const unsigned char c = (unsigned char)s[i];
+        uint32_t cp = 0;
+        size_t n = 1;
+        if (c < 0x80) { cp = c; }
+        else if ((c >> 5) == 0x6) { cp = c & 0x1F; n = 2; }
+        else if ((c >> 4) == 0xE) { cp = c & 0x0F; n = 3; }
+        else if ((c >> 3) == 0x1E) { cp = c & 0x07; n = 4; }
+        else { cp = 0xFFFD; }
+        if (i + n > s.size()) { cp = 0xFFFD; n = s.size() - i; }
+        for (size_t k = 1; k < n; ++k) cp = (cp << 6) | ((unsigned char)s[i + k] & 0x3F);
+        i += n;
+        if (sizeof(wchar_t) == 2 && cp >= 0x10000) {
+            cp -= 0x10000;
+            out += (wchar_t)(0xD800 + (cp >> 10));
+            out += (wchar_t)(0xDC00 + (cp & 0x3FF));
+        } else {
+            out += (wchar_t)cp;
+        }
+    }
+    return out;
+}
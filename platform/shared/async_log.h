@@ -0,0 +1,98 @@
+// Lock-free asynchronous logger shared by macOS/Windows frontends
+//
+// Call sites push fixed-size binary records into a bounded MPSC ring buffer
+// (no locks, no allocation, no I/O, no string formatting for perf records).
+// A single background thread drains the ring, formats lines, batch-writes
+// them to the log file and hands the batch to an optional UI sink.
+// When the ring is full records are dropped and counted, never blocking.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+enum class AsyncLogKind : uint8_t {
+    Text = 0,         // free-form UTF-8 message (may span continuation cells)
+    Perf = 1,         // page/zoom/time/mem sample
+    Continuation = 2, // extra text bytes of the preceding Text record
+};
+
+// Record flags
+enum : uint8_t {
+    kAsyncLogFileOnly = 0x01, // do not forward to the UI sink
+};
+
+// Fixed-size binary record, exactly one ring-buffer cell.
+struct AsyncLogRecord {
+    uint64_t timestampNs;  // steady clock, relative to process start
+    uint32_t threadId;     // small sequential id, see AsyncLog_ThreadId()
+    uint16_t siteId;       // source location id, 0 = unknown
+    uint8_t level;         // frontend LogLevel value
+    AsyncLogKind kind;
+    uint8_t flags;
+    uint8_t textLen;       // bytes used in 'text'
+    uint8_t contCount;     // continuation cells following a Text record
+    uint8_t reserved;
+    int32_t page;
+    float zoomPct;
+    double timeMs;
+    double memMB;
+    double deltaMB;
+    char text[72];
+};
+static_assert(sizeof(AsyncLogRecord) == 128, "AsyncLogRecord must stay one 128-byte cell");
+
+// Source location registered once per (file, line, func, remarks).
+struct AsyncLogSite {
+    const char* file {nullptr};  // must be a string literal (__FILE__)
+    const char* func {nullptr};  // must be a string literal (__FUNCTION__)
+    int line {0};
+    std::string remarks;         // UTF-8 copy of the remarks text
+};
+
+// A drained record with its text reassembled from continuation cells.
+struct AsyncLogEntry {
+    AsyncLogRecord record;
+    std::string text;
+};
+
+// Called on the logger thread with each drained batch (in enqueue order).
+using AsyncLogSink = std::function<void(std::vector<AsyncLogEntry>&& batch)>;
+
+// Start the background thread. 'filePathUtf8' may be nullptr (no file output);
+// an existing file is truncated. 'sink' may be empty. Returns false if already running.
+bool AsyncLog_Start(const char* filePathUtf8, AsyncLogSink sink);
+
+// Drain everything still queued, then stop and join the background thread.
+void AsyncLog_Stop();
+
+// Block until every record enqueued before this call has been written.
+void AsyncLog_Flush();
+
+bool AsyncLog_IsRunning();
+
+// Resolve a call site to a compact id. Lock-free after the first call per site.
+uint16_t AsyncLog_SiteId(const char* file, int line, const char* func, const wchar_t* remarks);
+const AsyncLogSite* AsyncLog_GetSite(uint16_t siteId);
+
+// Hot-path producers. Return false when the record was dropped (ring full or not started).
+bool AsyncLog_Perf(uint8_t level, uint16_t siteId, int page, double zoomPct, double timeMs, double memMB, double deltaMB);
+bool AsyncLog_Text(uint8_t level, uint8_t flags, uint16_t siteId, const char* utf8, size_t len);
+
+// Number of records dropped because the ring was full.
+uint64_t AsyncLog_DroppedCount();
+
+// Nanoseconds since process start on the logger's clock.
+uint64_t AsyncLog_NowNs();
+
+// Small sequential id of the calling thread (1 = first thread that logged).
+uint32_t AsyncLog_ThreadId();
+
+// Format one entry the way it is written to the log file (no trailing newline).
+std::string AsyncLog_FormatLine(const AsyncLogEntry& entry);
+
+// UTF conversion helpers (wchar_t is UTF-16 on Windows, UTF-32 on macOS).
+std::string AsyncLog_WideToUtf8(const wchar_t* ws);
+std::wstring AsyncLog_Utf8ToWide(const std::string& s);
@@ -0,0 +1,54 @@
+#include "frame_pacing.h"
+#include "async_log.h"
+#include "metrics.h"
+
+#include <atomic>
+
+namespace {
+
+// Interactions further apart than this are separate bursts, not a slow frame.
+constexpr uint64_t kIdleGapNs = 250ull * 1000 * 1000;
+
+std::atomic<uint64_t> g_pendingInputNs {0}; // 0 = nothing pending
+std::atomic<const char*> g_pendingSource {nullptr};
+uint64_t g_lastPresentNs = 0;               // paint thread only
+
+} // namespace
+
+void FramePacing_MarkInput(const char* source) {
+    uint64_t expected = 0;
+    // Keep the earliest unpresented input; +1 so a timestamp of 0 is never "empty".
+    if (g_pendingInputNs.compare_exchange_strong(expected, AsyncLog_NowNs() + 1, std::memory_order_acq_rel))
+        g_pendingSource.store(source, std::memory_order_release);
+}
+
+FramePresent FramePacing_Present() {
+    static MetricHistogram& latency = Metrics_Histogram("input_to_present.ms");
+    static MetricHistogram& interval = Metrics_Histogram("frame_interval.ms");
+    static MetricCounter& jank16 = Metrics_Counter("frames.jank_16ms");
+    static MetricCounter& jank33 = Metrics_Counter("frames.jank_33ms");
+
+    FramePresent f;
+    const uint64_t now = AsyncLog_NowNs();
+    const char* source = g_pendingSource.load(std::memory_order_acquire);
+    const uint64_t input = g_pendingInputNs.exchange(0, std::memory_order_acq_rel);
+    if (!input) return f; // not input-driven: leave pacing state untouched
+
+    f.source = source;
+    f.inputToPresentMs = (double)(now - (input - 1)) / 1e6;
+    latency.Record(f.inputToPresentMs);
+    if (g_lastPresentNs && now - g_lastPresentNs < kIdleGapNs) {
+        f.intervalMs = (double)(now - g_lastPresentNs) / 1e6;
+        interval.Record(f.intervalMs);
+    }
+    g_lastPresentNs = now;
+
+    if (f.inputToPresentMs > kFrameSevereJankMs) {
+        f.jankLevel = 2;
+        jank33.Add(1);
+    } else if (f.inputToPresentMs > kFrameJankMs) {
+        f.jankLevel = 1;
+        jank16.Add(1);
+    }
+    return f;
+}
@@ -0,0 +1,30 @@
+// Input-to-present latency and frame pacing monitor shared by macOS/Windows frontends
+//
+// Input handlers call FramePacing_MarkInput() when they change what is on
+// screen (before InvalidateRect / setNeedsDisplay:); the paint path calls
+// FramePacing_Present() once the frame has been handed to the window
+// (after StretchDIBits / at the end of drawRect:). The earliest input not yet
+// presented starts the latency window, so wheel events coalesced into one
+// paint are measured from the first of them. Jank is judged on that latency
+// only: the interval between frames also depends on how often the device
+// delivers input (wheel notches are far apart), so it is recorded, not judged.
+//
+// Feeds the metrics registry: histograms "input_to_present.ms" and
+// "frame_interval.ms", counters "frames.jank_16ms" / "frames.jank_33ms".
+#pragma once
+
+constexpr double kFrameJankMs = 1000.0 / 60.0;        // one 60 Hz refresh
+constexpr double kFrameSevereJankMs = 2000.0 / 60.0;  // two refreshes
+
+struct FramePresent {
+    double inputToPresentMs {-1.0}; // -1: frame not caused by input (expose, resize, ...)
+    double intervalMs {-1.0};       // since the previous input-driven present, -1 after idle
+    const char* source {nullptr};   // input handler that opened the latency window
+    int jankLevel {0};              // latency 0: on time, 1: > kFrameJankMs, 2: > kFrameSevereJankMs
+};
+
+// 'source' must be a string literal (stored by pointer), e.g. "WM_MOUSEWHEEL".
+void FramePacing_MarkInput(const char* source);
+
+// Close the latency window for the frame that was just presented.
+FramePresent FramePacing_Present();
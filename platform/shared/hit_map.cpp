@@ -0,0 +1,192 @@
+#include "hit_map.h"
+#include "metrics.h"
+
+#include <fpdf_annot.h>
+#include <fpdf_doc.h>
+
+#include <algorithm>
+#include <list>
+
+namespace {
+
+constexpr size_t kCachedPages = 16;
+
+bool ToRect(const FS_RECTF& r, PdfTextRect& out) {
+    out.left = std::min(r.left, r.right);
+    out.right = std::max(r.left, r.right);
+    out.bottom = std::min(r.bottom, r.top);
+    out.top = std::max(r.bottom, r.top);
+    return out.right > out.left && out.top > out.bottom;
+}
+
+void ResolveLink(FPDF_DOCUMENT doc, FPDF_LINK link, PdfHitEntry& e) {
+    FPDF_DEST dest = FPDFLink_GetDest(doc, link);
+    FPDF_ACTION action = dest ? nullptr : FPDFLink_GetAction(link);
+    if (action) {
+        switch (FPDFAction_GetType(action)) {
+        case PDFACTION_GOTO:
+            dest = FPDFAction_GetDest(doc, action);
+            break;
+        case PDFACTION_URI: {
+            const unsigned long n = FPDFAction_GetURIPath(doc, action, nullptr, 0);
+            if (n > 1) {
+                e.target.resize(n);
+                FPDFAction_GetURIPath(doc, action, e.target.data(), n);
+                e.target.resize(n - 1);
+                e.kind = PdfHitEntry::Kind::Uri;
+            }
+            break;
+        }
+        case PDFACTION_REMOTEGOTO:
+        case PDFACTION_LAUNCH: {
+            const unsigned long n = FPDFAction_GetFilePath(action, nullptr, 0);
+            if (n > 1) {
+                e.target.resize(n);
+                FPDFAction_GetFilePath(action, e.target.data(), n);
+                e.target.resize(n - 1);
+                e.kind = PdfHitEntry::Kind::External;
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    if (!dest) return;
+    const int page = FPDFDest_GetDestPageIndex(doc, dest);
+    if (page < 0) return;
+    e.kind = PdfHitEntry::Kind::GoTo;
+    e.destPage = page;
+    FPDF_BOOL hasX = 0, hasY = 0, hasZoom = 0;
+    float x = 0, y = 0, zoom = 0;
+    if (FPDFDest_GetLocationInPage(dest, &hasX, &hasY, &hasZoom, &x, &y, &zoom)) {
+        e.hasDestX = hasX != 0;
+        e.hasDestY = hasY != 0;
+        e.destX = x;
+        e.destY = y;
+    }
+}
+
+void ReadAnnotations(FPDF_PAGE page, std::vector<PdfHitEntry>& out) {
+    const int count = FPDFPage_GetAnnotCount(page);
+    for (int i = 0; i < count; ++i) {
+        FPDF_ANNOTATION annot = FPDFPage_GetAnnot(page, i);
+        if (!annot) continue;
+        const int subtype = FPDFAnnot_GetSubtype(annot);
+        FS_RECTF r {};
+        PdfHitEntry e;
+        // Links come from FPDFLink_Enumerate; popups only mirror their parent.
+        if (subtype != FPDF_ANNOT_LINK && subtype != FPDF_ANNOT_POPUP && FPDFAnnot_GetRect(annot, &r) && ToRect(r, e.rect)) {
+            e.kind = PdfHitEntry::Kind::Annotation;
+            e.subtype = subtype;
+            const unsigned long bytes = FPDFAnnot_GetStringValue(annot, "Contents", nullptr, 0);
+            if (bytes > 2) {
+                std::vector<FPDF_WCHAR> buf(bytes / 2);
+                FPDFAnnot_GetStringValue(annot, "Contents", buf.data(), bytes);
+                e.contents.assign(buf.begin(), buf.end() - 1);
+            }
+            out.push_back(std::move(e));
+        }
+        FPDFPage_CloseAnnot(annot);
+    }
+}
+
+void BuildSlabs(PdfHitMap& m) {
+    for (const PdfHitEntry& e : m.entries) {
+        m.slabEdges.push_back(e.rect.bottom);
+        m.slabEdges.push_back(e.rect.top);
+    }
+    std::sort(m.slabEdges.begin(), m.slabEdges.end());
+    m.slabEdges.erase(std::unique(m.slabEdges.begin(), m.slabEdges.end()), m.slabEdges.end());
+    const size_t slabs = m.slabEdges.empty() ? 0 : m.slabEdges.size() - 1;
+    auto slabRange = [&m](const PdfTextRect& r, size_t& lo, size_t& hi) {
+        lo = std::lower_bound(m.slabEdges.begin(), m.slabEdges.end(), r.bottom) - m.slabEdges.begin();
+        hi = std::lower_bound(m.slabEdges.begin(), m.slabEdges.end(), r.top) - m.slabEdges.begin();
+    };
+    // Two passes (count, then fill) so each slab lists its entries in ascending order.
+    m.slabFirst.assign(slabs + 1, 0);
+    size_t lo = 0, hi = 0;
+    for (const PdfHitEntry& e : m.entries) {
+        slabRange(e.rect, lo, hi);
+        for (size_t s = lo; s < hi; ++s) ++m.slabFirst[s + 1];
+    }
+    for (size_t s = 0; s < slabs; ++s) m.slabFirst[s + 1] += m.slabFirst[s];
+    m.slabEntries.resize(m.slabFirst[slabs]);
+    std::vector<int> fill(m.slabFirst.begin(), m.slabFirst.end() - 1);
+    for (int i = 0; i < (int)m.entries.size(); ++i) {
+        slabRange(m.entries[i].rect, lo, hi);
+        for (size_t s = lo; s < hi; ++s) m.slabEntries[fill[s]++] = i;
+    }
+}
+
+PdfHitMap* Build(FPDF_DOCUMENT doc, FPDF_PAGE page, int pageIndex) {
+    auto* m = new PdfHitMap;
+    m->pageIndex = pageIndex;
+    m->pageWidth = FPDF_GetPageWidthF(page);
+    m->pageHeight = FPDF_GetPageHeightF(page);
+    ReadAnnotations(page, m->entries);
+    int pos = 0;
+    FPDF_LINK link = nullptr;
+    while (FPDFLink_Enumerate(page, &pos, &link)) {
+        FS_RECTF r {};
+        PdfHitEntry e;
+        if (!link || !FPDFLink_GetAnnotRect(link, &r) || !ToRect(r, e.rect)) continue;
+        ResolveLink(doc, link, e);
+        m->entries.push_back(std::move(e));
+    }
+    BuildSlabs(*m);
+    return m;
+}
+
+struct CacheEntry {
+    FPDF_DOCUMENT doc;
+    int page;
+    PdfHitMapRef map;
+};
+
+std::list<CacheEntry>& Cache() {
+    static std::list<CacheEntry> lru;   // most recently used first
+    return lru;
+}
+
+} // namespace
+
+const PdfHitEntry* PdfHitMap::HitTest(float x, float y) const {
+    if (slabEdges.size() < 2 || y < slabEdges.front() || y > slabEdges.back()) return nullptr;
+    size_t slab = std::upper_bound(slabEdges.begin(), slabEdges.end(), y) - slabEdges.begin() - 1;
+    slab = std::min(slab, slabEdges.size() - 2);    // y on the topmost edge
+    // Entries are ascending and links were added last, so scanning backwards
+    // meets the topmost link first.
+    for (int k = slabFirst[slab + 1] - 1; k >= slabFirst[slab]; --k) {
+        const PdfHitEntry& e = entries[slabEntries[k]];
+        if (x >= e.rect.left && x <= e.rect.right && y >= e.rect.bottom && y <= e.rect.top) return &e;
+    }
+    return nullptr;
+}
+
+PdfHitMapRef PdfHitMap_Get(FPDF_DOCUMENT doc, int pageIndex, FPDF_PAGE page) {
+    if (!doc || pageIndex < 0) return nullptr;
+    static MetricCacheCounters cacheStats = Metrics_CacheCounters("hit_map");
+    std::list<CacheEntry>& lru = Cache();
+    for (auto it = lru.begin(); it != lru.end(); ++it) {
+        if (it->doc == doc && it->page == pageIndex) {
+            lru.splice(lru.begin(), lru, it);
+            cacheStats.Record(true);
+            return it->map;
+        }
+    }
+    cacheStats.Record(false);
+    static MetricHistogram& buildMs = Metrics_Histogram("hit_map.build_ms");
+    MetricTimer timer(buildMs);
+    FPDF_PAGE loaded = page ? nullptr : FPDF_LoadPage(doc, pageIndex);
+    if (!page && !loaded) return nullptr;
+    PdfHitMapRef map(Build(doc, page ? page : loaded, pageIndex));
+    if (loaded) FPDF_ClosePage(loaded);
+    lru.push_front(CacheEntry {doc, pageIndex, map});
+    if (lru.size() > kCachedPages) lru.pop_back();
+    return map;
+}
+
+void PdfHitMap_InvalidateDocument(FPDF_DOCUMENT doc) {
+    Cache().remove_if([doc](const CacheEntry& e) { return e.doc == doc; });
+}
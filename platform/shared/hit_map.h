@@ -0,0 +1,61 @@
+// Per-page link and annotation hit map shared by macOS/Windows frontends
+//
+// Links (FPDFLink_Enumerate) and the page's other annotations are read once
+// per page with their destinations resolved up front. Their rectangles are
+// indexed by horizontal slabs: the distinct top/bottom edges sorted by y,
+// each slab listing the entries that cover it. A hover or click is then a
+// binary search for the slab plus a scan of its few entries, with no PDFium
+// call on the input path. Maps live in a small LRU keyed by document and
+// page; lookups feed "cache.hit_map.hit" / ".miss". Main thread only.
+#pragma once
+
+#include "text_geometry.h"
+
+#include <fpdfview.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct PdfHitEntry {
+    enum class Kind : uint8_t {
+        GoTo,           // link to a page of this document
+        Uri,            // link to 'target'
+        External,       // remote go-to / launch of file 'target'
+        Unsupported,    // link with no destination we can follow
+        Annotation,     // any other annotation ('subtype')
+    };
+    Kind kind {Kind::Unsupported};
+    PdfTextRect rect;                   // page points, PDF coordinates
+    int destPage {-1};                  // GoTo
+    bool hasDestX {false}, hasDestY {false};
+    float destX {0}, destY {0};         // GoTo: point on destPage, PDF coordinates
+    int subtype {0};                    // Annotation: FPDF_ANNOT_*
+    std::string target;                 // Uri / External, as stored in the file
+    std::u16string contents;            // Annotation: /Contents, for tooltips
+
+    bool IsLink() const { return kind != Kind::Annotation; }
+};
+
+struct PdfHitMap {
+    int pageIndex {-1};
+    float pageWidth {0}, pageHeight {0};    // points, for view-to-page mapping
+    std::vector<PdfHitEntry> entries;   // annotations in page order, then links
+    std::vector<float> slabEdges;       // ascending; slab i is [slabEdges[i], slabEdges[i + 1])
+    std::vector<int> slabFirst;         // offsets into slabEntries; size slabs + 1
+    std::vector<int> slabEntries;       // entry indices per slab, ascending
+
+    // Entry under page point (x, y): links win over annotations, later
+    // entries over earlier ones. nullptr if nothing is there.
+    const PdfHitEntry* HitTest(float x, float y) const;
+};
+using PdfHitMapRef = std::shared_ptr<const PdfHitMap>;
+
+// Hit map of 'pageIndex', built on first use. Pass 'page' when the caller
+// already has it loaded (e.g. while rendering) to avoid loading it again.
+// nullptr if the page cannot be loaded.
+PdfHitMapRef PdfHitMap_Get(FPDF_DOCUMENT doc, int pageIndex, FPDF_PAGE page = nullptr);
+
+// Call before FPDF_CloseDocument.
+void PdfHitMap_InvalidateDocument(FPDF_DOCUMENT doc);
@@ -0,0 +1,197 @@
+#include "image_cache.h"
+#include "metrics.h"
+#include "pdf_utils.h"
+#include "trace.h"
+
+#include <fpdf_edit.h>
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+struct CacheKey {
+    FPDF_DOCUMENT doc {nullptr};
+    uint32_t objNum {0};
+    uint64_t hash {0};                  // stream hash when objNum is 0; matrix hash for Rendered
+    bool rendered {false};
+
+    bool operator==(const CacheKey& o) const {
+        return doc == o.doc && objNum == o.objNum && hash == o.hash && rendered == o.rendered;
+    }
+};
+
+struct CacheKeyHash {
+    size_t operator()(const CacheKey& k) const {
+        uint64_t h = k.hash ^ ((uint64_t)k.objNum << 1) ^ (uint64_t)(uintptr_t)k.doc * 0x9E3779B97F4A7C15ull;
+        return (size_t)(h ^ (h >> 29) ^ (k.rendered ? 0x5bd1e995u : 0u));
+    }
+};
+
+struct CacheEntry {
+    CacheKey key;
+    PdfDecodedImageRef image;
+};
+
+struct ImageCache {
+    std::mutex mutex;
+    std::list<CacheEntry> lru;          // most recently used first
+    std::unordered_map<CacheKey, std::list<CacheEntry>::iterator, CacheKeyHash> index;
+    int64_t bytes {0};
+    int64_t capacity {512ll << 20};
+    uint32_t (*objectNumber)(FPDF_PAGEOBJECT) {nullptr};
+    uint64_t (*paramsHash)(FPDF_PAGEOBJECT) {nullptr};
+};
+
+ImageCache& Cache() {
+    static ImageCache c;
+    return c;
+}
+
+// Caller holds the mutex.
+void EvictLocked(ImageCache& c) {
+    while (c.bytes > c.capacity && c.lru.size() > 1) {
+        const CacheEntry& e = c.lru.back();
+        c.bytes -= e.image->Bytes();
+        c.index.erase(e.key);
+        c.lru.pop_back();
+    }
+}
+
+PdfDecodedImageRef Lookup(ImageCache& c, const CacheKey& key) {
+    std::lock_guard<std::mutex> lk(c.mutex);
+    auto it = c.index.find(key);
+    if (it == c.index.end()) return nullptr;
+    c.lru.splice(c.lru.begin(), c.lru, it->second);
+    return it->second->image;
+}
+
+void Insert(ImageCache& c, const CacheKey& key, const PdfDecodedImageRef& image) {
+    std::lock_guard<std::mutex> lk(c.mutex);
+    if (c.index.count(key)) return;
+    c.lru.push_front(CacheEntry {key, image});
+    c.index.emplace(key, c.lru.begin());
+    c.bytes += image->Bytes();
+    EvictLocked(c);
+}
+
+// Size, colour space, filters and the dictionary's decode parameters go into
+// the hash: identical stream bytes under different parameters decode differently.
+uint64_t StreamHash(FPDF_PAGE page, FPDF_PAGEOBJECT obj, uint64_t paramsHash) {
+    std::vector<uint8_t> stream(FPDFImageObj_GetImageDataRaw(obj, nullptr, 0));
+    if (!stream.empty()) FPDFImageObj_GetImageDataRaw(obj, stream.data(), (unsigned long)stream.size());
+    return PdfImageStreamHash(page, obj, stream.data(), stream.size(), paramsHash);
+}
+
+PdfDecodedImageRef DecodeUncached(FPDF_DOCUMENT doc, FPDF_PAGE page, FPDF_PAGEOBJECT obj) {
+    PDFWV_TRACE_SCOPE("image", "decode");
+    if (FPDF_BITMAP bmp = FPDFImageObj_GetBitmap(obj)) return std::make_shared<const PdfDecodedImage>(bmp, false);
+    FPDF_BITMAP bmp = FPDFImageObj_GetRenderedBitmap(doc, page, obj);
+    return bmp ? std::make_shared<const PdfDecodedImage>(bmp, true) : nullptr;
+}
+
+uint64_t MatrixHash(FPDF_PAGEOBJECT obj) {
+    FS_MATRIX m {};
+    FPDFPageObj_GetMatrix(obj, &m);
+    return PdfHashBytes(reinterpret_cast<const uint8_t*>(&m), sizeof(m));
+}
+
+} // namespace
+
+PdfDecodedImage::PdfDecodedImage(FPDF_BITMAP bmp, bool isRendered) : bitmap(bmp), rendered(isRendered) {
+    width = FPDFBitmap_GetWidth(bmp);
+    height = FPDFBitmap_GetHeight(bmp);
+    stride = FPDFBitmap_GetStride(bmp);
+    format = FPDFBitmap_GetFormat(bmp);
+    Metrics_MemoryAdd(MemCategory::DecodedImage, Bytes());
+}
+
+PdfDecodedImage::~PdfDecodedImage() {
+    Metrics_MemoryAdd(MemCategory::DecodedImage, -Bytes());
+    FPDFBitmap_Destroy(bitmap);
+}
+
+PdfDecodedImageRef PdfImageCache_Acquire(FPDF_DOCUMENT doc, FPDF_PAGE page, FPDF_PAGEOBJECT imageObj) {
+    if (!doc || !imageObj || FPDFPageObj_GetType(imageObj) != FPDF_PAGEOBJ_IMAGE) return nullptr;
+    static MetricCacheCounters cacheStats = Metrics_CacheCounters("decoded_image");
+    ImageCache& c = Cache();
+    CacheKey key;
+    key.doc = doc;
+    key.objNum = c.objectNumber ? c.objectNumber(imageObj) : 0;
+    if (!key.objNum) {
+        // /Decode, /SMask, ... are not in the stream: without their hash two
+        // images could share an entry, so decode for this caller only.
+        if (!c.paramsHash) {
+            cacheStats.Record(false);
+            return DecodeUncached(doc, page, imageObj);
+        }
+        key.hash = StreamHash(page, imageObj, c.paramsHash(imageObj));
+    }
+
+    if (PdfDecodedImageRef hit = Lookup(c, key)) {
+        cacheStats.Record(true);
+        return hit;
+    }
+    PDFWV_TRACE_SCOPE("image", "decode");
+    if (FPDF_BITMAP bmp = FPDFImageObj_GetBitmap(imageObj)) {
+        cacheStats.Record(false);
+        auto image = std::make_shared<const PdfDecodedImage>(bmp, false);
+        Insert(c, key, image);
+        return image;
+    }
+
+    // No embedded pixels (e.g. an unsupported filter): fall back to rendering
+    // the object, which also depends on where and how large it is drawn.
+    key.rendered = true;
+    key.hash ^= MatrixHash(imageObj);
+    if (PdfDecodedImageRef hit = Lookup(c, key)) {
+        cacheStats.Record(true);
+        return hit;
+    }
+    cacheStats.Record(false);
+    FPDF_BITMAP bmp = FPDFImageObj_GetRenderedBitmap(doc, page, imageObj);
+    if (!bmp) return nullptr;
+    auto image = std::make_shared<const PdfDecodedImage>(bmp, true);
+    Insert(c, key, image);
+    return image;
+}
+
+void PdfImageCache_SetObjectNumberFn(uint32_t (*fn)(FPDF_PAGEOBJECT)) {
+    ImageCache& c = Cache();
+    std::lock_guard<std::mutex> lk(c.mutex);
+    c.objectNumber = fn;
+}
+
+void PdfImageCache_SetParamsHashFn(uint64_t (*fn)(FPDF_PAGEOBJECT)) {
+    ImageCache& c = Cache();
+    std::lock_guard<std::mutex> lk(c.mutex);
+    c.paramsHash = fn;
+}
+
+void PdfImageCache_SetCapacity(int64_t bytes) {
+    ImageCache& c = Cache();
+    std::lock_guard<std::mutex> lk(c.mutex);
+    c.capacity = bytes > 0 ? bytes : 0;
+    EvictLocked(c);
+    if (c.capacity == 0 && !c.lru.empty()) {
+        c.lru.clear();
+        c.index.clear();
+        c.bytes = 0;
+    }
+}
+
+void PdfImageCache_InvalidateDocument(FPDF_DOCUMENT doc) {
+    ImageCache& c = Cache();
+    std::lock_guard<std::mutex> lk(c.mutex);
+    for (auto it = c.lru.begin(); it != c.lru.end();) {
+        if (it->key.doc == doc) {
+            c.bytes -= it->image->Bytes();
+            c.index.erase(it->key);
+            it = c.lru.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
@@ -0,0 +1,62 @@
+// Bounded cache of decoded image bitmaps shared by macOS/Windows frontends
+//
+// Saving or inspecting an image used to decode it again every time, which for
+// a 100-megapixel scan costs seconds. Entries are keyed by document, image
+// identity and decode mode:
+//  - identity is the image XObject's object number when a lookup function is
+//    installed (macOS: PdfiumEx_GetImageObjectNumber), so every page that
+//    references the same XObject shares one entry. Inline images and lookups
+//    that fail fall back to a hash of the encoded stream, its size, colour
+//    metadata and a hash of the dictionary's decode parameters (macOS:
+//    PdfiumEx_GetImageParamsHash); the stream alone is not enough, since
+//    /Decode, /SMask, ... change the pixels. With neither function
+//    (Windows) images are decoded uncached;
+//  - mode is Embedded (FPDFImageObj_GetBitmap, the image's own pixels) or
+//    Rendered (FPDFImageObj_GetRenderedBitmap, the fallback, which also
+//    depends on the object's matrix).
+// Bitmaps keep the format PDFium decoded them to, so a gray scan stays one
+// byte per pixel; callers convert only if their encoder needs BGRA.
+// Least recently used entries are dropped beyond the byte budget; a dropped
+// bitmap lives on until its last handle is released. Memory is charged to
+// MemCategory::DecodedImage while a bitmap is alive, lookups feed
+// "cache.decoded_image.hit" / ".miss".
+#pragma once
+
+#include <fpdfview.h>
+
+#include <cstdint>
+#include <memory>
+
+struct PdfDecodedImage {
+    FPDF_BITMAP bitmap {nullptr};
+    int width {0}, height {0}, stride {0};
+    int format {0};                     // FPDFBitmap_*
+    bool rendered {false};
+
+    PdfDecodedImage(FPDF_BITMAP bmp, bool isRendered);
+    ~PdfDecodedImage();
+    PdfDecodedImage(const PdfDecodedImage&) = delete;
+    PdfDecodedImage& operator=(const PdfDecodedImage&) = delete;
+
+    const uint8_t* Buffer() const { return static_cast<const uint8_t*>(FPDFBitmap_GetBuffer(bitmap)); }
+    int64_t Bytes() const { return (int64_t)stride * height; }
+};
+using PdfDecodedImageRef = std::shared_ptr<const PdfDecodedImage>;
+
+// Decoded pixels of 'imageObj' (on 'page' of 'doc'), from the cache when
+// possible. nullptr if PDFium cannot decode the image. Call on the thread that
+// owns 'doc'; the returned handle may be kept and released anywhere.
+PdfDecodedImageRef PdfImageCache_Acquire(FPDF_DOCUMENT doc, FPDF_PAGE page, FPDF_PAGEOBJECT imageObj);
+
+// Optional object-number lookup; 0 means "unknown, hash the stream".
+void PdfImageCache_SetObjectNumberFn(uint32_t (*fn)(FPDF_PAGEOBJECT));
+
+// Optional hash of the decode parameters the public API does not expose
+// (/Decode, /SMask, ...). Required for caching images without an object number.
+void PdfImageCache_SetParamsHashFn(uint64_t (*fn)(FPDF_PAGEOBJECT));
+
+// Byte budget for retained bitmaps (default 512 MB); shrinking evicts at once.
+void PdfImageCache_SetCapacity(int64_t bytes);
+
+// Call before FPDF_CloseDocument: keys hold the document pointer.
+void PdfImageCache_InvalidateDocument(FPDF_DOCUMENT doc);
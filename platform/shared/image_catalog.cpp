@@ -0,0 +1,308 @@
+#include "image_catalog.h"
+#include "async_log.h"
+#include "metrics.h"
+#include "pdf_utils.h"
+#include "trace.h"
+
+#include <fpdf_edit.h>
+
+#include <sys/stat.h>
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const char kSidecarMagic[] = "pdfwv-image-catalog 1";
+
+struct Catalog {
+    FPDF_DOCUMENT doc {nullptr};
+    std::string sidecarPath;
+    uint64_t fileSize {0};
+    int64_t fileMtime {0};
+    uint32_t (*objectNumber)(FPDF_PAGEOBJECT) {nullptr};
+    int pageCount {0};
+    int nextPage {0};
+    bool fromSidecar {false};
+    std::vector<PdfImageCatalogEntry> entries;
+    std::vector<int> pageStart;         // first entry of each scanned page; size nextPage + 1
+};
+
+Catalog& State() {
+    static Catalog c;
+    return c;
+}
+
+FILE* OpenUtf8(const std::string& path, const char* mode) {
+#if defined(_WIN32)
+    return _wfopen(AsyncLog_Utf8ToWide(path.c_str()).c_str(), AsyncLog_Utf8ToWide(mode).c_str());
+#else
+    return fopen(path.c_str(), mode);
+#endif
+}
+
+bool FileStamp(const std::string& path, uint64_t& size, int64_t& mtime) {
+#if defined(_WIN32)
+    struct _stat64 st;
+    if (_wstat64(AsyncLog_Utf8ToWide(path.c_str()).c_str(), &st) != 0) return false;
+#else
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return false;
+#endif
+    size = (uint64_t)st.st_size;
+    mtime = (int64_t)st.st_mtime;
+    return true;
+}
+
+struct Quad {
+    float x[4], y[4];
+};
+
+void Transform(const FS_MATRIX& m, Quad& q) {
+    for (int i = 0; i < 4; ++i) {
+        const float x = q.x[i], y = q.y[i];
+        q.x[i] = m.a * x + m.c * y + m.e;
+        q.y[i] = m.b * x + m.d * y + m.f;
+    }
+}
+
+// Bounds of objects inside form XObjects are in form space; 'forms' is the
+// chain of enclosing form objects, innermost last.
+void AddImage(Catalog& c, FPDF_PAGE page, int pageIndex, FPDF_PAGEOBJECT obj,
+              const std::vector<FPDF_PAGEOBJECT>& forms, int& ordinal) {
+    PdfImageCatalogEntry e;
+    e.page = pageIndex;
+    e.ordinal = ordinal++;
+    e.objectNumber = c.objectNumber ? c.objectNumber(obj) : 0;
+
+    float l = 0, b = 0, r = 0, t = 0;
+    if (FPDFPageObj_GetBounds(obj, &l, &b, &r, &t)) {
+        Quad q {{l, r, r, l}, {b, b, t, t}};
+        for (auto it = forms.rbegin(); it != forms.rend(); ++it) {
+            FS_MATRIX m {};
+            if (FPDFPageObj_GetMatrix(*it, &m)) Transform(m, q);
+        }
+        e.left = *std::min_element(q.x, q.x + 4);
+        e.right = *std::max_element(q.x, q.x + 4);
+        e.bottom = *std::min_element(q.y, q.y + 4);
+        e.top = *std::max_element(q.y, q.y + 4);
+    }
+
+    FPDF_IMAGEOBJ_METADATA md {};
+    if (FPDFImageObj_GetImageMetadata(obj, page, &md)) {
+        e.width = md.width;
+        e.height = md.height;
+        e.bitsPerPixel = md.bits_per_pixel;
+        e.colorspace = md.colorspace;
+        e.decodedBytes = ((uint64_t)md.width * md.height * md.bits_per_pixel + 7) / 8;
+    }
+    const int nfilters = FPDFImageObj_GetImageFilterCount(obj);
+    if (nfilters > 0) {
+        char name[64] {};
+        if (FPDFImageObj_GetImageFilter(obj, nfilters - 1, name, sizeof(name)) > 0) e.filter = name;
+    }
+    e.compressedBytes = FPDFImageObj_GetImageDataRaw(obj, nullptr, 0);
+    c.entries.push_back(std::move(e));
+}
+
+void CollectImages(Catalog& c, FPDF_PAGE page, int pageIndex, FPDF_PAGEOBJECT obj,
+                   std::vector<FPDF_PAGEOBJECT>& forms, int& ordinal) {
+    const int type = FPDFPageObj_GetType(obj);
+    if (type == FPDF_PAGEOBJ_IMAGE) {
+        AddImage(c, page, pageIndex, obj, forms, ordinal);
+    } else if (type == FPDF_PAGEOBJ_FORM) {
+        forms.push_back(obj);
+        const int n = FPDFFormObj_CountObjects(obj);
+        for (int i = 0; i < n; ++i) {
+            if (FPDF_PAGEOBJECT child = FPDFFormObj_GetObject(obj, (unsigned long)i))
+                CollectImages(c, page, pageIndex, child, forms, ordinal);
+        }
+        forms.pop_back();
+    }
+}
+
+void ScanPage(Catalog& c) {
+    static MetricHistogram& pageMs = Metrics_Histogram("image_catalog.page_ms");
+    MetricTimer timer(pageMs);
+    const int p = c.nextPage;
+    PDFWV_TRACE_SCOPE_PAGE("image", "catalog_page", p);
+    if (FPDF_PAGE page = FPDF_LoadPage(c.doc, p)) {
+        std::vector<FPDF_PAGEOBJECT> forms;
+        int ordinal = 0;
+        const int count = FPDFPage_CountObjects(page);
+        for (int i = 0; i < count; ++i) {
+            if (FPDF_PAGEOBJECT obj = FPDFPage_GetObject(page, i)) CollectImages(c, page, p, obj, forms, ordinal);
+        }
+        FPDF_ClosePage(page);
+    }
+    ++c.nextPage;
+    c.pageStart.push_back((int)c.entries.size());
+}
+
+// Tab-separated: a header with the file stamp, one line per entry, then "end"
+// so a truncated file is rejected.
+bool SaveSidecar(const Catalog& c) {
+    FILE* f = OpenUtf8(c.sidecarPath, "wb");
+    if (!f) return false;
+    fprintf(f, "%s\n%" PRIu64 "\t%" PRId64 "\t%d\t%zu\n", kSidecarMagic, c.fileSize, c.fileMtime, c.pageCount,
+            c.entries.size());
+    for (const PdfImageCatalogEntry& e : c.entries) {
+        fprintf(f, "%d\t%d\t%u\t%.3f\t%.3f\t%.3f\t%.3f\t%u\t%u\t%u\t%d\t%s\t%" PRIu64 "\t%" PRIu64 "\n", e.page,
+                e.ordinal, e.objectNumber, e.left, e.bottom, e.right, e.top, e.width, e.height, e.bitsPerPixel,
+                e.colorspace, e.filter.empty() ? "-" : e.filter.c_str(), e.compressedBytes, e.decodedBytes);
+    }
+    fputs("end\n", f);
+    const bool ok = !ferror(f);
+    return fclose(f) == 0 && ok;
+}
+
+bool LoadSidecar(Catalog& c) {
+    FILE* f = OpenUtf8(c.sidecarPath, "rb");
+    if (!f) return false;
+    char line[512];
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    int pages = 0;
+    size_t count = 0;
+    bool ok = fgets(line, sizeof(line), f) && strncmp(line, kSidecarMagic, sizeof(kSidecarMagic) - 1) == 0 &&
+              fgets(line, sizeof(line), f) &&
+              sscanf(line, "%" SCNu64 "\t%" SCNd64 "\t%d\t%zu", &size, &mtime, &pages, &count) == 4 &&
+              size == c.fileSize && mtime == c.fileMtime && pages == c.pageCount;
+    std::vector<PdfImageCatalogEntry> entries;
+    if (ok) entries.reserve(std::min<size_t>(count, 1u << 16));
+    while (ok && entries.size() < count) {
+        PdfImageCatalogEntry e;
+        char filter[64] {};
+        ok = fgets(line, sizeof(line), f) &&
+             sscanf(line, "%d\t%d\t%u\t%f\t%f\t%f\t%f\t%u\t%u\t%u\t%d\t%63s\t%" SCNu64 "\t%" SCNu64, &e.page,
+                    &e.ordinal, &e.objectNumber, &e.left, &e.bottom, &e.right, &e.top, &e.width, &e.height,
+                    &e.bitsPerPixel, &e.colorspace, filter, &e.compressedBytes, &e.decodedBytes) == 14 &&
+             e.page >= 0 && e.page < pages && (entries.empty() || entries.back().page <= e.page);
+        if (ok && strcmp(filter, "-") != 0) e.filter = filter;
+        if (ok) entries.push_back(std::move(e));
+    }
+    ok = ok && fgets(line, sizeof(line), f) && strcmp(line, "end\n") == 0;
+    fclose(f);
+    if (!ok) return false;
+
+    c.entries.swap(entries);
+    c.pageStart.assign(1, 0);
+    size_t i = 0;
+    for (int p = 0; p < pages; ++p) {
+        while (i < c.entries.size() && c.entries[i].page == p) ++i;
+        c.pageStart.push_back((int)i);
+    }
+    c.nextPage = pages;
+    return true;
+}
+
+const char* ColorspaceName(int cs) {
+    static const char* const kNames[] = {"unknown", "DeviceGray", "DeviceRGB", "DeviceCMYK", "CalGray", "CalRGB",
+                                         "Lab", "ICCBased", "Separation", "DeviceN", "Indexed", "Pattern"};
+    return (cs >= 0 && cs < (int)(sizeof(kNames) / sizeof(kNames[0]))) ? kNames[cs] : "unknown";
+}
+
+bool Scanned(const Catalog& c, int page) {
+    return c.doc && page >= 0 && page < c.nextPage;
+}
+
+} // namespace
+
+void PdfImageCatalog_Open(FPDF_DOCUMENT doc, const std::string& pdfPathUtf8, const std::string& sidecarPathUtf8,
+                          uint32_t (*objectNumber)(FPDF_PAGEOBJECT)) {
+    PdfImageCatalog_Close();
+    Catalog& c = State();
+    if (!doc) return;
+    c.doc = doc;
+    c.objectNumber = objectNumber;
+    c.pageCount = FPDF_GetPageCount(doc);
+    c.pageStart.assign(1, 0);
+    if (sidecarPathUtf8.empty() || !FileStamp(pdfPathUtf8, c.fileSize, c.fileMtime)) return;
+    c.sidecarPath = sidecarPathUtf8;
+    PDFWV_TRACE_SCOPE("image", "catalog_load");
+    c.fromSidecar = LoadSidecar(c);
+}
+
+bool PdfImageCatalog_Step(double budgetMs) {
+    Catalog& c = State();
+    if (!c.doc || c.nextPage >= c.pageCount) return false;
+    const auto t0 = std::chrono::steady_clock::now();
+    do {
+        ScanPage(c);
+    } while (c.nextPage < c.pageCount &&
+             std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() < budgetMs);
+    if (c.nextPage < c.pageCount) return true;
+    // A failed write only costs a rescan next time.
+    if (!c.sidecarPath.empty()) SaveSidecar(c);
+    return false;
+}
+
+void PdfImageCatalog_Close() {
+    State() = Catalog {};
+}
+
+PdfImageCatalogStatus PdfImageCatalog_Status() {
+    const Catalog& c = State();
+    PdfImageCatalogStatus s;
+    s.pagesScanned = c.nextPage;
+    s.pageCount = c.pageCount;
+    s.images = (int)c.entries.size();
+    s.complete = c.doc && c.nextPage >= c.pageCount;
+    s.fromSidecar = c.fromSidecar;
+    return s;
+}
+
+const std::vector<PdfImageCatalogEntry>& PdfImageCatalog_Entries() {
+    return State().entries;
+}
+
+int PdfImageCatalog_PageImageCount(int page) {
+    const Catalog& c = State();
+    return Scanned(c, page) ? c.pageStart[page + 1] - c.pageStart[page] : -1;
+}
+
+const PdfImageCatalogEntry* PdfImageCatalog_LargestOnPage(int page) {
+    const Catalog& c = State();
+    if (!Scanned(c, page)) return nullptr;
+    const PdfImageCatalogEntry* best = nullptr;
+    for (int i = c.pageStart[page]; i < c.pageStart[page + 1]; ++i) {
+        const PdfImageCatalogEntry& e = c.entries[i];
+        if (!best || (uint64_t)e.width * e.height > (uint64_t)best->width * best->height) best = &e;
+    }
+    return best;
+}
+
+bool PdfImageCatalog_MayHitImage(int page, float x, float y, float tolerance) {
+    const Catalog& c = State();
+    if (!Scanned(c, page)) return true;
+    for (int i = c.pageStart[page]; i < c.pageStart[page + 1]; ++i) {
+        const PdfImageCatalogEntry& e = c.entries[i];
+        if (x >= e.left - tolerance && x <= e.right + tolerance && y >= e.bottom - tolerance &&
+            y <= e.top + tolerance)
+            return true;
+    }
+    return false;
+}
+
+bool PdfImageCatalog_WriteCsv(const std::string& pathUtf8) {
+    FILE* f = OpenUtf8(pathUtf8, "wb");
+    if (!f) return false;
+    fputs("page,index,object,left,bottom,right,top,width,height,bpp,colorspace,filter,compressed_bytes,decoded_bytes\n",
+          f);
+    for (const PdfImageCatalogEntry& e : State().entries) {
+        fprintf(f, "%d,%d,%u,%.2f,%.2f,%.2f,%.2f,%u,%u,%u,%s,%s,%" PRIu64 ",%" PRIu64 "\n", e.page + 1, e.ordinal + 1,
+                e.objectNumber, e.left, e.bottom, e.right, e.top, e.width, e.height, e.bitsPerPixel,
+                ColorspaceName(e.colorspace), e.filter.c_str(), e.compressedBytes, e.decodedBytes);
+    }
+    const bool ok = !ferror(f);
+    return fclose(f) == 0 && ok;
+}
+
+std::string PdfSidecarFileName(const std::string& pdfPathUtf8, const char* suffix) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%016" PRIx64,
+             PdfHashBytes(reinterpret_cast<const uint8_t*>(pdfPathUtf8.data()), pdfPathUtf8.size()));
+    return std::string(buf) + suffix;
+}
@@ -0,0 +1,76 @@
+// Per-document image catalog shared by macOS/Windows frontends
+//
+// Answers "which images does this document have, where and how large"
+// without loading pages: one entry per image object (form XObjects
+// included) with bounds, pixel size, bit depth, colour space, filter and
+// compressed/decoded byte sizes. Built in the background on the UI thread -
+// PDFium is not thread-safe - in time-boxed slices driven by a frontend timer
+// (PdfImageCatalog_Step), so pages already scanned are queryable while the
+// rest is pending.
+//
+// A finished catalog is written to a sidecar file keyed by the PDF's path and
+// validated by its size and modification time, so reopening a document makes
+// the catalog complete at once. Main thread only.
+#pragma once
+
+#include <fpdfview.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct PdfImageCatalogEntry {
+    int page {0};
+    int ordinal {0};                    // n-th image on the page, content order
+    uint32_t objectNumber {0};          // 0 when unknown or inline
+    float left {0}, bottom {0}, right {0}, top {0}; // page points, PDF coordinates
+    uint32_t width {0}, height {0};     // pixels
+    uint32_t bitsPerPixel {0};
+    int colorspace {0};                 // FPDF_COLORSPACE_*
+    std::string filter;                 // last filter in the chain, empty if none
+    uint64_t compressedBytes {0};       // stream as stored in the file
+    uint64_t decodedBytes {0};          // width * height * bitsPerPixel / 8
+};
+
+struct PdfImageCatalogStatus {
+    int pagesScanned {0}, pageCount {0};
+    int images {0};
+    bool complete {false};
+    bool fromSidecar {false};
+};
+
+// Start cataloguing 'doc' (opened from 'pdfPathUtf8'). Loads 'sidecarPathUtf8'
+// if it still matches the file, otherwise scans from page 0 and writes it
+// there once complete; an empty sidecar path disables persistence.
+// 'objectNumber' is optional (see ImageExtractOptions::objectNumber).
+void PdfImageCatalog_Open(FPDF_DOCUMENT doc, const std::string& pdfPathUtf8, const std::string& sidecarPathUtf8,
+                          uint32_t (*objectNumber)(FPDF_PAGEOBJECT) = nullptr);
+
+// Scan pages for about 'budgetMs' (at least one page). Returns true while
+// pages remain, i.e. the frontend should keep its timer running.
+bool PdfImageCatalog_Step(double budgetMs);
+
+// Call before FPDF_CloseDocument.
+void PdfImageCatalog_Close();
+
+PdfImageCatalogStatus PdfImageCatalog_Status();
+
+// All entries of scanned pages, ordered by page then ordinal.
+const std::vector<PdfImageCatalogEntry>& PdfImageCatalog_Entries();
+
+// Number of images on 'page', -1 if the page has not been scanned yet.
+int PdfImageCatalog_PageImageCount(int page);
+
+// Largest image on 'page' by pixel count, nullptr if none or not scanned yet.
+const PdfImageCatalogEntry* PdfImageCatalog_LargestOnPage(int page);
+
+// False only if 'page' is scanned and no image bounds (grown by 'tolerance')
+// contain (x, y) in PDF coordinates; lets hit tests skip loading the page.
+bool PdfImageCatalog_MayHitImage(int page, float x, float y, float tolerance);
+
+// One line per image, header included. For "list all images" exports.
+bool PdfImageCatalog_WriteCsv(const std::string& pathUtf8);
+
+// File name for per-document data stored under a frontend's sidecar
+// directory: hash of the document path plus 'suffix' (e.g. ".images").
+std::string PdfSidecarFileName(const std::string& pdfPathUtf8, const char* suffix);
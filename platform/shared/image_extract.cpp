@@ -0,0 +1,304 @@
+#include "image_extract.h"
+#include "async_log.h"
+#include "metrics.h"
+#include "pdf_utils.h"
+#include "trace.h"
+
+#include <fpdf_edit.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+// Either an encoded stream to copy to disk or decoded pixels to encode.
+struct ExtractJob {
+    std::string path;                   // without extension for pixels
+    std::vector<uint8_t> data;
+    bool raw {false};
+    int width {0}, height {0}, stride {0}, format {0};
+};
+
+struct ExtractQueue {
+    std::mutex mutex;
+    std::condition_variable ready;      // job queued or closed
+    std::condition_variable drained;    // bytes released
+    std::deque<ExtractJob> jobs;
+    size_t queuedBytes {0};
+    bool closed {false};
+
+    std::atomic<int> written {0}, passthrough {0}, failed {0};
+    std::atomic<uint64_t> bytesWritten {0};
+};
+
+uint64_t WriteFileUtf8(const std::string& path, const uint8_t* data, size_t size) {
+#if defined(_WIN32)
+    FILE* f = _wfopen(AsyncLog_Utf8ToWide(path.c_str()).c_str(), L"wb");
+#else
+    FILE* f = fopen(path.c_str(), "wb");
+#endif
+    if (!f) return 0;
+    const bool ok = fwrite(data, 1, size, f) == size;
+    return (fclose(f) == 0 && ok) ? size : 0;
+}
+
+// Any FPDFBitmap_* format to opaque-or-alpha BGRA; BGRA input is used as is.
+void ToBGRA(ExtractJob& job) {
+    if (job.format == FPDFBitmap_BGRA) return;
+    if (job.format == FPDFBitmap_BGRx) {
+        for (int y = 0; y < job.height; ++y) {
+            uint8_t* row = job.data.data() + (size_t)y * job.stride;
+            for (int x = 0; x < job.width; ++x) row[4 * x + 3] = 255;
+        }
+        job.format = FPDFBitmap_BGRA;
+        return;
+    }
+    std::vector<uint8_t> out((size_t)job.width * job.height * 4);
+    for (int y = 0; y < job.height; ++y) {
+        const uint8_t* src = job.data.data() + (size_t)y * job.stride;
+        uint8_t* dst = out.data() + (size_t)y * job.width * 4;
+        for (int x = 0; x < job.width; ++x, dst += 4) {
+            if (job.format == FPDFBitmap_Gray) {
+                dst[0] = dst[1] = dst[2] = src[x];
+            } else if (job.format == FPDFBitmap_BGR) {
+                memcpy(dst, src + 3 * x, 3);
+            } else {
+                memcpy(dst, src + 4 * x, 3);
+            }
+            dst[3] = 255;
+        }
+    }
+    job.data.swap(out);
+    job.stride = job.width * 4;
+    job.format = FPDFBitmap_BGRA;
+}
+
+void RunWorker(ExtractQueue& q, const ImageEncodeFn& encode) {
+    PDFWV_TRACE_THREAD_NAME("image_extract");
+    static MetricHistogram& encodeMs = Metrics_Histogram("image_encode.ms");
+    static MetricCounter& bytesCounter = Metrics_Counter("image_extract.bytes");
+    for (;;) {
+        ExtractJob job;
+        {
+            std::unique_lock<std::mutex> lk(q.mutex);
+            q.ready.wait(lk, [&] { return q.closed || !q.jobs.empty(); });
+            if (q.jobs.empty()) return;
+            job = std::move(q.jobs.front());
+            q.jobs.pop_front();
+        }
+        const size_t jobBytes = job.data.size();
+        uint64_t bytes = 0;
+        if (job.raw) {
+            PDFWV_TRACE_SCOPE("image", "write_raw");
+            bytes = WriteFileUtf8(job.path, job.data.data(), job.data.size());
+        } else if (encode) {
+            PDFWV_TRACE_SCOPE("image", "encode");
+            MetricTimer timer(encodeMs);
+            ToBGRA(job);
+            bytes = encode(job.path + ".png", job.data.data(), job.width, job.height, job.stride);
+        }
+        if (bytes > 0) {
+            q.written.fetch_add(1, std::memory_order_relaxed);
+            if (job.raw) q.passthrough.fetch_add(1, std::memory_order_relaxed);
+            q.bytesWritten.fetch_add(bytes, std::memory_order_relaxed);
+            bytesCounter.Add((int64_t)bytes);
+        } else {
+            q.failed.fetch_add(1, std::memory_order_relaxed);
+        }
+        {
+            std::lock_guard<std::mutex> lk(q.mutex);
+            q.queuedBytes -= jobBytes;
+        }
+        q.drained.notify_one();
+    }
+}
+
+void CollectImages(FPDF_PAGEOBJECT obj, std::vector<FPDF_PAGEOBJECT>& out) {
+    const int type = FPDFPageObj_GetType(obj);
+    if (type == FPDF_PAGEOBJ_IMAGE) {
+        out.push_back(obj);
+    } else if (type == FPDF_PAGEOBJ_FORM) {
+        const int n = FPDFFormObj_CountObjects(obj);
+        for (int i = 0; i < n; ++i) {
+            if (FPDF_PAGEOBJECT child = FPDFFormObj_GetObject(obj, (unsigned long)i)) CollectImages(child, out);
+        }
+    }
+}
+
+std::string JoinPath(const std::string& dir, const char* name) {
+    if (dir.empty()) return name;
+    const char last = dir.back();
+    return (last == '/' || last == '\\') ? dir + name : dir + "/" + name;
+}
+
+// Decode 'obj' into a pixel job. PDFium's bitmap is copied so the worker can
+// convert and encode it after the page is closed.
+bool DecodeImage(FPDF_DOCUMENT doc, FPDF_PAGE page, FPDF_PAGEOBJECT obj, ExtractJob& job) {
+    static MetricHistogram& decodeMs = Metrics_Histogram("image_decode.ms");
+    MetricTimer timer(decodeMs);
+    bool needsDestroy = false;
+    FPDF_BITMAP bmp = PdfAcquireBitmapForImage(doc, page, obj, needsDestroy);
+    if (!bmp) return false;
+    const uint8_t* buf = static_cast<const uint8_t*>(FPDFBitmap_GetBuffer(bmp));
+    job.width = FPDFBitmap_GetWidth(bmp);
+    job.height = FPDFBitmap_GetHeight(bmp);
+    job.stride = FPDFBitmap_GetStride(bmp);
+    job.format = FPDFBitmap_GetFormat(bmp);
+    const bool ok = buf && job.width > 0 && job.height > 0 && job.stride > 0;
+    if (ok) job.data.assign(buf, buf + (size_t)job.stride * job.height);
+    if (needsDestroy) FPDFBitmap_Destroy(bmp);
+    return ok;
+}
+
+} // namespace
+
+bool PdfExtractAllImages(const std::string& pdfPathUtf8, const ImageExtractOptions& options,
+                         const ImageEncodeFn& encode, const ImageExtractProgressFn& progress,
+                         ImageExtractProgress& result, std::string& error) {
+    result = ImageExtractProgress {};
+    PDFWV_TRACE_SCOPE("image", "extract_all");
+    const auto t0 = std::chrono::steady_clock::now();
+
+    // Private instance: the viewer's document and its page caches are left alone.
+    FPDF_DOCUMENT doc = FPDF_LoadDocument(pdfPathUtf8.c_str(), nullptr);
+    if (!doc) {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "FPDF_LoadDocument failed (error %lu)", FPDF_GetLastError());
+        error = buf;
+        return false;
+    }
+    result.pageCount = FPDF_GetPageCount(doc);
+
+    ExtractQueue q;
+    const int hw = (int)std::thread::hardware_concurrency();
+    const int threads = options.threads > 0 ? options.threads : std::max(1, hw - 1);
+    std::vector<std::thread> pool;
+    for (int i = 0; i < threads; ++i) pool.emplace_back(RunWorker, std::ref(q), std::cref(encode));
+
+    int decodeFailed = 0;
+    auto snapshot = [&] {
+        result.imagesWritten = q.written.load(std::memory_order_relaxed);
+        result.passthrough = q.passthrough.load(std::memory_order_relaxed);
+        result.failed = q.failed.load(std::memory_order_relaxed) + decodeFailed;
+        result.bytesWritten = q.bytesWritten.load(std::memory_order_relaxed);
+        result.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    };
+    auto push = [&](ExtractJob&& job) {
+        std::unique_lock<std::mutex> lk(q.mutex);
+        // Bounded: wait for workers unless the queue is empty (one oversized image still goes through).
+        q.drained.wait(lk, [&] { return q.jobs.empty() || q.queuedBytes + job.data.size() <= options.maxQueuedBytes; });
+        q.queuedBytes += job.data.size();
+        q.jobs.push_back(std::move(job));
+        lk.unlock();
+        q.ready.notify_one();
+    };
+
+    std::unordered_set<uint32_t> seenObjects;
+    std::unordered_set<uint64_t> seenStreams;
+    std::unordered_set<uint64_t> seenPixels;
+    std::vector<FPDF_PAGEOBJECT> images;
+    std::vector<uint8_t> stream;
+    for (int p = 0; p < result.pageCount && !result.cancelled; ++p) {
+        {
+            PDFWV_TRACE_SCOPE_PAGE("image", "extract_page", p);
+            FPDF_PAGE page = FPDF_LoadPage(doc, p);
+            if (page) {
+                images.clear();
+                const int count = FPDFPage_CountObjects(page);
+                for (int i = 0; i < count; ++i) {
+                    if (FPDF_PAGEOBJECT obj = FPDFPage_GetObject(page, i)) CollectImages(obj, images);
+                }
+                int n = 0;
+                for (FPDF_PAGEOBJECT obj : images) {
+                    ++result.imagesFound;
+                    const uint32_t objNum = options.objectNumber ? options.objectNumber(obj) : 0;
+                    if (objNum && !seenObjects.insert(objNum).second) {
+                        ++result.duplicates;
+                        continue;
+                    }
+                    char name[48];
+                    snprintf(name, sizeof(name), "p%04d_%03d", p + 1, ++n);
+                    ExtractJob job;
+                    job.path = JoinPath(options.outDir, name);
+
+                    PdfRawImage raw;
+                    uint64_t hash = 0;
+                    bool byContent = false;
+                    if (options.passthrough && PdfExtractRawImage(page, obj, raw, options.paramsPlain)) {
+                        // Written as-is: equal bytes make equal files.
+                        hash = PdfHashBytes(raw.data.data(), raw.data.size());
+                        byContent = true;
+                        job.raw = true;
+                        job.path += '.';
+                        job.path += raw.extension;
+                        job.data = std::move(raw.data);
+                    } else if (options.paramsHash) {
+                        // Decoded: equal only if the decode parameters match too. An
+                        // empty read is a failure, not content, and is never deduped.
+                        const unsigned long len = FPDFImageObj_GetImageDataRaw(obj, nullptr, 0);
+                        stream.resize(len);
+                        if (len && FPDFImageObj_GetImageDataRaw(obj, stream.data(), len) == len) {
+                            hash = PdfImageStreamHash(page, obj, stream.data(), len, options.paramsHash(obj));
+                            byContent = true;
+                        }
+                    }
+                    // Skip duplicates before paying for the decode.
+                    if (byContent && !seenStreams.insert(hash).second) {
+                        ++result.duplicates;
+                        --n;
+                        continue;
+                    }
+                    if (!job.raw && !DecodeImage(doc, page, obj, job)) {
+                        ++decodeFailed;
+                        continue;
+                    }
+                    // Nothing told the stream apart beforehand: equal pixels
+                    // still make equal files, so at least skip the encode and write.
+                    if (!job.raw && !byContent) {
+                        const uint32_t dims[] = {(uint32_t)job.width, (uint32_t)job.height, (uint32_t)job.format};
+                        const uint64_t pixels = PdfHashBytes(job.data.data(), job.data.size()) ^
+                                                PdfHashBytes(reinterpret_cast<const uint8_t*>(dims), sizeof(dims));
+                        if (!seenPixels.insert(pixels).second) {
+                            ++result.duplicates;
+                            ++result.decodedDuplicates;
+                            --n;
+                            continue;
+                        }
+                    }
+                    push(std::move(job));
+                }
+                FPDF_ClosePage(page);
+            } else {
+                ++decodeFailed;
+            }
+        }
+        result.pagesDone = p + 1;
+        snapshot();
+        if (progress && !progress(result)) result.cancelled = true;
+    }
+    FPDF_CloseDocument(doc);
+
+    {
+        std::lock_guard<std::mutex> lk(q.mutex);
+        if (result.cancelled) {
+            for (const ExtractJob& job : q.jobs) q.queuedBytes -= job.data.size();
+            q.jobs.clear();
+        }
+        q.closed = true;
+    }
+    q.ready.notify_all();
+    for (std::thread& t : pool) t.join();
+
+    snapshot();
+    if (progress) progress(result);
+    return true;
+}
@@ -0,0 +1,75 @@
+// Batch extraction of every image in a document, shared by macOS/Windows frontends
+//
+// PDFium is not thread-safe, not even across separate FPDF_DOCUMENTs (font
+// and codec caches are process-wide), so the calling thread is the only one
+// that touches PDFium. It opens a private instance of the document, walks all
+// pages including nested form XObjects, fetches each image's stream and
+// dedupes it by object number and by a hash of the stream bytes and its
+// decode parameters (passed-through streams: the bytes alone). Without those
+// hooks (Windows: the public API has neither) decoded images are deduped by
+// their pixels, after the decode. Unique images are either taken as-is (DCTDecode/JPXDecode, see PdfExtractRawImage)
+// or decoded to pixels, then queued. Worker threads do everything that does
+// not need PDFium: pixel conversion, encoding (platform callback) and writes.
+//
+// Feeds the metrics registry: histograms "image_decode.ms" and
+// "image_encode.ms", counter "image_extract.bytes". Deliberately bypasses the
+// decoded-image cache (image_cache.h): each image is decoded once anyway.
+#pragma once
+
+#include <fpdfview.h>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+struct ImageExtractOptions {
+    std::string outDir;                     // UTF-8, must exist
+    int threads {0};                        // encoder workers, 0: hardware_concurrency - 1
+    bool passthrough {true};                // write DCT/JPX streams without re-encoding
+    size_t maxQueuedBytes {256u << 20};     // decoded pixels waiting for a worker
+    // Object number of an image XObject, 0 for inline images. Optional: skips
+    // fetching a shared XObject's stream again.
+    uint32_t (*objectNumber)(FPDF_PAGEOBJECT) {nullptr};
+    // Hash of the decode parameters the public API does not expose (/Decode,
+    // /SMask, ...), e.g. PdfiumEx_GetImageParamsHash. Optional: without it,
+    // equal stream bytes may still decode differently, so images that get
+    // decoded are deduped by their pixels once decoded.
+    uint64_t (*paramsHash)(FPDF_PAGEOBJECT) {nullptr};
+    // Whether the image dictionary lets its stream be written as-is, e.g.
+    // PdfiumEx_IsImageParamsPlain (no /Decode, no /ImageMask). Optional, see
+    // PdfExtractRawImage: without it CMYK streams are decoded.
+    int (*paramsPlain)(FPDF_PAGEOBJECT) {nullptr};
+};
+
+struct ImageExtractProgress {
+    int pagesDone {0}, pageCount {0};
+    int imagesFound {0};                    // image objects seen, duplicates included
+    int imagesWritten {0};
+    int passthrough {0};                    // of imagesWritten, stream copied as-is
+    int duplicates {0};                     // same object, same stream bytes or same pixels
+    int decodedDuplicates {0};              // of duplicates, only recognised after decoding
+    int failed {0};
+    uint64_t bytesWritten {0};
+    double elapsedMs {0.0};
+    bool cancelled {false};
+
+    double ImagesPerSecond() const { return elapsedMs > 0 ? imagesWritten * 1000.0 / elapsedMs : 0.0; }
+    double MegabytesPerSecond() const { return elapsedMs > 0 ? bytesWritten / 1048.576 / elapsedMs : 0.0; }
+};
+
+// Encode 8-bit BGRA pixels (top-down, 'stride' bytes per row) to 'pathUtf8'
+// (extension ".png" already appended) and return the file size, 0 on
+// failure. Called concurrently from worker threads.
+using ImageEncodeFn = std::function<uint64_t(const std::string& pathUtf8, const uint8_t* bgra,
+                                             int width, int height, int stride)>;
+
+// Called on the calling thread after every page and once at the end; return
+// false to cancel. Frontends pump their event loop from here.
+using ImageExtractProgressFn = std::function<bool(const ImageExtractProgress&)>;
+
+// Files are named p<page>_<n>.<ext> after the first page an image appears on.
+// Returns false only if the document cannot be opened ('error' says why);
+// per-image failures are counted in 'result'.
+bool PdfExtractAllImages(const std::string& pdfPathUtf8, const ImageExtractOptions& options,
+                         const ImageEncodeFn& encode, const ImageExtractProgressFn& progress,
+                         ImageExtractProgress& result, std::string& error);
@@ -0,0 +1,348 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(_WIN32)
+#include "async_log.h" // AsyncLog_Utf8ToWide
+#endif
+
+namespace {
+
+struct Registry {
+    std::mutex mutex;
+    std::map<std::string, std::unique_ptr<MetricHistogram>> histograms;
+    std::map<std::string, std::unique_ptr<MetricCounter>> counters;
+};
+
+Registry& Reg() {
+    static Registry* r = new Registry(); // intentionally leaked: metrics may be touched during exit
+    return *r;
+}
+
+int FloorLog2(uint64_t v) {
+    int e = 0;
+    while (v >>= 1) ++e;
+    return e;
+}
+
+void AppendJsonKey(std::string& out, const std::string& key) {
+    out += '"';
+    for (char c : key) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    out += "\":";
+}
+
+} // namespace
+
+// ---- MetricHistogram ----
+
+int MetricHistogram::BucketIndex(uint64_t us) {
+    if (us < (uint64_t)kSubCount) return (int)us;
+    int e = FloorLog2(us);
+    if (e > kMaxExponent) return kBucketCount - 1;
+    const int sub = (int)((us >> (e - kSubBits)) & (kSubCount - 1));
+    return kSubCount + (e - kSubBits) * kSubCount + sub;
+}
+
+uint64_t MetricHistogram::BucketUpperBound(int index) {
+    if (index < kSubCount) return (uint64_t)index;
+    const int e = (index - kSubCount) / kSubCount + kSubBits;
+    const uint64_t sub = (uint64_t)((index - kSubCount) % kSubCount);
+    const uint64_t width = 1ull << (e - kSubBits);
+    return (1ull << e) + sub * width + (width - 1);
+}
+
+void MetricHistogram::Record(double ms) {
+    RecordMicros(ms <= 0.0 ? 0 : (uint64_t)std::llround(ms * 1000.0));
+}
+
+void MetricHistogram::RecordMicros(uint64_t us) {
+    buckets_[BucketIndex(us)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(us, std::memory_order_relaxed);
+    uint64_t prev = max_.load(std::memory_order_relaxed);
+    while (us > prev && !max_.compare_exchange_weak(prev, us, std::memory_order_relaxed)) {
+    }
+}
+
+void MetricHistogram::Reset() {
+    for (auto& b : buckets_) b.store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+double MetricHistogram::MeanMs() const {
+    const uint64_t n = Count();
+    return n ? (double)sum_.load(std::memory_order_relaxed) / (double)n / 1000.0 : 0.0;
+}
+
+double MetricHistogram::PercentileMs(double p) const {
+    const uint64_t n = Count();
+    if (n == 0) return 0.0;
+    p = std::clamp(p, 0.0, 100.0);
+    const uint64_t rank = std::max<uint64_t>(1, (uint64_t)std::ceil(p / 100.0 * (double)n));
+    uint64_t seen = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            // Never report above the exact maximum.
+            return (double)std::min(BucketUpperBound(i), max_.load(std::memory_order_relaxed)) / 1000.0;
+        }
+    }
+    return MaxMs();
+}
+
+// ---- MetricCounter ----
+
+void MetricCounter::UpdatePeak(int64_t v) {
+    int64_t prev = peak_.load(std::memory_order_relaxed);
+    while (v > prev && !peak_.compare_exchange_weak(prev, v, std::memory_order_relaxed)) {
+    }
+}
+
+void MetricCounter::Add(int64_t delta) {
+    UpdatePeak(value_.fetch_add(delta, std::memory_order_relaxed) + delta);
+}
+
+void MetricCounter::Set(int64_t value) {
+    value_.store(value, std::memory_order_relaxed);
+    UpdatePeak(value);
+}
+
+void MetricCounter::Set(int64_t value, int64_t peak) {
+    value_.store(value, std::memory_order_relaxed);
+    UpdatePeak(std::max(value, peak));
+}
+
+void MetricCounter::Reset() {
+    value_.store(0, std::memory_order_relaxed);
+    peak_.store(0, std::memory_order_relaxed);
+}
+
+// ---- Registry ----
+
+MetricHistogram& Metrics_Histogram(const char* name) {
+    Registry& r = Reg();
+    std::lock_guard<std::mutex> lk(r.mutex);
+    auto& slot = r.histograms[name ? name : ""];
+    if (!slot) slot = std::make_unique<MetricHistogram>();
+    return *slot;
+}
+
+MetricCounter& Metrics_Counter(const char* name) {
+    Registry& r = Reg();
+    std::lock_guard<std::mutex> lk(r.mutex);
+    auto& slot = r.counters[name ? name : ""];
+    if (!slot) slot = std::make_unique<MetricCounter>();
+    return *slot;
+}
+
+MetricHistogram& Metrics_RenderLatency(double zoomPct) {
+    static MetricHistogram& z50 = Metrics_Histogram("render.ms.zoom_<=50");
+    static MetricHistogram& z100 = Metrics_Histogram("render.ms.zoom_<=100");
+    static MetricHistogram& z200 = Metrics_Histogram("render.ms.zoom_<=200");
+    static MetricHistogram& z400 = Metrics_Histogram("render.ms.zoom_<=400");
+    static MetricHistogram& zmax = Metrics_Histogram("render.ms.zoom_>400");
+    if (zoomPct <= 50.5) return z50;
+    if (zoomPct <= 100.5) return z100;
+    if (zoomPct <= 200.5) return z200;
+    if (zoomPct <= 400.5) return z400;
+    return zmax;
+}
+
+MetricHistogram& Metrics_PageLoadLatency() {
+    static MetricHistogram& h = Metrics_Histogram("page_load.ms");
+    return h;
+}
+
+MetricHistogram& Metrics_HitTestLatency() {
+    static MetricHistogram& h = Metrics_Histogram("hit_test.ms");
+    return h;
+}
+
+MetricCacheCounters Metrics_CacheCounters(const char* cacheName) {
+    const std::string base = std::string("cache.") + (cacheName ? cacheName : "");
+    return {Metrics_Counter((base + ".hit").c_str()), Metrics_Counter((base + ".miss").c_str())};
+}
+
+void Metrics_SetCacheTotals(const char* cacheName, uint64_t hits, uint64_t misses) {
+    const std::string base = std::string("cache.") + (cacheName ? cacheName : "");
+    Metrics_Counter((base + ".hit").c_str()).Set((int64_t)hits);
+    Metrics_Counter((base + ".miss").c_str()).Set((int64_t)misses);
+}
+
+// ---- Memory accounting ----
+
+namespace {
+
+constexpr int kMemCategoryCount = (int)MemCategory::Count;
+
+const char* const kMemCategoryNames[kMemCategoryCount] = {
+    "render_bitmap", "text_page", "object_info", "object_tree",
+    "pdfium_ex_string", "mapping_cache", "reference_graph", "search_index",
+    "decoded_image", "text_geometry",
+};
+
+bool IsMemoryGauge(const std::string& name) { return name.compare(0, 4, "mem.") == 0; }
+
+struct MemoryGauges {
+    MetricCounter* categories[kMemCategoryCount] {};
+    MetricCounter* total {nullptr};
+};
+
+const MemoryGauges& Mem() {
+    static const MemoryGauges g = [] {
+        MemoryGauges m;
+        for (int i = 0; i < kMemCategoryCount; ++i)
+            m.categories[i] = &Metrics_Counter((std::string("mem.") + kMemCategoryNames[i]).c_str());
+        m.total = &Metrics_Counter("mem.total");
+        return m;
+    }();
+    return g;
+}
+
+} // namespace
+
+const char* Metrics_MemoryCategoryName(MemCategory c) {
+    const int i = (int)c;
+    return i >= 0 && i < kMemCategoryCount ? kMemCategoryNames[i] : "unknown";
+}
+
+MetricCounter& Metrics_Memory(MemCategory c) {
+    return *Mem().categories[std::clamp((int)c, 0, kMemCategoryCount - 1)];
+}
+
+void Metrics_MemoryAdd(MemCategory c, int64_t deltaBytes) {
+    if (deltaBytes == 0) return;
+    Metrics_Memory(c).Add(deltaBytes);
+    Mem().total->Add(deltaBytes);
+}
+
+void Metrics_MemorySet(MemCategory c, int64_t liveBytes, int64_t peakBytes) {
+    MetricCounter& gauge = Metrics_Memory(c);
+    const int64_t previous = gauge.Value();
+    gauge.Set(liveBytes, peakBytes);
+    if (liveBytes != previous) Mem().total->Add(liveBytes - previous);
+}
+
+std::string Metrics_FormatMemory() {
+    const MemoryGauges& m = Mem();
+    const double total = (double)m.total->Value();
+    std::string out;
+    char line[160];
+    snprintf(line, sizeof(line), "%-24s %10s %10s %6s\n", "memory (KB)", "live", "peak", "share");
+    out += line;
+    for (int i = 0; i < kMemCategoryCount; ++i) {
+        const MetricCounter& c = *m.categories[i];
+        if (c.Value() == 0 && c.Peak() == 0) continue;
+        snprintf(line, sizeof(line), "%-24s %10.1f %10.1f %5.1f%%\n", kMemCategoryNames[i], c.Value() / 1024.0,
+                 c.Peak() / 1024.0, total > 0 ? 100.0 * (double)c.Value() / total : 0.0);
+        out += line;
+    }
+    snprintf(line, sizeof(line), "%-24s %10.1f %10.1f\n", "total", total / 1024.0, m.total->Peak() / 1024.0);
+    out += line;
+    return out;
+}
+
+void Metrics_ResetAll() {
+    Mem(); // register the memory gauges before taking the registry lock
+    Registry& r = Reg();
+    std::lock_guard<std::mutex> lk(r.mutex);
+    for (auto& it : r.histograms) it.second->Reset();
+    for (auto& it : r.counters) {
+        if (IsMemoryGauge(it.first)) it.second->ResetPeak();
+        else it.second->Reset();
+    }
+}
+
+std::string Metrics_FormatSummary() {
+    const std::string memory = Metrics_FormatMemory();
+    Registry& r = Reg();
+    std::lock_guard<std::mutex> lk(r.mutex);
+    std::string out;
+    char line[256];
+    snprintf(line, sizeof(line), "%-24s %8s %9s %9s %9s %9s\n", "latency (ms)", "count", "p50", "p90", "p99", "max");
+    out += line;
+    for (const auto& it : r.histograms) {
+        const MetricHistogram& h = *it.second;
+        if (h.Count() == 0) continue;
+        snprintf(line, sizeof(line), "%-24s %8llu %9.2f %9.2f %9.2f %9.2f\n", it.first.c_str(),
+                 (unsigned long long)h.Count(), h.PercentileMs(50), h.PercentileMs(90), h.PercentileMs(99), h.MaxMs());
+        out += line;
+    }
+    // Cache hit rates from ".hit"/".miss" pairs; other counters as value/peak.
+    for (const auto& it : r.counters) {
+        const std::string& name = it.first;
+        if (name.size() > 4 && name.compare(name.size() - 4, 4, ".hit") == 0) {
+            const std::string base = name.substr(0, name.size() - 4);
+            auto miss = r.counters.find(base + ".miss");
+            const int64_t hits = it.second->Value();
+            const int64_t misses = miss != r.counters.end() ? miss->second->Value() : 0;
+            const int64_t total = hits + misses;
+            snprintf(line, sizeof(line), "%-24s hit %5.1f%% (%lld/%lld)\n", base.c_str(),
+                     total ? 100.0 * (double)hits / (double)total : 0.0, (long long)hits, (long long)total);
+            out += line;
+        } else if ((name.size() > 5 && name.compare(name.size() - 5, 5, ".miss") == 0) || IsMemoryGauge(name)) {
+            continue;
+        } else {
+            snprintf(line, sizeof(line), "%-24s %lld (peak %lld)\n", name.c_str(), (long long)it.second->Value(),
+                     (long long)it.second->Peak());
+            out += line;
+        }
+    }
+    out += memory;
+    return out;
+}
+
+std::string Metrics_ToJson() {
+    Registry& r = Reg();
+    std::lock_guard<std::mutex> lk(r.mutex);
+    std::string out = "{\"histograms\":{";
+    char buf[256];
+    bool first = true;
+    for (const auto& it : r.histograms) {
+        const MetricHistogram& h = *it.second;
+        if (!first) out += ',';
+        first = false;
+        AppendJsonKey(out, it.first);
+        snprintf(buf, sizeof(buf),
+                 "{\"count\":%llu,\"mean\":%.3f,\"p50\":%.3f,\"p90\":%.3f,\"p99\":%.3f,\"p999\":%.3f,\"max\":%.3f}",
+                 (unsigned long long)h.Count(), h.MeanMs(), h.PercentileMs(50), h.PercentileMs(90),
+                 h.PercentileMs(99), h.PercentileMs(99.9), h.MaxMs());
+        out += buf;
+    }
+    out += "},\"counters\":{";
+    first = true;
+    for (const auto& it : r.counters) {
+        if (!first) out += ',';
+        first = false;
+        AppendJsonKey(out, it.first);
+        snprintf(buf, sizeof(buf), "{\"value\":%lld,\"peak\":%lld}", (long long)it.second->Value(),
+                 (long long)it.second->Peak());
+        out += buf;
+    }
+    out += "}}";
+    return out;
+}
+
+bool Metrics_DumpJson(const char* pathUtf8) {
+    if (!pathUtf8 || !pathUtf8[0]) return false;
+    const std::string json = Metrics_ToJson();
+#if defined(_WIN32)
+    FILE* f = _wfopen(AsyncLog_Utf8ToWide(pathUtf8).c_str(), L"wb");
+#else
+    FILE* f = fopen(pathUtf8, "wb");
+#endif
+    if (!f) return false;
+    const bool ok = fwrite(json.data(), 1, json.size(), f) == json.size();
+    return fclose(f) == 0 && ok;
+}
@@ -0,0 +1,141 @@
+// Live metrics registry shared by macOS/Windows frontends
+//
+// Histograms are HDR-style (log-linear buckets, ~3% relative precision,
+// 1 us .. hours) with lock-free Record(); counters double as gauges and keep
+// their peak. Metrics are created on first lookup and live until exit, so
+// call sites can cache the returned reference in a function-local static.
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+class MetricHistogram {
+public:
+    static constexpr int kSubBits = 5;                   // 32 sub-buckets per power of two
+    static constexpr int kSubCount = 1 << kSubBits;
+    static constexpr int kMaxExponent = 42;              // ~4.4e12 us
+    static constexpr int kBucketCount = kSubCount + (kMaxExponent - kSubBits + 1) * kSubCount;
+
+    void Record(double ms);
+    void RecordMicros(uint64_t us);
+    void Reset();
+
+    uint64_t Count() const { return count_.load(std::memory_order_relaxed); }
+    double MeanMs() const;
+    double MaxMs() const { return max_.load(std::memory_order_relaxed) / 1000.0; }
+    // p in [0, 100]; returns the highest value equivalent to the bucket holding the p-th percentile.
+    double PercentileMs(double p) const;
+
+private:
+    static int BucketIndex(uint64_t us);
+    static uint64_t BucketUpperBound(int index);
+
+    std::atomic<uint64_t> buckets_[kBucketCount] {};
+    std::atomic<uint64_t> count_ {0};
+    std::atomic<uint64_t> sum_ {0};
+    std::atomic<uint64_t> max_ {0};
+};
+
+// Monotonic counter or gauge (Add negative values / Set). Tracks the peak value.
+class MetricCounter {
+public:
+    void Add(int64_t delta);
+    void Set(int64_t value);
+    // Gauge mirrored from another component that tracks its own peak.
+    void Set(int64_t value, int64_t peak);
+    void Reset();
+    void ResetPeak() { peak_.store(Value(), std::memory_order_relaxed); }
+    int64_t Value() const { return value_.load(std::memory_order_relaxed); }
+    int64_t Peak() const { return peak_.load(std::memory_order_relaxed); }
+
+private:
+    void UpdatePeak(int64_t v);
+    std::atomic<int64_t> value_ {0};
+    std::atomic<int64_t> peak_ {0};
+};
+
+// Records the scope's wall time into a histogram.
+class MetricTimer {
+public:
+    explicit MetricTimer(MetricHistogram& h) : h_(h), t0_(std::chrono::steady_clock::now()) {}
+    ~MetricTimer() {
+        h_.RecordMicros((uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::steady_clock::now() - t0_).count());
+    }
+    MetricTimer(const MetricTimer&) = delete;
+    MetricTimer& operator=(const MetricTimer&) = delete;
+
+private:
+    MetricHistogram& h_;
+    std::chrono::steady_clock::time_point t0_;
+};
+
+// Lookup-or-create by name. References stay valid until process exit.
+MetricHistogram& Metrics_Histogram(const char* name);
+MetricCounter& Metrics_Counter(const char* name);
+
+// Well-known metrics
+MetricHistogram& Metrics_RenderLatency(double zoomPct); // render.ms.zoom_<=50 .. render.ms.zoom_>400
+MetricHistogram& Metrics_PageLoadLatency();             // page_load.ms
+MetricHistogram& Metrics_HitTestLatency();              // hit_test.ms
+// Cache hit/miss pair: counters "cache.<name>.hit" / "cache.<name>.miss".
+// Resolve once into a function-local static; Record() is then a single
+// relaxed atomic add, no lookup or lock:
+//   static MetricCacheCounters cacheStats = Metrics_CacheCounters("hit_map");
+//   cacheStats.Record(found);
+struct MetricCacheCounters {
+    MetricCounter& hit;
+    MetricCounter& miss;
+    void Record(bool isHit) const { (isHit ? hit : miss).Add(1); }
+};
+MetricCacheCounters Metrics_CacheCounters(const char* cacheName);
+void Metrics_SetCacheTotals(const char* cacheName, uint64_t hits, uint64_t misses);
+
+// Tracked memory by subsystem: gauges "mem.<category>" in bytes, plus
+// "mem.total" over all categories (its peak is the highest simultaneous sum,
+// not the sum of per-category peaks). Only memory the app owns or can size is
+// counted; PDFium's internal caches stay in the process-wide figures.
+enum class MemCategory {
+    RenderBitmap,     // page bitmaps: drawRect:/WM_PAINT buffers, PNG export
+    TextPage,         // live FPDF_TEXTPAGE handles (estimated, see PdfEstimateTextPageBytes)
+    ObjectInfo,       // pdfium_ex PDFIUM_EX_OBJECT_INFO results
+    ObjectTree,       // pdfium_ex object reference trees (inspector)
+    PdfiumExString,   // strings returned by pdfium_ex while the caller holds them
+    MappingCache,     // pdfium_ex page-object mapping cache
+    ReferenceGraph,   // pdfium_ex per-document reference graph
+    SearchIndex,      // text search indexes
+    DecodedImage,     // decoded image bitmaps held by the image cache (and its handles)
+    TextGeometry,     // per-page char geometry for selection (text_geometry)
+    Count
+};
+const char* Metrics_MemoryCategoryName(MemCategory c);   // "render_bitmap", ...
+MetricCounter& Metrics_Memory(MemCategory c);
+void Metrics_MemoryAdd(MemCategory c, int64_t deltaBytes);
+// Mirror a category accounted elsewhere (e.g. PdfiumEx_GetMemoryStats).
+void Metrics_MemorySet(MemCategory c, int64_t liveBytes, int64_t peakBytes);
+
+// Charges 'bytes' to a category for the scope's lifetime.
+class MemoryCharge {
+public:
+    MemoryCharge(MemCategory c, int64_t bytes) : c_(c), bytes_(bytes) { Metrics_MemoryAdd(c_, bytes_); }
+    ~MemoryCharge() { Metrics_MemoryAdd(c_, -bytes_); }
+    MemoryCharge(const MemoryCharge&) = delete;
+    MemoryCharge& operator=(const MemoryCharge&) = delete;
+
+private:
+    MemCategory c_;
+    int64_t bytes_;
+};
+
+// Memory gauges keep their live value; only peaks restart.
+void Metrics_ResetAll();
+
+// Fixed-width text table: histograms (count/p50/p90/p99/max), cache hit rates,
+// counters, then the memory breakdown.
+std::string Metrics_FormatSummary();
+// Live/peak bytes per memory category with share of the tracked total.
+std::string Metrics_FormatMemory();
+std::string Metrics_ToJson();
+bool Metrics_DumpJson(const char* pathUtf8);
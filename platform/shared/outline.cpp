@@ -0,0 +1,252 @@
+#include "outline.h"
+#include "metrics.h"
+
+#include <fpdf_doc.h>
+
+#include <algorithm>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+constexpr size_t kMaxEntries = 1u << 20;
+
+int BookmarkPage(FPDF_DOCUMENT doc, FPDF_BOOKMARK bm) {
+    FPDF_DEST dest = FPDFBookmark_GetDest(doc, bm);
+    if (!dest) {
+        FPDF_ACTION action = FPDFBookmark_GetAction(bm);
+        if (action) dest = FPDFAction_GetDest(doc, action);
+    }
+    return dest ? FPDFDest_GetDestPageIndex(doc, dest) : -1;
+}
+
+class Builder {
+public:
+    explicit Builder(FPDF_DOCUMENT doc) : doc_(doc) {}
+
+    PdfOutline Build() {
+        int first = 0;
+        AppendChildren(nullptr, -1, first, out_.topCount);
+        // Depth-first in document order: ranks decide ties in the page index.
+        std::vector<int> stack;
+        for (int i = out_.topCount - 1; i >= 0; --i) stack.push_back(i);
+        std::vector<int> rank(out_.entries.size(), 0);
+        int nextRank = 0;
+        while (!stack.empty()) {
+            const int i = stack.back();
+            stack.pop_back();
+            rank[i] = nextRank++;
+            int childFirst = 0, childCount = 0;
+            AppendChildren(handles_[i], i, childFirst, childCount);
+            out_.entries[i].firstChild = childFirst;
+            out_.entries[i].childCount = childCount;
+            rank.resize(out_.entries.size(), 0);
+            for (int c = childFirst + childCount - 1; c >= childFirst; --c) stack.push_back(c);
+        }
+        BuildPageIndex(rank);
+        out_.titles.shrink_to_fit();
+        return std::move(out_);
+    }
+
+private:
+    void AppendChildren(FPDF_BOOKMARK parentBm, int parent, int& first, int& count) {
+        first = (int)out_.entries.size();
+        for (FPDF_BOOKMARK bm = FPDFBookmark_GetFirstChild(doc_, parentBm); bm && out_.entries.size() < kMaxEntries;
+             bm = FPDFBookmark_GetNextSibling(doc_, bm)) {
+            if (!seen_.insert(bm).second) break;    // malformed outline: cycle
+            PdfOutlineEntry e;
+            e.parent = parent;
+            e.pageIndex = BookmarkPage(doc_, bm);
+            InternTitle(bm, e);
+            out_.entries.push_back(e);
+            handles_.push_back(bm);
+        }
+        count = (int)out_.entries.size() - first;
+    }
+
+    void InternTitle(FPDF_BOOKMARK bm, PdfOutlineEntry& e) {
+        const unsigned long bytes = FPDFBookmark_GetTitle(bm, nullptr, 0);
+        if (bytes <= 2) return;
+        title_.resize(bytes / 2);
+        FPDFBookmark_GetTitle(bm, title_.data(), bytes);
+        title_.resize(bytes / 2 - 1);
+        auto [it, inserted] = interned_.try_emplace(title_, (uint32_t)out_.titles.size());
+        if (inserted) out_.titles += title_;
+        e.titleOffset = it->second;
+        e.titleLength = (uint32_t)title_.size();
+    }
+
+    void BuildPageIndex(const std::vector<int>& rank) {
+        std::vector<std::tuple<int, int, int>> byPage;  // page, rank, entry
+        for (int i = 0; i < (int)out_.entries.size(); ++i) {
+            if (out_.entries[i].pageIndex >= 0) byPage.emplace_back(out_.entries[i].pageIndex, rank[i], i);
+        }
+        std::sort(byPage.begin(), byPage.end());
+        for (const auto& [page, r, entry] : byPage) {
+            if (!out_.pageStarts.empty() && out_.pageStarts.back() == page) continue;
+            out_.pageStarts.push_back(page);
+            out_.pageEntries.push_back(entry);
+        }
+    }
+
+    FPDF_DOCUMENT doc_;
+    PdfOutline out_;
+    std::vector<FPDF_BOOKMARK> handles_;            // per entry, for walking children
+    std::unordered_set<FPDF_BOOKMARK> seen_;
+    std::unordered_map<std::u16string, uint32_t> interned_;
+    std::u16string title_;
+};
+
+char16_t FoldCase(char16_t c) {
+    return (c >= u'A' && c <= u'Z') ? char16_t(c - u'A' + u'a') : c;
+}
+
+uint64_t Trigram(char16_t a, char16_t b, char16_t c) {
+    return ((uint64_t)a << 32) | ((uint64_t)b << 16) | (uint64_t)c;
+}
+
+} // namespace
+
+int PdfOutline::EntryForPage(int pageIndex) const {
+    auto it = std::upper_bound(pageStarts.begin(), pageStarts.end(), pageIndex);
+    if (it == pageStarts.begin()) return -1;
+    return pageEntries[(it - pageStarts.begin()) - 1];
+}
+
+PdfOutline PdfOutline_Build(FPDF_DOCUMENT doc) {
+    if (!doc) return PdfOutline();
+    static MetricHistogram& buildMs = Metrics_Histogram("outline.build_ms");
+    MetricTimer timer(buildMs);
+    return Builder(doc).Build();
+}
+
+PdfOutlineFilter PdfOutlineFilter_Build(const PdfOutline& outline) {
+    static MetricHistogram& buildMs = Metrics_Histogram("outline.filter_build_ms");
+    MetricTimer timer(buildMs);
+    PdfOutlineFilter f;
+    f.folded.resize(outline.titles.size());
+    std::transform(outline.titles.begin(), outline.titles.end(), f.folded.begin(), FoldCase);
+
+    // Distinct titles: interning gives equal titles the same offset.
+    std::unordered_map<uint32_t, int> titleOf;
+    std::vector<int> entryTitle(outline.entries.size(), -1);
+    for (int i = 0; i < (int)outline.entries.size(); ++i) {
+        const PdfOutlineEntry& e = outline.entries[i];
+        if (e.titleLength == 0) continue;
+        auto [it, inserted] = titleOf.try_emplace(e.titleOffset, (int)f.titleOffsets.size());
+        if (inserted) {
+            f.titleOffsets.push_back(e.titleOffset);
+            f.titleLengths.push_back(e.titleLength);
+        }
+        entryTitle[i] = it->second;
+    }
+    const size_t titles = f.titleOffsets.size();
+    f.titleEntryFirst.assign(titles + 1, 0);
+    for (int t : entryTitle) {
+        if (t >= 0) ++f.titleEntryFirst[t + 1];
+    }
+    for (size_t t = 0; t < titles; ++t) f.titleEntryFirst[t + 1] += f.titleEntryFirst[t];
+    f.titleEntries.resize(f.titleEntryFirst[titles]);
+    std::vector<int> fill(f.titleEntryFirst.begin(), f.titleEntryFirst.end() - 1);
+    for (int i = 0; i < (int)entryTitle.size(); ++i) {
+        if (entryTitle[i] >= 0) f.titleEntries[fill[entryTitle[i]]++] = i;
+    }
+
+    // Posting lists by counting sort: number the distinct trigrams, count
+    // titles per trigram, then fill. Titles are visited in ascending order,
+    // so each list comes out sorted; 'last' drops repeats within a title.
+    std::unordered_map<uint64_t, uint32_t> gramId;
+    std::vector<uint32_t> positions;    // trigram id at each title position
+    positions.reserve(f.folded.size());
+    std::vector<uint32_t> count, last;
+    for (uint32_t t = 0; t < (uint32_t)titles; ++t) {
+        const char16_t* s = f.folded.data() + f.titleOffsets[t];
+        const uint32_t n = f.titleLengths[t];
+        for (uint32_t i = 0; i < n; ++i) {
+            const char16_t b = i + 1 < n ? s[i + 1] : 0;
+            const char16_t c = i + 2 < n ? s[i + 2] : 0;
+            auto [it, inserted] = gramId.try_emplace(Trigram(s[i], b, c), (uint32_t)count.size());
+            if (inserted) {
+                count.push_back(0);
+                last.push_back(UINT32_MAX);
+            }
+            positions.push_back(it->second);
+            if (last[it->second] != t) {
+                last[it->second] = t;
+                ++count[it->second];
+            }
+        }
+    }
+    // Sort the trigrams for binary search and renumber ids to match.
+    f.grams.reserve(gramId.size());
+    for (const auto& [gram, id] : gramId) f.grams.push_back(gram);
+    std::sort(f.grams.begin(), f.grams.end());
+    std::vector<uint32_t> rank(f.grams.size());
+    for (uint32_t g = 0; g < (uint32_t)f.grams.size(); ++g) rank[gramId[f.grams[g]]] = g;
+    f.gramFirst.assign(f.grams.size() + 1, 0);
+    for (uint32_t id = 0; id < (uint32_t)count.size(); ++id) f.gramFirst[rank[id] + 1] = count[id];
+    for (size_t g = 0; g < f.grams.size(); ++g) f.gramFirst[g + 1] += f.gramFirst[g];
+    f.gramTitles.resize(f.gramFirst.back());
+    std::vector<uint32_t> gramFill(f.gramFirst.begin(), f.gramFirst.end() - 1);
+    std::fill(last.begin(), last.end(), UINT32_MAX);
+    size_t pos = 0;
+    for (uint32_t t = 0; t < (uint32_t)titles; ++t) {
+        for (uint32_t i = 0; i < f.titleLengths[t]; ++i) {
+            const uint32_t id = positions[pos++];
+            if (last[id] == t) continue;
+            last[id] = t;
+            f.gramTitles[gramFill[rank[id]]++] = t;
+        }
+    }
+    return f;
+}
+
+int PdfOutlineFilter_Match(const PdfOutline& outline, const PdfOutlineFilter& f,
+                           std::u16string_view query, std::vector<uint8_t>& flags) {
+    flags.assign(outline.entries.size(), 0);
+    std::u16string q(query);
+    std::transform(q.begin(), q.end(), q.begin(), FoldCase);
+    q.erase(std::remove(q.begin(), q.end(), u'\0'), q.end());
+    if (q.empty()) return 0;
+    static MetricHistogram& matchMs = Metrics_Histogram("outline.filter_ms");
+    MetricTimer timer(matchMs);
+
+    std::vector<uint8_t> titleHit(f.titleOffsets.size(), 0);
+    if (q.size() < 3) {
+        // Every occurrence starts a (padded) trigram: union the prefix range.
+        const uint64_t lo = q.size() == 1 ? Trigram(q[0], 0, 0) : Trigram(q[0], q[1], 0);
+        const uint64_t hi = q.size() == 1 ? Trigram(q[0], 0xFFFF, 0xFFFF) : Trigram(q[0], q[1], 0xFFFF);
+        const size_t first = std::lower_bound(f.grams.begin(), f.grams.end(), lo) - f.grams.begin();
+        const size_t last = std::upper_bound(f.grams.begin(), f.grams.end(), hi) - f.grams.begin();
+        for (uint32_t k = f.gramFirst[first]; k < f.gramFirst[last]; ++k) titleHit[f.gramTitles[k]] = 1;
+    } else {
+        // Shortest posting list among the query's trigrams, then verify.
+        size_t best = f.grams.size();
+        for (size_t i = 0; i + 2 < q.size(); ++i) {
+            auto it = std::lower_bound(f.grams.begin(), f.grams.end(), Trigram(q[i], q[i + 1], q[i + 2]));
+            if (it == f.grams.end() || *it != Trigram(q[i], q[i + 1], q[i + 2])) return 0;
+            const size_t g = it - f.grams.begin();
+            if (best == f.grams.size() || f.gramFirst[g + 1] - f.gramFirst[g] < f.gramFirst[best + 1] - f.gramFirst[best])
+                best = g;
+        }
+        const std::u16string_view folded(f.folded);
+        for (uint32_t k = f.gramFirst[best]; k < f.gramFirst[best + 1]; ++k) {
+            const uint32_t t = f.gramTitles[k];
+            if (folded.substr(f.titleOffsets[t], f.titleLengths[t]).find(q) != std::u16string_view::npos) titleHit[t] = 1;
+        }
+    }
+
+    int matches = 0;
+    for (size_t t = 0; t < titleHit.size(); ++t) {
+        if (!titleHit[t]) continue;
+        for (int k = f.titleEntryFirst[t]; k < f.titleEntryFirst[t + 1]; ++k) {
+            const int e = f.titleEntries[k];
+            flags[e] |= kPdfOutlineMatch;
+            ++matches;
+            for (int p = outline.entries[e].parent; p >= 0 && !(flags[p] & kPdfOutlineAncestor); p = outline.entries[p].parent)
+                flags[p] |= kPdfOutlineAncestor;
+        }
+    }
+    return matches;
+}
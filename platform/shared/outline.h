@@ -0,0 +1,80 @@
+// Flattened document outline (bookmarks) shared by macOS/Windows frontends
+//
+// The outline is walked once into a compact array: children of an entry are
+// contiguous, titles are interned into a single UTF-16 buffer, and each
+// entry's destination page is resolved up front. Frontends create tree items
+// only for rows they show and expand, instead of one UI object per bookmark
+// at open. A sorted page-interval index (distinct bookmarked pages, each with
+// its first bookmark in document order) answers "current bookmark for page N"
+// with a binary search. Main thread only (PDFium).
+#pragma once
+
+#include <fpdfview.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct PdfOutlineEntry {
+    int parent {-1};            // -1: top level
+    int firstChild {0};         // children are [firstChild, firstChild + childCount)
+    int childCount {0};
+    int pageIndex {-1};         // -1: no destination in this document
+    uint32_t titleOffset {0};   // into PdfOutline::titles
+    uint32_t titleLength {0};
+};
+
+struct PdfOutline {
+    std::vector<PdfOutlineEntry> entries;   // top-level entries are [0, topCount)
+    int topCount {0};
+    std::u16string titles;                  // interned titles, back to back
+    std::vector<int> pageStarts;            // ascending distinct bookmarked pages
+    std::vector<int> pageEntries;           // per page start: first bookmark in document order
+
+    bool Empty() const { return entries.empty(); }
+    std::u16string_view Title(int entry) const {
+        const PdfOutlineEntry& e = entries[entry];
+        return std::u16string_view(titles).substr(e.titleOffset, e.titleLength);
+    }
+    // Children of 'entry' (-1: the top level).
+    int ChildCount(int entry) const { return entry < 0 ? topCount : entries[entry].childCount; }
+    int Child(int entry, int index) const { return (entry < 0 ? 0 : entries[entry].firstChild) + index; }
+
+    // Bookmark covering 'pageIndex': the one with the greatest destination
+    // page <= pageIndex, the first in document order on ties. -1 if the page
+    // comes before every bookmarked page.
+    int EntryForPage(int pageIndex) const;
+};
+
+// Walk the outline of 'doc'. Malformed outlines (cycles, runaway sizes) are
+// cut short rather than rejected.
+PdfOutline PdfOutline_Build(FPDF_DOCUMENT doc);
+
+// Filter-as-you-type over titles: case-insensitive (ASCII) substring match
+// backed by a trigram index over the distinct interned titles. Every title
+// is padded with two sentinels, so one- and two-character queries are
+// prefix ranges of the same sorted trigram array. Longer queries take the
+// shortest posting list among their trigrams and verify each candidate.
+struct PdfOutlineFilter {
+    std::u16string folded;                  // PdfOutline::titles, ASCII lower-cased
+    std::vector<uint32_t> titleOffsets;     // distinct non-empty titles
+    std::vector<uint32_t> titleLengths;
+    std::vector<int> titleEntryFirst;       // entries per title: [first[t], first[t + 1])
+    std::vector<int> titleEntries;
+    std::vector<uint64_t> grams;            // ascending distinct trigrams
+    std::vector<uint32_t> gramFirst;        // postings per trigram: [first[g], first[g + 1])
+    std::vector<uint32_t> gramTitles;       // title ids, ascending per trigram
+};
+
+enum : uint8_t {
+    kPdfOutlineMatch = 1,       // title contains the query
+    kPdfOutlineAncestor = 2,    // has a matching descendant
+};
+
+PdfOutlineFilter PdfOutlineFilter_Build(const PdfOutline& outline);
+
+// Fill 'flags' (one per entry) with kPdfOutline* bits for 'query' and
+// return the number of matching entries. An empty query clears all flags.
+int PdfOutlineFilter_Match(const PdfOutline& outline, const PdfOutlineFilter& filter,
+                           std::u16string_view query, std::vector<uint8_t>& flags);
@@ -1,9 +1,13 @@
 #include "pdf_utils.h"
+#include "metrics.h"
 #include <algorithm>
+#include <cstring>
+#include <iterator>
 
 PdfHitImageResult PdfHitImageAt(FPDF_PAGE page, double pageX, double pageY, double pageHeight, float tolerancePx) {
     PdfHitImageResult result{};
     if (!page) return result;
+    MetricTimer timer(Metrics_HitTestLatency());
     
     // Convert from top-left origin to PDF coordinate system (bottom-left origin)
     float px = (float)pageX;
@@ -47,8 +51,8 @@ FPDF_BITMAP PdfAcquireBitmapForImage(FPDF_DOCUMENT doc,
     // 优先尝试获取原始高分辨率位图
     FPDF_BITMAP base = FPDFImageObj_GetBitmap(imageObj);
     if (base) {
-        // 原始位图不需要释放
-        outNeedsDestroy = false;
+        // FPDFImageObj_GetBitmap 返回新建的位图，由调用者释放
+        outNeedsDestroy = true;
         return base;
     }
     
@@ -63,3 +67,160 @@ FPDF_BITMAP PdfAcquireBitmapForImage(FPDF_DOCUMENT doc,
 }
 
 
+namespace {
+
+// Colour spaces a JPEG / JPEG 2000 reader shows the same way PDF does:
+// DeviceGray/RGB/CMYK and ICCBased with as many components. Image masks,
+// Indexed, Separation, DeviceN, Lab, ... report other families.
+bool IsDeviceColorSpace(FPDF_PAGE page, FPDF_PAGEOBJECT imageObj) {
+    FPDF_IMAGEOBJ_METADATA md {};
+    if (!FPDFImageObj_GetImageMetadata(imageObj, page, &md)) return false;
+    switch (md.colorspace) {
+    case FPDF_COLORSPACE_DEVICEGRAY: return md.bits_per_pixel == 8;
+    case FPDF_COLORSPACE_DEVICERGB: return md.bits_per_pixel == 24;
+    case FPDF_COLORSPACE_DEVICECMYK: return md.bits_per_pixel == 32;
+    case FPDF_COLORSPACE_ICCBASED:
+        return md.bits_per_pixel == 8 || md.bits_per_pixel == 24 || md.bits_per_pixel == 32;
+    default: return false;
+    }
+}
+
+// Four-component JPEG with an Adobe APP14 segment: readers follow Adobe and
+// take the samples as inverted CMYK, PDF takes them as they are.
+bool IsAdobeCmykJpeg(const std::vector<unsigned char>& d) {
+    if (d.size() < 4 || d[0] != 0xFF || d[1] != 0xD8) return false;
+    bool adobe = false;
+    int components = 0;
+    size_t pos = 2;
+    while (pos + 4 <= d.size()) {
+        if (d[pos] != 0xFF) return false;
+        const unsigned char marker = d[pos + 1];
+        if (marker == 0xFF) { ++pos; continue; }                    // fill byte
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) { pos += 2; continue; }
+        if (marker == 0xDA || marker == 0xD9) break;                // scan data follows
+        const size_t len = (size_t)d[pos + 2] << 8 | d[pos + 3];
+        const unsigned char* seg = d.data() + pos + 4;
+        if (len < 2 || pos + 2 + len > d.size()) break;
+        if (marker == 0xEE && len >= 7 && memcmp(seg, "Adobe", 5) == 0) {
+            adobe = true;
+        } else if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 &&
+                   marker != 0xCC && len >= 8) {
+            components = seg[5];
+        }
+        pos += 2 + len;
+    }
+    return adobe && components == 4;
+}
+
+} // namespace
+
+bool PdfExtractRawImage(FPDF_PAGE page, FPDF_PAGEOBJECT imageObj, PdfRawImage& out,
+                        int (*paramsPlain)(FPDF_PAGEOBJECT)) {
+    out = PdfRawImage {};
+    if (!imageObj || FPDFPageObj_GetType(imageObj) != FPDF_PAGEOBJ_IMAGE) return false;
+    const int nfilters = FPDFImageObj_GetImageFilterCount(imageObj);
+    if (nfilters <= 0) return false;
+
+    // 只有最后一个滤镜是图像编码时才能直通；之前的滤镜必须都是通用滤镜
+    static const char* const kImageFilters[] = {"DCTDecode", "JPXDecode", "JBIG2Decode", "CCITTFaxDecode", "RunLengthDecode"};
+    auto isImageFilter = [](const char* name) {
+        return std::any_of(std::begin(kImageFilters), std::end(kImageFilters),
+                           [name](const char* f) { return strcmp(name, f) == 0; });
+    };
+    for (int k = 0; k < nfilters; ++k) {
+        char name[32] {};
+        if (FPDFImageObj_GetImageFilter(imageObj, k, name, sizeof(name)) == 0) return false;
+        if (k < nfilters - 1) {
+            if (isImageFilter(name)) return false;
+        } else if (strcmp(name, "DCTDecode") == 0) {
+            out.filter = "DCTDecode";
+        } else if (strcmp(name, "JPXDecode") == 0) {
+            out.filter = "JPXDecode";
+        } else {
+            return false;
+        }
+    }
+
+    // The stream alone says nothing about /Decode, /ImageMask or a colour
+    // space a reader cannot reproduce; those images are decoded instead.
+    // Without 'paramsPlain' the dictionary is out of reach and /Decode cannot
+    // be seen, so CMYK (where inverting /Decode arrays are common) is decoded too.
+    if (!IsDeviceColorSpace(page, imageObj)) return false;
+    if (paramsPlain) {
+        if (!paramsPlain(imageObj)) return false;
+    } else {
+        FPDF_IMAGEOBJ_METADATA md {};
+        FPDFImageObj_GetImageMetadata(imageObj, page, &md);
+        if (md.bits_per_pixel == 32) return false;
+    }
+
+    // GetImageDataDecoded 只解除非图像滤镜，输出仍是 JPEG/JPEG 2000 码流
+    auto fetch = nfilters == 1 ? FPDFImageObj_GetImageDataRaw : FPDFImageObj_GetImageDataDecoded;
+    const unsigned long len = fetch(imageObj, nullptr, 0);
+    if (len == 0) return false;
+    out.data.resize(len);
+    if (fetch(imageObj, out.data.data(), len) != len) {
+        out.data.clear();
+        return false;
+    }
+
+    if (strcmp(out.filter, "DCTDecode") == 0) {
+        if (IsAdobeCmykJpeg(out.data)) {
+            out.data.clear();
+            return false;
+        }
+        out.extension = "jpg";
+    } else {
+        // JP2 文件头（签名框）或裸码流
+        static const unsigned char kJp2Signature[] = {0x00, 0x00, 0x00, 0x0C, 'j', 'P', ' ', ' '};
+        const bool jp2 = out.data.size() >= sizeof(kJp2Signature) &&
+                         memcmp(out.data.data(), kJp2Signature, sizeof(kJp2Signature)) == 0;
+        out.extension = jp2 ? "jp2" : "j2k";
+    }
+    return true;
+}
+
+uint64_t PdfHashBytes(const uint8_t* data, size_t n) {
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = 0; i < n; ++i) {
+        h ^= data[i];
+        h *= 1099511628211ull;
+    }
+    return h ^ (uint64_t)n * 0x9E3779B97F4A7C15ull;
+}
+
+uint64_t PdfImageStreamHash(FPDF_PAGE page, FPDF_PAGEOBJECT obj, const uint8_t* stream, size_t n,
+                            uint64_t paramsHash) {
+    FPDF_IMAGEOBJ_METADATA md {};
+    FPDFImageObj_GetImageMetadata(obj, page, &md);
+    std::string params;
+    const uint32_t dims[] = {md.width, md.height, md.bits_per_pixel, (uint32_t)md.colorspace};
+    params.append(reinterpret_cast<const char*>(dims), sizeof(dims));
+    params.append(reinterpret_cast<const char*>(&paramsHash), sizeof(paramsHash));
+    const int nfilters = FPDFImageObj_GetImageFilterCount(obj);
+    for (int k = 0; k < nfilters; ++k) {
+        char name[32] {};
+        FPDFImageObj_GetImageFilter(obj, k, name, sizeof(name));
+        params += name;
+        params += '/';
+    }
+    return PdfHashBytes(stream, n) ^
+           (PdfHashBytes(reinterpret_cast<const uint8_t*>(params.data()), params.size()) << 1);
+}
+
+
+FPDF_BITMAP PdfRenderPageRegion(FPDF_PAGE page, int pagePxW, int pagePxH,
+                                int offsetX, int offsetY, int outW, int outH, int flags) {
+    if (!page || pagePxW <= 0 || pagePxH <= 0 || outW <= 0 || outH <= 0) return nullptr;
+    FPDF_BITMAP bmp = FPDFBitmap_Create(outW, outH, 1);
+    if (!bmp) return nullptr;
+    FPDFBitmap_FillRect(bmp, 0, 0, outW, outH, 0xFFFFFFFF);
+    FPDF_RenderPageBitmap(bmp, page, -offsetX, -offsetY, pagePxW, pagePxH, 0, flags);
+    return bmp;
+}
+
+int64_t PdfEstimateTextPageBytes(FPDF_TEXTPAGE textPage) {
+    constexpr int64_t kBytesPerChar = 96;
+    const int chars = textPage ? FPDFText_CountChars(textPage) : 0;
+    return chars > 0 ? (int64_t)chars * kBytesPerChar : 0;
+}
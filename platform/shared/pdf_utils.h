@@ -3,6 +3,11 @@
 
 #include <fpdfview.h>
 #include <fpdf_edit.h>
+#include <fpdf_text.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 
 // Result of image hit test
 struct PdfHitImageResult {
@@ -18,10 +23,57 @@ PdfHitImageResult PdfHitImageAt(FPDF_PAGE page, double pageX, double pageY, doub
 // Try to obtain a bitmap for the given image object.
 // Prefer the original embedded bitmap; if unavailable, fallback to a rendered bitmap.
 // Returns nullptr on failure. If 'outNeedsDestroy' is true, the caller should
-// destroy the returned bitmap via FPDFBitmap_Destroy().
+// destroy the returned bitmap via FPDFBitmap_Destroy(). Uncached: interactive
+// callers go through PdfImageCache_Acquire (image_cache.h) instead.
 FPDF_BITMAP PdfAcquireBitmapForImage(FPDF_DOCUMENT doc,
                                      FPDF_PAGE page,
                                      FPDF_PAGEOBJECT imageObj,
                                      bool& outNeedsDestroy);
 
+// Embedded image stream that can be written to disk as-is.
+struct PdfRawImage {
+    const char* filter {nullptr};       // "DCTDecode" or "JPXDecode"
+    const char* extension {nullptr};    // "jpg", "jp2" or "j2k"
+    std::vector<unsigned char> data;
+};
+
+// Extract the encoded bytes of an image whose filter chain ends in DCTDecode
+// or JPXDecode, without decoding pixels. A lone image filter is a byte copy
+// of the stream (FPDFImageObj_GetImageDataRaw); leading non-image filters
+// (FlateDecode, ASCII85Decode, ...) are undone by PDFium first. Returns false
+// for every other encoding (JBIG2, CCITT, Flate pixels, ...) and for streams
+// whose bytes alone would show something else than the page does: colour
+// spaces other than DeviceGray/RGB/CMYK (or ICCBased with as many
+// components), Adobe-inverted CMYK JPEGs, and whatever 'paramsPlain' rejects
+// (e.g. PdfiumEx_IsImageParamsPlain: /Decode, /ImageMask). Without it, CMYK
+// is always rejected since /Decode is not exposed. Callers then fall back to
+// PdfAcquireBitmapForImage.
+bool PdfExtractRawImage(FPDF_PAGE page, FPDF_PAGEOBJECT imageObj, PdfRawImage& out,
+                        int (*paramsPlain)(FPDF_PAGEOBJECT) = nullptr);
+
+// 64-bit FNV-1a over 'n' bytes, mixed with the length. Identifies image
+// streams for dedup and caching when no object number is available.
+uint64_t PdfHashBytes(const uint8_t* data, size_t n);
+
+// Hash of an image's stream bytes ('stream', as from
+// FPDFImageObj_GetImageDataRaw) together with what decides how they decode
+// that the public API exposes: pixel size, bits per pixel, colour space and
+// the filter chain. /Decode, /SMask and friends are not exposed; callers that
+// can read them (PdfiumEx_GetImageParamsHash) pass their hash in 'paramsHash'.
+uint64_t PdfImageStreamHash(FPDF_PAGE page, FPDF_PAGEOBJECT obj, const uint8_t* stream, size_t n,
+                            uint64_t paramsHash);
+
+
+// Render the part of a page that is visible through a viewport.
+// The page is laid out at pagePxW x pagePxH device pixels; the returned
+// outW x outH bitmap (white background) shows it starting at (offsetX, offsetY).
+// Used by the Windows frontend and the headless session replayer so both
+// render exactly the same region. Caller destroys via FPDFBitmap_Destroy().
+FPDF_BITMAP PdfRenderPageRegion(FPDF_PAGE page, int pagePxW, int pagePxH,
+                                int offsetX, int offsetY, int outW, int outH, int flags);
+
 
+// Approximate heap size of a loaded text page: PDFium keeps one CharInfo
+// (code, unicode, origin, box, matrix, owning text object) plus text buffer
+// and index entries per character. Used for MemCategory::TextPage.
+int64_t PdfEstimateTextPageBytes(FPDF_TEXTPAGE textPage);
@@ -0,0 +1,165 @@
+#include "render_cost.h"
+#include "metrics.h"
+#include "trace.h"
+
+#include <fpdf_edit.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+constexpr int kMaxGrid = 32;
+
+double ElapsedMs(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// Render 'page' laid out at pagePxW x pagePxH into 'bmp' with its top-left
+// corner at page pixel (x, y); returns the render time only (not the fill).
+double TimeRender(FPDF_BITMAP bmp, FPDF_PAGE page, int x, int y, int pagePxW, int pagePxH, int flags) {
+    FPDFBitmap_FillRect(bmp, 0, 0, FPDFBitmap_GetWidth(bmp), FPDFBitmap_GetHeight(bmp), 0xFFFFFFFF);
+    const auto t0 = std::chrono::steady_clock::now();
+    FPDF_RenderPageBitmap(bmp, page, -x, -y, pagePxW, pagePxH, 0, flags);
+    return ElapsedMs(t0);
+}
+
+bool ProfileTiles(FPDF_PAGE page, int flags, RenderCostProfile& out) {
+    const int W = out.pagePxW, H = out.pagePxH;
+    {
+        FPDF_BITMAP full = FPDFBitmap_Create(W, H, 0);
+        if (!full) return false;
+        MemoryCharge mem(MemCategory::RenderBitmap, (int64_t)W * H * 4);
+        out.fullMs = TimeRender(full, page, 0, 0, W, H, flags);
+        FPDFBitmap_Destroy(full);
+    }
+
+    const int tile = out.tilePx;
+    FPDF_BITMAP bmp = FPDFBitmap_Create(tile, tile, 0);
+    if (!bmp) return false;
+    MemoryCharge mem(MemCategory::RenderBitmap, (int64_t)tile * tile * 4);
+    out.tiles.reserve((size_t)out.cols * out.rows);
+    for (int r = 0; r < out.rows; ++r) {
+        for (int c = 0; c < out.cols; ++c) {
+            RenderTileCost t;
+            t.x = c * tile;
+            t.y = r * tile;
+            t.w = std::min(tile, W - t.x);
+            t.h = std::min(tile, H - t.y);
+            t.ms = TimeRender(bmp, page, t.x, t.y, W, H, flags);
+            out.tilesMs += t.ms;
+            out.tiles.push_back(t);
+        }
+    }
+    FPDFBitmap_Destroy(bmp);
+
+    auto [lo, hi] = std::minmax_element(out.tiles.begin(), out.tiles.end(),
+                                        [](const RenderTileCost& a, const RenderTileCost& b) { return a.ms < b.ms; });
+    if (lo != out.tiles.end()) {
+        out.minTileMs = lo->ms;
+        out.maxTileMs = hi->ms;
+    }
+    return true;
+}
+
+// Detach every object from a private page instance, then attach and render
+// them one at a time over the object's own bounds.
+void ProfileObjects(FPDF_PAGE page, int flags, RenderCostProfile& out) {
+    const int count = FPDFPage_CountObjects(page);
+    if (count <= 0) return;
+    const double sx = out.pagePxW / std::max(1.0f, FPDF_GetPageWidthF(page));
+    const double sy = out.pagePxH / std::max(1.0f, FPDF_GetPageHeightF(page));
+    const double heightPt = FPDF_GetPageHeightF(page);
+    const int objectFlags = flags & ~FPDF_ANNOT;
+
+    std::vector<FPDF_PAGEOBJECT> detached((size_t)count, nullptr);
+    for (int i = count - 1; i >= 0; --i) {
+        FPDF_PAGEOBJECT obj = FPDFPage_GetObject(page, i);
+        if (obj && FPDFPage_RemoveObject(page, obj)) detached[(size_t)i] = obj;
+    }
+
+    if (FPDF_BITMAP probe = FPDFBitmap_Create(16, 16, 0)) {
+        double best = 0.0;
+        for (int i = 0; i < 3; ++i) {
+            const double ms = TimeRender(probe, page, 0, 0, out.pagePxW, out.pagePxH, objectFlags);
+            best = i == 0 ? ms : std::min(best, ms);
+        }
+        out.emptyPageMs = best;
+        FPDFBitmap_Destroy(probe);
+    }
+
+    out.objects.reserve((size_t)count);
+    for (int i = 0; i < count; ++i) {
+        FPDF_PAGEOBJECT obj = detached[(size_t)i];
+        if (!obj) continue;
+        RenderObjectCost cost;
+        cost.index = i;
+        cost.type = FPDFPageObj_GetType(obj);
+        if (!FPDFPageObj_GetBounds(obj, &cost.left, &cost.bottom, &cost.right, &cost.top)) {
+            out.objects.push_back(cost);
+            continue;
+        }
+        const int x0 = std::clamp((int)std::floor(cost.left * sx), 0, out.pagePxW);
+        const int x1 = std::clamp((int)std::ceil(cost.right * sx), 0, out.pagePxW);
+        const int y0 = std::clamp((int)std::floor((heightPt - cost.top) * sy), 0, out.pagePxH);
+        const int y1 = std::clamp((int)std::ceil((heightPt - cost.bottom) * sy), 0, out.pagePxH);
+        if (x1 > x0 && y1 > y0) {
+            FPDF_BITMAP bmp = FPDFBitmap_Create(x1 - x0, y1 - y0, 0);
+            if (bmp) {
+                MemoryCharge mem(MemCategory::RenderBitmap, (int64_t)(x1 - x0) * (y1 - y0) * 4);
+                FPDFPage_InsertObject(page, obj);
+                const double ms = TimeRender(bmp, page, x0, y0, out.pagePxW, out.pagePxH, objectFlags);
+                FPDFPage_RemoveObject(page, obj);
+                cost.ms = std::max(0.0, ms - out.emptyPageMs);
+                FPDFBitmap_Destroy(bmp);
+            }
+        }
+        out.objects.push_back(cost);
+    }
+    for (FPDF_PAGEOBJECT obj : detached) {
+        if (obj) FPDFPageObj_Destroy(obj);
+    }
+
+    std::stable_sort(out.objects.begin(), out.objects.end(),
+                     [](const RenderObjectCost& a, const RenderObjectCost& b) { return a.ms > b.ms; });
+}
+
+} // namespace
+
+bool PdfProfileRenderCost(FPDF_DOCUMENT doc, int pageIndex, int pagePxW, int pagePxH, int tilePx, int flags,
+                          RenderCostProfile& out) {
+    out = RenderCostProfile {};
+    if (!doc || pagePxW <= 0 || pagePxH <= 0) return false;
+    PDFWV_TRACE_SCOPE_PAGE("render", "render_cost_profile", pageIndex);
+    out.pageIndex = pageIndex;
+    out.pagePxW = pagePxW;
+    out.pagePxH = pagePxH;
+    const int longest = std::max(pagePxW, pagePxH);
+    out.tilePx = std::max({tilePx, 16, (longest + kMaxGrid - 1) / kMaxGrid});
+    out.cols = (pagePxW + out.tilePx - 1) / out.tilePx;
+    out.rows = (pagePxH + out.tilePx - 1) / out.tilePx;
+
+    // Objects first, on a cold page, so their times include decoding.
+    FPDF_PAGE isolated = FPDF_LoadPage(doc, pageIndex);
+    if (!isolated) return false;
+    ProfileObjects(isolated, flags, out);
+    FPDF_ClosePage(isolated);
+
+    FPDF_PAGE page = FPDF_LoadPage(doc, pageIndex);
+    if (!page) return false;
+    const bool ok = ProfileTiles(page, flags, out);
+    FPDF_ClosePage(page);
+    return ok;
+}
+
+const char* PdfPageObjectTypeName(int type) {
+    switch (type) {
+    case FPDF_PAGEOBJ_TEXT: return "text";
+    case FPDF_PAGEOBJ_PATH: return "path";
+    case FPDF_PAGEOBJ_IMAGE: return "image";
+    case FPDF_PAGEOBJ_SHADING: return "shading";
+    case FPDF_PAGEOBJ_FORM: return "form";
+    default: return "unknown";
+    }
+}
@@ -0,0 +1,56 @@
+// Render-cost profiling of a single page (diagnostic heatmap mode)
+//
+// Tiles: after one warm-up render of the whole page (image decoding and font
+// loading land in fullMs), the page is rendered again as a grid of square
+// tiles and each tile is timed, so a hatch pattern or soft-masked image shows
+// up as a hot region.
+// Objects: every top-level page object is rendered alone, with the other
+// objects detached from a private instance of the page, and timed. Times
+// include decoding (the private page starts cold) minus the cost of
+// rendering the empty page.
+#pragma once
+
+#include <fpdfview.h>
+
+#include <vector>
+
+struct RenderTileCost {
+    int x {0}, y {0}, w {0}, h {0};     // page pixels, origin at top-left
+    double ms {0.0};
+};
+
+struct RenderObjectCost {
+    int index {0};                      // FPDFPage_GetObject index
+    int type {0};                       // FPDF_PAGEOBJ_*
+    double ms {0.0};
+    float left {0}, bottom {0}, right {0}, top {0}; // page points, PDF coordinates
+};
+
+struct RenderCostProfile {
+    int pageIndex {-1};
+    int pagePxW {0}, pagePxH {0};
+    int tilePx {0};
+    int cols {0}, rows {0};
+    double fullMs {0.0};                // cold render of the whole page
+    double tilesMs {0.0};               // sum over tiles
+    double minTileMs {0.0}, maxTileMs {0.0};
+    double emptyPageMs {0.0};           // baseline subtracted from object times
+    std::vector<RenderTileCost> tiles;       // row-major, cols * rows
+    std::vector<RenderObjectCost> objects;   // most expensive first
+
+    // 0..1 relative to the cheapest/most expensive tile.
+    double TileHeat(const RenderTileCost& t) const {
+        return maxTileMs > minTileMs ? (t.ms - minTileMs) / (maxTileMs - minTileMs) : 0.0;
+    }
+};
+
+// Profile page 'pageIndex' laid out at pagePxW x pagePxH device pixels.
+// 'tilePx' is the requested tile edge; it grows so the grid stays within
+// 32 x 32 tiles. 'flags' are the FPDF_RenderPageBitmap flags the frontend
+// uses (annotations are left out of the per-object renders).
+// Slow by design: one render per tile plus one per page object.
+bool PdfProfileRenderCost(FPDF_DOCUMENT doc, int pageIndex, int pagePxW, int pagePxH, int tilePx, int flags,
+                          RenderCostProfile& out);
+
+// "text", "path", "image", "shading", "form" or "unknown".
+const char* PdfPageObjectTypeName(int type);
@@ -0,0 +1,138 @@
+#include "session_recorder.h"
+#include "async_log.h"
+
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <string>
+
+namespace {
+
+struct SessionState {
+    std::mutex mutex;
+    FILE* file {nullptr};
+    uint64_t startNs {0};
+    std::atomic<bool> recording {false};
+};
+
+SessionState& State() {
+    static SessionState s;
+    return s;
+}
+
+void AppendEscaped(std::string& out, const char* s) {
+    for (; s && *s; ++s) {
+        const char c = *s;
+        if (c == '"' || c == '\\') { out += '\\'; out += c; }
+        else if ((unsigned char)c < 0x20) { char buf[8]; snprintf(buf, sizeof(buf), "\\u%04x", c); out += buf; }
+        else out += c;
+    }
+}
+
+// Prefix every event with its timestamp and type; caller appends fields and '}'.
+std::string BeginEvent(const SessionState& s, const char* ev, const char* source) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "{\"t\":%.3f,\"ev\":\"", (AsyncLog_NowNs() - s.startNs) / 1e6);
+    std::string line = buf;
+    line += ev;
+    line += "\",\"src\":\"";
+    AppendEscaped(line, source);
+    line += '"';
+    return line;
+}
+
+void WriteLine(SessionState& s, std::string& line) {
+    line += "}\n";
+    std::lock_guard<std::mutex> lk(s.mutex);
+    if (s.file) fwrite(line.data(), 1, line.size(), s.file);
+}
+
+} // namespace
+
+bool Session_Start(const char* pathUtf8, const char* documentUtf8) {
+    if (!pathUtf8 || !pathUtf8[0]) return false;
+    SessionState& s = State();
+    std::lock_guard<std::mutex> lk(s.mutex);
+    if (s.file) return false;
+#if defined(_WIN32)
+    s.file = _wfopen(AsyncLog_Utf8ToWide(pathUtf8).c_str(), L"wb");
+#else
+    s.file = fopen(pathUtf8, "wb");
+#endif
+    if (!s.file) return false;
+    setvbuf(s.file, nullptr, _IOFBF, 64 * 1024);
+
+    std::string header = "{\"session\":1,\"platform\":\"";
+#if defined(_WIN32)
+    header += "win";
+#elif defined(__APPLE__)
+    header += "mac";
+#else
+    header += "other";
+#endif
+    header += "\",\"document\":\"";
+    AppendEscaped(header, documentUtf8);
+    header += "\"}\n";
+    fwrite(header.data(), 1, header.size(), s.file);
+
+    s.startNs = AsyncLog_NowNs();
+    s.recording.store(true, std::memory_order_release);
+    return true;
+}
+
+void Session_Stop() {
+    SessionState& s = State();
+    std::lock_guard<std::mutex> lk(s.mutex);
+    s.recording.store(false, std::memory_order_release);
+    if (s.file) {
+        fclose(s.file);
+        s.file = nullptr;
+    }
+}
+
+bool Session_IsRecording() { return State().recording.load(std::memory_order_acquire); }
+
+void Session_RecordDocument(const char* documentUtf8) {
+    SessionState& s = State();
+    if (!s.recording.load(std::memory_order_acquire)) return;
+    std::string line = BeginEvent(s, "open", "open");
+    line += ",\"document\":\"";
+    AppendEscaped(line, documentUtf8);
+    line += '"';
+    WriteLine(s, line);
+}
+
+void Session_RecordViewport(const char* source, const SessionViewport& v) {
+    SessionState& s = State();
+    if (!s.recording.load(std::memory_order_acquire)) return;
+    std::string line = BeginEvent(s, "viewport", source);
+    char buf[192];
+    snprintf(buf, sizeof(buf),
+             ",\"page\":%d,\"zoom\":%.4f,\"sx\":%d,\"sy\":%d,\"vw\":%d,\"vh\":%d,\"scale\":%.4f,\"render\":\"%s\"",
+             v.page, v.zoom, v.scrollX, v.scrollY, v.viewW, v.viewH, v.pxPerPt, v.fullPage ? "page" : "viewport");
+    line += buf;
+    WriteLine(s, line);
+}
+
+void Session_RecordSelection(const char* source, int page, double x0, double y0, double x1, double y1, bool final) {
+    SessionState& s = State();
+    if (!s.recording.load(std::memory_order_acquire)) return;
+    std::string line = BeginEvent(s, "select", source);
+    char buf[160];
+    snprintf(buf, sizeof(buf), ",\"page\":%d,\"x0\":%.2f,\"y0\":%.2f,\"x1\":%.2f,\"y1\":%.2f,\"final\":%d",
+             page, x0, y0, x1, y1, final ? 1 : 0);
+    line += buf;
+    WriteLine(s, line);
+}
+
+void Session_RecordHitTest(const char* source, const char* kind, int page, double x, double y, bool hit) {
+    SessionState& s = State();
+    if (!s.recording.load(std::memory_order_acquire)) return;
+    std::string line = BeginEvent(s, "hit", source);
+    line += ",\"kind\":\"";
+    AppendEscaped(line, kind);
+    char buf[96];
+    snprintf(buf, sizeof(buf), "\",\"page\":%d,\"x\":%.2f,\"y\":%.2f,\"hit\":%d", page, x, y, hit ? 1 : 0);
+    line += buf;
+    WriteLine(s, line);
+}
@@ -0,0 +1,53 @@
+// Interaction session recorder shared by macOS/Windows frontends
+//
+// Records timestamped viewport changes (page, zoom, scroll offsets, view
+// size), text selection rectangles and hit tests to a newline-delimited JSON
+// file, so a user-reported slow interaction can be replayed headlessly with
+// the same timing (see third_party/pdfwv_bench, pdfwv_replay).
+//
+// File layout: one header object, then one event per line:
+//   {"session":1,"platform":"mac","document":"/path/a.pdf"}
+//   {"t":12.5,"ev":"viewport","src":"scrollWheel:","page":0,"zoom":1.25,
+//    "sx":0,"sy":340,"vw":1600,"vh":1000,"scale":2.5,"render":"page"}
+//   {"t":80.1,"ev":"select","src":"WM_MOUSEMOVE","page":0,"x0":..,"final":0}
+//   {"t":95.0,"ev":"hit","src":"rightMouseDown:","kind":"image","page":0,"x":..,"y":..,"hit":1}
+// 't' is milliseconds since Session_Start on the AsyncLog_NowNs() clock.
+// All functions are cheap no-ops while no session is recording.
+#pragma once
+
+// Viewport state after an input event, in device pixels.
+struct SessionViewport {
+    int page {0};
+    double zoom {1.0};
+    int scrollX {0};          // offset of the visible area inside the page bitmap
+    int scrollY {0};
+    int viewW {0};            // visible area size
+    int viewH {0};
+    double pxPerPt {1.0};     // device pixels per PDF point at zoom 1.0 (DPI / 72)
+    bool fullPage {false};    // frontend renders the whole page, not only the visible area
+};
+
+// Start writing a session to 'pathUtf8' (truncated). 'documentUtf8' is the
+// currently open file or nullptr. Returns false if already recording or the
+// file cannot be created.
+bool Session_Start(const char* pathUtf8, const char* documentUtf8);
+
+// Flush and close the session file.
+void Session_Stop();
+
+bool Session_IsRecording();
+
+// A different document was opened while recording.
+void Session_RecordDocument(const char* documentUtf8);
+
+// 'source' names the input handler (string literal), e.g. "WM_MOUSEWHEEL".
+void Session_RecordViewport(const char* source, const SessionViewport& v);
+
+// Selection drag in page points, origin at the page's top-left corner:
+// (x0, y0) is where the drag started, (x1, y1) the current mouse position
+// (not normalized; the selected text runs between the carets nearest to
+// them). 'final' marks the mouse-up that completes the selection.
+void Session_RecordSelection(const char* source, int page, double x0, double y0, double x1, double y1, bool final);
+
+// Hit test at a page point (top-left origin). 'kind' is "image", "link" or "object".
+void Session_RecordHitTest(const char* source, const char* kind, int page, double x, double y, bool hit);
@@ -0,0 +1,277 @@
+#include "text_export.h"
+#include "metrics.h"
+#include "pdf_utils.h"
+#include "text_geometry.h"
+#include "trace.h"
+
+#include <fpdf_text.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// One page as read by PDFium: raw text (plain mode) or chars with boxes.
+struct PageJob {
+    int page {-1};
+    bool lineBoxes {false};
+    std::u16string text;
+    std::unique_ptr<PdfTextGeometry> geometry;
+};
+
+struct ExportQueue {
+    std::mutex mutex;
+    std::condition_variable ready;      // job queued or closed
+    std::condition_variable drained;    // page written
+    std::deque<PageJob> jobs;
+    bool closed {false};
+    int inFlight {0};                   // read, not yet written
+    // Ordered hand-off: formatted pages wait here for the earlier ones.
+    std::map<int, std::string> done;
+    int nextPage {0};
+    bool writing {false};               // a worker is feeding the sink
+    bool sinkFailed {false};
+
+    std::atomic<int> written {0};
+    std::atomic<uint64_t> bytesWritten {0}, lines {0};
+};
+
+void AppendUtf8(std::string& out, char32_t c) {
+    if (c < 0x80) {
+        out += (char)c;
+    } else if (c < 0x800) {
+        out += (char)(0xC0 | (c >> 6));
+        out += (char)(0x80 | (c & 0x3F));
+    } else if (c < 0x10000) {
+        out += (char)(0xE0 | (c >> 12));
+        out += (char)(0x80 | ((c >> 6) & 0x3F));
+        out += (char)(0x80 | (c & 0x3F));
+    } else {
+        out += (char)(0xF0 | (c >> 18));
+        out += (char)(0x80 | ((c >> 12) & 0x3F));
+        out += (char)(0x80 | ((c >> 6) & 0x3F));
+        out += (char)(0x80 | (c & 0x3F));
+    }
+}
+
+// UTF-16 to UTF-8; PDFium's "\r\n" and stray '\r' become '\n', NULs are
+// dropped and unpaired surrogates become U+FFFD.
+void AppendText(std::string& out, const char16_t* s, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        char32_t c = s[i];
+        if (c == 0) continue;
+        if (c == u'\r') {
+            if (i + 1 < n && s[i + 1] == u'\n') continue;
+            c = u'\n';
+        } else if (c >= 0xD800 && c <= 0xDBFF && i + 1 < n && s[i + 1] >= 0xDC00 && s[i + 1] <= 0xDFFF) {
+            c = 0x10000 + ((c - 0xD800) << 10) + (s[++i] - 0xDC00);
+        } else if (c >= 0xD800 && c <= 0xDFFF) {
+            c = 0xFFFD;
+        }
+        AppendUtf8(out, c);
+    }
+}
+
+void FormatPlain(const std::u16string& text, std::string& out) {
+    out.reserve(text.size() + text.size() / 2 + 2);
+    AppendText(out, text.data(), text.size());
+    if (!out.empty() && out.back() != '\n') out += '\n';
+    out += '\f';
+}
+
+uint64_t FormatLines(const PdfTextGeometry& g, std::string& out) {
+    uint64_t lines = 0;
+    std::u16string line;
+    char head[96];
+    for (int l = 0; l < g.LineCount(); ++l) {
+        const PdfTextRect& box = g.lineBox[l];
+        if (box.right < box.left) continue;     // only generated breaks
+        line = g.Text(g.lineFirst[l], g.lineFirst[l + 1]);
+        for (char16_t& c : line) {
+            if (c == u'\t' || c == u'\r' || c == u'\n' || c == 0) c = u' ';
+        }
+        const size_t first = line.find_first_not_of(u' ');
+        if (first == std::u16string::npos) continue;
+        const size_t last = line.find_last_not_of(u' ');
+        snprintf(head, sizeof(head), "%d\t%.2f\t%.2f\t%.2f\t%.2f\t", g.pageIndex + 1, box.left, box.bottom,
+                 box.right, box.top);
+        out += head;
+        AppendText(out, line.data() + first, last + 1 - first);
+        out += '\n';
+        ++lines;
+    }
+    return lines;
+}
+
+void RunWorker(ExportQueue& q, const TextExportWriteFn& write) {
+    PDFWV_TRACE_THREAD_NAME("text_export");
+    static MetricCounter& bytesCounter = Metrics_Counter("text_export.bytes");
+    for (;;) {
+        PageJob job;
+        {
+            std::unique_lock<std::mutex> lk(q.mutex);
+            q.ready.wait(lk, [&] { return q.closed || !q.jobs.empty(); });
+            if (q.jobs.empty()) return;
+            job = std::move(q.jobs.front());
+            q.jobs.pop_front();
+        }
+        std::string out;
+        {
+            PDFWV_TRACE_SCOPE_PAGE("text", "export_format", job.page);
+            if (job.geometry) {
+                PdfTextGeometry_BuildLines(*job.geometry);
+                q.lines.fetch_add(FormatLines(*job.geometry, out), std::memory_order_relaxed);
+            } else if (!job.lineBoxes) {
+                FormatPlain(job.text, out);
+            }
+        }
+
+        std::unique_lock<std::mutex> lk(q.mutex);
+        q.done.emplace(job.page, std::move(out));
+        if (q.writing) continue;        // that worker will pick this page up
+        q.writing = true;
+        for (auto it = q.done.find(q.nextPage); it != q.done.end(); it = q.done.find(q.nextPage)) {
+            const std::string chunk = std::move(it->second);
+            q.done.erase(it);
+            const bool skip = q.sinkFailed;
+            lk.unlock();
+            // An empty page (no lines, or unreadable) skips the sink but is
+            // still written: it counts unless the sink has failed.
+            const bool wrote = !skip && (chunk.empty() || write(chunk.data(), chunk.size()));
+            if (wrote) q.written.fetch_add(1, std::memory_order_relaxed);
+            if (wrote && !chunk.empty()) {
+                q.bytesWritten.fetch_add(chunk.size(), std::memory_order_relaxed);
+                bytesCounter.Add((int64_t)chunk.size());
+            }
+            const bool ok = skip || wrote;
+            lk.lock();
+            if (!ok) q.sinkFailed = true;
+            ++q.nextPage;
+            --q.inFlight;
+            q.drained.notify_all();
+        }
+        q.writing = false;
+    }
+}
+
+// Copy out what the workers need so the page can be closed right away.
+// false if the page or its text cannot be loaded.
+bool ReadPage(FPDF_DOCUMENT doc, PageJob& job, uint64_t& chars) {
+    FPDF_PAGE page = FPDF_LoadPage(doc, job.page);
+    if (!page) return false;
+    FPDF_TEXTPAGE tp = FPDFText_LoadPage(page);
+    if (!tp) {
+        FPDF_ClosePage(page);
+        return false;
+    }
+    {
+        MemoryCharge textMem(MemCategory::TextPage, PdfEstimateTextPageBytes(tp));
+        if (job.lineBoxes) {
+            job.geometry = std::make_unique<PdfTextGeometry>();
+            PdfTextGeometry_ReadChars(tp, job.page, *job.geometry);
+            chars += (uint64_t)job.geometry->CharCount();
+        } else {
+            const int n = FPDFText_CountChars(tp);
+            if (n > 0) {
+                // One call for the whole page; the count includes the terminator.
+                job.text.resize((size_t)n + 1);
+                const int got = FPDFText_GetText(tp, 0, n, reinterpret_cast<unsigned short*>(job.text.data()));
+                job.text.resize(got > 0 ? (size_t)got - 1 : 0);
+                chars += (uint64_t)n;
+            }
+        }
+    }
+    FPDFText_ClosePage(tp);
+    FPDF_ClosePage(page);
+    return true;
+}
+
+} // namespace
+
+bool PdfExportText(const std::string& pdfPathUtf8, const TextExportOptions& options,
+                   const TextExportWriteFn& write, const TextExportProgressFn& progress,
+                   TextExportProgress& result, std::string& error) {
+    result = TextExportProgress {};
+    PDFWV_TRACE_SCOPE("text", "export_all");
+    const auto t0 = std::chrono::steady_clock::now();
+
+    // Private instance: the viewer's document and its page caches are left alone.
+    FPDF_DOCUMENT doc = FPDF_LoadDocument(pdfPathUtf8.c_str(), nullptr);
+    if (!doc) {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "FPDF_LoadDocument failed (error %lu)", FPDF_GetLastError());
+        error = buf;
+        return false;
+    }
+    result.pageCount = FPDF_GetPageCount(doc);
+
+    ExportQueue q;
+    const int hw = (int)std::thread::hardware_concurrency();
+    const int threads = options.threads > 0 ? options.threads : std::max(1, hw - 1);
+    std::vector<std::thread> pool;
+    for (int i = 0; i < threads; ++i) pool.emplace_back(RunWorker, std::ref(q), std::cref(write));
+
+    auto snapshot = [&] {
+        result.pagesWritten = q.written.load(std::memory_order_relaxed);
+        result.bytesWritten = q.bytesWritten.load(std::memory_order_relaxed);
+        result.lines = q.lines.load(std::memory_order_relaxed);
+        result.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    };
+
+    static MetricHistogram& pageMs = Metrics_Histogram("text_export.page_ms");
+    const int maxInFlight = std::max(1, options.maxPagesInFlight);
+    bool sinkFailed = false;
+    for (int p = 0; p < result.pageCount && !result.cancelled; ++p) {
+        {
+            std::unique_lock<std::mutex> lk(q.mutex);
+            q.drained.wait(lk, [&] { return q.inFlight < maxInFlight || q.sinkFailed; });
+            sinkFailed = q.sinkFailed;
+        }
+        if (sinkFailed) break;
+        PageJob job;
+        job.page = p;
+        job.lineBoxes = options.lineBoxes;
+        {
+            PDFWV_TRACE_SCOPE_PAGE("text", "export_page", p);
+            MetricTimer timer(pageMs);
+            // An unloadable page still gets its (empty) slot so page order holds.
+            if (!ReadPage(doc, job, result.chars)) ++result.failedPages;
+        }
+        {
+            std::lock_guard<std::mutex> lk(q.mutex);
+            ++q.inFlight;
+            q.jobs.push_back(std::move(job));
+        }
+        q.ready.notify_one();
+        result.pagesRead = p + 1;
+        snapshot();
+        if (progress && !progress(result)) result.cancelled = true;
+    }
+    FPDF_CloseDocument(doc);
+
+    // Pages already read are still written, so a cancelled export is a clean prefix.
+    {
+        std::lock_guard<std::mutex> lk(q.mutex);
+        q.closed = true;
+    }
+    q.ready.notify_all();
+    for (std::thread& t : pool) t.join();
+    sinkFailed = q.sinkFailed;
+
+    snapshot();
+    if (progress) progress(result);
+    if (sinkFailed) {
+        error = "writing the output failed";
+        return false;
+    }
+    return true;
+}
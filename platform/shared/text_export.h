@@ -0,0 +1,62 @@
+// Whole-document text export, shared by macOS/Windows frontends and the
+// headless pdfwv_textexport tool
+//
+// Pages are exported in order as UTF-8. PDFium is not thread-safe, not even
+// across separate FPDF_DOCUMENTs, so the calling thread is the only one that
+// touches it: it opens a private instance of the document and, per page,
+// copies out the raw text (plain mode: one FPDFText_GetText call) or the
+// chars with their boxes (line-box mode, see PdfTextGeometry_ReadChars).
+// Worker threads do the rest: line assembly, UTF-8 conversion and
+// formatting. Finished pages are handed to the sink strictly in page order
+// by whichever worker completes the next one; the reader blocks once
+// 'maxPagesInFlight' pages are read but not yet written, so memory stays
+// bounded however far ahead extraction runs.
+//
+// Output: plain mode writes each page's text with PDFium's line breaks as
+// '\n' and ends every page with '\f'. Line-box mode writes one line per text
+// line, "page<TAB>left<TAB>bottom<TAB>right<TAB>top<TAB>text" (1-based page,
+// PDF points; tabs and breaks inside the text become spaces), lines in
+// PDFium's reading order.
+//
+// Feeds the metrics registry: histogram "text_export.page_ms" (PDFium part
+// of a page), counter "text_export.bytes".
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+struct TextExportOptions {
+    int threads {0};                        // layout workers, 0: hardware_concurrency - 1
+    bool lineBoxes {false};                 // one TSV row per line with its bounding box
+    int maxPagesInFlight {32};              // read by PDFium but not yet written
+};
+
+struct TextExportProgress {
+    int pagesRead {0}, pagesWritten {0}, pageCount {0};
+    int failedPages {0};                    // could not be loaded; written as empty
+    uint64_t chars {0};                     // PDFium chars, generated breaks included
+    uint64_t lines {0};                     // line-box mode only
+    uint64_t bytesWritten {0};
+    double elapsedMs {0.0};
+    bool cancelled {false};
+
+    double PagesPerSecond() const { return elapsedMs > 0 ? pagesWritten * 1000.0 / elapsedMs : 0.0; }
+    double MegabytesPerSecond() const { return elapsedMs > 0 ? bytesWritten / 1048.576 / elapsedMs : 0.0; }
+};
+
+// Receives the output in page order, one call per non-empty page, from a
+// worker thread (never two at once). Return false to stop the export (e.g.
+// disk full). Empty pages count in pagesWritten without a call.
+using TextExportWriteFn = std::function<bool(const char* data, size_t size)>;
+
+// Called on the calling thread after every page read and once at the end;
+// return false to cancel. Frontends pump their event loop from here.
+using TextExportProgressFn = std::function<bool(const TextExportProgress&)>;
+
+// Returns false if the document cannot be opened or the sink failed
+// ('error' says why); unloadable pages are only counted in 'result'.
+bool PdfExportText(const std::string& pdfPathUtf8, const TextExportOptions& options,
+                   const TextExportWriteFn& write, const TextExportProgressFn& progress,
+                   TextExportProgress& result, std::string& error);
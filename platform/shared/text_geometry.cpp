@@ -0,0 +1,315 @@
+#include "text_geometry.h"
+#include "metrics.h"
+#include "pdf_utils.h"
+
+#include <fpdf_text.h>
+
+#include <algorithm>
+#include <limits>
+#include <list>
+
+namespace {
+
+constexpr size_t kCachedPages = 8;
+
+bool IsSpace(char32_t c) {
+    return c == u' ' || c == u'\t' || c == u'\r' || c == u'\n' || c == 0x00A0 || c == 0x3000 || c == 0;
+}
+
+// CJK has no spaces between words; each ideograph / syllable is its own word.
+bool IsIdeographic(char32_t c) {
+    return (c >= 0x3040 && c <= 0x9FFF) || (c >= 0xAC00 && c <= 0xD7AF) || (c >= 0xF900 && c <= 0xFAFF) ||
+           (c >= 0x20000 && c <= 0x3FFFF);
+}
+
+bool IsHighSurrogate(char32_t c) { return c >= 0xD800 && c <= 0xDBFF; }
+bool IsLowSurrogate(char32_t c) { return c >= 0xDC00 && c <= 0xDFFF; }
+
+// Second half of a character PDFium split into two surrogate chars.
+bool IsTrailingHalf(const PdfTextGeometry& g, int i) {
+    return i > 0 && IsLowSurrogate(g.text[i]) && IsHighSurrogate(g.text[i - 1]);
+}
+
+// Code point of char 'i', joining split surrogate halves.
+char32_t CodePointAt(const PdfTextGeometry& g, int i) {
+    if (IsTrailingHalf(g, i)) --i;
+    const char32_t c = g.text[i];
+    if (IsHighSurrogate(c) && i + 1 < g.CharCount() && IsLowSurrogate(g.text[i + 1]))
+        return 0x10000 + ((c - 0xD800) << 10) + (g.text[i + 1] - 0xDC00);
+    return c;
+}
+
+float CenterX(const PdfTextGeometry& g, int i) { return (g.left[i] + g.right[i]) * 0.5f; }
+
+// A glyph starts a new line when it barely overlaps the current line
+// vertically, or jumps back left by more than a line height (next column).
+bool StartsNewLine(const PdfTextRect& line, float l, float b, float t, float prevRight) {
+    const float h = std::min(line.top - line.bottom, t - b);
+    const float overlap = std::min(line.top, t) - std::max(line.bottom, b);
+    return overlap < 0.3f * h || l < prevRight - std::max(h, 1.0f) * 2.0f;
+}
+
+void Unite(PdfTextRect& r, float l, float b, float rt, float t) {
+    r.left = std::min(r.left, l);
+    r.bottom = std::min(r.bottom, b);
+    r.right = std::max(r.right, rt);
+    r.top = std::max(r.top, t);
+}
+
+const PdfTextRect kEmptyRect {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                              std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()};
+
+bool IsEmpty(const PdfTextRect& r) { return r.right < r.left; }
+
+void BuildLines(PdfTextGeometry& g) {
+    const int n = g.CharCount();
+    PdfTextRect cur = kEmptyRect;
+    float prevRight = 0;
+    auto closeLine = [&](int end) {
+        g.lineBox.push_back(cur);
+        g.lineFirst.push_back(end);
+        cur = kEmptyRect;
+    };
+    g.lineFirst.push_back(0);
+    for (int i = 0; i < n; ++i) {
+        if (g.flags[i] & PdfTextGeometry::kHasBox) {
+            if (!IsEmpty(cur) && i > g.lineFirst.back() &&
+                StartsNewLine(cur, g.left[i], g.bottom[i], g.top[i], prevRight))
+                closeLine(i);
+            Unite(cur, g.left[i], g.bottom[i], g.right[i], g.top[i]);
+            prevRight = g.right[i];
+        } else if (g.text[i] == u'\n') {
+            closeLine(i + 1);           // the break belongs to the line it ends
+        }
+    }
+    if (g.lineFirst.back() < n) closeLine(n);
+
+    const int lines = g.LineCount();
+    for (int l = 0; l < lines; ++l) {
+        if (IsEmpty(g.lineBox[l])) continue;
+        g.linesByY.push_back(l);
+        g.maxHalfLineHeight = std::max(g.maxHalfLineHeight, (g.lineBox[l].top - g.lineBox[l].bottom) * 0.5f);
+    }
+    auto centerY = [&](int l) { return (g.lineBox[l].top + g.lineBox[l].bottom) * 0.5f; };
+    std::stable_sort(g.linesByY.begin(), g.linesByY.end(), [&](int a, int b) { return centerY(a) > centerY(b); });
+    g.lineCenterY.reserve(g.linesByY.size());
+    for (int l : g.linesByY) g.lineCenterY.push_back(centerY(l));
+
+    g.glyphFirst.reserve((size_t)lines + 1);
+    for (int l = 0; l < lines; ++l) {
+        g.glyphFirst.push_back((int)g.glyphsByX.size());
+        const size_t begin = g.glyphsByX.size();
+        for (int i = g.lineFirst[l]; i < g.lineFirst[l + 1]; ++i) {
+            if (g.flags[i] & PdfTextGeometry::kHasBox) g.glyphsByX.push_back(i);
+        }
+        std::stable_sort(g.glyphsByX.begin() + begin, g.glyphsByX.end(),
+                         [&](int a, int b) { return CenterX(g, a) < CenterX(g, b); });
+    }
+    g.glyphFirst.push_back((int)g.glyphsByX.size());
+}
+
+PdfTextGeometry* Build(FPDF_TEXTPAGE tp, int pageIndex) {
+    auto* g = new PdfTextGeometry;
+    PdfTextGeometry_ReadChars(tp, pageIndex, *g);
+    PdfTextGeometry_BuildLines(*g);
+    return g;
+}
+
+struct CacheEntry {
+    FPDF_DOCUMENT doc;
+    int page;
+    PdfTextGeometryRef geometry;
+};
+
+std::list<CacheEntry>& Cache() {
+    static std::list<CacheEntry> lru;   // most recently used first
+    return lru;
+}
+
+} // namespace
+
+void PdfTextGeometry_ReadChars(FPDF_TEXTPAGE textPage, int pageIndex, PdfTextGeometry& g) {
+    g = PdfTextGeometry {};
+    g.pageIndex = pageIndex;
+    const int n = std::max(0, FPDFText_CountChars(textPage));
+    g.left.resize(n);
+    g.bottom.resize(n);
+    g.right.resize(n);
+    g.top.resize(n);
+    g.text.resize(n);
+    g.flags.resize(n);
+    for (int i = 0; i < n; ++i) {
+        g.text[i] = (char32_t)FPDFText_GetUnicode(textPage, i);
+        // Loose boxes span the font's ascent/descent, so a line's glyphs share
+        // one height; fall back to the tight box when there is none.
+        FS_RECTF r {};
+        double l = 0, rt = 0, b = 0, t = 0;
+        if (FPDFText_GetLooseCharBox(textPage, i, &r) && r.right > r.left && r.top > r.bottom) {
+            g.left[i] = r.left;
+            g.bottom[i] = r.bottom;
+            g.right[i] = r.right;
+            g.top[i] = r.top;
+            g.flags[i] = PdfTextGeometry::kHasBox;
+        } else if (FPDFText_GetCharBox(textPage, i, &l, &rt, &b, &t) && rt > l && t > b) {
+            g.left[i] = (float)l;
+            g.bottom[i] = (float)b;
+            g.right[i] = (float)rt;
+            g.top[i] = (float)t;
+            g.flags[i] = PdfTextGeometry::kHasBox;
+        }
+    }
+}
+
+void PdfTextGeometry_BuildLines(PdfTextGeometry& g) {
+    const int n = g.CharCount();
+    for (int i = 0; i < n; ++i) {
+        const char32_t c = CodePointAt(g, i);
+        uint8_t f = g.flags[i] & PdfTextGeometry::kHasBox;
+        if (IsSpace(c)) f |= PdfTextGeometry::kSpace;
+        if (!(f & PdfTextGeometry::kSpace) && !IsTrailingHalf(g, i) &&
+            (i == 0 || (g.flags[i - 1] & PdfTextGeometry::kSpace) || IsIdeographic(c) ||
+             IsIdeographic(CodePointAt(g, i - 1))))
+            f |= PdfTextGeometry::kWordStart;
+        g.flags[i] = f;
+    }
+    BuildLines(g);
+}
+
+int64_t PdfTextGeometry::Bytes() const {
+    return (int64_t)(left.capacity() + bottom.capacity() + right.capacity() + top.capacity() +
+                     lineCenterY.capacity()) * sizeof(float) +
+           (int64_t)text.capacity() * sizeof(char32_t) + (int64_t)flags.capacity() +
+           (int64_t)(lineFirst.capacity() + linesByY.capacity() + glyphFirst.capacity() + glyphsByX.capacity()) *
+               sizeof(int) +
+           (int64_t)lineBox.capacity() * sizeof(PdfTextRect);
+}
+
+int PdfTextGeometry::LineOf(int i) const {
+    return (int)(std::upper_bound(lineFirst.begin(), lineFirst.end(), i) - lineFirst.begin()) - 1;
+}
+
+int PdfTextGeometry::CaretAt(float x, float y) const {
+    if (linesByY.empty()) return -1;
+    // Closest line: vertical distance first, then horizontal. Lines are sorted
+    // by centre, so the scan stops once no line can be closer vertically.
+    const size_t start = std::lower_bound(lineCenterY.begin(), lineCenterY.end(), y,
+                                          [](float c, float v) { return c > v; }) - lineCenterY.begin();
+    int best = -1;
+    float bestDy = std::numeric_limits<float>::max(), bestDx = bestDy;
+    auto consider = [&](size_t k) {
+        const PdfTextRect& b = lineBox[linesByY[k]];
+        const float dy = std::max(0.0f, std::max(b.bottom - y, y - b.top));
+        const float dx = std::max(0.0f, std::max(b.left - x, x - b.right));
+        if (dy < bestDy || (dy == bestDy && dx < bestDx)) {
+            best = linesByY[k];
+            bestDy = dy;
+            bestDx = dx;
+        }
+    };
+    for (size_t k = start; k < linesByY.size() && y - lineCenterY[k] - maxHalfLineHeight <= bestDy; ++k) consider(k);
+    for (size_t k = start; k-- > 0 && lineCenterY[k] - y - maxHalfLineHeight <= bestDy;) consider(k);
+
+    const int* first = glyphsByX.data() + glyphFirst[best];
+    const int* last = glyphsByX.data() + glyphFirst[best + 1];
+    const int* it = std::lower_bound(first, last, x, [this](int i, float v) { return CenterX(*this, i) < v; });
+    // 'it' is the first glyph whose centre is right of x: the caret goes before it, or after the last glyph.
+    if (it == last) return *(last - 1) + 1;
+    if (it == first) return *first;
+    return (x - CenterX(*this, *(it - 1)) < CenterX(*this, *it) - x) ? *(it - 1) + 1 : *it;
+}
+
+void PdfTextGeometry::WordAt(int i, int& first, int& last) const {
+    const int n = CharCount();
+    first = last = std::clamp(i, 0, n);
+    if (n == 0) return;
+    if (first == n) --first;
+    last = first + 1;
+    if (flags[first] & kSpace) return;
+    while (first > 0 && !(flags[first] & kWordStart)) --first;
+    while (last < n && !(flags[last] & (kSpace | kWordStart))) ++last;
+}
+
+void PdfTextGeometry::SelectionRects(int first, int last, std::vector<PdfTextRect>& out) const {
+    out.clear();
+    first = std::max(first, 0);
+    last = std::min(last, CharCount());
+    if (first >= last) return;
+    const int lf = LineOf(first), ll = LineOf(last - 1);
+    for (int l = lf; l <= ll; ++l) {
+        const PdfTextRect& line = lineBox[l];
+        if (IsEmpty(line)) continue;
+        const int a = std::max(first, lineFirst[l]), b = std::min(last, lineFirst[l + 1]);
+        if (a == lineFirst[l] && b == lineFirst[l + 1]) {
+            out.push_back(line);
+            continue;
+        }
+        // Partial line: the glyphs' horizontal extent at the full line height.
+        PdfTextRect r = kEmptyRect;
+        for (int i = a; i < b; ++i) {
+            if (flags[i] & kHasBox) Unite(r, left[i], line.bottom, right[i], line.top);
+        }
+        if (!IsEmpty(r)) out.push_back(r);
+    }
+}
+
+std::u16string PdfTextGeometry::Text(int first, int last) const {
+    first = std::max(first, 0);
+    last = std::min(last, CharCount());
+    std::u16string out;
+    if (first >= last) return out;
+    out.reserve((size_t)(last - first));
+    for (int i = first; i < last; ++i) {
+        const char32_t c = text[i];
+        if (c >= 0x10000 && c <= 0x10FFFF) {
+            out += (char16_t)(0xD800 + ((c - 0x10000) >> 10));
+            out += (char16_t)(0xDC00 + ((c - 0x10000) & 0x3FF));
+        } else {
+            out += (char16_t)(c <= 0xFFFF ? c : 0xFFFD);
+        }
+    }
+    return out;
+}
+
+PdfTextGeometryRef PdfTextGeometry_Get(FPDF_DOCUMENT doc, int pageIndex) {
+    if (!doc || pageIndex < 0) return nullptr;
+    static MetricCacheCounters cacheStats = Metrics_CacheCounters("text_geometry");
+    std::list<CacheEntry>& lru = Cache();
+    for (auto it = lru.begin(); it != lru.end(); ++it) {
+        if (it->doc == doc && it->page == pageIndex) {
+            lru.splice(lru.begin(), lru, it);
+            cacheStats.Record(true);
+            return it->geometry;
+        }
+    }
+    cacheStats.Record(false);
+    static MetricHistogram& buildMs = Metrics_Histogram("text_geometry.build_ms");
+    MetricTimer timer(buildMs);
+    FPDF_PAGE page = FPDF_LoadPage(doc, pageIndex);
+    if (!page) return nullptr;
+    FPDF_TEXTPAGE tp = FPDFText_LoadPage(page);
+    if (!tp) {
+        FPDF_ClosePage(page);
+        return nullptr;
+    }
+    PdfTextGeometry* raw = nullptr;
+    {
+        MemoryCharge textMem(MemCategory::TextPage, PdfEstimateTextPageBytes(tp));
+        raw = Build(tp, pageIndex);
+    }
+    FPDFText_ClosePage(tp);
+    FPDF_ClosePage(page);
+
+    const int64_t bytes = raw->Bytes();
+    Metrics_MemoryAdd(MemCategory::TextGeometry, bytes);
+    PdfTextGeometryRef geometry(raw, [bytes](const PdfTextGeometry* g) {
+        Metrics_MemoryAdd(MemCategory::TextGeometry, -bytes);
+        delete g;
+    });
+    lru.push_front(CacheEntry {doc, pageIndex, geometry});
+    if (lru.size() > kCachedPages) lru.pop_back();
+    return geometry;
+}
+
+void PdfTextGeometry_InvalidateDocument(FPDF_DOCUMENT doc) {
+    Cache().remove_if([doc](const CacheEntry& e) { return e.doc == doc; });
+}
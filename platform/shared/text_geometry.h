@@ -0,0 +1,79 @@
+// Per-page character geometry for text selection, shared by macOS/Windows frontends
+//
+// Built once per page from FPDF_TEXTPAGE (loose char boxes, so a line's
+// glyphs share one height) and kept in a small LRU, so dragging a selection
+// never calls into PDFium: finding the caret under the mouse is a binary
+// search over lines sorted by height on the page and then over the line's
+// glyphs sorted by x, and the highlight is one rectangle per line.
+//
+// Storage is structure-of-arrays indexed by FPDFText char index; chars
+// without a box (PDFium's generated spaces and line breaks) keep their
+// text but are never hit. Text is kept as FPDFText_GetUnicode returns it,
+// one code point per char, so characters above U+FFFF survive (builds
+// where PDFium splits them into two surrogate chars keep both halves).
+// Lines follow PDFium's reading order. Memory is charged to
+// MemCategory::TextGeometry, lookups feed "cache.text_geometry.hit" /
+// ".miss".
+#pragma once
+
+#include <fpdfview.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct PdfTextRect {
+    float left {0}, bottom {0}, right {0}, top {0};   // page points, PDF coordinates
+};
+
+struct PdfTextGeometry {
+    enum : uint8_t { kHasBox = 1, kWordStart = 2, kSpace = 4 };
+
+    int pageIndex {-1};
+    // Per char.
+    std::vector<float> left, bottom, right, top;
+    std::vector<char32_t> text;
+    std::vector<uint8_t> flags;
+    // Per line: chars [lineFirst[i], lineFirst[i + 1]), union box of the boxed ones.
+    std::vector<int> lineFirst;
+    std::vector<PdfTextRect> lineBox;
+    // Lookup tables.
+    std::vector<int> linesByY;          // line indices, line centres top to bottom
+    std::vector<float> lineCenterY;     // in linesByY order (descending)
+    std::vector<int> glyphFirst;        // per line, offset into glyphsByX; size lines + 1
+    std::vector<int> glyphsByX;         // boxed char indices of each line, by centre x
+    float maxHalfLineHeight {0};
+
+    int CharCount() const { return (int)text.size(); }
+    int LineCount() const { return (int)lineBox.size(); }
+    int64_t Bytes() const;
+
+    // Line holding char 'i' (0 <= i < CharCount()).
+    int LineOf(int i) const;
+    // Caret position (0..CharCount()) nearest to page point (x, y): before or
+    // after the closest glyph of the closest line. -1 if the page has no text.
+    int CaretAt(float x, float y) const;
+    // Word around char 'i' as [first, last).
+    void WordAt(int i, int& first, int& last) const;
+    // Highlight of chars [first, last): one rectangle per line the range touches.
+    void SelectionRects(int first, int last, std::vector<PdfTextRect>& out) const;
+    // UTF-16 text of chars [first, last), PDFium's line breaks included;
+    // characters above U+FFFF become surrogate pairs.
+    std::u16string Text(int first, int last) const;
+};
+using PdfTextGeometryRef = std::shared_ptr<const PdfTextGeometry>;
+
+// Geometry of page 'pageIndex' of 'doc', built on first use. nullptr if the
+// page or its text cannot be loaded. Call on the thread that owns 'doc'.
+PdfTextGeometryRef PdfTextGeometry_Get(FPDF_DOCUMENT doc, int pageIndex);
+
+// Call before FPDF_CloseDocument.
+void PdfTextGeometry_InvalidateDocument(FPDF_DOCUMENT doc);
+
+// The two halves of a build, for callers that pipeline many pages without
+// the cache (text export): ReadChars fills text, boxes and kHasBox on the
+// thread that owns 'textPage'; BuildLines derives word flags, lines and the
+// lookup tables and touches no PDFium state, so it may run on any thread.
+void PdfTextGeometry_ReadChars(FPDF_TEXTPAGE textPage, int pageIndex, PdfTextGeometry& g);
+void PdfTextGeometry_BuildLines(PdfTextGeometry& g);
@@ -0,0 +1,144 @@
+#include "text_search.h"
+#include "metrics.h"
+#include "pdf_utils.h"
+
+#include <fpdf_text.h>
+
+#include <algorithm>
+#include <list>
+
+namespace {
+
+constexpr size_t kCachedPages = 64;
+
+struct CacheEntry {
+    FPDF_DOCUMENT doc;
+    int page;
+    PdfPageSearchHitsRef hits;
+};
+
+struct SearchState {
+    std::u16string query;
+    unsigned long flags {0};
+    std::list<CacheEntry> lru;  // most recently used first
+};
+
+SearchState& State() {
+    static SearchState s;
+    return s;
+}
+
+PdfPageSearchHits* Search(FPDF_TEXTPAGE tp, int pageIndex, const std::u16string& query, unsigned long flags) {
+    auto* hits = new PdfPageSearchHits;
+    hits->pageIndex = pageIndex;
+    FPDF_SCHHANDLE sch = FPDFText_FindStart(tp, reinterpret_cast<FPDF_WIDESTRING>(query.c_str()), flags, 0);
+    if (!sch) return hits;
+    while (FPDFText_FindNext(sch)) {
+        PdfSearchMatch m;
+        m.charIndex = FPDFText_GetSchResultIndex(sch);
+        m.charCount = FPDFText_GetSchCount(sch);
+        m.firstRect = (int)hits->rects.size();
+        // One rectangle per run of the match on a line; GetRect reads the
+        // rectangles of the preceding CountRects call.
+        const int rects = FPDFText_CountRects(tp, m.charIndex, m.charCount);
+        for (int r = 0; r < rects; ++r) {
+            double l = 0, t = 0, rt = 0, b = 0;
+            if (FPDFText_GetRect(tp, r, &l, &t, &rt, &b))
+                hits->rects.push_back(PdfTextRect {(float)l, (float)b, (float)rt, (float)t});
+        }
+        m.rectCount = (int)hits->rects.size() - m.firstRect;
+        hits->matches.push_back(m);
+    }
+    FPDFText_FindClose(sch);
+    return hits;
+}
+
+int64_t HitsBytes(const PdfPageSearchHits& h) {
+    return (int64_t)(sizeof(PdfPageSearchHits) + h.matches.capacity() * sizeof(PdfSearchMatch) +
+                     h.rects.capacity() * sizeof(PdfTextRect));
+}
+
+} // namespace
+
+bool PdfTextSearch_SetQuery(const std::u16string& query, unsigned long flags) {
+    SearchState& s = State();
+    if (query == s.query && (query.empty() || flags == s.flags)) return false;
+    s.query = query;
+    s.flags = flags;
+    s.lru.clear();
+    return true;
+}
+
+const std::u16string& PdfTextSearch_Query() {
+    return State().query;
+}
+
+PdfPageSearchHitsRef PdfTextSearch_PageHits(FPDF_DOCUMENT doc, int pageIndex) {
+    SearchState& s = State();
+    if (!doc || pageIndex < 0 || s.query.empty()) return nullptr;
+    static MetricCacheCounters cacheStats = Metrics_CacheCounters("text_search");
+    for (auto it = s.lru.begin(); it != s.lru.end(); ++it) {
+        if (it->doc == doc && it->page == pageIndex) {
+            s.lru.splice(s.lru.begin(), s.lru, it);
+            cacheStats.Record(true);
+            return it->hits;
+        }
+    }
+    cacheStats.Record(false);
+    static MetricHistogram& searchMs = Metrics_Histogram("text_search.page_ms");
+    MetricTimer timer(searchMs);
+    FPDF_PAGE page = FPDF_LoadPage(doc, pageIndex);
+    if (!page) return nullptr;
+    FPDF_TEXTPAGE tp = FPDFText_LoadPage(page);
+    if (!tp) {
+        FPDF_ClosePage(page);
+        return nullptr;
+    }
+    PdfPageSearchHits* raw = nullptr;
+    {
+        MemoryCharge textMem(MemCategory::TextPage, PdfEstimateTextPageBytes(tp));
+        raw = Search(tp, pageIndex, s.query, s.flags);
+    }
+    FPDFText_ClosePage(tp);
+    FPDF_ClosePage(page);
+
+    const int64_t bytes = HitsBytes(*raw);
+    Metrics_MemoryAdd(MemCategory::SearchIndex, bytes);
+    PdfPageSearchHitsRef hits(raw, [bytes](const PdfPageSearchHits* h) {
+        Metrics_MemoryAdd(MemCategory::SearchIndex, -bytes);
+        delete h;
+    });
+    s.lru.push_front(CacheEntry {doc, pageIndex, hits});
+    if (s.lru.size() > kCachedPages) s.lru.pop_back();
+    return hits;
+}
+
+bool PdfTextSearch_Step(FPDF_DOCUMENT doc, int& page, int& match, bool backward) {
+    if (!doc || State().query.empty()) return false;
+    const int pageCount = FPDF_GetPageCount(doc);
+    if (pageCount <= 0) return false;
+    const int start = std::clamp(page, 0, pageCount - 1);
+    PdfPageSearchHitsRef hits = PdfTextSearch_PageHits(doc, start);
+    const int n = hits ? (int)hits->matches.size() : 0;
+    const int m = backward ? (match < 0 ? -1 : std::min(match, n) - 1) : match + 1;
+    if (m >= 0 && m < n) {
+        page = start;
+        match = m;
+        return true;
+    }
+    // Following pages, wrapping around; the last one tried is 'start' itself.
+    for (int i = 1; i <= pageCount; ++i) {
+        const int p = backward ? (start - i % pageCount + pageCount) % pageCount : (start + i) % pageCount;
+        hits = PdfTextSearch_PageHits(doc, p);
+        if (hits && !hits->matches.empty()) {
+            page = p;
+            match = backward ? (int)hits->matches.size() - 1 : 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+void PdfTextSearch_InvalidateDocument(FPDF_DOCUMENT doc) {
+    State().lru.remove_if([doc](const CacheEntry& e) { return e.doc == doc; });
+}
@@ -0,0 +1,49 @@
+// Highlight-all text search shared by macOS/Windows frontends
+//
+// Matches of the current query are found once per page with FPDFText_Find*
+// and turned into rectangles with FPDFText_CountRects / FPDFText_GetRect.
+// The result is cached per page (small LRU, cleared when the query
+// changes), so frontends draw the hits as an overlay over an already
+// rendered page bitmap: typing a query never re-renders a page and
+// returning to a page never searches it again. Memory is charged to
+// MemCategory::SearchIndex, lookups feed "cache.text_search.hit" / ".miss".
+// Main thread only.
+#pragma once
+
+#include "text_geometry.h"
+
+#include <fpdfview.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+struct PdfSearchMatch {
+    int charIndex {0}, charCount {0};   // FPDFText char range
+    int firstRect {0}, rectCount {0};   // into PdfPageSearchHits::rects
+};
+
+struct PdfPageSearchHits {
+    int pageIndex {-1};
+    std::vector<PdfSearchMatch> matches;    // reading order
+    std::vector<PdfTextRect> rects;         // page points, PDF coordinates
+};
+using PdfPageSearchHitsRef = std::shared_ptr<const PdfPageSearchHits>;
+
+// Replace the query. 'flags' are FPDF_MATCHCASE / FPDF_MATCHWHOLEWORD; an
+// empty query clears the search. Returns true if anything changed.
+bool PdfTextSearch_SetQuery(const std::u16string& query, unsigned long flags);
+const std::u16string& PdfTextSearch_Query();
+
+// Hits of the current query on 'pageIndex', searched on first use. nullptr
+// if there is no query or the page's text cannot be loaded.
+PdfPageSearchHitsRef PdfTextSearch_PageHits(FPDF_DOCUMENT doc, int pageIndex);
+
+// Step from match 'match' of page 'page' (-1: before the first match) to the
+// next match in reading order, or the previous one if 'backward', wrapping
+// around the document. Searches further pages as needed. Returns false and
+// leaves the arguments alone if the document has no match.
+bool PdfTextSearch_Step(FPDF_DOCUMENT doc, int& page, int& match, bool backward);
+
+// Call before FPDF_CloseDocument.
+void PdfTextSearch_InvalidateDocument(FPDF_DOCUMENT doc);
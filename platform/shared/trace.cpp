@@ -0,0 +1,143 @@
+#include "trace.h"
+#include "async_log.h"
+
+#include <atomic>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+constexpr size_t kTraceCapacity = 1u << 16; // most recent spans kept
+
+// Seqlock-style slot: 'seq' is the global index + 1 once written, 0 while writing.
+struct TraceSlot {
+    std::atomic<uint64_t> seq {0};
+    TraceEvent ev {};
+};
+
+struct TraceBuffer {
+    std::unique_ptr<TraceSlot[]> slots {new TraceSlot[kTraceCapacity]};
+    std::atomic<uint64_t> next {0};
+    std::atomic<bool> enabled {true};
+    std::mutex namesMutex;
+    std::map<uint32_t, std::string> threadNames;
+};
+
+TraceBuffer& Buffer() {
+    static TraceBuffer* b = new TraceBuffer(); // intentionally leaked: spans may close during exit
+    return *b;
+}
+
+void AppendEscaped(std::string& out, const char* s) {
+    for (; s && *s; ++s) {
+        const char c = *s;
+        if (c == '"' || c == '\\') { out += '\\'; out += c; }
+        else if ((unsigned char)c < 0x20) { char buf[8]; snprintf(buf, sizeof(buf), "\\u%04x", c); out += buf; }
+        else out += c;
+    }
+}
+
+} // namespace
+
+TraceSpan::TraceSpan(const char* category, const char* name, int arg)
+    : category_(category), name_(name), startNs_(0), arg_(arg) {
+    if (Buffer().enabled.load(std::memory_order_relaxed)) startNs_ = AsyncLog_NowNs() + 1;
+}
+
+TraceSpan::~TraceSpan() {
+    if (!startNs_) return;
+    const uint64_t start = startNs_ - 1;
+    Trace_Record(category_, name_, start, AsyncLog_NowNs() - start, arg_);
+}
+
+void Trace_SetEnabled(bool on) { Buffer().enabled.store(on, std::memory_order_relaxed); }
+bool Trace_IsEnabled() { return Buffer().enabled.load(std::memory_order_relaxed); }
+
+void Trace_Record(const char* category, const char* name, uint64_t startNs, uint64_t durNs, int arg) {
+    TraceBuffer& b = Buffer();
+    if (!b.enabled.load(std::memory_order_relaxed)) return;
+    const uint64_t idx = b.next.fetch_add(1, std::memory_order_relaxed);
+    TraceSlot& slot = b.slots[idx & (kTraceCapacity - 1)];
+    slot.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.ev.name = name;
+    slot.ev.category = category;
+    slot.ev.startNs = startNs;
+    slot.ev.durNs = durNs;
+    slot.ev.threadId = AsyncLog_ThreadId();
+    slot.ev.arg = arg;
+    slot.seq.store(idx + 1, std::memory_order_release);
+}
+
+void Trace_SetThreadName(const char* name) {
+    TraceBuffer& b = Buffer();
+    std::lock_guard<std::mutex> lk(b.namesMutex);
+    b.threadNames[AsyncLog_ThreadId()] = name ? name : "";
+}
+
+void Trace_Clear() {
+    TraceBuffer& b = Buffer();
+    for (size_t i = 0; i < kTraceCapacity; ++i) b.slots[i].seq.store(0, std::memory_order_relaxed);
+}
+
+std::string Trace_ToChromeJson() {
+    TraceBuffer& b = Buffer();
+    const uint64_t end = b.next.load(std::memory_order_acquire);
+    const uint64_t begin = end > kTraceCapacity ? end - kTraceCapacity : 0;
+
+    std::string out;
+    out.reserve(256 + (size_t)(end - begin) * 128);
+    out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    {
+        std::lock_guard<std::mutex> lk(b.namesMutex);
+        for (const auto& it : b.threadNames) {
+            if (!first) out += ',';
+            first = false;
+            char head[96];
+            snprintf(head, sizeof(head), "{\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"name\":\"thread_name\",\"args\":{\"name\":\"", it.first);
+            out += head;
+            AppendEscaped(out, it.second.c_str());
+            out += "\"}}";
+        }
+    }
+    for (uint64_t idx = begin; idx < end; ++idx) {
+        TraceSlot& slot = b.slots[idx & (kTraceCapacity - 1)];
+        if (slot.seq.load(std::memory_order_acquire) != idx + 1) continue;
+        const TraceEvent ev = slot.ev;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != idx + 1) continue; // overwritten while copying
+        if (!first) out += ',';
+        first = false;
+        out += "{\"ph\":\"X\",\"pid\":1,\"name\":\"";
+        AppendEscaped(out, ev.name);
+        out += "\",\"cat\":\"";
+        AppendEscaped(out, ev.category);
+        char tail[160];
+        snprintf(tail, sizeof(tail), "\",\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f", ev.threadId, ev.startNs / 1000.0,
+                 ev.durNs / 1000.0);
+        out += tail;
+        if (ev.arg >= 0) {
+            snprintf(tail, sizeof(tail), ",\"args\":{\"page\":%d}", ev.arg + 1);
+            out += tail;
+        }
+        out += '}';
+    }
+    out += "]}";
+    return out;
+}
+
+bool Trace_ExportChromeJson(const char* pathUtf8) {
+    if (!pathUtf8 || !pathUtf8[0]) return false;
+    const std::string json = Trace_ToChromeJson();
+#if defined(_WIN32)
+    FILE* f = _wfopen(AsyncLog_Utf8ToWide(pathUtf8).c_str(), L"wb");
+#else
+    FILE* f = fopen(pathUtf8, "wb");
+#endif
+    if (!f) return false;
+    const bool ok = fwrite(json.data(), 1, json.size(), f) == json.size();
+    return fclose(f) == 0 && ok;
+}
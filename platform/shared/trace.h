@@ -0,0 +1,66 @@
+// Scoped trace spans shared by macOS/Windows frontends
+//
+// PDFWV_TRACE_SCOPE("render") records one complete span (begin + duration +
+// thread id) into a fixed in-memory ring when the scope exits. The ring keeps
+// the most recent spans and can be exported as Chrome trace-event JSON
+// (load in chrome://tracing or ui.perfetto.dev).
+// All macros compile to nothing when PDFWV_ENABLE_LOGGING is 0.
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Span names / categories must be string literals (stored by pointer).
+struct TraceEvent {
+    const char* name;
+    const char* category;
+    uint64_t startNs;   // same clock as AsyncLog_NowNs()
+    uint64_t durNs;
+    uint32_t threadId;  // AsyncLog_ThreadId()
+    int32_t arg;        // page index or -1
+};
+
+class TraceSpan {
+public:
+    TraceSpan(const char* category, const char* name, int arg = -1);
+    ~TraceSpan();
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* category_;
+    const char* name_;
+    uint64_t startNs_;
+    int32_t arg_;
+};
+
+// Recording can be toggled at runtime (default: on).
+void Trace_SetEnabled(bool on);
+bool Trace_IsEnabled();
+
+// Record an already measured span (e.g. across callbacks).
+void Trace_Record(const char* category, const char* name, uint64_t startNs, uint64_t durNs, int arg = -1);
+
+// Name the calling thread in exported traces (literal or long-lived string).
+void Trace_SetThreadName(const char* name);
+
+// Drop all recorded spans.
+void Trace_Clear();
+
+// Serialize the recorded spans (oldest first) as Chrome trace-event JSON.
+std::string Trace_ToChromeJson();
+bool Trace_ExportChromeJson(const char* pathUtf8);
+
+#define PDFWV_TRACE_CONCAT_(a, b) a##b
+#define PDFWV_TRACE_CONCAT(a, b) PDFWV_TRACE_CONCAT_(a, b)
+
+#if defined(PDFWV_ENABLE_LOGGING) && PDFWV_ENABLE_LOGGING
+#define PDFWV_TRACE_SCOPE(cat, name) TraceSpan PDFWV_TRACE_CONCAT(_pdfwvTrace, __LINE__)((cat), (name))
+#define PDFWV_TRACE_SCOPE_PAGE(cat, name, page) \
+    TraceSpan PDFWV_TRACE_CONCAT(_pdfwvTrace, __LINE__)((cat), (name), (int)(page))
+#define PDFWV_TRACE_THREAD_NAME(name) Trace_SetThreadName(name)
+#else
+#define PDFWV_TRACE_SCOPE(cat, name) do {} while (0)
+#define PDFWV_TRACE_SCOPE_PAGE(cat, name, page) do {} while (0)
+#define PDFWV_TRACE_THREAD_NAME(name) do {} while (0)
+#endif
@@ -0,0 +1,87 @@
+// PDF原始对象扫描器 - 公共接口
+// 版权所有 (C) 2024 PdfWinViewer项目
+//
+// 独立于PDFium：内存映射文件，读取 xref（表/流/修复扫描）与对象流，
+// 多线程并行切分间接对象，输出每个对象的类型、大小、过滤器与引用。
+// 引用列表的语义与 PdfiumEx_GetObjectReferences 一致（去重、升序、不含自身），
+// 便于与 PDFium 的解析结果交叉校验。
+
+#ifndef PDF_RAW_SCANNER_H_
+#define PDF_RAW_SCANNER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace pdf_raw_scanner {
+
+// 间接对象的顶层类型
+enum class RawObjectType {
+    kUnknown = 0,   // 解析失败
+    kNull,
+    kBoolean,
+    kNumber,
+    kString,
+    kName,
+    kArray,
+    kDictionary,
+    kStream,
+    kReference,
+};
+
+// xref 来源
+enum class XrefKind {
+    kNone = 0,
+    kTable,          // 传统 xref 表（含混合 /XRefStm）
+    kStream,         // 交叉引用流
+    kReconstructed,  // xref 损坏，线性扫描 "N G obj" 重建
+};
+
+// 单个间接对象的扫描结果
+struct RawObjectInfo {
+    uint32_t obj_num = 0;
+    uint16_t gen_num = 0;
+    RawObjectType type = RawObjectType::kUnknown;
+    std::string dict_type;               // /Type 的值（不含'/'）
+    std::string subtype;                 // /Subtype 的值
+    uint64_t offset = 0;                 // 文件偏移（对象流中的对象为0）
+    uint32_t container = 0;              // 所在对象流编号（0表示直接存放在文件中）
+    uint64_t size = 0;                   // 对象占用字节数（文件中 obj..endobj；对象流中为解压后字节）
+    uint64_t stream_length = 0;          // 流数据长度（压缩后/编码后）
+    std::vector<std::string> filters;    // /Filter 列表
+    std::vector<uint32_t> refs;          // 引用的对象编号（去重、升序、不含自身）
+    bool parse_error = false;
+};
+
+struct ScanOptions {
+    int threads = 0;                     // 0 表示使用 std::thread::hardware_concurrency()
+};
+
+struct ScanResult {
+    bool ok = false;
+    std::string error;
+    uint64_t file_size = 0;
+    XrefKind xref = XrefKind::kNone;
+    bool encrypted = false;              // 有 /Encrypt 时对象流无法解码
+    int threads_used = 0;
+    double elapsed_ms = 0.0;
+    uint32_t object_streams = 0;         // 展开的对象流数量
+    uint32_t object_stream_errors = 0;   // 无法解码的对象流数量
+    std::vector<RawObjectInfo> objects;  // 按对象编号升序
+};
+
+// 扫描单个文件
+ScanResult ScanFile(const std::string& path, const ScanOptions& options = ScanOptions());
+
+// 扫描内存中的PDF数据（data 需在调用期间保持有效）
+ScanResult ScanBuffer(const uint8_t* data, size_t size, const ScanOptions& options = ScanOptions());
+
+const char* RawObjectTypeName(RawObjectType type);
+const char* XrefKindName(XrefKind kind);
+
+// 序列化为单行JSON（便于 NDJSON 批量输出）
+std::string ToJson(const ScanResult& result, const std::string& file_label, bool include_objects = true);
+
+} // namespace pdf_raw_scanner
+
+#endif  // PDF_RAW_SCANNER_H_
@@ -0,0 +1,984 @@
+// PDF原始对象扫描器 - 实现
+// 流程：
+//   1. 内存映射文件
+//   2. 从 startxref 沿 /Prev 链读取 xref（表或流），新节优先；失败时线性扫描重建
+//   3. 第一阶段：并行解析全部直接存放的对象（动态分配任务）
+//   4. 第二阶段：并行解压并切分对象流（每个对象流一个任务）
+//   5. 按对象编号排序输出
+
+#include "../include/pdf_raw_scanner.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace pdf_raw_scanner {
+
+namespace {
+
+// 接受的最大对象编号：防止畸形 xref（如 /Index [4000000000 1]）让条目表分配数 G 项
+constexpr uint64_t kMaxObjectNumber = 10000000;
+
+// ========== 内存映射 ==========
+
+class MappedFile {
+public:
+    ~MappedFile() { Close(); }
+
+    bool Open(const std::string& path) {
+#ifdef _WIN32
+        int wlen = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+        std::wstring wpath(wlen > 0 ? wlen - 1 : 0, L'\0');
+        if (wlen > 0) MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, wpath.data(), wlen);
+        file_ = CreateFileW(wpath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER sz;
+        if (!GetFileSizeEx(file_, &sz)) return false;
+        size_ = static_cast<size_t>(sz.QuadPart);
+        if (size_ == 0) return true;
+        mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping_) return false;
+        data_ = static_cast<const uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+        return data_ != nullptr;
+#else
+        fd_ = open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) return false;
+        struct stat st;
+        if (fstat(fd_, &st) != 0) return false;
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ == 0) return true;
+        void* p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (p == MAP_FAILED) return false;
+        data_ = static_cast<const uint8_t*>(p);
+        return true;
+#endif
+    }
+
+    void Close() {
+#ifdef _WIN32
+        if (data_) UnmapViewOfFile(data_);
+        if (mapping_) CloseHandle(mapping_);
+        if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+        mapping_ = nullptr;
+        file_ = INVALID_HANDLE_VALUE;
+#else
+        if (data_) munmap(const_cast<uint8_t*>(data_), size_);
+        if (fd_ >= 0) close(fd_);
+        fd_ = -1;
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+#ifdef _WIN32
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// ========== 词法/语法 ==========
+
+bool IsWs(uint8_t c) {
+    return c == 0 || c == '\t' || c == '\n' || c == '\f' || c == '\r' || c == ' ';
+}
+
+bool IsDelim(uint8_t c) {
+    return c == '(' || c == ')' || c == '<' || c == '>' || c == '[' || c == ']' ||
+           c == '{' || c == '}' || c == '/' || c == '%';
+}
+
+int HexValue(uint8_t c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// 轻量对象树：只保留扫描需要的信息
+struct Value {
+    RawObjectType kind = RawObjectType::kUnknown;
+    double number = 0;
+    std::string text;                                   // 名字（已解码 #xx）或字符串原文
+    uint32_t ref_num = 0;
+    std::vector<Value> items;                           // 数组
+    std::vector<std::pair<std::string, Value>> entries; // 字典
+
+    const Value* Get(const char* key) const {
+        for (const auto& e : entries) {
+            if (e.first == key) return &e.second;
+        }
+        return nullptr;
+    }
+};
+
+class Lexer {
+public:
+    Lexer(const uint8_t* data, size_t size, size_t pos) : data_(data), size_(size), pos_(pos) {}
+
+    size_t pos() const { return pos_; }
+    void set_pos(size_t pos) { pos_ = pos; }
+    bool eof() const { return pos_ >= size_; }
+
+    void SkipWs() {
+        while (pos_ < size_) {
+            uint8_t c = data_[pos_];
+            if (IsWs(c)) { ++pos_; continue; }
+            if (c == '%') {
+                while (pos_ < size_ && data_[pos_] != '\r' && data_[pos_] != '\n') ++pos_;
+                continue;
+            }
+            break;
+        }
+    }
+
+    // 读取一个常规词（数字或关键字）
+    std::string ReadWord() {
+        SkipWs();
+        size_t begin = pos_;
+        while (pos_ < size_ && !IsWs(data_[pos_]) && !IsDelim(data_[pos_])) ++pos_;
+        return std::string(reinterpret_cast<const char*>(data_ + begin), pos_ - begin);
+    }
+
+    bool ReadUInt(uint64_t* out) {
+        SkipWs();
+        size_t begin = pos_;
+        uint64_t v = 0;
+        while (pos_ < size_ && data_[pos_] >= '0' && data_[pos_] <= '9') {
+            v = v * 10 + (data_[pos_] - '0');
+            ++pos_;
+        }
+        if (pos_ == begin) return false;
+        *out = v;
+        return true;
+    }
+
+    bool MatchKeyword(const char* kw) {
+        SkipWs();
+        size_t len = strlen(kw);
+        if (pos_ + len > size_ || memcmp(data_ + pos_, kw, len) != 0) return false;
+        if (pos_ + len < size_ && !IsWs(data_[pos_ + len]) && !IsDelim(data_[pos_ + len])) return false;
+        pos_ += len;
+        return true;
+    }
+
+    bool ParseValue(Value* out, int depth = 0) {
+        if (depth > 256) return false;
+        SkipWs();
+        if (pos_ >= size_) return false;
+        uint8_t c = data_[pos_];
+        if (c == '/') {
+            out->kind = RawObjectType::kName;
+            out->text = ReadName();
+            return true;
+        }
+        if (c == '(') {
+            out->kind = RawObjectType::kString;
+            size_t begin = ++pos_;
+            int nest = 1;
+            while (pos_ < size_) {
+                uint8_t ch = data_[pos_++];
+                if (ch == '\\') { ++pos_; continue; }
+                if (ch == '(') ++nest;
+                else if (ch == ')' && --nest == 0) break;
+            }
+            out->text.assign(reinterpret_cast<const char*>(data_ + begin),
+                             std::min(pos_, size_) - begin - (nest == 0 ? 1 : 0));
+            return true;
+        }
+        if (c == '<') {
+            if (pos_ + 1 < size_ && data_[pos_ + 1] == '<') {
+                pos_ += 2;
+                out->kind = RawObjectType::kDictionary;
+                while (true) {
+                    SkipWs();
+                    if (pos_ + 1 < size_ && data_[pos_] == '>' && data_[pos_ + 1] == '>') {
+                        pos_ += 2;
+                        return true;
+                    }
+                    if (pos_ >= size_ || data_[pos_] != '/') return false;
+                    std::string key = ReadName();
+                    Value v;
+                    if (!ParseValue(&v, depth + 1)) return false;
+                    out->entries.emplace_back(std::move(key), std::move(v));
+                }
+            }
+            out->kind = RawObjectType::kString;
+            size_t begin = ++pos_;
+            while (pos_ < size_ && data_[pos_] != '>') ++pos_;
+            out->text.assign(reinterpret_cast<const char*>(data_ + begin), pos_ - begin);
+            if (pos_ < size_) ++pos_;
+            return true;
+        }
+        if (c == '[') {
+            ++pos_;
+            out->kind = RawObjectType::kArray;
+            while (true) {
+                SkipWs();
+                if (pos_ < size_ && data_[pos_] == ']') { ++pos_; return true; }
+                Value v;
+                if (!ParseValue(&v, depth + 1)) return false;
+                out->items.push_back(std::move(v));
+            }
+        }
+        if (IsDelim(c)) return false;
+
+        std::string word = ReadWord();
+        if (word.empty()) return false;
+        if (word == "true" || word == "false") { out->kind = RawObjectType::kBoolean; return true; }
+        if (word == "null") { out->kind = RawObjectType::kNull; return true; }
+        char* end = nullptr;
+        double num = strtod(word.c_str(), &end);
+        if (!end || *end != '\0') return false;  // 其它关键字（endobj、stream…）
+        // 检查 "N G R"
+        bool is_int = word.find_first_not_of("0123456789") == std::string::npos;
+        if (is_int) {
+            size_t save = pos_;
+            uint64_t gen = 0;
+            if (ReadUInt(&gen) && MatchKeyword("R")) {
+                out->kind = RawObjectType::kReference;
+                out->ref_num = static_cast<uint32_t>(num);
+                return true;
+            }
+            pos_ = save;
+        }
+        out->kind = RawObjectType::kNumber;
+        out->number = num;
+        return true;
+    }
+
+private:
+    std::string ReadName() {
+        ++pos_;  // '/'
+        std::string name;
+        while (pos_ < size_ && !IsWs(data_[pos_]) && !IsDelim(data_[pos_])) {
+            uint8_t c = data_[pos_];
+            if (c == '#' && pos_ + 2 < size_ && HexValue(data_[pos_ + 1]) >= 0 && HexValue(data_[pos_ + 2]) >= 0) {
+                name.push_back(static_cast<char>(HexValue(data_[pos_ + 1]) * 16 + HexValue(data_[pos_ + 2])));
+                pos_ += 3;
+                continue;
+            }
+            name.push_back(static_cast<char>(c));
+            ++pos_;
+        }
+        return name;
+    }
+
+    const uint8_t* data_;
+    size_t size_;
+    size_t pos_;
+};
+
+void CollectRefs(const Value& v, std::vector<uint32_t>* refs) {
+    switch (v.kind) {
+        case RawObjectType::kReference: refs->push_back(v.ref_num); break;
+        case RawObjectType::kArray:
+            for (const auto& item : v.items) CollectRefs(item, refs);
+            break;
+        case RawObjectType::kDictionary:
+        case RawObjectType::kStream:
+            for (const auto& e : v.entries) CollectRefs(e.second, refs);
+            break;
+        default: break;
+    }
+}
+
+void FinalizeRefs(RawObjectInfo* info) {
+    auto& r = info->refs;
+    std::sort(r.begin(), r.end());
+    r.erase(std::unique(r.begin(), r.end()), r.end());
+    r.erase(std::remove_if(r.begin(), r.end(), [&](uint32_t n) { return n == 0 || n == info->obj_num; }), r.end());
+}
+
+// 从顶层值填充类型、/Type、/Subtype、/Filter 与引用
+void FillInfoFromValue(const Value& v, RawObjectInfo* info) {
+    info->type = v.kind;
+    if (v.kind == RawObjectType::kDictionary || v.kind == RawObjectType::kStream) {
+        if (const Value* t = v.Get("Type"); t && t->kind == RawObjectType::kName) info->dict_type = t->text;
+        if (const Value* st = v.Get("Subtype"); st && st->kind == RawObjectType::kName) info->subtype = st->text;
+        if (const Value* f = v.Get("Filter")) {
+            if (f->kind == RawObjectType::kName) info->filters.push_back(f->text);
+            else if (f->kind == RawObjectType::kArray) {
+                for (const auto& item : f->items) {
+                    if (item.kind == RawObjectType::kName) info->filters.push_back(item.text);
+                }
+            }
+        }
+    }
+    CollectRefs(v, &info->refs);
+    FinalizeRefs(info);
+}
+
+// ========== 解码 ==========
+
+bool FlateDecode(const uint8_t* src, size_t len, std::vector<uint8_t>* out) {
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    if (inflateInit(&zs) != Z_OK) return false;
+    zs.next_in = const_cast<Bytef*>(src);
+    zs.avail_in = static_cast<uInt>(len);
+    out->clear();
+    uint8_t buf[64 * 1024];
+    int ret = Z_OK;
+    while (ret == Z_OK) {
+        zs.next_out = buf;
+        zs.avail_out = sizeof(buf);
+        ret = inflate(&zs, Z_NO_FLUSH);
+        out->insert(out->end(), buf, buf + (sizeof(buf) - zs.avail_out));
+        if (ret == Z_BUF_ERROR && zs.avail_in == 0) break;  // 截断的流：保留已解出的数据
+    }
+    inflateEnd(&zs);
+    return ret == Z_STREAM_END || !out->empty();
+}
+
+// PNG 预测器（xref 流常用 /Predictor 12）
+bool UndoPngPredictor(std::vector<uint8_t>* data, int columns, int colors, int bpc) {
+    const size_t bpp = std::max(1, (colors * bpc + 7) / 8);
+    const size_t row_len = (static_cast<size_t>(columns) * colors * bpc + 7) / 8;
+    if (row_len == 0) return false;
+    std::vector<uint8_t> out;
+    std::vector<uint8_t> prev(row_len, 0);
+    size_t pos = 0;
+    while (pos + 1 + row_len <= data->size()) {
+        uint8_t tag = (*data)[pos++];
+        uint8_t* row = data->data() + pos;
+        for (size_t i = 0; i < row_len; ++i) {
+            uint8_t left = i >= bpp ? row[i - bpp] : 0;
+            uint8_t up = prev[i];
+            uint8_t up_left = i >= bpp ? prev[i - bpp] : 0;
+            switch (tag) {
+                case 1: row[i] += left; break;
+                case 2: row[i] += up; break;
+                case 3: row[i] += static_cast<uint8_t>((left + up) / 2); break;
+                case 4: {
+                    int p = left + up - up_left;
+                    int pa = abs(p - left), pb = abs(p - up), pc = abs(p - up_left);
+                    row[i] += (pa <= pb && pa <= pc) ? left : (pb <= pc ? up : up_left);
+                    break;
+                }
+                default: break;
+            }
+        }
+        out.insert(out.end(), row, row + row_len);
+        memcpy(prev.data(), row, row_len);
+        pos += row_len;
+    }
+    data->swap(out);
+    return true;
+}
+
+int GetInt(const Value* v, int def) {
+    return v && v->kind == RawObjectType::kNumber ? static_cast<int>(v->number) : def;
+}
+
+// 解码流数据：只支持 FlateDecode（含预测器），对象流与 xref 流实际只用到它
+bool DecodeStream(const Value& dict, const uint8_t* src, size_t len, std::vector<uint8_t>* out) {
+    std::vector<std::string> filters;
+    const Value* parms = dict.Get("DecodeParms");
+    if (const Value* f = dict.Get("Filter")) {
+        if (f->kind == RawObjectType::kName) filters.push_back(f->text);
+        else if (f->kind == RawObjectType::kArray) {
+            for (const auto& item : f->items) filters.push_back(item.text);
+            if (parms && parms->kind == RawObjectType::kArray) parms = parms->items.empty() ? nullptr : &parms->items[0];
+        }
+    }
+    if (filters.empty()) {
+        out->assign(src, src + len);
+        return true;
+    }
+    if (filters.size() != 1 || (filters[0] != "FlateDecode" && filters[0] != "Fl")) return false;
+    if (!FlateDecode(src, len, out)) return false;
+    if (parms && parms->kind == RawObjectType::kDictionary) {
+        int predictor = GetInt(parms->Get("Predictor"), 1);
+        if (predictor >= 10) {
+            return UndoPngPredictor(out, GetInt(parms->Get("Columns"), 1), GetInt(parms->Get("Colors"), 1),
+                                    GetInt(parms->Get("BitsPerComponent"), 8));
+        }
+        if (predictor != 1) return false;  // TIFF 预测器极少用于对象/xref 流
+    }
+    return true;
+}
+
+// ========== xref ==========
+
+struct XrefEntry {
+    uint8_t type = 0;       // 0 空闲/未设置，1 直接存放，2 对象流中
+    bool set = false;
+    uint64_t field2 = 0;    // 偏移 或 对象流编号
+    uint32_t field3 = 0;    // 代号 或 对象流内序号
+};
+
+size_t FindLast(const uint8_t* data, size_t size, const char* needle, size_t window) {
+    size_t len = strlen(needle);
+    if (size < len) return SIZE_MAX;
+    size_t stop = size > window ? size - window : 0;
+    for (size_t i = size - len + 1; i-- > stop;) {
+        if (memcmp(data + i, needle, len) == 0) return i;
+    }
+    return SIZE_MAX;
+}
+
+size_t FindForward(const uint8_t* data, size_t size, size_t from, const char* needle) {
+    size_t len = strlen(needle);
+    if (size < len) return SIZE_MAX;
+    for (size_t i = from; i + len <= size; ++i) {
+        if (data[i] == needle[0] && memcmp(data + i, needle, len) == 0) return i;
+    }
+    return SIZE_MAX;
+}
+
+class Scanner {
+public:
+    Scanner(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+    bool ReadXref(ScanResult* result) {
+        size_t sx = FindLast(data_, size_, "startxref", 4096);
+        if (sx == SIZE_MAX) return false;
+        Lexer lx(data_, size_, sx + 9);
+        uint64_t offset = 0;
+        if (!lx.ReadUInt(&offset)) return false;
+
+        std::unordered_set<uint64_t> visited;
+        bool first = true;
+        while (offset < size_ && visited.insert(offset).second) {
+            Value trailer;
+            bool is_stream = false;
+            if (!ReadXrefSection(offset, &trailer, &is_stream)) return !first;
+            if (first) {
+                result->xref = is_stream ? XrefKind::kStream : XrefKind::kTable;
+                result->encrypted = trailer.Get("Encrypt") != nullptr;
+                first = false;
+            }
+            // 混合文件：表之后紧接着读 /XRefStm
+            if (const Value* xs = trailer.Get("XRefStm"); !is_stream && xs && xs->kind == RawObjectType::kNumber) {
+                Value ignored;
+                bool s = false;
+                if (visited.insert(static_cast<uint64_t>(xs->number)).second)
+                    ReadXrefSection(static_cast<uint64_t>(xs->number), &ignored, &s);
+            }
+            const Value* prev = trailer.Get("Prev");
+            if (!prev || prev->kind != RawObjectType::kNumber) break;
+            offset = static_cast<uint64_t>(prev->number);
+        }
+        return !first;
+    }
+
+    // xref 损坏时线性扫描 "N G obj"，后出现的覆盖先出现的
+    void Reconstruct(ScanResult* result) {
+        result->xref = XrefKind::kReconstructed;
+        entries_.clear();
+        size_t pos = 0;
+        while ((pos = FindForward(data_, size_, pos, "obj")) != SIZE_MAX) {
+            size_t kw = pos;
+            pos += 3;
+            if (pos < size_ && !IsWs(data_[pos]) && !IsDelim(data_[pos])) continue;
+            // 向前找 "N G "
+            size_t p = kw;
+            auto back_ws = [&]() { while (p > 0 && IsWs(data_[p - 1])) --p; };
+            auto back_digits = [&]() {
+                size_t end = p;
+                while (p > 0 && data_[p - 1] >= '0' && data_[p - 1] <= '9') --p;
+                return end - p;
+            };
+            back_ws();
+            size_t gen_end = p;
+            if (back_digits() == 0) continue;
+            size_t gen_begin = p;
+            back_ws();
+            if (p == gen_begin) continue;
+            size_t num_end = p;
+            if (back_digits() == 0) continue;
+            if (p > 0 && !IsWs(data_[p - 1]) && !IsDelim(data_[p - 1])) continue;
+            uint64_t num = strtoull(std::string(reinterpret_cast<const char*>(data_ + p), num_end - p).c_str(), nullptr, 10);
+            uint64_t gen = strtoull(std::string(reinterpret_cast<const char*>(data_ + gen_begin), gen_end - gen_begin).c_str(), nullptr, 10);
+            if (num == 0 || num > kMaxObjectNumber) continue;
+            XrefEntry& e = Entry(static_cast<uint32_t>(num));
+            e.type = 1;
+            e.set = true;
+            e.field2 = p;
+            e.field3 = static_cast<uint32_t>(gen);
+        }
+        const size_t tr = FindLast(data_, size_, "trailer", size_);
+        if (tr != SIZE_MAX) {
+            Lexer lx(data_, size_, tr + 7);
+            Value trailer;
+            if (lx.ParseValue(&trailer)) result->encrypted = trailer.Get("Encrypt") != nullptr;
+        }
+    }
+
+    const std::vector<XrefEntry>& entries() const { return entries_; }
+
+    // 解析直接存放的对象，返回顶层值；stream 相关字段写入 info
+    bool ParseDirectObject(uint64_t offset, RawObjectInfo* info, Value* value,
+                           size_t* stream_begin, size_t* stream_len) const {
+        Lexer lx(data_, size_, offset);
+        uint64_t num = 0, gen = 0;
+        if (!lx.ReadUInt(&num) || !lx.ReadUInt(&gen) || !lx.MatchKeyword("obj")) return false;
+        if (!lx.ParseValue(value)) return false;
+        size_t end = lx.pos();
+        *stream_begin = 0;
+        *stream_len = 0;
+        if (value->kind == RawObjectType::kDictionary && lx.MatchKeyword("stream")) {
+            size_t p = lx.pos();
+            if (p < size_ && data_[p] == '\r') ++p;
+            if (p < size_ && data_[p] == '\n') ++p;
+            *stream_begin = p;
+            size_t len = ResolveLength(value->Get("Length"));
+            if (!(len != SIZE_MAX && p + len <= size_ && EndstreamAt(p + len))) {
+                size_t es = FindForward(data_, size_, p, "endstream");
+                len = es == SIZE_MAX ? size_ - p : es - p;
+                while (len > 0 && (data_[p + len - 1] == '\n' || data_[p + len - 1] == '\r')) --len;
+            }
+            *stream_len = len;
+            end = p + len;
+            value->kind = RawObjectType::kStream;
+        }
+        size_t eo = FindForward(data_, size_, end, "endobj");
+        end = eo == SIZE_MAX ? end : eo + 6;
+        info->size = end - offset;
+        info->stream_length = *stream_len;
+        return true;
+    }
+
+private:
+    XrefEntry& Entry(uint32_t num) {
+        if (num >= entries_.size()) entries_.resize(num + 1);
+        return entries_[num];
+    }
+
+    void SetEntry(uint32_t num, uint8_t type, uint64_t f2, uint32_t f3) {
+        XrefEntry& e = Entry(num);
+        if (e.set) return;  // 新节（先读）优先
+        e.set = true;
+        e.type = type;
+        e.field2 = f2;
+        e.field3 = f3;
+    }
+
+    bool EndstreamAt(size_t p) const {
+        Lexer lx(data_, size_, p);
+        return lx.MatchKeyword("endstream");
+    }
+
+    // /Length 可能是间接引用
+    size_t ResolveLength(const Value* v) const {
+        if (!v) return SIZE_MAX;
+        if (v->kind == RawObjectType::kNumber) return v->number >= 0 ? static_cast<size_t>(v->number) : SIZE_MAX;
+        if (v->kind != RawObjectType::kReference || v->ref_num >= entries_.size()) return SIZE_MAX;
+        const XrefEntry& e = entries_[v->ref_num];
+        if (e.type != 1) return SIZE_MAX;
+        Lexer lx(data_, size_, e.field2);
+        uint64_t num = 0, gen = 0, len = 0;
+        if (!lx.ReadUInt(&num) || !lx.ReadUInt(&gen) || !lx.MatchKeyword("obj") || !lx.ReadUInt(&len)) return SIZE_MAX;
+        return static_cast<size_t>(len);
+    }
+
+    bool ReadXrefSection(uint64_t offset, Value* trailer, bool* is_stream) {
+        Lexer lx(data_, size_, offset);
+        if (lx.MatchKeyword("xref")) {
+            *is_stream = false;
+            while (true) {
+                size_t save = lx.pos();
+                if (lx.MatchKeyword("trailer")) break;
+                lx.set_pos(save);
+                uint64_t start = 0, count = 0;
+                if (!lx.ReadUInt(&start) || !lx.ReadUInt(&count)) return false;
+                for (uint64_t i = 0; i < count; ++i) {
+                    uint64_t off = 0, gen = 0;
+                    if (!lx.ReadUInt(&off) || !lx.ReadUInt(&gen)) return false;
+                    std::string kind = lx.ReadWord();
+                    if (start + i > kMaxObjectNumber) continue;
+                    uint32_t num = static_cast<uint32_t>(start + i);
+                    if (num == 0) continue;
+                    SetEntry(num, kind == "n" ? 1 : 0, off, static_cast<uint32_t>(gen));
+                }
+            }
+            return lx.ParseValue(trailer) && trailer->kind == RawObjectType::kDictionary;
+        }
+
+        // 交叉引用流
+        *is_stream = true;
+        RawObjectInfo info;
+        size_t sbegin = 0, slen = 0;
+        if (!ParseDirectObject(offset, &info, trailer, &sbegin, &slen)) return false;
+        if (trailer->kind != RawObjectType::kStream) return false;
+        std::vector<uint8_t> decoded;
+        if (!DecodeStream(*trailer, data_ + sbegin, slen, &decoded)) return false;
+
+        const Value* w = trailer->Get("W");
+        if (!w || w->kind != RawObjectType::kArray || w->items.size() < 3) return false;
+        // 每个字段最多 8 字节（uint64），负数或超宽的 /W 整节拒绝
+        int widths[3];
+        for (int i = 0; i < 3; ++i) {
+            const Value& item = w->items[i];
+            if (item.kind != RawObjectType::kNumber || item.number < 0 || item.number > 8) return false;
+            widths[i] = static_cast<int>(item.number);
+        }
+        const size_t row = static_cast<size_t>(widths[0] + widths[1] + widths[2]);
+        if (row == 0) return false;
+
+        // 起始编号与数量限制在 kMaxObjectNumber 内，不经 int 截断
+        auto object_count = [](const Value* v) -> uint64_t {
+            if (!v || v->kind != RawObjectType::kNumber || !(v->number >= 0)) return 0;
+            return v->number < static_cast<double>(kMaxObjectNumber) ? static_cast<uint64_t>(v->number)
+                                                                      : kMaxObjectNumber;
+        };
+        std::vector<std::pair<uint64_t, uint64_t>> ranges;
+        if (const Value* idx = trailer->Get("Index"); idx && idx->kind == RawObjectType::kArray) {
+            for (size_t i = 0; i + 1 < idx->items.size(); i += 2) {
+                const uint64_t start = object_count(&idx->items[i]);
+                const uint64_t count = object_count(&idx->items[i + 1]);
+                if (start < kMaxObjectNumber) ranges.emplace_back(start, std::min(count, kMaxObjectNumber - start));
+            }
+        } else {
+            ranges.emplace_back(0, object_count(trailer->Get("Size")));
+        }
+
+        size_t pos = 0;
+        auto field = [&](int width, uint64_t def) {
+            if (width == 0) return def;
+            uint64_t v = 0;
+            for (int i = 0; i < width && pos < decoded.size(); ++i) v = (v << 8) | decoded[pos++];
+            return v;
+        };
+        for (const auto& range : ranges) {
+            for (uint64_t i = 0; i < range.second && pos + row <= decoded.size(); ++i) {
+                uint64_t type = field(widths[0], 1);
+                uint64_t f2 = field(widths[1], 0);
+                uint64_t f3 = field(widths[2], 0);
+                uint32_t num = static_cast<uint32_t>(range.first + i);
+                if (num == 0) continue;
+                SetEntry(num, static_cast<uint8_t>(type <= 2 ? type : 0), f2, static_cast<uint32_t>(f3));
+            }
+        }
+        return true;
+    }
+
+    const uint8_t* data_;
+    size_t size_;
+    std::vector<XrefEntry> entries_;
+};
+
+// 对象流任务需要的第一阶段信息
+struct ObjStmInfo {
+    uint32_t obj_num = 0;
+    Value dict;
+    size_t stream_begin = 0;
+    size_t stream_len = 0;
+};
+
+// 动态分配的并行 for：worker 从原子计数器领取任务下标
+template <typename Fn>
+void ParallelFor(size_t count, int threads, Fn fn) {
+    if (count == 0) return;
+    const int n = std::max(1, std::min<int>(threads, static_cast<int>(count)));
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) fn(i);
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < n; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool) th.join();
+}
+
+} // namespace
+
+ScanResult ScanBuffer(const uint8_t* data, size_t size, const ScanOptions& options) {
+    auto t0 = std::chrono::steady_clock::now();
+    ScanResult result;
+    result.file_size = size;
+    int threads = options.threads > 0 ? options.threads : static_cast<int>(std::thread::hardware_concurrency());
+    result.threads_used = std::max(1, threads);
+
+    if (!data || size < 8) {
+        result.error = "file too small";
+        return result;
+    }
+
+    Scanner scanner(data, size);
+    if (!scanner.ReadXref(&result)) scanner.Reconstruct(&result);
+    const std::vector<XrefEntry>& xref = scanner.entries();
+
+    // 第一阶段：直接存放的对象
+    std::vector<uint32_t> direct;
+    for (uint32_t num = 1; num < xref.size(); ++num) {
+        if (xref[num].type == 1 && xref[num].field2 < size) direct.push_back(num);
+    }
+    std::vector<RawObjectInfo> direct_infos(direct.size());
+    std::vector<std::unique_ptr<ObjStmInfo>> objstm_slots(direct.size());
+    ParallelFor(direct.size(), result.threads_used, [&](size_t i) {
+        const XrefEntry& e = xref[direct[i]];
+        RawObjectInfo& info = direct_infos[i];
+        info.obj_num = direct[i];
+        info.gen_num = static_cast<uint16_t>(e.field3);
+        info.offset = e.field2;
+        Value value;
+        size_t sbegin = 0, slen = 0;
+        if (!scanner.ParseDirectObject(e.field2, &info, &value, &sbegin, &slen)) {
+            info.parse_error = true;
+            return;
+        }
+        FillInfoFromValue(value, &info);
+        if (info.type == RawObjectType::kStream && info.dict_type == "ObjStm") {
+            auto slot = std::make_unique<ObjStmInfo>();
+            slot->obj_num = info.obj_num;
+            slot->dict = std::move(value);
+            slot->stream_begin = sbegin;
+            slot->stream_len = slen;
+            objstm_slots[i] = std::move(slot);
+        }
+    });
+
+    // 第二阶段：对象流（每个流一个任务）
+    std::vector<ObjStmInfo*> objstms;
+    for (auto& slot : objstm_slots) {
+        if (slot) objstms.push_back(slot.get());
+    }
+    result.object_streams = static_cast<uint32_t>(objstms.size());
+    std::vector<std::vector<RawObjectInfo>> contained(objstms.size());
+    std::atomic<uint32_t> objstm_errors{0};
+    ParallelFor(objstms.size(), result.threads_used, [&](size_t i) {
+        const ObjStmInfo& os = *objstms[i];
+        std::vector<uint8_t> decoded;
+        if (result.encrypted || !DecodeStream(os.dict, data + os.stream_begin, os.stream_len, &decoded)) {
+            objstm_errors.fetch_add(1);
+            return;
+        }
+        const int n = GetInt(os.dict.Get("N"), 0);
+        const size_t first = static_cast<size_t>(GetInt(os.dict.Get("First"), 0));
+        if (n <= 0 || first > decoded.size()) {
+            objstm_errors.fetch_add(1);
+            return;
+        }
+        Lexer header(decoded.data(), first, 0);
+        std::vector<std::pair<uint32_t, size_t>> offsets;
+        for (int k = 0; k < n; ++k) {
+            uint64_t num = 0, off = 0;
+            if (!header.ReadUInt(&num) || !header.ReadUInt(&off)) break;
+            offsets.emplace_back(static_cast<uint32_t>(num), first + static_cast<size_t>(off));
+        }
+        for (size_t k = 0; k < offsets.size(); ++k) {
+            const uint32_t num = offsets[k].first;
+            // 只报告 xref 指向本对象流的对象；重建模式下 xref 中没有的对象也报告
+            bool listed = num < xref.size() && xref[num].set;
+            if (listed && !(xref[num].type == 2 && xref[num].field2 == os.obj_num)) continue;
+            RawObjectInfo info;
+            info.obj_num = num;
+            info.container = os.obj_num;
+            size_t begin = std::min(offsets[k].second, decoded.size());
+            size_t end = k + 1 < offsets.size() ? std::min(offsets[k + 1].second, decoded.size()) : decoded.size();
+            info.size = end > begin ? end - begin : 0;
+            Lexer lx(decoded.data(), end, begin);
+            Value value;
+            if (lx.ParseValue(&value)) FillInfoFromValue(value, &info);
+            else info.parse_error = true;
+            contained[i].push_back(std::move(info));
+        }
+    });
+    result.object_stream_errors = objstm_errors.load();
+
+    // 合并并按对象编号排序
+    result.objects = std::move(direct_infos);
+    for (auto& list : contained) {
+        for (auto& info : list) result.objects.push_back(std::move(info));
+    }
+    std::sort(result.objects.begin(), result.objects.end(),
+              [](const RawObjectInfo& a, const RawObjectInfo& b) { return a.obj_num < b.obj_num; });
+
+    result.ok = true;
+    result.elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    return result;
+}
+
+ScanResult ScanFile(const std::string& path, const ScanOptions& options) {
+    auto t0 = std::chrono::steady_clock::now();
+    MappedFile file;
+    if (!file.Open(path)) {
+        ScanResult result;
+        result.error = "cannot open/map file";
+        return result;
+    }
+    ScanResult result = ScanBuffer(file.data(), file.size(), options);
+    result.elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    return result;
+}
+
+const char* RawObjectTypeName(RawObjectType type) {
+    switch (type) {
+        case RawObjectType::kNull: return "null";
+        case RawObjectType::kBoolean: return "boolean";
+        case RawObjectType::kNumber: return "number";
+        case RawObjectType::kString: return "string";
+        case RawObjectType::kName: return "name";
+        case RawObjectType::kArray: return "array";
+        case RawObjectType::kDictionary: return "dictionary";
+        case RawObjectType::kStream: return "stream";
+        case RawObjectType::kReference: return "reference";
+        default: return "unknown";
+    }
+}
+
+const char* XrefKindName(XrefKind kind) {
+    switch (kind) {
+        case XrefKind::kTable: return "table";
+        case XrefKind::kStream: return "stream";
+        case XrefKind::kReconstructed: return "reconstructed";
+        default: return "none";
+    }
+}
+
+namespace {
+
+void AppendJsonString(std::string* out, const std::string& s) {
+    out->push_back('"');
+    for (unsigned char c : s) {
+        switch (c) {
+            case '"': out->append("\\\""); break;
+            case '\\': out->append("\\\\"); break;
+            case '\n': out->append("\\n"); break;
+            case '\r': out->append("\\r"); break;
+            case '\t': out->append("\\t"); break;
+            default:
+                if (c < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out->append(buf);
+                } else {
+                    out->push_back(static_cast<char>(c));
+                }
+        }
+    }
+    out->push_back('"');
+}
+
+} // namespace
+
+std::string ToJson(const ScanResult& result, const std::string& file_label, bool include_objects) {
+    std::string out;
+    out.reserve(include_objects ? 128 + result.objects.size() * 96 : 512);
+    char buf[256];
+    out.append("{\"file\":");
+    AppendJsonString(&out, file_label);
+    snprintf(buf, sizeof(buf),
+             ",\"ok\":%s,\"file_size\":%llu,\"xref\":\"%s\",\"encrypted\":%s,\"threads\":%d,"
+             "\"elapsed_ms\":%.3f,\"object_count\":%zu,\"object_streams\":%u,\"object_stream_errors\":%u",
+             result.ok ? "true" : "false", static_cast<unsigned long long>(result.file_size),
+             XrefKindName(result.xref), result.encrypted ? "true" : "false", result.threads_used,
+             result.elapsed_ms, result.objects.size(), result.object_streams, result.object_stream_errors);
+    out.append(buf);
+    if (!result.error.empty()) {
+        out.append(",\"error\":");
+        AppendJsonString(&out, result.error);
+    }
+
+    // 汇总：按类型和过滤器统计
+    std::unordered_map<std::string, std::pair<uint64_t, uint64_t>> by_type;    // 数量, 字节
+    std::unordered_map<std::string, std::pair<uint64_t, uint64_t>> by_filter;  // 数量, 流字节
+    uint64_t parse_errors = 0;
+    for (const auto& o : result.objects) {
+        std::string key = o.dict_type.empty() ? RawObjectTypeName(o.type) : o.dict_type;
+        if (!o.subtype.empty()) key += "/" + o.subtype;
+        auto& t = by_type[key];
+        ++t.first;
+        t.second += o.size;
+        for (const auto& f : o.filters) {
+            auto& fl = by_filter[f];
+            ++fl.first;
+            fl.second += o.stream_length;
+        }
+        parse_errors += o.parse_error ? 1 : 0;
+    }
+    auto append_group = [&](const char* name, const std::unordered_map<std::string, std::pair<uint64_t, uint64_t>>& m) {
+        std::vector<std::pair<std::string, std::pair<uint64_t, uint64_t>>> sorted(m.begin(), m.end());
+        std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        out.append(",\"");
+        out.append(name);
+        out.append("\":{");
+        for (size_t i = 0; i < sorted.size(); ++i) {
+            if (i) out.push_back(',');
+            AppendJsonString(&out, sorted[i].first);
+            snprintf(buf, sizeof(buf), ":{\"count\":%llu,\"bytes\":%llu}",
+                     static_cast<unsigned long long>(sorted[i].second.first),
+                     static_cast<unsigned long long>(sorted[i].second.second));
+            out.append(buf);
+        }
+        out.push_back('}');
+    };
+    append_group("by_type", by_type);
+    append_group("by_filter", by_filter);
+    snprintf(buf, sizeof(buf), ",\"parse_errors\":%llu", static_cast<unsigned long long>(parse_errors));
+    out.append(buf);
+
+    if (include_objects) {
+        out.append(",\"objects\":[");
+        for (size_t i = 0; i < result.objects.size(); ++i) {
+            const RawObjectInfo& o = result.objects[i];
+            if (i) out.push_back(',');
+            snprintf(buf, sizeof(buf),
+                     "{\"num\":%u,\"gen\":%u,\"type\":\"%s\",\"offset\":%llu,\"container\":%u,"
+                     "\"size\":%llu,\"stream_length\":%llu",
+                     o.obj_num, o.gen_num, RawObjectTypeName(o.type), static_cast<unsigned long long>(o.offset),
+                     o.container, static_cast<unsigned long long>(o.size),
+                     static_cast<unsigned long long>(o.stream_length));
+            out.append(buf);
+            if (!o.dict_type.empty()) {
+                out.append(",\"dict_type\":");
+                AppendJsonString(&out, o.dict_type);
+            }
+            if (!o.subtype.empty()) {
+                out.append(",\"subtype\":");
+                AppendJsonString(&out, o.subtype);
+            }
+            if (!o.filters.empty()) {
+                out.append(",\"filters\":[");
+                for (size_t k = 0; k < o.filters.size(); ++k) {
+                    if (k) out.push_back(',');
+                    AppendJsonString(&out, o.filters[k]);
+                }
+                out.push_back(']');
+            }
+            out.append(",\"refs\":[");
+            for (size_t k = 0; k < o.refs.size(); ++k) {
+                if (k) out.push_back(',');
+                out.append(std::to_string(o.refs[k]));
+            }
+            out.push_back(']');
+            if (o.parse_error) out.append(",\"parse_error\":true");
+            out.push_back('}');
+        }
+        out.push_back(']');
+    }
+    out.push_back('}');
+    return out;
+}
+
+} // namespace pdf_raw_scanner
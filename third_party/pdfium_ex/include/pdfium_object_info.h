@@ -44,6 +44,51 @@ typedef struct PDFIUM_EX_OBJECT_TREE_NODE {
     int depth;
 } PDFIUM_EX_OBJECT_TREE_NODE;
 
+// 页面对象在内容流中的来源（由内容流扫描得到）
+typedef struct PDFIUM_EX_CONTENT_SOURCE {
+    uint32_t obj_num;           // 映射到的对象编号（Do/sh为资源对象，其余为内容流）
+    uint32_t stream_obj_num;    // 所在内容流对象编号（0表示直接对象）
+    int stream_index;           // 在页面 /Contents 中的序号
+    uint32_t op_begin;          // 解码后内容流中的起始字节偏移（含操作数）
+    uint32_t op_end;            // 结束字节偏移（不含）
+    char op[8];                 // 生成该对象的操作符（Tj/TJ/Do/f/S/BI/sh…）
+    char resource_name[64];     // 引用的资源名（字体或XObject，不含'/'）
+    uint32_t resource_obj_num;  // 引用资源的对象编号（0表示无或直接对象）
+} PDFIUM_EX_CONTENT_SOURCE;
+
+// 页面对象映射缓存统计（按文档）
+typedef struct PDFIUM_EX_MAPPING_CACHE_STATS {
+    uint64_t hits;              // 命中次数（无需扫描内容流，含页面重新加载后的重新绑定）
+    uint64_t misses;            // 未命中次数（需要扫描内容流建立页面索引）
+    uint64_t evictions;         // LRU淘汰的页面数
+    uint64_t page_builds;       // 构建页面索引的次数
+    int cached_pages;           // 当前缓存的页面数
+    int capacity;               // 页面数上限
+} PDFIUM_EX_MAPPING_CACHE_STATS;
+
+// 本库持有的内存（字节，进程内全部文档合计），peak 为历史最大值
+typedef struct PDFIUM_EX_MEMORY_STATS {
+    int64_t object_info_bytes;      // 尚未 ReleaseObjectInfo 的对象信息（含字典内容）
+    int64_t object_info_peak;
+    int64_t object_tree_bytes;      // 尚未 ReleaseObjectTree 的对象树
+    int64_t object_tree_peak;
+    int64_t mapping_cache_bytes;    // 页面对象映射缓存（按容器容量估算）
+    int64_t mapping_cache_peak;
+    int64_t reference_graph_bytes;  // 文档引用图
+    int64_t reference_graph_peak;
+} PDFIUM_EX_MEMORY_STATS;
+
+// 书签条目（PdfiumEx_SetOutline 的输入）
+typedef struct PDFIUM_EX_OUTLINE_ENTRY {
+    const char* title;          // 标题（UTF-8）
+    int parent;                 // 父条目下标（必须小于本条目下标），-1 表示顶层
+    int page_index;             // 目标页（/Fit），-1 表示无目标
+} PDFIUM_EX_OUTLINE_ENTRY;
+
+// 文档分析选项（PdfiumEx_AnalyzeDocument 的 flags）
+#define PDFIUM_EX_ANALYZE_SKIP_PAGES  0x01  // 不逐页加载（跳过内容流大小/对象数/解析耗时）
+#define PDFIUM_EX_ANALYZE_SKIP_DECODE 0x02  // 不解压流，decompressed 等于 compressed
+
 // 获取页面对象的真实PDF信息
 FPDF_EXPORT PDFIUM_EX_OBJECT_INFO* FPDF_CALLCONV 
 PdfiumEx_GetPageObjectInfo(FPDF_PAGEOBJECT page_object);
@@ -64,6 +109,80 @@ PdfiumEx_GetRawObjectContent(FPDF_DOCUMENT document, uint32_t obj_num, uint32_t
 FPDF_EXPORT uint32_t FPDF_CALLCONV 
 PdfiumEx_GetPageObjectNumber(FPDF_PAGEOBJECT page_object);
 
+// 获取图像对象所用图像 XObject 的对象编号（内联图像返回0），无需页面索引
+FPDF_EXPORT uint32_t FPDF_CALLCONV 
+PdfiumEx_GetImageObjectNumber(FPDF_PAGEOBJECT image_object);
+
+// 图像字典中影响解码结果的参数（/ColorSpace /BitsPerComponent /Decode /DecodeParms
+// /ImageMask /Mask /SMask /SMaskInData）的64位哈希，非图像对象返回0。
+// 流字节相同但这些参数不同的两幅图像解码结果不同，按字节去重时需一并比较
+FPDF_EXPORT uint64_t FPDF_CALLCONV 
+PdfiumEx_GetImageParamsHash(FPDF_PAGEOBJECT image_object);
+
+// 图像码流能否原样写出：无 /Decode、非 /ImageMask，且颜色空间为 DeviceGray/RGB/CMYK
+// （或 /N、/Alternate 与之对应的 ICCBased；JPX 省略颜色空间亦可）时返回1。
+// 其余（Indexed、Separation、DeviceN、Lab 等）需解码为像素后再导出
+FPDF_EXPORT int FPDF_CALLCONV 
+PdfiumEx_IsImageParamsPlain(FPDF_PAGEOBJECT image_object);
+
+// 获取页面对象在内容流中的来源（对象号、字节范围、操作符、资源），成功返回1
+FPDF_EXPORT int FPDF_CALLCONV 
+PdfiumEx_GetPageObjectSource(FPDF_PAGE page, FPDF_PAGEOBJECT page_object, PDFIUM_EX_CONTENT_SOURCE* out_source);
+
+// 页面关闭前调用（FPDF_ClosePage之前），解除该页面实例的对象绑定；
+// 内容流索引按页面保留，同一页重新加载后直接复用
+FPDF_EXPORT void FPDF_CALLCONV 
+PdfiumEx_InvalidatePageCache(FPDF_PAGE page);
+
+// 文档关闭前调用（FPDF_CloseDocument之前），释放该文档的全部映射缓存
+FPDF_EXPORT void FPDF_CALLCONV 
+PdfiumEx_InvalidateDocumentCache(FPDF_DOCUMENT document);
+
+// 设置文档映射缓存的页面数上限（LRU淘汰，默认64页）
+FPDF_EXPORT void FPDF_CALLCONV 
+PdfiumEx_SetMappingCacheCapacity(FPDF_DOCUMENT document, int max_pages);
+
+// 获取文档映射缓存统计，文档尚无缓存时返回0
+FPDF_EXPORT int FPDF_CALLCONV 
+PdfiumEx_GetMappingCacheStats(FPDF_DOCUMENT document, PDFIUM_EX_MAPPING_CACHE_STATS* stats);
+
+// 获取本库按类别统计的内存占用与峰值；返回的字符串由调用者 free()，不计入
+FPDF_EXPORT void FPDF_CALLCONV 
+PdfiumEx_GetMemoryStats(PDFIUM_EX_MEMORY_STATS* stats);
+
+// 构建（或获取已缓存的）文档对象引用图（CSR正向/反向图），返回边数，失败返回-1
+// 引用图按文档缓存，PdfiumEx_InvalidateDocumentCache 时释放
+FPDF_EXPORT int FPDF_CALLCONV 
+PdfiumEx_BuildReferenceGraph(FPDF_DOCUMENT document);
+
+// 分片构建引用图：解析对象约 budget_ms 毫秒后返回（0 只查询进度，不做解析），
+// 以免首次查询时同步解析全部对象。返回1表示已完成，0表示仍在构建，失败返回-1；
+// objects_done/objects_total（可为空）为已解析/全部对象数。与其它 PDFium 调用同线程
+FPDF_EXPORT int FPDF_CALLCONV 
+PdfiumEx_BuildReferenceGraphStep(FPDF_DOCUMENT document, double budget_ms,
+                                 uint32_t* objects_done, uint32_t* objects_total);
+
+// 获取对象直接引用的对象编号（升序），*out_obj_nums 指向内部只读数组，文档缓存失效前有效
+FPDF_EXPORT int FPDF_CALLCONV 
+PdfiumEx_GetObjectReferences(FPDF_DOCUMENT document, uint32_t obj_num, const uint32_t** out_obj_nums);
+
+// 获取直接引用该对象的对象编号（升序），指针有效期同上
+FPDF_EXPORT int FPDF_CALLCONV 
+PdfiumEx_GetObjectReferrers(FPDF_DOCUMENT document, uint32_t obj_num, const uint32_t** out_obj_nums);
+
+// 获取使用该对象的页面序号（升序），返回总数，page_indices 最多写入 max_count 个
+FPDF_EXPORT int FPDF_CALLCONV 
+PdfiumEx_GetObjectUsingPages(FPDF_DOCUMENT document, uint32_t obj_num, int* page_indices, int max_count);
+
+// 分析文档体积与解析耗时，按对象类型（图像按过滤器、字体嵌入/子集、内容流、对象流等）
+// 统计压缩前后字节数，并逐页统计内容流大小、对象数与解析耗时；返回JSON，调用者用free()释放
+FPDF_EXPORT char* FPDF_CALLCONV 
+PdfiumEx_AnalyzeDocument(FPDF_DOCUMENT document, int flags);
+
+// 用给定条目替换文档书签（/Outlines）；有子项的条目为折叠状态；count 为0时删除书签。成功返回1
+FPDF_EXPORT int FPDF_CALLCONV 
+PdfiumEx_SetOutline(FPDF_DOCUMENT document, const PDFIUM_EX_OUTLINE_ENTRY* entries, int count);
+
 // 检查页面对象是否为间接对象
 FPDF_EXPORT int FPDF_CALLCONV 
 PdfiumEx_IsIndirectPageObject(FPDF_PAGEOBJECT page_object);
@@ -1,5 +1,12 @@
 // PDFium扩展库 - 高级对象映射实现
 // 通过深度分析页面结构来建立页面对象与文档对象的精确映射
+//
+// 做法：单遍扫描页面的 /Contents 内容流（解码后），记录每一个会产生页面对象的
+// 操作（Tj/TJ/'/"、路径绘制、Do、BI…EI、sh）所在的内容流对象号、字节范围、
+// 操作符以及引用的资源（字体或XObject）。PDFium 解析内容流时按相同顺序生成
+// CPDF_PageObject，因此按类型顺序对齐即可得到页面对象 -> 来源的映射。
+// 每页只扫描一次：索引按页面字典对象号缓存，页面重新加载后按对象序号重新绑定，
+// 之后查询为 O(1)。
 
 #include "../include/pdfium_object_info.h"
 #include "core/fpdfapi/page/cpdf_page.h"
@@ -9,122 +16,672 @@
 #include "core/fpdfapi/parser/cpdf_document.h"
 #include "core/fpdfapi/parser/cpdf_dictionary.h"
 #include "core/fpdfapi/parser/cpdf_stream.h"
+#include "core/fpdfapi/parser/cpdf_stream_acc.h"
 #include "core/fpdfapi/parser/cpdf_array.h"
 #include "fpdfsdk/cpdfsdk_helpers.h"
 
-#include <map>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace pdfium_ex {
 
-// 对象映射缓存
+// 单个页面对象在内容流中的来源
+struct PageObjectSource {
+    int obj_type = 0;               // 对应的 CPDF_PageObject::Type
+    uint32_t stream_obj_num = 0;    // 所在内容流对象编号（0表示直接对象）
+    int stream_index = 0;           // 在 /Contents 中的序号
+    uint32_t op_begin = 0;          // 第一个操作数（或路径构造）的字节偏移
+    uint32_t op_end = 0;            // 操作符结束偏移（不含）
+    std::string op;                 // 生成该对象的操作符
+    std::string resource_name;      // 引用的资源名（字体或XObject）
+    uint32_t resource_obj_num = 0;  // 引用资源的对象编号
+};
+
+// 页面级索引：按内容流顺序的来源记录 + 页面对象序号 -> 记录下标
+// 以序号而非对象指针保存，页面关闭后仍有效，重新加载同一页时只需重新绑定
+struct PageObjectIndex {
+    std::vector<PageObjectSource> records;
+    std::vector<size_t> record_of;  // 页面对象序号 -> 记录下标（SIZE_MAX 表示未映射）
+    std::vector<int> types;         // 页面对象序号 -> 类型，重新绑定时校验页面未被修改
+};
+
+// 对象映射结果（按值返回，缓存被淘汰或失效后不会悬空）
 struct ObjectMapping {
-    uint32_t obj_num;
-    uint32_t gen_num;
-    const CPDF_Object* pdf_object;
+    uint32_t obj_num = 0;
+    uint32_t gen_num = 0;
+    PageObjectSource source;
 };
 
-// 页面对象映射缓存
-static std::map<CPDF_PageObject*, ObjectMapping> g_object_mapping_cache;
+// Do/sh 映射到引用的资源对象，其余映射到所在内容流
+static void FillMapping(const PageObjectSource& src, ObjectMapping* out) {
+    bool uses_resource = src.op == "Do" || src.op == "sh";
+    out->obj_num = uses_resource && src.resource_obj_num ? src.resource_obj_num : src.stream_obj_num;
+    out->gen_num = 0;
+    out->source = src;
+}
+
+// 页面缓存键：页面字典的对象编号，在文档生命周期内稳定（与 CPDF_Page 实例无关）
+static uint32_t PageCacheKey(const CPDF_Page* page) {
+    const CPDF_Dictionary* dict = page ? page->GetDict() : nullptr;
+    return dict ? dict->GetObjNum() : 0;
+}
+
+// 单个文档的映射缓存
+// - 内容流索引按页面字典对象号缓存，页面关闭/重新加载后复用，不再重新扫描
+// - 当前打开的页面实例绑定到索引：其对象指针 -> (页面, 序号)，页面关闭前解除绑定
+// - 页面索引按页 LRU 限额（近似 LRU：读路径只更新时间戳，淘汰时取最旧）
+// - 读多写少：查询持共享锁，绑定/插入/失效/淘汰持独占锁
+// - 缓存本身线程安全；但 PDFium 对同一文档的解析调用仍需调用方串行化
+class DocumentMappingCache {
+public:
+    static constexpr size_t kDefaultPageCapacity = 64;
+
+    // Bind 的结果
+    enum BindResult {
+        kNeedsBuild = -1,   // 无索引或页面已被修改，需要扫描内容流
+        kUnmapped = 0,      // 页面已绑定且未变化，对象确实无法映射
+        kBound = 1,         // 已把页面实例重新绑定到缓存的索引
+    };
+
+    // 命中返回1，已索引但未映射（内联对象）返回0，对象不属于已绑定页面返回-1
+    // 不计入统计，由调用方按查询结果记录命中/未命中
+    int Lookup(const CPDF_PageObject* obj, ObjectMapping* out) {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = owners_.find(obj);
+        if (it == owners_.end()) return -1;
+        auto page_it = pages_.find(it->second.page_key);
+        if (page_it == pages_.end()) return -1;
+        PageEntry& entry = *page_it->second;
+        entry.last_used.store(clock_.fetch_add(1, std::memory_order_relaxed), std::memory_order_relaxed);
+        const size_t record = entry.index->record_of[it->second.ordinal];
+        if (record == SIZE_MAX) return 0;
+        FillMapping(entry.index->records[record], out);
+        return 1;
+    }
+
+    // 把页面实例绑定到已缓存的索引（页面重新加载后对象指针全部变化，
+    // 按序号重新建立指针 -> 序号映射，代价为一次对象枚举）
+    BindResult Bind(uint32_t key, CPDF_Page* page) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto it = pages_.find(key);
+        if (it == pages_.end()) return kNeedsBuild;
+        PageEntry& entry = *it->second;
+        const size_t count = page->GetPageObjectCount();
+        if (entry.bound == page) {
+            bool unchanged = entry.objects.size() == count;
+            for (size_t i = 0; unchanged && i < count; ++i) {
+                unchanged = entry.objects[i] == page->GetPageObjectByIndex(i);
+            }
+            if (unchanged) return kUnmapped;
+        } else if (entry.index->types.size() == count) {
+            bool same = true;
+            for (size_t i = 0; same && i < count; ++i) {
+                const CPDF_PageObject* obj = page->GetPageObjectByIndex(i);
+                same = (obj ? static_cast<int>(obj->GetType()) : 0) == entry.index->types[i];
+            }
+            if (same) {
+                BindLocked(key, entry, page);
+                return kBound;
+            }
+        }
+        // 页面对象与索引不一致（页面被编辑过），丢弃后重建
+        EraseLocked(key);
+        return kNeedsBuild;
+    }
+
+    void Insert(uint32_t key, CPDF_Page* page, std::unique_ptr<PageObjectIndex> index) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        EraseLocked(key);
+        while (!pages_.empty() && pages_.size() >= capacity_) EvictOldestLocked();
+
+        auto entry = std::make_unique<PageEntry>();
+        entry->index = std::move(index);
+        entry->last_used.store(clock_.fetch_add(1, std::memory_order_relaxed), std::memory_order_relaxed);
+        BindLocked(key, *entry, page);
+        pages_[key] = std::move(entry);
+        builds_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // 页面实例关闭：只解除对象指针绑定，内容流索引保留
+    void UnbindPage(uint32_t key, const CPDF_Page* page) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto it = pages_.find(key);
+        if (it != pages_.end() && it->second->bound == page) UnbindLocked(key, *it->second);
+    }
+
+    void RecordHit() { hits_.fetch_add(1, std::memory_order_relaxed); }
+    void RecordMiss() { misses_.fetch_add(1, std::memory_order_relaxed); }
+
+    void SetCapacity(size_t capacity) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        capacity_ = std::max<size_t>(1, capacity);
+        while (pages_.size() > capacity_) EvictOldestLocked();
+    }
+
+    void GetStats(PDFIUM_EX_MAPPING_CACHE_STATS* stats) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        stats->hits = hits_.load(std::memory_order_relaxed);
+        stats->misses = misses_.load(std::memory_order_relaxed);
+        stats->evictions = evictions_.load(std::memory_order_relaxed);
+        stats->page_builds = builds_.load(std::memory_order_relaxed);
+        stats->cached_pages = static_cast<int>(pages_.size());
+        stats->capacity = static_cast<int>(capacity_);
+    }
+
+private:
+    struct PageEntry {
+        std::unique_ptr<PageObjectIndex> index;
+        const CPDF_Page* bound = nullptr;               // 当前绑定的页面实例
+        std::vector<const CPDF_PageObject*> objects;    // 绑定时的对象快照，用于解除绑定与变化检测
+        std::atomic<uint64_t> last_used{0};
+        TrackedBytes memory{kMemMappingCache};  // 条目淘汰/失效时扣除
+    };
+    struct ObjectOwner {
+        uint32_t page_key;
+        size_t ordinal;     // 页面对象序号
+    };
+
+    // 条目估算内存（含绑定页面在 owners_ 中的节点）
+    static int64_t EstimateEntryBytes(const PageEntry& entry) {
+        const PageObjectIndex& index = *entry.index;
+        int64_t bytes = static_cast<int64_t>(sizeof(PageEntry) + sizeof(PageObjectIndex) +
+                                             index.records.capacity() * sizeof(PageObjectSource) +
+                                             index.record_of.capacity() * sizeof(size_t) +
+                                             index.types.capacity() * sizeof(int) +
+                                             entry.objects.capacity() * sizeof(const CPDF_PageObject*));
+        for (const PageObjectSource& src : index.records) {
+            bytes += HeapStringBytes(src.op) + HeapStringBytes(src.resource_name);
+        }
+        // owners_ 中每个对象一个节点：键 + ObjectOwner + 链表指针与哈希
+        bytes += static_cast<int64_t>(entry.objects.size() *
+                                      (sizeof(const CPDF_PageObject*) + sizeof(ObjectOwner) + 2 * sizeof(void*)));
+        return bytes;
+    }
+
+    void BindLocked(uint32_t key, PageEntry& entry, CPDF_Page* page) {
+        UnbindLocked(key, entry);
+        const size_t count = page->GetPageObjectCount();
+        entry.bound = page;
+        entry.objects.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            const CPDF_PageObject* obj = page->GetPageObjectByIndex(i);
+            entry.objects.push_back(obj);
+            if (obj) owners_[obj] = {key, i};
+        }
+        entry.memory.Set(EstimateEntryBytes(entry));
+    }
+
+    void UnbindLocked(uint32_t key, PageEntry& entry) {
+        for (const CPDF_PageObject* obj : entry.objects) {
+            auto owner = owners_.find(obj);
+            if (owner != owners_.end() && owner->second.page_key == key) owners_.erase(owner);
+        }
+        entry.objects.clear();
+        entry.objects.shrink_to_fit();
+        entry.bound = nullptr;
+        entry.memory.Set(EstimateEntryBytes(entry));
+    }
+
+    void EraseLocked(uint32_t key) {
+        auto it = pages_.find(key);
+        if (it == pages_.end()) return;
+        UnbindLocked(key, *it->second);
+        pages_.erase(it);
+    }
+
+    void EvictOldestLocked() {
+        auto oldest = pages_.begin();
+        for (auto it = pages_.begin(); it != pages_.end(); ++it) {
+            if (it->second->last_used.load(std::memory_order_relaxed) <
+                oldest->second->last_used.load(std::memory_order_relaxed)) {
+                oldest = it;
+            }
+        }
+        EraseLocked(oldest->first);
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<uint32_t, std::unique_ptr<PageEntry>> pages_;
+    std::unordered_map<const CPDF_PageObject*, ObjectOwner> owners_;
+    size_t capacity_ = kDefaultPageCapacity;
+    std::atomic<uint64_t> clock_{0};
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+    std::atomic<uint64_t> builds_{0};
+};
+
+// 文档 -> 映射缓存。shared_ptr 保证文档缓存失效时正在使用它的线程不受影响
+static std::mutex g_doc_cache_mutex;
+static std::unordered_map<const CPDF_Document*, std::shared_ptr<DocumentMappingCache>> g_doc_caches;
+
+std::shared_ptr<DocumentMappingCache> GetDocumentMappingCache(const CPDF_Document* doc, bool create) {
+    if (!doc) return nullptr;
+    std::lock_guard<std::mutex> lock(g_doc_cache_mutex);
+    auto it = g_doc_caches.find(doc);
+    if (it != g_doc_caches.end()) return it->second;
+    if (!create) return nullptr;
+    auto cache = std::make_shared<DocumentMappingCache>();
+    g_doc_caches[doc] = cache;
+    return cache;
+}
+
+// 文档关闭时调用
+void InvalidateDocumentMappingCache(const CPDF_Document* doc) {
+    std::lock_guard<std::mutex> lock(g_doc_cache_mutex);
+    g_doc_caches.erase(doc);
+}
+
+// 页面关闭前调用：解除该页面实例的对象指针绑定，内容流索引保留供重新加载时复用
+void InvalidatePageMappingCache(const CPDF_Page* page) {
+    if (!page) return;
+    std::shared_ptr<DocumentMappingCache> cache = GetDocumentMappingCache(page->GetDocument(), false);
+    if (cache) cache->UnbindPage(PageCacheKey(page), page);
+}
 
 // 清理映射缓存
 void ClearObjectMappingCache() {
-    g_object_mapping_cache.clear();
+    std::lock_guard<std::mutex> lock(g_doc_cache_mutex);
+    g_doc_caches.clear();
 }
 
-// 分析页面的内容流，建立对象映射关系
-void AnalyzePageContentStreams(CPDF_Page* page) {
-    if (!page) return;
-    
+namespace {
+
+constexpr int kTypeText = static_cast<int>(CPDF_PageObject::Type::kText);
+constexpr int kTypePath = static_cast<int>(CPDF_PageObject::Type::kPath);
+constexpr int kTypeImage = static_cast<int>(CPDF_PageObject::Type::kImage);
+constexpr int kTypeShading = static_cast<int>(CPDF_PageObject::Type::kShading);
+constexpr int kTypeForm = static_cast<int>(CPDF_PageObject::Type::kForm);
+
+// 对齐时最多向前跳过的记录数（容忍 PDFium 丢弃的空文本/空路径）
+constexpr size_t kMaxAlignLookahead = 64;
+
+bool IsPdfWhitespace(uint8_t c) {
+    return c == 0 || c == '\t' || c == '\n' || c == '\f' || c == '\r' || c == ' ';
+}
+
+bool IsPdfDelimiter(uint8_t c) {
+    return c == '(' || c == ')' || c == '<' || c == '>' || c == '[' || c == ']' ||
+           c == '{' || c == '}' || c == '/' || c == '%';
+}
+
+int HexValue(uint8_t c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// 在资源字典的某个类别里查找资源名对应的间接对象编号
+uint32_t LookupResourceObjNum(const CPDF_Dictionary* resources,
+                              const char* category,
+                              const std::string& name) {
+    if (!resources || name.empty()) return 0;
+    RetainPtr<const CPDF_Dictionary> sub = resources->GetDictFor(category);
+    if (!sub) return 0;
+    RetainPtr<const CPDF_Object> obj = sub->GetObjectFor(ByteString(name.c_str()));
+    if (obj && obj->IsReference()) return obj->AsReference()->GetRefObjNum();
+    return obj ? obj->GetObjNum() : 0;
+}
+
+// 判断 XObject 资源是 Image 还是 Form
+int ClassifyXObject(const CPDF_Dictionary* resources, const std::string& name) {
+    if (!resources || name.empty()) return kTypeForm;
+    RetainPtr<const CPDF_Dictionary> xobjects = resources->GetDictFor("XObject");
+    if (!xobjects) return kTypeForm;
+    RetainPtr<const CPDF_Object> obj = xobjects->GetDirectObjectFor(ByteString(name.c_str()));
+    const CPDF_Stream* stream = obj ? obj->AsStream() : nullptr;
+    if (!stream) return kTypeForm;
+    ByteString subtype = stream->GetDict()->GetNameFor("Subtype");
+    return subtype == "Image" ? kTypeImage : kTypeForm;
+}
+
+// 单遍内容流扫描器。跨多个 /Contents 流保持状态（PDFium 会把它们拼接解析）。
+class ContentStreamScanner {
+public:
+    ContentStreamScanner(const CPDF_Dictionary* resources, std::vector<PageObjectSource>* out)
+        : resources_(resources), out_(out) {}
+
+    void Scan(pdfium::span<const uint8_t> data, uint32_t stream_obj_num, int stream_index) {
+        data_ = data;
+        pos_ = 0;
+        stream_obj_num_ = stream_obj_num;
+        stream_index_ = stream_index;
+        ResetOperands();
+        // 路径在流边界处不会延续到下一流的字节范围中，从流开头重新计数
+        if (path_open_) path_begin_ = 0;
+
+        while (pos_ < data_.size()) {
+            uint8_t c = data_[pos_];
+            if (IsPdfWhitespace(c)) { ++pos_; continue; }
+            if (c == '%') { SkipComment(); continue; }
+            size_t token_begin = pos_;
+            if (c == '(') { SkipLiteralString(); NoteOperand(token_begin); continue; }
+            if (c == '<') {
+                if (pos_ + 1 < data_.size() && data_[pos_ + 1] == '<') {
+                    pos_ += 2; ++dict_depth_; NoteOperand(token_begin);
+                } else {
+                    SkipHexString(); NoteOperand(token_begin);
+                }
+                continue;
+            }
+            if (c == '>') {
+                pos_ += (pos_ + 1 < data_.size() && data_[pos_ + 1] == '>') ? 2 : 1;
+                if (dict_depth_ > 0) --dict_depth_;
+                continue;
+            }
+            if (c == '[' || c == ']' || c == '{' || c == '}') {
+                ++pos_; NoteOperand(token_begin); continue;
+            }
+            if (c == '/') { ReadName(token_begin); continue; }
+            // 数字或关键字（操作符）
+            size_t end = pos_;
+            while (end < data_.size() && !IsPdfWhitespace(data_[end]) && !IsPdfDelimiter(data_[end])) ++end;
+            if (end == pos_) { ++pos_; continue; }
+            std::string word(reinterpret_cast<const char*>(data_.data() + pos_), end - pos_);
+            pos_ = end;
+            if (IsOperandKeyword(word)) { NoteOperand(token_begin); continue; }
+            if (dict_depth_ > 0) { NoteOperand(token_begin); continue; }
+            HandleOperator(word, token_begin);
+            ResetOperands();
+        }
+    }
+
+private:
+    static bool IsOperandKeyword(const std::string& w) {
+        if (w == "true" || w == "false" || w == "null") return true;
+        char c = w[0];
+        return (c >= '0' && c <= '9') || c == '+' || c == '-' || c == '.';
+    }
+
+    void ResetOperands() {
+        operands_begin_ = SIZE_MAX;
+        names_.clear();
+    }
+
+    void NoteOperand(size_t begin) {
+        if (operands_begin_ == SIZE_MAX) operands_begin_ = begin;
+    }
+
+    void SkipComment() {
+        while (pos_ < data_.size() && data_[pos_] != '\r' && data_[pos_] != '\n') ++pos_;
+    }
+
+    void SkipLiteralString() {
+        int depth = 0;
+        while (pos_ < data_.size()) {
+            uint8_t c = data_[pos_++];
+            if (c == '\\') { ++pos_; continue; }
+            if (c == '(') ++depth;
+            else if (c == ')' && --depth == 0) return;
+        }
+    }
+
+    void SkipHexString() {
+        while (pos_ < data_.size() && data_[pos_] != '>') ++pos_;
+        if (pos_ < data_.size()) ++pos_;
+    }
+
+    void ReadName(size_t token_begin) {
+        ++pos_;
+        std::string name;
+        while (pos_ < data_.size() && !IsPdfWhitespace(data_[pos_]) && !IsPdfDelimiter(data_[pos_])) {
+            uint8_t c = data_[pos_];
+            if (c == '#' && pos_ + 2 < data_.size() && HexValue(data_[pos_ + 1]) >= 0 &&
+                HexValue(data_[pos_ + 2]) >= 0) {
+                name.push_back(static_cast<char>(HexValue(data_[pos_ + 1]) * 16 + HexValue(data_[pos_ + 2])));
+                pos_ += 3;
+                continue;
+            }
+            name.push_back(static_cast<char>(c));
+            ++pos_;
+        }
+        NoteOperand(token_begin);
+        if (dict_depth_ == 0) names_.push_back(std::move(name));
+    }
+
+    // 内联图像：ID 之后跳过二进制数据直到 "EI"
+    void SkipInlineImageData() {
+        if (pos_ < data_.size() && IsPdfWhitespace(data_[pos_])) ++pos_;
+        while (pos_ + 1 < data_.size()) {
+            if (data_[pos_] == 'E' && data_[pos_ + 1] == 'I' &&
+                (pos_ == 0 || IsPdfWhitespace(data_[pos_ - 1])) &&
+                (pos_ + 2 >= data_.size() || IsPdfWhitespace(data_[pos_ + 2]) ||
+                 IsPdfDelimiter(data_[pos_ + 2]))) {
+                pos_ += 2;
+                return;
+            }
+            ++pos_;
+        }
+        pos_ = data_.size();
+    }
+
+    void Emit(int type, const std::string& op, size_t begin, size_t end,
+              const std::string& resource_name, uint32_t resource_obj_num) {
+        PageObjectSource src;
+        src.obj_type = type;
+        src.stream_obj_num = stream_obj_num_;
+        src.stream_index = stream_index_;
+        src.op_begin = static_cast<uint32_t>(begin);
+        src.op_end = static_cast<uint32_t>(end);
+        src.op = op;
+        src.resource_name = resource_name;
+        src.resource_obj_num = resource_obj_num;
+        out_->push_back(std::move(src));
+    }
+
+    void HandleOperator(const std::string& op, size_t op_begin) {
+        size_t begin = operands_begin_ != SIZE_MAX ? operands_begin_ : op_begin;
+        size_t end = pos_;
+
+        if (op == "q") { font_stack_.push_back(font_name_); return; }
+        if (op == "Q") {
+            if (!font_stack_.empty()) { font_name_ = font_stack_.back(); font_stack_.pop_back(); }
+            return;
+        }
+        if (op == "Tf") {
+            if (!names_.empty()) font_name_ = names_.back();
+            return;
+        }
+        if (op == "Tj" || op == "TJ" || op == "'" || op == "\"") {
+            Emit(kTypeText, op, begin, end, font_name_,
+                 LookupResourceObjNum(resources_, "Font", font_name_));
+            return;
+        }
+        // 路径构造
+        if (op == "m" || op == "l" || op == "c" || op == "v" || op == "y" || op == "h" || op == "re") {
+            if (!path_open_) { path_open_ = true; path_begin_ = begin; }
+            return;
+        }
+        // 路径绘制：产生一个路径对象
+        if (op == "S" || op == "s" || op == "f" || op == "F" || op == "f*" ||
+            op == "B" || op == "B*" || op == "b" || op == "b*") {
+            if (path_open_) Emit(kTypePath, op, path_begin_, end, std::string(), 0);
+            path_open_ = false;
+            return;
+        }
+        if (op == "n") { path_open_ = false; return; }
+        if (op == "Do") {
+            std::string name = names_.empty() ? std::string() : names_.back();
+            Emit(ClassifyXObject(resources_, name), op, begin, end, name,
+                 LookupResourceObjNum(resources_, "XObject", name));
+            return;
+        }
+        if (op == "sh") {
+            std::string name = names_.empty() ? std::string() : names_.back();
+            Emit(kTypeShading, op, begin, end, name,
+                 LookupResourceObjNum(resources_, "Shading", name));
+            return;
+        }
+        if (op == "BI") { inline_image_begin_ = op_begin; return; }
+        if (op == "ID") {
+            SkipInlineImageData();
+            Emit(kTypeImage, "BI", inline_image_begin_, pos_, std::string(), 0);
+            return;
+        }
+    }
+
+    const CPDF_Dictionary* resources_;
+    std::vector<PageObjectSource>* out_;
+
+    pdfium::span<const uint8_t> data_;
+    size_t pos_ = 0;
+    uint32_t stream_obj_num_ = 0;
+    int stream_index_ = 0;
+
+    size_t operands_begin_ = SIZE_MAX;
+    std::vector<std::string> names_;
+    int dict_depth_ = 0;
+
+    std::string font_name_;
+    std::vector<std::string> font_stack_;
+    bool path_open_ = false;
+    size_t path_begin_ = 0;
+    size_t inline_image_begin_ = 0;
+};
+
+} // namespace
+
+// 分析页面的内容流，按出现顺序生成页面对象来源记录
+void AnalyzePageContentStreams(CPDF_Page* page, std::vector<PageObjectSource>* records) {
+    if (!page || !records) return;
+
     const CPDF_Dictionary* page_dict = page->GetDict();
     if (!page_dict) return;
-    
+
+    CPDF_Document* doc = page->GetDocument();
+    if (!doc) return;
+
     // 获取页面的Contents对象
     const CPDF_Object* contents_obj = page_dict->GetObjectFor("Contents");
     if (!contents_obj) return;
-    
-    std::vector<uint32_t> content_stream_nums;
-    
-    // 收集所有内容流对象编号
-    if (contents_obj->IsReference()) {
-        content_stream_nums.push_back(contents_obj->AsReference()->GetRefObjNum());
-    } else if (contents_obj->IsArray()) {
+
+    // 收集所有内容流对象编号及对应的流（直接流对象编号记为0）
+    std::vector<std::pair<uint32_t, RetainPtr<const CPDF_Stream>>> streams;
+    auto collect = [&](const CPDF_Object* obj) {
+        if (!obj) return;
+        if (obj->IsReference()) {
+            uint32_t num = obj->AsReference()->GetRefObjNum();
+            RetainPtr<const CPDF_Object> target = doc->GetOrParseIndirectObject(num);
+            if (target && target->IsStream())
+                streams.emplace_back(num, pdfium::WrapRetain(target->AsStream()));
+        } else if (obj->IsStream()) {
+            streams.emplace_back(0, pdfium::WrapRetain(obj->AsStream()));
+        }
+    };
+    if (contents_obj->IsArray()) {
         const CPDF_Array* contents_array = contents_obj->AsArray();
         for (size_t i = 0; i < contents_array->size(); ++i) {
-            const CPDF_Object* stream_obj = contents_array->GetObjectAt(i);
-            if (stream_obj && stream_obj->IsReference()) {
-                content_stream_nums.push_back(stream_obj->AsReference()->GetRefObjNum());
-            }
+            collect(contents_array->GetObjectAt(i));
         }
+    } else {
+        collect(contents_obj);
+    }
+
+    RetainPtr<const CPDF_Dictionary> resources = page->GetResources();
+    ContentStreamScanner scanner(resources.Get(), records);
+    for (size_t i = 0; i < streams.size(); ++i) {
+        auto acc = pdfium::MakeRetain<CPDF_StreamAcc>(streams[i].second);
+        acc->LoadAllDataFiltered();
+        scanner.Scan(acc->GetSpan(), streams[i].first, static_cast<int>(i));
     }
-    
-    // TODO: 解析内容流，建立页面对象与PDF对象的映射
-    // 这需要解析PDF内容流的操作符和操作数
-    // 例如：Tf (字体设置)、Do (XObject绘制)、Tj (文本显示) 等
 }
 
-// 分析页面资源，查找对象引用
-void AnalyzePageResources(CPDF_Page* page) {
-    if (!page) return;
-    
-    const CPDF_Dictionary* page_dict = page->GetDict();
-    if (!page_dict) return;
-    
-    const CPDF_Dictionary* resources = page_dict->GetDictFor("Resources");
-    if (!resources) return;
-    
-    // 分析字体资源
-    const CPDF_Dictionary* fonts = resources->GetDictFor("Font");
-    if (fonts) {
-        CPDF_DictionaryLocker font_locker(fonts);
-        for (const auto& font_pair : font_locker) {
-            const CPDF_Object* font_obj = font_pair.second.Get();
-            if (font_obj && font_obj->IsReference()) {
-                // 记录字体对象信息
-                uint32_t font_obj_num = font_obj->AsReference()->GetRefObjNum();
-                (void)font_obj_num; // 避免未使用警告
-                // TODO: 将字体对象与使用该字体的文本对象关联
-            }
+// 按内容流顺序把页面对象与来源记录对齐
+void AnalyzePageResources(CPDF_Page* page, PageObjectIndex* index) {
+    if (!page || !index) return;
+
+    const size_t count = page->GetPageObjectCount();
+    index->record_of.assign(count, SIZE_MAX);
+    index->types.assign(count, 0);
+
+    size_t cursor = 0;
+    for (size_t i = 0; i < count; ++i) {
+        CPDF_PageObject* obj = page->GetPageObjectByIndex(i);
+        if (!obj) continue;
+
+        const int type = static_cast<int>(obj->GetType());
+        index->types[i] = type;
+        const int32_t stream_hint = obj->GetContentStream();
+        const size_t limit = std::min(index->records.size(), cursor + kMaxAlignLookahead);
+        for (size_t j = cursor; j < limit; ++j) {
+            const PageObjectSource& src = index->records[j];
+            if (src.obj_type != type) continue;
+            if (stream_hint >= 0 && src.stream_index != stream_hint) continue;
+            index->record_of[i] = j;
+            cursor = j + 1;
+            break;
         }
     }
-    
-    // 分析XObject资源
-    const CPDF_Dictionary* xobjects = resources->GetDictFor("XObject");
-    if (xobjects) {
-        CPDF_DictionaryLocker xobj_locker(xobjects);
-        for (const auto& xobj_pair : xobj_locker) {
-            const CPDF_Object* xobj = xobj_pair.second.Get();
-            if (xobj && xobj->IsReference()) {
-                // 记录XObject信息
-                uint32_t xobj_num = xobj->AsReference()->GetRefObjNum();
-                (void)xobj_num; // 避免未使用警告
-                // TODO: 将XObject与使用它的页面对象关联
-            }
+}
+
+// 高级对象映射：查询页面对象的来源，成功返回true
+// page 为空时只查已绑定的页面，只在拥有该对象的文档缓存中计数
+// 统计口径：无需扫描内容流即得出结果为命中，需要（重新）建立页面索引为未命中
+bool GetAdvancedPageObjectMapping(CPDF_PageObject* page_obj, CPDF_Page* page, ObjectMapping* out) {
+    if (!page_obj || !out) return false;
+
+    if (!page) {
+        std::vector<std::shared_ptr<DocumentMappingCache>> caches;
+        {
+            std::lock_guard<std::mutex> lock(g_doc_cache_mutex);
+            for (const auto& entry : g_doc_caches) caches.push_back(entry.second);
+        }
+        for (const auto& cache : caches) {
+            int found = cache->Lookup(page_obj, out);
+            if (found < 0) continue;
+            cache->RecordHit();
+            return found == 1;
         }
+        return false;
     }
-}
 
-// 高级对象映射：尝试建立精确的页面对象到文档对象映射
-const CPDF_Object* GetAdvancedPageObjectMapping(CPDF_PageObject* page_obj, CPDF_Page* page) {
-    if (!page_obj || !page) return nullptr;
-    
-    // 首先检查缓存
-    auto it = g_object_mapping_cache.find(page_obj);
-    if (it != g_object_mapping_cache.end()) {
-        return it->second.pdf_object;
-    }
-    
-    // 如果缓存中没有，进行分析
-    AnalyzePageContentStreams(page);
-    AnalyzePageResources(page);
-    
-    // 再次检查缓存
-    it = g_object_mapping_cache.find(page_obj);
-    if (it != g_object_mapping_cache.end()) {
-        return it->second.pdf_object;
+    std::shared_ptr<DocumentMappingCache> cache = GetDocumentMappingCache(page->GetDocument(), true);
+    if (!cache) return false;
+
+    // 首先检查当前绑定的页面实例
+    int found = cache->Lookup(page_obj, out);
+    if (found >= 0) {
+        cache->RecordHit();
+        return found == 1;
     }
-    
-    return nullptr;
+
+    // 同一页已建过索引（可能是之前关闭的页面实例）：重新绑定即可
+    const uint32_t key = PageCacheKey(page);
+    if (key) {
+        DocumentMappingCache::BindResult bound = cache->Bind(key, page);
+        if (bound != DocumentMappingCache::kNeedsBuild) {
+            cache->RecordHit();
+            return bound == DocumentMappingCache::kBound && cache->Lookup(page_obj, out) == 1;
+        }
+    }
+
+    // 建立页面索引（每页只扫描一次），在锁外解析内容流
+    cache->RecordMiss();
+    auto index = std::make_unique<PageObjectIndex>();
+    AnalyzePageContentStreams(page, &index->records);
+    AnalyzePageResources(page, index.get());
+    if (!key) {
+        // 直接对象形式的页面字典没有稳定的键，只做一次性查询
+        for (size_t i = 0; i < index->record_of.size(); ++i) {
+            if (page->GetPageObjectByIndex(i) != page_obj || index->record_of[i] == SIZE_MAX) continue;
+            FillMapping(index->records[index->record_of[i]], out);
+            return true;
+        }
+        return false;
+    }
+    cache->Insert(key, page, std::move(index));
+
+    // 再次检查缓存
+    return cache->Lookup(page_obj, out) == 1;
 }
 
 } // namespace pdfium_ex
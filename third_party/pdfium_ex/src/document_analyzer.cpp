@@ -0,0 +1,395 @@
+// PDFium扩展库 - 文档体积/解析耗时分析
+// 回答“这个PDF为什么慢”：按对象类型统计字节分布（压缩前后），
+// 并逐页统计内容流大小、页面对象数量与解析耗时，输出JSON供流水线判定异常文档。
+
+#include "../include/pdfium_object_info.h"
+#include "core/fpdfapi/page/cpdf_page.h"
+#include "core/fpdfapi/page/cpdf_pageobject.h"
+#include "core/fpdfapi/parser/cpdf_array.h"
+#include "core/fpdfapi/parser/cpdf_dictionary.h"
+#include "core/fpdfapi/parser/cpdf_document.h"
+#include "core/fpdfapi/parser/cpdf_reference.h"
+#include "core/fpdfapi/parser/cpdf_stream.h"
+#include "core/fpdfapi/parser/cpdf_stream_acc.h"
+#include "public/fpdfview.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace pdfium_ex {
+
+namespace {
+
+// 异常判定阈值
+constexpr double kSlowPageParseMs = 250.0;
+constexpr uint64_t kHugeContentBytes = 8ull * 1024 * 1024;
+constexpr size_t kHugeObjectCount = 20000;
+constexpr uint64_t kHugeImageBytes = 64ull * 1024 * 1024;
+
+struct SizeBucket {
+    uint64_t count = 0;
+    uint64_t compressed = 0;
+    uint64_t decompressed = 0;
+
+    void Add(uint64_t raw, uint64_t decoded) {
+        ++count;
+        compressed += raw;
+        decompressed += decoded;
+    }
+};
+
+struct FontStats {
+    uint64_t count = 0;
+    uint64_t embedded = 0;
+    uint64_t subset = 0;
+    std::map<std::string, uint64_t> by_subtype;
+    std::vector<std::string> not_embedded;  // BaseFont 名称
+};
+
+struct PageStats {
+    int index = 0;
+    uint64_t content_streams = 0;
+    uint64_t content_compressed = 0;
+    uint64_t content_decompressed = 0;
+    size_t objects = 0;
+    size_t by_type[5] = {0, 0, 0, 0, 0};  // text, path, image, shading, form
+    double parse_ms = 0.0;
+};
+
+void AppendJsonString(std::ostringstream& oss, const std::string& s) {
+    oss << '"';
+    for (unsigned char c : s) {
+        switch (c) {
+            case '"': oss << "\\\""; break;
+            case '\\': oss << "\\\\"; break;
+            case '\n': oss << "\\n"; break;
+            case '\r': oss << "\\r"; break;
+            case '\t': oss << "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    oss << buf;
+                } else {
+                    oss << static_cast<char>(c);
+                }
+        }
+    }
+    oss << '"';
+}
+
+void AppendBucket(std::ostringstream& oss, const SizeBucket& b) {
+    oss << "{\"count\":" << b.count << ",\"compressed\":" << b.compressed
+        << ",\"decompressed\":" << b.decompressed << "}";
+}
+
+// 过滤器链的最后一个名字，决定图像的编码方式
+std::string LastFilterName(const CPDF_Dictionary* dict) {
+    RetainPtr<const CPDF_Object> filter = dict->GetDirectObjectFor("Filter");
+    if (!filter) return "None";
+    if (filter->IsName()) return filter->GetString().c_str();
+    if (const CPDF_Array* arr = filter->AsArray()) {
+        if (arr->IsEmpty()) return "None";
+        return arr->GetByteStringAt(arr->size() - 1).c_str();
+    }
+    return "None";
+}
+
+// 由宽高、位深与颜色空间估算图像解码后的字节数（DCT/JPX 等不经 CPDF_StreamAcc 解码）
+uint64_t EstimateImageBytes(const CPDF_Dictionary* dict) {
+    const uint64_t w = static_cast<uint64_t>(std::max(0, dict->GetIntegerFor("Width")));
+    const uint64_t h = static_cast<uint64_t>(std::max(0, dict->GetIntegerFor("Height")));
+    if (dict->GetBooleanFor("ImageMask", false)) return (w + 7) / 8 * h;
+    int bpc = dict->GetIntegerFor("BitsPerComponent");
+    if (bpc <= 0) bpc = 8;
+    int comps = 3;
+    RetainPtr<const CPDF_Object> cs = dict->GetDirectObjectFor("ColorSpace");
+    ByteString cs_name;
+    if (cs && cs->IsName()) cs_name = cs->GetString();
+    else if (cs && cs->IsArray() && cs->AsArray()->size() > 0) cs_name = cs->AsArray()->GetByteStringAt(0);
+    if (cs_name == "DeviceGray" || cs_name == "CalGray" || cs_name == "Indexed" || cs_name == "Separation") {
+        comps = 1;
+    } else if (cs_name == "DeviceCMYK") {
+        comps = 4;
+    } else if (cs_name == "ICCBased" && cs->IsArray()) {
+        RetainPtr<const CPDF_Stream> icc = ToStream(cs->AsArray()->GetDirectObjectAt(1));
+        if (icc) comps = std::max(1, icc->GetDict()->GetIntegerFor("N"));
+    } else if (LastFilterName(dict) == "JBIG2Decode" || LastFilterName(dict) == "CCITTFaxDecode") {
+        comps = 1;
+        bpc = 1;
+    }
+    return (w * comps * bpc + 7) / 8 * h;
+}
+
+// 流解码后大小；跳过解码时返回原始大小
+uint64_t DecodedSize(const CPDF_Stream* stream, bool decode) {
+    if (!decode) return stream->GetRawSize();
+    auto acc = pdfium::MakeRetain<CPDF_StreamAcc>(pdfium::WrapRetain(stream));
+    acc->LoadAllDataFiltered();
+    return acc->GetSize();
+}
+
+bool IsSubsetName(const ByteString& base_font) {
+    // 子集字体名形如 "ABCDEF+Name"
+    if (base_font.GetLength() < 8 || base_font[6] != '+') return false;
+    for (size_t i = 0; i < 6; ++i) {
+        if (base_font[i] < 'A' || base_font[i] > 'Z') return false;
+    }
+    return true;
+}
+
+bool HasEmbeddedFontFile(const CPDF_Dictionary* font) {
+    RetainPtr<const CPDF_Dictionary> desc = font->GetDictFor("FontDescriptor");
+    if (!desc) {
+        // Type0 的描述符在 DescendantFonts 中
+        RetainPtr<const CPDF_Array> descendants = font->GetArrayFor("DescendantFonts");
+        RetainPtr<const CPDF_Dictionary> cid = descendants ? descendants->GetDictAt(0) : nullptr;
+        desc = cid ? cid->GetDictFor("FontDescriptor") : nullptr;
+    }
+    return desc && (desc->KeyExist("FontFile") || desc->KeyExist("FontFile2") || desc->KeyExist("FontFile3"));
+}
+
+void CollectContentStreamNums(const CPDF_Dictionary* page_dict, std::vector<uint32_t>* nums) {
+    RetainPtr<const CPDF_Object> contents = page_dict->GetObjectFor("Contents");
+    if (!contents) return;
+    if (contents->IsReference()) {
+        nums->push_back(contents->AsReference()->GetRefObjNum());
+    } else if (const CPDF_Array* arr = contents->AsArray()) {
+        for (size_t i = 0; i < arr->size(); ++i) {
+            RetainPtr<const CPDF_Object> item = arr->GetObjectAt(i);
+            if (item && item->IsReference()) nums->push_back(item->AsReference()->GetRefObjNum());
+        }
+    }
+}
+
+} // namespace
+
+// 分析文档体积与解析耗时，返回JSON
+std::string AnalyzeDocumentWeight(FPDF_DOCUMENT document, CPDF_Document* doc, int flags) {
+    const bool decode = (flags & PDFIUM_EX_ANALYZE_SKIP_DECODE) == 0;
+    const bool analyze_pages = (flags & PDFIUM_EX_ANALYZE_SKIP_PAGES) == 0;
+    auto t0 = std::chrono::steady_clock::now();
+
+    // 页面内容流编号，用于把流归类为 content
+    std::unordered_set<uint32_t> page_content_nums;
+    const int page_count = doc->GetPageCount();
+    std::vector<std::vector<uint32_t>> page_contents(page_count);
+    for (int i = 0; i < page_count; ++i) {
+        RetainPtr<const CPDF_Dictionary> page_dict = doc->GetPageDictionary(i);
+        if (!page_dict) continue;
+        CollectContentStreamNums(page_dict.Get(), &page_contents[i]);
+        page_content_nums.insert(page_contents[i].begin(), page_contents[i].end());
+    }
+
+    // 遍历全部间接对象
+    std::map<std::string, SizeBucket> images_by_filter;
+    SizeBucket content_streams, form_xobjects, font_files, object_streams, xref_streams, other_streams;
+    std::map<std::string, uint64_t> non_stream_by_type;
+    FontStats fonts;
+    uint64_t indirect_objects = 0;
+    uint64_t total_compressed = 0, total_decompressed = 0;
+    std::vector<std::string> warnings;
+
+    const uint32_t last = doc->GetLastObjNum();
+    for (uint32_t num = 1; num <= last; ++num) {
+        RetainPtr<const CPDF_Object> obj = doc->GetOrParseIndirectObject(num);
+        if (!obj) continue;
+        ++indirect_objects;
+
+        if (const CPDF_Stream* stream = obj->AsStream()) {
+            RetainPtr<const CPDF_Dictionary> dict = stream->GetDict();
+            const uint64_t raw = stream->GetRawSize();
+            const ByteString type = dict->GetNameFor("Type");
+            const ByteString subtype = dict->GetNameFor("Subtype");
+            uint64_t decoded = raw;
+            if (subtype == "Image") {
+                decoded = EstimateImageBytes(dict.Get());
+                images_by_filter[LastFilterName(dict.Get())].Add(raw, decoded);
+                if (decoded > kHugeImageBytes) {
+                    warnings.push_back("image " + std::to_string(num) + " decodes to " +
+                                       std::to_string(decoded / (1024 * 1024)) + " MB");
+                }
+            } else if (page_content_nums.count(num)) {
+                decoded = DecodedSize(stream, decode);
+                content_streams.Add(raw, decoded);
+            } else if (subtype == "Form") {
+                decoded = DecodedSize(stream, decode);
+                form_xobjects.Add(raw, decoded);
+            } else if (type == "ObjStm") {
+                decoded = DecodedSize(stream, decode);
+                object_streams.Add(raw, decoded);
+            } else if (type == "XRef") {
+                decoded = DecodedSize(stream, decode);
+                xref_streams.Add(raw, decoded);
+            } else if (dict->KeyExist("Length1") || dict->KeyExist("Length2") || subtype == "Type1C" ||
+                       subtype == "CIDFontType0C" || subtype == "OpenType") {
+                decoded = DecodedSize(stream, decode);
+                font_files.Add(raw, decoded);
+            } else {
+                decoded = DecodedSize(stream, decode);
+                other_streams.Add(raw, decoded);
+            }
+            total_compressed += raw;
+            total_decompressed += decoded;
+            continue;
+        }
+
+        if (const CPDF_Dictionary* dict = obj->AsDictionary()) {
+            const ByteString type = dict->GetNameFor("Type");
+            if (type == "Font") {
+                const ByteString subtype = dict->GetNameFor("Subtype");
+                // CIDFont 由其 Type0 父字体统计
+                if (subtype == "CIDFontType0" || subtype == "CIDFontType2") continue;
+                ++fonts.count;
+                ++fonts.by_subtype[subtype.IsEmpty() ? "Unknown" : subtype.c_str()];
+                const ByteString base_font = dict->GetNameFor("BaseFont");
+                if (IsSubsetName(base_font)) ++fonts.subset;
+                if (HasEmbeddedFontFile(dict)) {
+                    ++fonts.embedded;
+                } else if (subtype != "Type3" && fonts.not_embedded.size() < 64) {
+                    fonts.not_embedded.push_back(base_font.c_str());
+                }
+                continue;
+            }
+            ++non_stream_by_type[type.IsEmpty() ? "dictionary" : type.c_str()];
+            continue;
+        }
+        ++non_stream_by_type["other"];
+    }
+
+    // 逐页：内容流大小、页面对象数量、解析耗时
+    std::vector<PageStats> pages;
+    if (analyze_pages) {
+        pages.resize(page_count);
+        for (int i = 0; i < page_count; ++i) {
+            PageStats& ps = pages[i];
+            ps.index = i;
+            for (uint32_t num : page_contents[i]) {
+                RetainPtr<const CPDF_Stream> stream = ToStream(doc->GetOrParseIndirectObject(num));
+                if (!stream) continue;
+                ++ps.content_streams;
+                ps.content_compressed += stream->GetRawSize();
+                ps.content_decompressed += DecodedSize(stream.Get(), decode);
+            }
+            auto p0 = std::chrono::steady_clock::now();
+            FPDF_PAGE page = FPDF_LoadPage(document, i);
+            ps.parse_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - p0).count();
+            if (CPDF_Page* pPage = GetInternalPage(page)) {
+                ps.objects = pPage->GetPageObjectCount();
+                for (size_t k = 0; k < ps.objects; ++k) {
+                    CPDF_PageObject* po = pPage->GetPageObjectByIndex(k);
+                    int t = po ? static_cast<int>(po->GetType()) - 1 : -1;
+                    if (t >= 0 && t < 5) ++ps.by_type[t];
+                }
+            }
+            if (page) {
+                InvalidatePageMappingCache(GetInternalPage(page));
+                FPDF_ClosePage(page);
+            }
+            if (ps.parse_ms > kSlowPageParseMs)
+                warnings.push_back("page " + std::to_string(i + 1) + " parse " + std::to_string(static_cast<int>(ps.parse_ms)) + " ms");
+            if (ps.content_decompressed > kHugeContentBytes)
+                warnings.push_back("page " + std::to_string(i + 1) + " content " + std::to_string(ps.content_decompressed / 1024) + " KB");
+            if (ps.objects > kHugeObjectCount)
+                warnings.push_back("page " + std::to_string(i + 1) + " has " + std::to_string(ps.objects) + " objects");
+        }
+    }
+    if (!fonts.not_embedded.empty())
+        warnings.push_back(std::to_string(fonts.not_embedded.size()) + " non-embedded fonts");
+
+    const double total_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    // 输出JSON
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(3);
+    oss << "{\"page_count\":" << page_count << ",\"indirect_objects\":" << indirect_objects
+        << ",\"compressed_bytes\":" << total_compressed << ",\"decompressed_bytes\":" << total_decompressed
+        << ",\"decoded\":" << (decode ? "true" : "false") << ",\"analysis_ms\":" << total_ms;
+
+    oss << ",\"images\":{";
+    bool first = true;
+    SizeBucket image_total;
+    for (const auto& entry : images_by_filter) {
+        if (!first) oss << ",";
+        first = false;
+        AppendJsonString(oss, entry.first);
+        oss << ":";
+        AppendBucket(oss, entry.second);
+        image_total.count += entry.second.count;
+        image_total.compressed += entry.second.compressed;
+        image_total.decompressed += entry.second.decompressed;
+    }
+    oss << "},\"images_total\":";
+    AppendBucket(oss, image_total);
+
+    oss << ",\"fonts\":{\"count\":" << fonts.count << ",\"embedded\":" << fonts.embedded
+        << ",\"subset\":" << fonts.subset << ",\"by_subtype\":{";
+    first = true;
+    for (const auto& entry : fonts.by_subtype) {
+        if (!first) oss << ",";
+        first = false;
+        AppendJsonString(oss, entry.first);
+        oss << ":" << entry.second;
+    }
+    oss << "},\"not_embedded\":[";
+    for (size_t i = 0; i < fonts.not_embedded.size(); ++i) {
+        if (i) oss << ",";
+        AppendJsonString(oss, fonts.not_embedded[i]);
+    }
+    oss << "],\"font_files\":";
+    AppendBucket(oss, font_files);
+    oss << "}";
+
+    oss << ",\"content_streams\":";
+    AppendBucket(oss, content_streams);
+    oss << ",\"form_xobjects\":";
+    AppendBucket(oss, form_xobjects);
+    oss << ",\"object_streams\":";
+    AppendBucket(oss, object_streams);
+    oss << ",\"xref_streams\":";
+    AppendBucket(oss, xref_streams);
+    oss << ",\"other_streams\":";
+    AppendBucket(oss, other_streams);
+
+    oss << ",\"non_stream_objects\":{";
+    first = true;
+    for (const auto& entry : non_stream_by_type) {
+        if (!first) oss << ",";
+        first = false;
+        AppendJsonString(oss, entry.first);
+        oss << ":" << entry.second;
+    }
+    oss << "}";
+
+    if (analyze_pages) {
+        oss << ",\"pages\":[";
+        for (size_t i = 0; i < pages.size(); ++i) {
+            const PageStats& ps = pages[i];
+            if (i) oss << ",";
+            oss << "{\"page\":" << ps.index + 1 << ",\"content_streams\":" << ps.content_streams
+                << ",\"content_compressed\":" << ps.content_compressed
+                << ",\"content_decompressed\":" << ps.content_decompressed << ",\"objects\":" << ps.objects
+                << ",\"text\":" << ps.by_type[0] << ",\"path\":" << ps.by_type[1] << ",\"image\":" << ps.by_type[2]
+                << ",\"shading\":" << ps.by_type[3] << ",\"form\":" << ps.by_type[4]
+                << ",\"parse_ms\":" << ps.parse_ms << "}";
+        }
+        oss << "]";
+    }
+
+    oss << ",\"warnings\":[";
+    for (size_t i = 0; i < warnings.size(); ++i) {
+        if (i) oss << ",";
+        AppendJsonString(oss, warnings[i]);
+    }
+    oss << "]}";
+    return oss.str();
+}
+
+} // namespace pdfium_ex
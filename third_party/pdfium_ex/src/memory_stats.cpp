@@ -0,0 +1,96 @@
+// PDFium扩展库 - 内存统计
+// 按类别记录本库持有的内存及峰值：返回给调用者的对象信息与对象树（直到 Release），
+// 页面对象映射缓存与文档引用图（直到淘汰/失效）。缓存为容器容量的估算值。
+// 返回的字符串（GetRawObjectContent、AnalyzeDocument）由调用者 free()，不在此统计。
+
+#include "../include/pdfium_object_info.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace pdfium_ex {
+
+enum MemoryCategory {
+    kMemObjectInfo,
+    kMemObjectTree,
+    kMemMappingCache,
+    kMemReferenceGraph,
+    kMemCategoryCount
+};
+
+struct MemoryGauge {
+    std::atomic<int64_t> live{0};
+    std::atomic<int64_t> peak{0};
+};
+
+static MemoryGauge g_memory[kMemCategoryCount];
+
+static void TrackMemory(MemoryCategory category, int64_t delta) {
+    if (delta == 0) return;
+    MemoryGauge& gauge = g_memory[category];
+    const int64_t live = gauge.live.fetch_add(delta, std::memory_order_relaxed) + delta;
+    int64_t peak = gauge.peak.load(std::memory_order_relaxed);
+    while (live > peak && !gauge.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+// 随所属对象析构自动扣除（用作缓存条目的成员）
+class TrackedBytes {
+public:
+    explicit TrackedBytes(MemoryCategory category) : category_(category) {}
+    ~TrackedBytes() { TrackMemory(category_, -bytes_); }
+    TrackedBytes(const TrackedBytes&) = delete;
+    TrackedBytes& operator=(const TrackedBytes&) = delete;
+
+    void Set(int64_t bytes) {
+        TrackMemory(category_, bytes - bytes_);
+        bytes_ = bytes;
+    }
+
+private:
+    MemoryCategory category_;
+    int64_t bytes_ = 0;
+};
+
+// 超出短字符串优化的 std::string 堆内存
+static int64_t HeapStringBytes(const std::string& s) {
+    return s.capacity() >= sizeof(std::string) ? static_cast<int64_t>(s.capacity() + 1) : 0;
+}
+
+// 哈希表：桶数组 + 每个节点（值 + next 指针 + 缓存的哈希值）
+template <typename Map>
+static int64_t HashMapBytes(const Map& map) {
+    return static_cast<int64_t>(map.bucket_count() * sizeof(void*) +
+                                map.size() * (sizeof(typename Map::value_type) + 2 * sizeof(void*)));
+}
+
+static int64_t ObjectInfoBytes(const PDFIUM_EX_OBJECT_INFO* info) {
+    return static_cast<int64_t>(sizeof(PDFIUM_EX_OBJECT_INFO) +
+                                (info->raw_dict_content ? info->dict_length + 1 : 0));
+}
+
+// 单个树节点（不含子节点）
+static int64_t TreeNodeBytes(const PDFIUM_EX_OBJECT_TREE_NODE* node) {
+    return static_cast<int64_t>(sizeof(PDFIUM_EX_OBJECT_TREE_NODE) +
+                                (node->raw_content ? node->content_length + 1 : 0) +
+                                (node->children ? sizeof(PDFIUM_EX_OBJECT_TREE_NODE*) * node->max_children : 0));
+}
+
+} // namespace pdfium_ex
+
+FPDF_EXPORT void FPDF_CALLCONV
+PdfiumEx_GetMemoryStats(PDFIUM_EX_MEMORY_STATS* stats) {
+    if (!stats) return;
+    using namespace pdfium_ex;
+    auto live = [](MemoryCategory c) { return g_memory[c].live.load(std::memory_order_relaxed); };
+    auto peak = [](MemoryCategory c) { return g_memory[c].peak.load(std::memory_order_relaxed); };
+    stats->object_info_bytes = live(kMemObjectInfo);
+    stats->object_info_peak = peak(kMemObjectInfo);
+    stats->object_tree_bytes = live(kMemObjectTree);
+    stats->object_tree_peak = peak(kMemObjectTree);
+    stats->mapping_cache_bytes = live(kMemMappingCache);
+    stats->mapping_cache_peak = peak(kMemMappingCache);
+    stats->reference_graph_bytes = live(kMemReferenceGraph);
+    stats->reference_graph_peak = peak(kMemReferenceGraph);
+}
@@ -0,0 +1,79 @@
+// PDFium扩展库 - 书签（大纲）写入
+// PDFium 公共编辑API只能读取书签，这里直接构建 /Outlines 字典树，
+// 供压力测试文档生成器与需要写书签的工具使用。
+
+#include "../include/pdfium_object_info.h"
+#include "core/fpdfapi/parser/cpdf_array.h"
+#include "core/fpdfapi/parser/cpdf_dictionary.h"
+#include "core/fpdfapi/parser/cpdf_document.h"
+#include "core/fpdfapi/parser/cpdf_name.h"
+#include "core/fpdfapi/parser/cpdf_number.h"
+#include "core/fpdfapi/parser/cpdf_reference.h"
+#include "core/fpdfapi/parser/cpdf_string.h"
+
+#include <vector>
+
+namespace pdfium_ex {
+
+// 用新的书签树替换文档目录中的 /Outlines。
+// 有子项的条目写成折叠状态（/Count 为负的直接子项数），与大型文档常见的保存状态一致。
+bool WriteOutline(CPDF_Document* doc, const PDFIUM_EX_OUTLINE_ENTRY* entries, int count) {
+    if (!doc || count < 0 || (count > 0 && !entries)) return false;
+    RetainPtr<CPDF_Dictionary> root = doc->GetMutableRoot();
+    if (!root) return false;
+
+    if (count == 0) {
+        root->RemoveFor("Outlines");
+        return true;
+    }
+
+    // 先校验父子关系：父条目必须出现在子条目之前
+    std::vector<std::vector<int>> children(count + 1); // [count] 为顶层
+    for (int i = 0; i < count; ++i) {
+        const int parent = entries[i].parent;
+        if (parent >= i || parent < -1) return false;
+        children[parent < 0 ? count : parent].push_back(i);
+    }
+
+    RetainPtr<CPDF_Dictionary> outlines = doc->NewIndirect<CPDF_Dictionary>();
+    outlines->SetNewFor<CPDF_Name>("Type", "Outlines");
+
+    std::vector<RetainPtr<CPDF_Dictionary>> items(count);
+    for (int i = 0; i < count; ++i) {
+        items[i] = doc->NewIndirect<CPDF_Dictionary>();
+        const WideString title = WideString::FromUTF8(ByteStringView(entries[i].title ? entries[i].title : ""));
+        items[i]->SetNewFor<CPDF_String>("Title", title.AsStringView());
+        if (entries[i].page_index >= 0) {
+            RetainPtr<CPDF_Dictionary> page = doc->GetMutablePageDictionary(entries[i].page_index);
+            if (page) {
+                auto dest = items[i]->SetNewFor<CPDF_Array>("Dest");
+                dest->AppendNew<CPDF_Reference>(doc, page->GetObjNum());
+                dest->AppendNew<CPDF_Name>("Fit");
+            }
+        }
+    }
+
+    auto link = [&](CPDF_Dictionary* parent, uint32_t parent_num, const std::vector<int>& kids) {
+        if (kids.empty()) return;
+        parent->SetNewFor<CPDF_Reference>("First", doc, items[kids.front()]->GetObjNum());
+        parent->SetNewFor<CPDF_Reference>("Last", doc, items[kids.back()]->GetObjNum());
+        for (size_t k = 0; k < kids.size(); ++k) {
+            CPDF_Dictionary* item = items[kids[k]].Get();
+            item->SetNewFor<CPDF_Reference>("Parent", doc, parent_num);
+            if (k > 0) item->SetNewFor<CPDF_Reference>("Prev", doc, items[kids[k - 1]]->GetObjNum());
+            if (k + 1 < kids.size()) item->SetNewFor<CPDF_Reference>("Next", doc, items[kids[k + 1]]->GetObjNum());
+        }
+    };
+
+    link(outlines.Get(), outlines->GetObjNum(), children[count]);
+    outlines->SetNewFor<CPDF_Number>("Count", static_cast<int>(children[count].size()));
+    for (int i = 0; i < count; ++i) {
+        link(items[i].Get(), items[i]->GetObjNum(), children[i]);
+        if (!children[i].empty()) items[i]->SetNewFor<CPDF_Number>("Count", -static_cast<int>(children[i].size()));
+    }
+
+    root->SetNewFor<CPDF_Reference>("Outlines", doc, outlines->GetObjNum());
+    return true;
+}
+
+} // namespace pdfium_ex
@@ -13,9 +13,21 @@
 
 using namespace pdfium_ex;
 
+// 包含内存统计
+#include "memory_stats.cpp"
+
 // 包含高级映射功能
 #include "advanced_object_mapper.cpp"
 
+// 包含文档引用图
+#include "reference_graph.cpp"
+
+// 包含文档体积分析
+#include "document_analyzer.cpp"
+
+// 包含书签写入
+#include "outline_writer.cpp"
+
 FPDF_EXPORT PDFIUM_EX_OBJECT_INFO *FPDF_CALLCONV
 PdfiumEx_GetPageObjectInfo(FPDF_PAGEOBJECT page_object) {
   CPDF_PageObject *pPageObj = GetInternalPageObject(page_object);
@@ -84,6 +96,7 @@ PdfiumEx_GetPageObjectInfo(FPDF_PAGEOBJECT page_object) {
     strcpy(obj_info->raw_dict_content, dict_str.c_str());
   }
 
+  TrackMemory(kMemObjectInfo, ObjectInfoBytes(obj_info));
   return obj_info;
 }
 
@@ -105,12 +118,13 @@ PdfiumEx_GetPageObjectInfoEx(FPDF_PAGE page, FPDF_PAGEOBJECT page_object) {
   // 获取对象类型
   obj_info->obj_type = static_cast<int>(pPageObj->GetType());
 
-  // 尝试获取真实的PDF对象映射
-  const CPDF_Object *pdf_obj = GetAdvancedPageObjectMapping(pPageObj, pPage);
-  if (pdf_obj && pdf_obj->IsReference()) {
-    // 找到了真实的间接对象
-    obj_info->obj_num = pdf_obj->AsReference()->GetRefObjNum();
-    obj_info->gen_num = 0; // 通常为0
+  // 尝试获取真实的PDF对象映射（页面索引只构建一次，之后O(1)查询）
+  ObjectMapping mapping;
+  if (GetAdvancedPageObjectMapping(pPageObj, pPage, &mapping) &&
+      mapping.obj_num > 0) {
+    // 找到了真实的间接对象（XObject/Shading资源或所在内容流）
+    obj_info->obj_num = mapping.obj_num;
+    obj_info->gen_num = mapping.gen_num;
     obj_info->is_indirect = 1;
 
     // 获取真实的对象内容
@@ -177,6 +191,7 @@ PdfiumEx_GetPageObjectInfoEx(FPDF_PAGE page, FPDF_PAGEOBJECT page_object) {
     }
   }
 
+  TrackMemory(kMemObjectInfo, ObjectInfoBytes(obj_info));
   return obj_info;
 }
 
@@ -185,6 +200,7 @@ PdfiumEx_ReleaseObjectInfo(PDFIUM_EX_OBJECT_INFO *obj_info) {
   if (!obj_info)
     return;
 
+  TrackMemory(kMemObjectInfo, -ObjectInfoBytes(obj_info));
   if (obj_info->raw_dict_content) {
     free(obj_info->raw_dict_content);
   }
@@ -221,9 +237,229 @@ PdfiumEx_GetPageObjectNumber(FPDF_PAGEOBJECT page_object) {
   if (!pPageObj)
     return 0;
 
-  // 注意：这里需要页面信息才能查找真实对象编号
-  // 当前API设计的限制，返回0表示内联对象
-  return 0;
+  // 没有页面上下文时只能查已建立的索引；
+  // 调用过 PdfiumEx_GetPageObjectInfoEx/PdfiumEx_GetPageObjectSource 的页面可直接命中
+  ObjectMapping mapping;
+  return GetAdvancedPageObjectMapping(pPageObj, nullptr, &mapping)
+             ? mapping.obj_num
+             : 0;
+}
+
+FPDF_EXPORT uint32_t FPDF_CALLCONV
+PdfiumEx_GetImageObjectNumber(FPDF_PAGEOBJECT image_object) {
+  CPDF_PageObject *pPageObj = GetInternalPageObject(image_object);
+  const CPDF_ImageObject *img_obj = pPageObj ? pPageObj->AsImage() : nullptr;
+  if (!img_obj)
+    return 0;
+  // 同一 XObject 在各页共享同一个 CPDF_Image，其流即间接对象本身
+  RetainPtr<CPDF_Image> image = img_obj->GetImage();
+  return image && image->GetStream() ? image->GetStream()->GetObjNum() : 0;
+}
+
+FPDF_EXPORT uint64_t FPDF_CALLCONV
+PdfiumEx_GetImageParamsHash(FPDF_PAGEOBJECT image_object) {
+  CPDF_PageObject *pPageObj = GetInternalPageObject(image_object);
+  const CPDF_ImageObject *img_obj = pPageObj ? pPageObj->AsImage() : nullptr;
+  if (!img_obj)
+    return 0;
+  RetainPtr<CPDF_Image> image = img_obj->GetImage();
+  if (!image || !image->GetStream())
+    return 0;
+  auto dict = image->GetStream()->GetDict();
+  if (!dict)
+    return 0;
+
+  // 内联图像的缩写键在解析时已展开为全称；引用按对象号参与哈希
+  static const char *const kDecodeKeys[] = {
+      "ColorSpace", "BitsPerComponent", "Decode", "DecodeParms",
+      "ImageMask",  "Mask",             "SMask",  "SMaskInData"};
+  std::string params;
+  for (const char *key : kDecodeKeys) {
+    params += key;
+    params += '=';
+    params += ObjectToPdfString(dict->GetObjectFor(key).Get());
+    params += ';';
+  }
+  uint64_t h = 14695981039346656037ull; // FNV-1a
+  for (unsigned char c : params) {
+    h ^= c;
+    h *= 1099511628211ull;
+  }
+  return h ? h : 1;
+}
+
+FPDF_EXPORT int FPDF_CALLCONV
+PdfiumEx_IsImageParamsPlain(FPDF_PAGEOBJECT image_object) {
+  CPDF_PageObject *pPageObj = GetInternalPageObject(image_object);
+  const CPDF_ImageObject *img_obj = pPageObj ? pPageObj->AsImage() : nullptr;
+  if (!img_obj)
+    return 0;
+  RetainPtr<CPDF_Image> image = img_obj->GetImage();
+  if (!image || !image->GetStream())
+    return 0;
+  auto dict = image->GetStream()->GetDict();
+  if (!dict)
+    return 0;
+
+  // /Decode、/ImageMask 改变样本含义，单独写出的码流无法体现
+  if (dict->KeyExist("Decode") || dict->GetBooleanFor("ImageMask", false))
+    return 0;
+  RetainPtr<const CPDF_Object> cs = dict->GetDirectObjectFor("ColorSpace");
+  if (!cs) // JPX 可省略，由码流自带颜色空间
+    return 1;
+  ByteString family;
+  if (cs->IsName())
+    family = cs->GetString();
+  else if (cs->IsArray() && cs->AsArray()->size() > 0)
+    family = cs->AsArray()->GetByteStringAt(0);
+  if (family == "ICCBased" && cs->IsArray()) {
+    // 按 /Alternate（缺省按 /N）对应的设备颜色空间处理，分量数须一致
+    RetainPtr<const CPDF_Stream> icc =
+        ToStream(cs->AsArray()->GetDirectObjectAt(1));
+    RetainPtr<const CPDF_Dictionary> icc_dict = icc ? icc->GetDict() : nullptr;
+    const int n = icc_dict ? icc_dict->GetIntegerFor("N") : 0;
+    static const char *const kDeviceByN[] = {"", "DeviceGray", "", "DeviceRGB",
+                                             "DeviceCMYK"};
+    if (n < 1 || n > 4 || !*kDeviceByN[n])
+      return 0;
+    ByteString alternate = icc_dict->GetNameFor("Alternate");
+    if (!alternate.IsEmpty() && alternate != kDeviceByN[n])
+      return 0;
+    family = kDeviceByN[n];
+  }
+  const bool device = family == "DeviceGray" || family == "DeviceRGB" ||
+                      family == "DeviceCMYK";
+  return device ? 1 : 0;
+}
+
+FPDF_EXPORT int FPDF_CALLCONV
+PdfiumEx_GetPageObjectSource(FPDF_PAGE page, FPDF_PAGEOBJECT page_object,
+                             PDFIUM_EX_CONTENT_SOURCE *out_source) {
+  CPDF_Page *pPage = GetInternalPage(page);
+  CPDF_PageObject *pPageObj = GetInternalPageObject(page_object);
+  if (!pPage || !pPageObj || !out_source)
+    return 0;
+
+  memset(out_source, 0, sizeof(PDFIUM_EX_CONTENT_SOURCE));
+
+  ObjectMapping mapping;
+  if (!GetAdvancedPageObjectMapping(pPageObj, pPage, &mapping))
+    return 0;
+
+  const PageObjectSource *src = &mapping.source;
+  out_source->obj_num = mapping.obj_num;
+  out_source->stream_obj_num = src->stream_obj_num;
+  out_source->stream_index = src->stream_index;
+  out_source->op_begin = src->op_begin;
+  out_source->op_end = src->op_end;
+  strncpy(out_source->op, src->op.c_str(), sizeof(out_source->op) - 1);
+  strncpy(out_source->resource_name, src->resource_name.c_str(),
+          sizeof(out_source->resource_name) - 1);
+  out_source->resource_obj_num = src->resource_obj_num;
+  return 1;
+}
+
+FPDF_EXPORT void FPDF_CALLCONV PdfiumEx_InvalidatePageCache(FPDF_PAGE page) {
+  InvalidatePageMappingCache(GetInternalPage(page));
+}
+
+FPDF_EXPORT void FPDF_CALLCONV
+PdfiumEx_InvalidateDocumentCache(FPDF_DOCUMENT document) {
+  CPDF_Document *pDoc = GetInternalDocument(document);
+  InvalidateDocumentMappingCache(pDoc);
+  InvalidateReferenceGraph(pDoc);
+}
+
+FPDF_EXPORT void FPDF_CALLCONV
+PdfiumEx_SetMappingCacheCapacity(FPDF_DOCUMENT document, int max_pages) {
+  std::shared_ptr<DocumentMappingCache> cache =
+      GetDocumentMappingCache(GetInternalDocument(document), true);
+  if (cache && max_pages > 0)
+    cache->SetCapacity(static_cast<size_t>(max_pages));
+}
+
+FPDF_EXPORT int FPDF_CALLCONV PdfiumEx_GetMappingCacheStats(
+    FPDF_DOCUMENT document, PDFIUM_EX_MAPPING_CACHE_STATS *stats) {
+  if (!stats)
+    return 0;
+  memset(stats, 0, sizeof(PDFIUM_EX_MAPPING_CACHE_STATS));
+  std::shared_ptr<DocumentMappingCache> cache =
+      GetDocumentMappingCache(GetInternalDocument(document), false);
+  if (!cache)
+    return 0;
+  cache->GetStats(stats);
+  return 1;
+}
+
+FPDF_EXPORT char *FPDF_CALLCONV PdfiumEx_AnalyzeDocument(FPDF_DOCUMENT document,
+                                                         int flags) {
+  CPDF_Document *pDoc = GetInternalDocument(document);
+  if (!pDoc)
+    return nullptr;
+
+  std::string report = AnalyzeDocumentWeight(document, pDoc, flags);
+  char *result = static_cast<char *>(malloc(report.length() + 1));
+  if (result) {
+    memcpy(result, report.c_str(), report.length() + 1);
+  }
+  return result;
+}
+
+FPDF_EXPORT int FPDF_CALLCONV
+PdfiumEx_SetOutline(FPDF_DOCUMENT document,
+                    const PDFIUM_EX_OUTLINE_ENTRY *entries, int count) {
+  return WriteOutline(GetInternalDocument(document), entries, count) ? 1 : 0;
+}
+
+FPDF_EXPORT int FPDF_CALLCONV
+PdfiumEx_BuildReferenceGraph(FPDF_DOCUMENT document) {
+  std::shared_ptr<const ReferenceGraph> graph =
+      GetReferenceGraph(GetInternalDocument(document));
+  return graph ? static_cast<int>(graph->fwd_targets.size()) : -1;
+}
+
+FPDF_EXPORT int FPDF_CALLCONV
+PdfiumEx_BuildReferenceGraphStep(FPDF_DOCUMENT document, double budget_ms,
+                                 uint32_t *objects_done,
+                                 uint32_t *objects_total) {
+  return BuildReferenceGraphStep(GetInternalDocument(document), budget_ms,
+                                 objects_done, objects_total);
+}
+
+FPDF_EXPORT int FPDF_CALLCONV
+PdfiumEx_GetObjectReferences(FPDF_DOCUMENT document, uint32_t obj_num,
+                             const uint32_t **out_obj_nums) {
+  std::shared_ptr<const ReferenceGraph> graph =
+      GetReferenceGraph(GetInternalDocument(document));
+  if (!graph) {
+    if (out_obj_nums)
+      *out_obj_nums = nullptr;
+    return 0;
+  }
+  return GetReferenceNeighbours(*graph, obj_num, true, out_obj_nums);
+}
+
+FPDF_EXPORT int FPDF_CALLCONV
+PdfiumEx_GetObjectReferrers(FPDF_DOCUMENT document, uint32_t obj_num,
+                            const uint32_t **out_obj_nums) {
+  std::shared_ptr<const ReferenceGraph> graph =
+      GetReferenceGraph(GetInternalDocument(document));
+  if (!graph) {
+    if (out_obj_nums)
+      *out_obj_nums = nullptr;
+    return 0;
+  }
+  return GetReferenceNeighbours(*graph, obj_num, false, out_obj_nums);
+}
+
+FPDF_EXPORT int FPDF_CALLCONV PdfiumEx_GetObjectUsingPages(
+    FPDF_DOCUMENT document, uint32_t obj_num, int *page_indices,
+    int max_count) {
+  std::shared_ptr<const ReferenceGraph> graph =
+      GetReferenceGraph(GetInternalDocument(document));
+  if (!graph)
+    return 0;
+  return CollectUsingPages(*graph, obj_num, page_indices, max_count);
 }
 
 FPDF_EXPORT int FPDF_CALLCONV
@@ -301,6 +537,7 @@ PdfiumEx_GetPageObjectDict(FPDF_PAGE page) {
     strcpy(obj_info->raw_dict_content, dict_content.c_str());
   }
 
+  TrackMemory(kMemObjectInfo, ObjectInfoBytes(obj_info));
   return obj_info;
 }
 
@@ -385,6 +622,7 @@ static PDFIUM_EX_OBJECT_TREE_NODE *CreateTreeNode(uint32_t obj_num,
            sizeof(PDFIUM_EX_OBJECT_TREE_NODE *) * node->max_children);
   }
 
+  TrackMemory(kMemObjectTree, TreeNodeBytes(node));
   return node;
 }
 
@@ -402,6 +640,9 @@ static void AddChildNode(PDFIUM_EX_OBJECT_TREE_NODE *parent,
     if (!new_children)
       return;
 
+    TrackMemory(kMemObjectTree,
+                static_cast<int64_t>(sizeof(PDFIUM_EX_OBJECT_TREE_NODE *)) *
+                    (new_capacity - parent->max_children));
     parent->children = new_children;
     parent->max_children = new_capacity;
   }
@@ -586,6 +827,7 @@ PdfiumEx_ReleaseObjectTree(PDFIUM_EX_OBJECT_TREE_NODE *root) {
   }
 
   // 释放当前节点的资源
+  TrackMemory(kMemObjectTree, -TreeNodeBytes(root));
   if (root->raw_content) {
     free(root->raw_content);
   }
@@ -0,0 +1,252 @@
+// PDFium扩展库 - 文档级对象引用图
+// 单遍遍历 xref 中的全部间接对象，收集每个对象直接引用的对象编号，
+// 构建 CSR（压缩稀疏行）形式的正向图与反向图：
+//   forward: offsets[n] .. offsets[n+1] 为对象 n 引用的对象
+//   reverse: offsets[n] .. offsets[n+1] 为引用对象 n 的对象
+// 邻居查询为 O(1) 定位 + 连续内存读取。每个文档缓存一份，文档关闭时释放。
+// 正向图的解析可分片进行（BuildReferenceGraphStep），前端在主线程上按时间片
+// 推进，避免首次查询时同步解析全部对象而卡住界面。
+
+#include "../include/pdfium_object_info.h"
+#include "core/fpdfapi/parser/cpdf_array.h"
+#include "core/fpdfapi/parser/cpdf_dictionary.h"
+#include "core/fpdfapi/parser/cpdf_document.h"
+#include "core/fpdfapi/parser/cpdf_reference.h"
+#include "core/fpdfapi/parser/cpdf_stream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace pdfium_ex {
+
+struct ReferenceGraph {
+    uint32_t node_count = 0;                // 最大对象编号 + 1
+    std::vector<uint32_t> fwd_offsets;      // node_count + 1
+    std::vector<uint32_t> fwd_targets;
+    std::vector<uint32_t> rev_offsets;      // node_count + 1
+    std::vector<uint32_t> rev_sources;
+    std::vector<int32_t> page_index;        // 对象编号 -> 页面序号（非页面为 -1）
+    std::vector<uint32_t> tree_parent;      // 页面树节点 -> /Parent 对象编号（其它为 0）
+    TrackedBytes memory{kMemReferenceGraph};
+};
+
+namespace {
+
+// 收集一个对象（含其直接子对象）中出现的全部引用，不跟随引用
+void CollectReferences(const CPDF_Object* obj, std::vector<uint32_t>* refs, int depth) {
+    if (!obj || depth > 64) return;
+    switch (obj->GetType()) {
+        case CPDF_Object::kReference:
+            refs->push_back(obj->AsReference()->GetRefObjNum());
+            break;
+        case CPDF_Object::kArray: {
+            const CPDF_Array* arr = obj->AsArray();
+            for (size_t i = 0; i < arr->size(); ++i) {
+                CollectReferences(arr->GetObjectAt(i).Get(), refs, depth + 1);
+            }
+            break;
+        }
+        case CPDF_Object::kDictionary: {
+            CPDF_DictionaryLocker locker(obj->AsDictionary());
+            for (const auto& pair : locker) {
+                CollectReferences(pair.second.Get(), refs, depth + 1);
+            }
+            break;
+        }
+        case CPDF_Object::kStream:
+            CollectReferences(obj->AsStream()->GetDict().Get(), refs, depth + 1);
+            break;
+        default:
+            break;
+    }
+}
+
+// 构建中的引用图：正向图已解析到 next_num
+struct ReferenceGraphBuild {
+    std::unique_ptr<ReferenceGraph> graph;
+    uint32_t next_num = 1;
+    std::vector<uint32_t> refs;
+};
+
+std::unique_ptr<ReferenceGraphBuild> BeginReferenceGraph(CPDF_Document* doc) {
+    auto build = std::make_unique<ReferenceGraphBuild>();
+    build->graph = std::make_unique<ReferenceGraph>();
+    const uint32_t n = doc->GetLastObjNum() + 1;
+    build->graph->node_count = n;
+    build->graph->fwd_offsets.assign(n + 1, 0);
+    return build;
+}
+
+// 正向图：按对象编号顺序逐个解析，边直接追加，天然是 CSR 布局。
+// budget_ms < 0 表示一次做完；否则约 budget_ms 后返回。全部解析完返回 true
+bool StepForwardGraph(CPDF_Document* doc, ReferenceGraphBuild& build, double budget_ms) {
+    ReferenceGraph& graph = *build.graph;
+    const uint32_t n = graph.node_count;
+    const auto deadline = std::chrono::steady_clock::now() +
+                          std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                              std::chrono::duration<double, std::milli>(budget_ms));
+    for (uint32_t& num = build.next_num; num < n; ++num) {
+        // 每 64 个对象检查一次时间
+        if (budget_ms >= 0 && (num & 63) == 0 && std::chrono::steady_clock::now() >= deadline) return false;
+        graph.fwd_offsets[num] = static_cast<uint32_t>(graph.fwd_targets.size());
+        RetainPtr<const CPDF_Object> obj = doc->GetOrParseIndirectObject(num);
+        if (!obj) continue;
+        build.refs.clear();
+        CollectReferences(obj.Get(), &build.refs, 0);
+        std::sort(build.refs.begin(), build.refs.end());
+        build.refs.erase(std::unique(build.refs.begin(), build.refs.end()), build.refs.end());
+        for (uint32_t target : build.refs) {
+            if (target > 0 && target < n && target != num) graph.fwd_targets.push_back(target);
+        }
+    }
+    return true;
+}
+
+// 正向图完成后：反向图与页面标记（线性，不再解析对象）
+std::unique_ptr<ReferenceGraph> FinishReferenceGraph(CPDF_Document* doc, ReferenceGraphBuild& build) {
+    std::unique_ptr<ReferenceGraph> graph = std::move(build.graph);
+    const uint32_t n = graph->node_count;
+    graph->fwd_offsets[n] = static_cast<uint32_t>(graph->fwd_targets.size());
+    graph->fwd_targets.shrink_to_fit();
+
+    // 反向图：计数 + 前缀和 + 填充（按来源编号递增，结果有序）
+    graph->rev_offsets.assign(n + 1, 0);
+    for (uint32_t target : graph->fwd_targets) ++graph->rev_offsets[target + 1];
+    for (uint32_t i = 0; i < n; ++i) graph->rev_offsets[i + 1] += graph->rev_offsets[i];
+    graph->rev_sources.resize(graph->fwd_targets.size());
+    std::vector<uint32_t> cursor(graph->rev_offsets.begin(), graph->rev_offsets.end() - 1);
+    for (uint32_t src = 0; src < n; ++src) {
+        for (uint32_t e = graph->fwd_offsets[src]; e < graph->fwd_offsets[src + 1]; ++e) {
+            graph->rev_sources[cursor[graph->fwd_targets[e]]++] = src;
+        }
+    }
+
+    // 页面对象标记，用于“哪些页面使用了该对象”
+    // 同时记录页面树的 /Parent 链，继承资源时只向下查找子页面
+    graph->page_index.assign(n, -1);
+    graph->tree_parent.assign(n, 0);
+    const int page_count = doc->GetPageCount();
+    for (int i = 0; i < page_count; ++i) {
+        RetainPtr<const CPDF_Dictionary> node = doc->GetPageDictionary(i);
+        uint32_t num = node ? node->GetObjNum() : 0;
+        if (num == 0 || num >= n) continue;
+        graph->page_index[num] = i;
+        while (node && num > 0 && num < n && graph->tree_parent[num] == 0) {
+            RetainPtr<const CPDF_Dictionary> parent = node->GetDictFor("Parent");
+            uint32_t parent_num = parent ? parent->GetObjNum() : 0;
+            if (parent_num == 0 || parent_num >= n) break;
+            graph->tree_parent[num] = parent_num;
+            node = parent;
+            num = parent_num;
+        }
+    }
+    graph->memory.Set(static_cast<int64_t>(
+        sizeof(ReferenceGraph) +
+        (graph->fwd_offsets.capacity() + graph->fwd_targets.capacity() + graph->rev_offsets.capacity() +
+         graph->rev_sources.capacity() + graph->tree_parent.capacity()) * sizeof(uint32_t) +
+        graph->page_index.capacity() * sizeof(int32_t)));
+    return graph;
+}
+
+std::mutex g_ref_graph_mutex;
+std::unordered_map<const CPDF_Document*, std::shared_ptr<const ReferenceGraph>> g_ref_graphs;
+// 分片构建中的文档（解析 PDFium 对象，只在调用方的 PDFium 线程上推进）
+std::unordered_map<const CPDF_Document*, std::unique_ptr<ReferenceGraphBuild>> g_ref_builds;
+
+} // namespace
+
+// 推进文档引用图的构建约 budget_ms（<0 表示做完，0 只查询进度）。
+// 返回 1 表示已完成，0 表示仍在构建；done/total 为已解析/全部对象数
+int BuildReferenceGraphStep(CPDF_Document* doc, double budget_ms, uint32_t* done, uint32_t* total) {
+    if (!doc) return -1;
+    std::lock_guard<std::mutex> lock(g_ref_graph_mutex);
+    auto ready = g_ref_graphs.find(doc);
+    if (ready != g_ref_graphs.end()) {
+        if (done) *done = ready->second->node_count;
+        if (total) *total = ready->second->node_count;
+        return 1;
+    }
+    std::unique_ptr<ReferenceGraphBuild>& build = g_ref_builds[doc];
+    if (!build) build = BeginReferenceGraph(doc);
+    const uint32_t n = build->graph->node_count;
+    bool finished = budget_ms != 0 && StepForwardGraph(doc, *build, budget_ms);
+    if (total) *total = n;
+    if (!finished) {
+        if (done) *done = std::min(build->next_num, n);
+        return 0;
+    }
+    if (done) *done = n;
+    g_ref_graphs.emplace(doc, FinishReferenceGraph(doc, *build));
+    g_ref_builds.erase(doc);
+    return 1;
+}
+
+// 获取（必要时构建）文档的引用图；已分片构建的部分不会重复解析
+std::shared_ptr<const ReferenceGraph> GetReferenceGraph(CPDF_Document* doc) {
+    if (!doc) return nullptr;
+    if (BuildReferenceGraphStep(doc, -1, nullptr, nullptr) != 1) return nullptr;
+    std::lock_guard<std::mutex> lock(g_ref_graph_mutex);
+    auto it = g_ref_graphs.find(doc);
+    return it != g_ref_graphs.end() ? it->second : nullptr;
+}
+
+// 文档关闭时调用
+void InvalidateReferenceGraph(const CPDF_Document* doc) {
+    std::lock_guard<std::mutex> lock(g_ref_graph_mutex);
+    g_ref_graphs.erase(doc);
+    g_ref_builds.erase(doc);
+}
+
+// 查询对象 obj_num 的邻居（forward=true 为其引用的对象，否则为引用它的对象）
+int GetReferenceNeighbours(const ReferenceGraph& graph, uint32_t obj_num, bool forward,
+                           const uint32_t** out) {
+    if (obj_num == 0 || obj_num >= graph.node_count) {
+        if (out) *out = nullptr;
+        return 0;
+    }
+    const std::vector<uint32_t>& offsets = forward ? graph.fwd_offsets : graph.rev_offsets;
+    const std::vector<uint32_t>& edges = forward ? graph.fwd_targets : graph.rev_sources;
+    uint32_t begin = offsets[obj_num];
+    uint32_t end = offsets[obj_num + 1];
+    if (out) *out = edges.empty() ? nullptr : edges.data() + begin;
+    return static_cast<int>(end - begin);
+}
+
+// 沿反向边查找使用该对象的页面。遇到页面即停止；遇到页面树中间节点（继承资源）
+// 只走向其子节点，不回到父节点，避免扩散到整棵页面树
+int CollectUsingPages(const ReferenceGraph& graph, uint32_t obj_num, int* page_indices, int max_count) {
+    if (obj_num == 0 || obj_num >= graph.node_count) return 0;
+    std::vector<uint8_t> visited(graph.node_count, 0);
+    std::vector<uint32_t> stack{obj_num};
+    visited[obj_num] = 1;
+    std::vector<int> pages;
+    while (!stack.empty()) {
+        uint32_t cur = stack.back();
+        stack.pop_back();
+        if (graph.page_index[cur] >= 0) {
+            pages.push_back(graph.page_index[cur]);
+            if (cur != obj_num) continue;
+        }
+        const uint32_t skip = graph.tree_parent[cur];
+        for (uint32_t e = graph.rev_offsets[cur]; e < graph.rev_offsets[cur + 1]; ++e) {
+            uint32_t src = graph.rev_sources[e];
+            if (src == skip) continue;
+            if (!visited[src]) {
+                visited[src] = 1;
+                stack.push_back(src);
+            }
+        }
+    }
+    std::sort(pages.begin(), pages.end());
+    int count = static_cast<int>(pages.size());
+    if (page_indices) {
+        for (int i = 0; i < count && i < max_count; ++i) page_indices[i] = pages[i];
+    }
+    return count;
+}
+
+} // namespace pdfium_ex
@@ -0,0 +1,190 @@
+#include "bench_compare.h"
+#include "bench_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <map>
+
+namespace pdfwv_bench {
+
+namespace {
+
+std::vector<double> Samples(const JsonValue& metric) {
+    std::vector<double> out;
+    for (const auto& v : metric["samples"].array) out.push_back(v.AsNumber());
+    return out;
+}
+
+// 没有原始样本的旧结果文件退化为只比较中位数
+double MedianOf(const JsonValue& metric, const std::vector<double>& samples) {
+    return samples.empty() ? metric["median"].AsNumber() : Median(samples);
+}
+
+std::string ConfigSignature(const JsonValue& root) {
+    const JsonValue& c = root["config"];
+    std::string sig;
+    char buf[128];
+    snprintf(buf, sizeof(buf), "runs=%g warmup=%g max_pages=%g hit_grid=%g tree_depth=%g dpis=", c["runs"].AsNumber(),
+             c["warmup"].AsNumber(), c["max_pages"].AsNumber(), c["hit_grid"].AsNumber(), c["tree_depth"].AsNumber());
+    sig += buf;
+    for (const auto& d : c["dpis"].array) sig += std::to_string((int)d.AsNumber()) + ",";
+    sig += " query=" + c["query"].AsString();
+    return sig;
+}
+
+const char* StatusText(DiffStatus s) {
+    switch (s) {
+    case DiffStatus::Same: return "~";
+    case DiffStatus::Slower: return "slower";
+    case DiffStatus::Regressed: return "REGRESSED";
+    case DiffStatus::Faster: return "faster";
+    case DiffStatus::New: return "new";
+    case DiffStatus::Missing: return "missing";
+    }
+    return "?";
+}
+
+std::string Ellipsize(const std::string& s, size_t width) {
+    if (s.size() <= width) return s;
+    return "..." + s.substr(s.size() - (width - 3));
+}
+
+} // namespace
+
+double ThresholdFor(const CompareOptions& options, const std::string& metric) {
+    for (const auto& it : options.metricThresholdPct) {
+        const std::string& pat = it.first;
+        if (!pat.empty() && pat.back() == '*') {
+            if (metric.compare(0, pat.size() - 1, pat, 0, pat.size() - 1) == 0) return it.second;
+        } else if (pat == metric) {
+            return it.second;
+        }
+    }
+    return options.thresholdPct;
+}
+
+CompareReport CompareResults(const JsonValue& baseline, const JsonValue& current, const CompareOptions& options) {
+    CompareReport report;
+
+    const std::string baseSig = ConfigSignature(baseline);
+    const std::string curSig = ConfigSignature(current);
+    if (baseSig != curSig) report.warnings.push_back("config differs: baseline {" + baseSig + "} current {" + curSig + "}");
+
+    std::map<std::string, const JsonValue*> baseDocs;
+    for (const auto& d : baseline["documents"].array) baseDocs[d["file"].AsString()] = &d;
+
+    for (const auto& cur : current["documents"].array) {
+        const std::string& file = cur["file"].AsString();
+        auto it = baseDocs.find(file);
+        if (it == baseDocs.end()) {
+            report.warnings.push_back(file + ": not in baseline");
+            continue;
+        }
+        const JsonValue& base = *it->second;
+        baseDocs.erase(it);
+        if (!cur["error"].IsNull() || !base["error"].IsNull()) {
+            if (cur["error"].IsNull() != base["error"].IsNull())
+                report.warnings.push_back(file + ": " + (cur["error"].IsNull() ? "failed in baseline: " + base["error"].AsString()
+                                                                               : "failed now: " + cur["error"].AsString()));
+            continue;
+        }
+        for (const char* key : {"text_chars", "search_hits", "image_hits", "tree_nodes"}) {
+            const double b = base["counts"][key].AsNumber(-1), c = cur["counts"][key].AsNumber(-1);
+            if (b != c) {
+                char buf[160];
+                snprintf(buf, sizeof(buf), ": %s differs (baseline %.0f, current %.0f)", key, b, c);
+                report.warnings.push_back(file + buf);
+            }
+        }
+
+        const JsonValue& baseMetrics = base["metrics"];
+        for (const auto& m : cur["metrics"].object) {
+            MetricDiff row;
+            row.file = file;
+            row.metric = m.first;
+            const std::vector<double> curSamples = Samples(m.second);
+            row.curMedian = MedianOf(m.second, curSamples);
+            const JsonValue& bm = baseMetrics[m.first];
+            if (bm.IsNull()) {
+                row.status = DiffStatus::New;
+                report.rows.push_back(row);
+                continue;
+            }
+            const std::vector<double> baseSamples = Samples(bm);
+            row.baseMedian = MedianOf(bm, baseSamples);
+            const double deltaMs = row.curMedian - row.baseMedian;
+            row.deltaPct = row.baseMedian > 0.0 ? deltaMs / row.baseMedian * 100.0 : 0.0;
+            row.tested = curSamples.size() >= 2 && baseSamples.size() >= 2;
+            if (row.tested) {
+                row.pSlower = MannWhitneyGreaterP(curSamples, baseSamples);
+                row.pFaster = MannWhitneyGreaterP(baseSamples, curSamples);
+            }
+            // 没有样本可检验时只看阈值
+            const bool sigSlower = row.tested ? row.pSlower < options.alpha : true;
+            const bool sigFaster = row.tested ? row.pFaster < options.alpha : true;
+            const double threshold = ThresholdFor(options, row.metric);
+            if (deltaMs > 0 && sigSlower) {
+                row.status = (row.deltaPct > threshold && deltaMs > options.minDeltaMs) ? DiffStatus::Regressed
+                             : row.tested                                               ? DiffStatus::Slower
+                                                                                        : DiffStatus::Same;
+            } else if (deltaMs < 0 && sigFaster && -row.deltaPct > threshold && -deltaMs > options.minDeltaMs) {
+                row.status = DiffStatus::Faster;
+            }
+            if (row.status == DiffStatus::Regressed) ++report.regressions;
+            if (row.status == DiffStatus::Faster) ++report.improvements;
+            report.rows.push_back(row);
+        }
+        for (const auto& m : baseMetrics.object) {
+            if (!cur["metrics"][m.first].IsNull()) continue;
+            MetricDiff row;
+            row.file = file;
+            row.metric = m.first;
+            row.baseMedian = MedianOf(m.second, Samples(m.second));
+            row.status = DiffStatus::Missing;
+            report.rows.push_back(row);
+        }
+    }
+    for (const auto& it : baseDocs) report.warnings.push_back(it.first + ": missing from current run");
+    return report;
+}
+
+std::string FormatDiffTable(const CompareReport& report, const CompareOptions& options) {
+    std::string out;
+    char line[320];
+    snprintf(line, sizeof(line), "%-32s %-16s %10s %10s %8s %7s  %s\n", "document", "metric", "base(ms)", "cur(ms)",
+             "delta", "p", "status");
+    out += line;
+    size_t hidden = 0;
+    for (const auto& r : report.rows) {
+        // 紧凑模式只列出越过阈值的变化与新增/缺失指标
+        if ((r.status == DiffStatus::Same || r.status == DiffStatus::Slower) && !options.showAll) {
+            ++hidden;
+            continue;
+        }
+        char pbuf[16];
+        if (!r.tested) {
+            snprintf(pbuf, sizeof(pbuf), "-");
+        } else {
+            snprintf(pbuf, sizeof(pbuf), "%.3f", r.curMedian >= r.baseMedian ? r.pSlower : r.pFaster);
+        }
+        char dbuf[16];
+        if (r.status == DiffStatus::New || r.status == DiffStatus::Missing) snprintf(dbuf, sizeof(dbuf), "-");
+        else snprintf(dbuf, sizeof(dbuf), "%+.1f%%", r.deltaPct);
+        snprintf(line, sizeof(line), "%-32s %-16s %10.2f %10.2f %8s %7s  %s\n", Ellipsize(r.file, 32).c_str(),
+                 Ellipsize(r.metric, 16).c_str(), r.baseMedian, r.curMedian, dbuf, pbuf, StatusText(r.status));
+        out += line;
+    }
+    if (hidden) {
+        snprintf(line, sizeof(line), "(%zu rows within threshold hidden; --all to show)\n", hidden);
+        out += line;
+    }
+    for (const auto& w : report.warnings) out += "warning: " + w + "\n";
+    snprintf(line, sizeof(line), "%d regression(s), %d improvement(s) in %zu comparisons (alpha %.3g, threshold %.1f%%, min %.2f ms)\n",
+             report.regressions, report.improvements, report.rows.size(), options.alpha, options.thresholdPct,
+             options.minDeltaMs);
+    out += line;
+    return out;
+}
+
+} // namespace pdfwv_bench
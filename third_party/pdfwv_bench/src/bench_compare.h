@@ -0,0 +1,51 @@
+// 基线比较：逐文档、逐指标检验当前结果相对基线是否显著变慢，用作回归门禁
+#pragma once
+
+#include "bench_json.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace pdfwv_bench {
+
+struct CompareOptions {
+    double alpha = 0.05;          // 显著性水平（单侧 Mann-Whitney）
+    double thresholdPct = 5.0;    // 中位数变慢超过该百分比才算回归
+    double minDeltaMs = 0.5;      // 中位数绝对差低于该值时忽略（计时噪声）
+    // 按指标覆盖阈值：名称精确匹配，或以 '*' 结尾时按前缀匹配（如 "render.*"）
+    std::vector<std::pair<std::string, double>> metricThresholdPct;
+    bool showAll = false;         // 表格中也列出未越过阈值的行
+};
+
+// Slower：显著变慢但未越过阈值（不影响退出码）；Regressed：显著且越过阈值
+enum class DiffStatus { Same, Slower, Regressed, Faster, New, Missing };
+
+struct MetricDiff {
+    std::string file;
+    std::string metric;
+    double baseMedian = 0.0;
+    double curMedian = 0.0;
+    double deltaPct = 0.0;
+    double pSlower = 1.0;         // 当前整体大于基线的单侧 p 值
+    double pFaster = 1.0;
+    bool tested = false;          // 两侧样本都足够（各 >= 2）时才做检验
+    DiffStatus status = DiffStatus::Same;
+};
+
+struct CompareReport {
+    std::vector<MetricDiff> rows;
+    std::vector<std::string> warnings; // 配置或工作量不一致、文档缺失等
+    int regressions = 0;
+    int improvements = 0;
+};
+
+// baseline / current 均为 ResultsToJson() 的输出
+CompareReport CompareResults(const JsonValue& baseline, const JsonValue& current, const CompareOptions& options);
+
+// 紧凑差异表（文本，等宽对齐）
+std::string FormatDiffTable(const CompareReport& report, const CompareOptions& options);
+
+double ThresholdFor(const CompareOptions& options, const std::string& metric);
+
+} // namespace pdfwv_bench
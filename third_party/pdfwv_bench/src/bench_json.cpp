@@ -0,0 +1,189 @@
+#include "bench_json.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace pdfwv_bench {
+
+namespace {
+
+struct Parser {
+    const char* p;
+    const char* begin;
+    const char* end;
+    std::string error;
+
+    void SkipWs() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) ++p;
+    }
+
+    bool Fail(const char* what) {
+        if (error.empty()) error = std::string(what) + " at offset " + std::to_string(p - begin);
+        return false;
+    }
+
+    static void AppendUtf8(std::string& out, uint32_t cp) {
+        if (cp < 0x80) {
+            out += (char)cp;
+        } else if (cp < 0x800) {
+            out += (char)(0xC0 | (cp >> 6));
+            out += (char)(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += (char)(0xE0 | (cp >> 12));
+            out += (char)(0x80 | ((cp >> 6) & 0x3F));
+            out += (char)(0x80 | (cp & 0x3F));
+        } else {
+            out += (char)(0xF0 | (cp >> 18));
+            out += (char)(0x80 | ((cp >> 12) & 0x3F));
+            out += (char)(0x80 | ((cp >> 6) & 0x3F));
+            out += (char)(0x80 | (cp & 0x3F));
+        }
+    }
+
+    bool ParseHex4(uint32_t& cp) {
+        if (end - p < 4) return Fail("truncated \\u escape");
+        char buf[5] = {p[0], p[1], p[2], p[3], 0};
+        char* stop = nullptr;
+        cp = (uint32_t)strtoul(buf, &stop, 16);
+        if (stop != buf + 4) return Fail("bad \\u escape");
+        p += 4;
+        return true;
+    }
+
+    bool ParseString(std::string& out) {
+        ++p; // '"'
+        while (p < end && *p != '"') {
+            if (*p != '\\') {
+                out += *p++;
+                continue;
+            }
+            if (++p >= end) break;
+            const char c = *p++;
+            switch (c) {
+            case 'n': out += '\n'; break;
+            case 't': out += '\t'; break;
+            case 'r': out += '\r'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'u': {
+                uint32_t cp = 0;
+                if (!ParseHex4(cp)) return false;
+                if (cp >= 0xD800 && cp < 0xDC00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+                    p += 2;
+                    uint32_t lo = 0;
+                    if (!ParseHex4(lo)) return false;
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                }
+                AppendUtf8(out, cp);
+                break;
+            }
+            default: out += c; break;
+            }
+        }
+        if (p >= end) return Fail("unterminated string");
+        ++p;
+        return true;
+    }
+
+    bool ParseValue(JsonValue& v, int depth) {
+        if (depth > 64) return Fail("nesting too deep");
+        SkipWs();
+        if (p >= end) return Fail("unexpected end");
+        const char c = *p;
+        if (c == '{') {
+            v.type = JsonValue::Type::Object;
+            ++p;
+            SkipWs();
+            if (p < end && *p == '}') { ++p; return true; }
+            while (true) {
+                SkipWs();
+                if (p >= end || *p != '"') return Fail("expected key");
+                std::string key;
+                if (!ParseString(key)) return false;
+                SkipWs();
+                if (p >= end || *p != ':') return Fail("expected ':'");
+                ++p;
+                if (!ParseValue(v.object[key], depth + 1)) return false;
+                SkipWs();
+                if (p < end && *p == ',') { ++p; continue; }
+                if (p < end && *p == '}') { ++p; return true; }
+                return Fail("expected ',' or '}'");
+            }
+        }
+        if (c == '[') {
+            v.type = JsonValue::Type::Array;
+            ++p;
+            SkipWs();
+            if (p < end && *p == ']') { ++p; return true; }
+            while (true) {
+                v.array.emplace_back();
+                if (!ParseValue(v.array.back(), depth + 1)) return false;
+                SkipWs();
+                if (p < end && *p == ',') { ++p; continue; }
+                if (p < end && *p == ']') { ++p; return true; }
+                return Fail("expected ',' or ']'");
+            }
+        }
+        if (c == '"') {
+            v.type = JsonValue::Type::String;
+            return ParseString(v.string);
+        }
+        if (end - p >= 4 && strncmp(p, "true", 4) == 0) { v.type = JsonValue::Type::Bool; v.boolean = true; p += 4; return true; }
+        if (end - p >= 5 && strncmp(p, "false", 5) == 0) { v.type = JsonValue::Type::Bool; p += 5; return true; }
+        if (end - p >= 4 && strncmp(p, "null", 4) == 0) { p += 4; return true; }
+        // 数字：strtod 需要以0结尾的缓冲
+        char buf[64];
+        size_t n = 0;
+        while (p + n < end && n < sizeof(buf) - 1 && strchr("+-0123456789.eE", p[n])) ++n;
+        if (n == 0) return Fail("unexpected character");
+        memcpy(buf, p, n);
+        buf[n] = 0;
+        v.type = JsonValue::Type::Number;
+        v.number = strtod(buf, nullptr);
+        p += n;
+        return true;
+    }
+};
+
+} // namespace
+
+const JsonValue& JsonValue::operator[](const std::string& key) const {
+    static const JsonValue kNull;
+    if (type != Type::Object) return kNull;
+    auto it = object.find(key);
+    return it != object.end() ? it->second : kNull;
+}
+
+bool ParseJson(const std::string& text, JsonValue& out, std::string& error) {
+    Parser parser {text.data(), text.data(), text.data() + text.size(), {}};
+    out = JsonValue();
+    if (!parser.ParseValue(out, 0)) {
+        error = parser.error;
+        return false;
+    }
+    parser.SkipWs();
+    if (parser.p != parser.end) {
+        parser.Fail("trailing data");
+        error = parser.error;
+        return false;
+    }
+    return true;
+}
+
+bool ParseJsonFile(const std::string& path, JsonValue& out, std::string& error) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::string text;
+    char buf[65536];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) text.append(buf, n);
+    fclose(f);
+    return ParseJson(text, out, error);
+}
+
+} // namespace pdfwv_bench
@@ -0,0 +1,31 @@
+// 最小 JSON 解析器：只用于读取 pdfwv_bench 自己生成的结果文件（基线）
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace pdfwv_bench {
+
+struct JsonValue {
+    enum class Type { Null, Bool, Number, String, Array, Object };
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<JsonValue> array;
+    std::map<std::string, JsonValue> object;
+
+    // 不存在或类型不符时返回共享的 null 值
+    const JsonValue& operator[](const std::string& key) const;
+    double AsNumber(double fallback = 0.0) const { return type == Type::Number ? number : fallback; }
+    const std::string& AsString() const { return string; }
+    bool IsNull() const { return type == Type::Null; }
+};
+
+// 解析失败返回 false，error 中给出字节偏移
+bool ParseJson(const std::string& text, JsonValue& out, std::string& error);
+bool ParseJsonFile(const std::string& path, JsonValue& out, std::string& error);
+
+} // namespace pdfwv_bench
@@ -0,0 +1,133 @@
+#include "bench_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace pdfwv_bench {
+
+double Median(std::vector<double> values) {
+    if (values.empty()) return 0.0;
+    const size_t mid = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + mid, values.end());
+    const double hi = values[mid];
+    if (values.size() % 2) return hi;
+    const double lo = *std::max_element(values.begin(), values.begin() + mid);
+    return (lo + hi) / 2.0;
+}
+
+double Percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0.0;
+    const double clamped = std::min(100.0, std::max(0.0, p));
+    size_t rank = (size_t)std::ceil(clamped / 100.0 * (double)values.size());
+    if (rank > 0) --rank;
+    std::nth_element(values.begin(), values.begin() + rank, values.end());
+    return values[rank];
+}
+
+SampleStats ComputeStats(const std::vector<double>& samples) {
+    SampleStats st;
+    st.n = samples.size();
+    if (st.n == 0) return st;
+    st.min = *std::min_element(samples.begin(), samples.end());
+    st.max = *std::max_element(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (double v : samples) sum += v;
+    st.mean = sum / (double)st.n;
+    if (st.n > 1) {
+        double sq = 0.0;
+        for (double v : samples) sq += (v - st.mean) * (v - st.mean);
+        st.variance = sq / (double)(st.n - 1);
+        st.stddev = std::sqrt(st.variance);
+    }
+    st.median = Median(samples);
+    std::vector<double> dev;
+    dev.reserve(st.n);
+    for (double v : samples) dev.push_back(std::fabs(v - st.median));
+    st.mad = Median(std::move(dev));
+    return st;
+}
+
+double MannWhitneyGreaterP(const std::vector<double>& x, const std::vector<double>& y) {
+    const size_t n1 = x.size(), n2 = y.size(), n = n1 + n2;
+    if (n1 == 0 || n2 == 0) return 1.0;
+
+    // 合并排序并分配平均秩
+    std::vector<std::pair<double, int>> all;
+    all.reserve(n);
+    for (double v : x) all.emplace_back(v, 0);
+    for (double v : y) all.emplace_back(v, 1);
+    std::sort(all.begin(), all.end());
+    double rankSumX = 0.0;
+    double tieTerm = 0.0; // sum(t^3 - t)
+    for (size_t i = 0; i < n;) {
+        size_t j = i;
+        while (j < n && all[j].first == all[i].first) ++j;
+        const double t = (double)(j - i);
+        const double rank = (double)(i + j + 1) / 2.0; // 1-based 平均秩
+        for (size_t k = i; k < j; ++k) {
+            if (all[k].second == 0) rankSumX += rank;
+        }
+        tieTerm += t * t * t - t;
+        i = j;
+    }
+
+    if (tieTerm == 0.0 && n <= 40) {
+        // 精确分布：从 1..n 中取 n1 个秩，dp[k][s] 为取 k 个且秩和为 s 的组合数
+        const size_t maxSum = n * (n + 1) / 2;
+        std::vector<std::vector<double>> dp(n1 + 1, std::vector<double>(maxSum + 1, 0.0));
+        dp[0][0] = 1.0;
+        for (size_t r = 1; r <= n; ++r) {
+            for (size_t k = std::min(r, n1); k >= 1; --k) {
+                for (size_t s = maxSum; s >= r; --s) dp[k][s] += dp[k - 1][s - r];
+            }
+        }
+        double total = 0.0, tail = 0.0;
+        const size_t observed = (size_t)std::llround(rankSumX);
+        for (size_t s = 0; s <= maxSum; ++s) {
+            total += dp[n1][s];
+            if (s >= observed) tail += dp[n1][s];
+        }
+        return total > 0.0 ? tail / total : 1.0;
+    }
+
+    const double u = rankSumX - (double)n1 * (double)(n1 + 1) / 2.0;
+    const double mu = (double)n1 * (double)n2 / 2.0;
+    const double var = (double)n1 * (double)n2 / 12.0 * (((double)n + 1.0) - tieTerm / ((double)n * ((double)n - 1.0)));
+    if (var <= 0.0) return u > mu ? 0.0 : 1.0;
+    const double z = (u - mu - 0.5) / std::sqrt(var);
+    return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+
+void AppendJsonString(std::string& out, const std::string& s) {
+    out += '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if ((unsigned char)c < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+void AppendStatsJson(std::string& out, const SampleStats& st, const std::vector<double>& samples) {
+    char buf[320];
+    snprintf(buf, sizeof(buf),
+             "{\"n\":%zu,\"median\":%.4f,\"mean\":%.4f,\"variance\":%.6g,\"stddev\":%.4f,\"mad\":%.4f,"
+             "\"min\":%.4f,\"max\":%.4f,\"samples\":[",
+             st.n, st.median, st.mean, st.variance, st.stddev, st.mad, st.min, st.max);
+    out += buf;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        snprintf(buf, sizeof(buf), i ? ",%.4f" : "%.4f", samples[i]);
+        out += buf;
+    }
+    out += "]}";
+}
+
+} // namespace pdfwv_bench
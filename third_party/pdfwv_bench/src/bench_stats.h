@@ -0,0 +1,36 @@
+// 基准测试统计工具：样本汇总（中位数、方差等）与 JSON 输出辅助
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace pdfwv_bench {
+
+// 一组重复测量的汇总（单位由调用方决定，本工具统一为毫秒）
+struct SampleStats {
+    size_t n = 0;
+    double min = 0.0;
+    double max = 0.0;
+    double mean = 0.0;
+    double median = 0.0;
+    double variance = 0.0; // 样本方差（n-1）
+    double stddev = 0.0;
+    double mad = 0.0;      // 中位数绝对偏差，对离群值不敏感
+};
+
+SampleStats ComputeStats(const std::vector<double>& samples);
+double Median(std::vector<double> values);
+// 最近秩百分位（p 取 0~100），空样本返回 0
+double Percentile(std::vector<double> values, double p);
+
+// Mann-Whitney U 单侧检验：返回 "x 整体大于 y" 的 p 值（x 为当前，y 为基线时即"变慢"）。
+// 无并列且 n1+n2 <= 40 时用精确分布，否则用带并列修正与连续性修正的正态近似。
+// 任一组样本为空时返回 1。
+double MannWhitneyGreaterP(const std::vector<double>& x, const std::vector<double>& y);
+
+// JSON 字符串转义后追加（含两侧引号）
+void AppendJsonString(std::string& out, const std::string& s);
+// 追加 {"n":..,"median":..,...,"samples":[...]}
+void AppendStatsJson(std::string& out, const SampleStats& st, const std::vector<double>& samples);
+
+} // namespace pdfwv_bench
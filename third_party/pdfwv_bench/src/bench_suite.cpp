@@ -0,0 +1,301 @@
+#include "bench_suite.h"
+#include "bench_stats.h"
+
+#include "pdf_utils.h"
+#include "pdfium_object_info.h"
+
+#include <fpdf_text.h>
+#include <fpdfview.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+namespace pdfwv_bench {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double MsSince(Clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+// UTF-8 -> UTF-16LE（FPDF_WIDESTRING），以0结尾
+std::vector<unsigned short> Utf8ToUtf16(const std::string& s) {
+    std::vector<unsigned short> out;
+    size_t i = 0;
+    while (i < s.size()) {
+        const unsigned char c = (unsigned char)s[i];
+        uint32_t cp = 0xFFFD;
+        int len = 1;
+        if (c < 0x80) {
+            cp = c;
+        } else if ((c >> 5) == 0x6 && i + 1 < s.size()) {
+            cp = ((c & 0x1Fu) << 6) | (s[i + 1] & 0x3Fu);
+            len = 2;
+        } else if ((c >> 4) == 0xE && i + 2 < s.size()) {
+            cp = ((c & 0x0Fu) << 12) | ((s[i + 1] & 0x3Fu) << 6) | (s[i + 2] & 0x3Fu);
+            len = 3;
+        } else if ((c >> 3) == 0x1E && i + 3 < s.size()) {
+            cp = ((c & 0x07u) << 18) | ((s[i + 1] & 0x3Fu) << 12) | ((s[i + 2] & 0x3Fu) << 6) | (s[i + 3] & 0x3Fu);
+            len = 4;
+        }
+        if (cp >= 0x10000) {
+            cp -= 0x10000;
+            out.push_back((unsigned short)(0xD800 + (cp >> 10)));
+            out.push_back((unsigned short)(0xDC00 + (cp & 0x3FF)));
+        } else {
+            out.push_back((unsigned short)cp);
+        }
+        i += len;
+    }
+    out.push_back(0);
+    return out;
+}
+
+// 与查看器相同的渲染路径：BGRx 位图 + 白底 + FPDF_ANNOT | FPDF_LCD_TEXT
+bool RenderPage(FPDF_PAGE page, int dpi) {
+    const double wpt = FPDF_GetPageWidthF(page);
+    const double hpt = FPDF_GetPageHeightF(page);
+    const int pxW = std::max(1, (int)std::lround(wpt / 72.0 * dpi));
+    const int pxH = std::max(1, (int)std::lround(hpt / 72.0 * dpi));
+    FPDF_BITMAP bmp = FPDFBitmap_Create(pxW, pxH, 0);
+    if (!bmp) return false;
+    FPDFBitmap_FillRect(bmp, 0, 0, pxW, pxH, 0xFFFFFFFF);
+    FPDF_RenderPageBitmap(bmp, page, 0, 0, pxW, pxH, 0, FPDF_ANNOT | FPDF_LCD_TEXT);
+    FPDFBitmap_Destroy(bmp);
+    return true;
+}
+
+long long CountTreeNodes(const PDFIUM_EX_OBJECT_TREE_NODE* node) {
+    if (!node) return 0;
+    long long n = 1;
+    for (int i = 0; i < node->child_count; ++i) n += CountTreeNodes(node->children[i]);
+    return n;
+}
+
+MetricSeries& Series(DocumentResult& r, const std::string& name) {
+    for (auto& m : r.metrics) {
+        if (m.name == name) return m;
+    }
+    r.metrics.push_back(MetricSeries {name, {}});
+    return r.metrics.back();
+}
+
+// 一次完整测量；record 为 false 时是预热，只执行不记录
+bool RunOnce(const std::string& path, const BenchConfig& cfg, bool record, DocumentResult& r) {
+    // 打开 + 首页渲染（从打开开始计时，即用户看到第一页的时间）
+    const auto t0 = Clock::now();
+    FPDF_DOCUMENT doc = FPDF_LoadDocument(path.c_str(), nullptr);
+    const double openMs = MsSince(t0);
+    if (!doc) {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "FPDF_LoadDocument failed (error %lu)", FPDF_GetLastError());
+        r.error = buf;
+        return false;
+    }
+    const int pageCount = FPDF_GetPageCount(doc);
+    const int pages = cfg.maxPages > 0 ? std::min(pageCount, cfg.maxPages) : pageCount;
+    if (pages > 0) {
+        FPDF_PAGE first = FPDF_LoadPage(doc, 0);
+        if (first) {
+            RenderPage(first, cfg.dpis.empty() ? 96 : cfg.dpis.front());
+            FPDF_ClosePage(first);
+        }
+    }
+    const double firstPageMs = MsSince(t0);
+    if (record) {
+        r.pageCount = pageCount;
+        r.pagesMeasured = pages;
+        Series(r, kMetricOpen).samples.push_back(openMs);
+        if (pages > 0) Series(r, kMetricFirstPage).samples.push_back(firstPageMs);
+        if (cfg.perPage && r.pageRender.empty()) r.pageRender.assign(cfg.dpis.size(), std::vector<std::vector<double>>(pages));
+    }
+
+    // 逐页渲染：每个 DPI 一个指标，样本为所有测量页（加载 + 渲染 + 关闭）的总耗时
+    for (size_t d = 0; d < cfg.dpis.size(); ++d) {
+        double total = 0.0;
+        for (int i = 0; i < pages; ++i) {
+            const auto tp = Clock::now();
+            FPDF_PAGE page = FPDF_LoadPage(doc, i);
+            if (page) {
+                RenderPage(page, cfg.dpis[d]);
+                FPDF_ClosePage(page);
+            }
+            const double ms = MsSince(tp);
+            total += ms;
+            if (record && cfg.perPage) r.pageRender[d][i].push_back(ms);
+        }
+        if (record && pages > 0) Series(r, RenderMetricName(cfg.dpis[d])).samples.push_back(total);
+    }
+
+    // 文本提取：加载页面与文本页并取出全部字符；页面保持打开供后续阶段使用
+    std::vector<FPDF_PAGE> pageHandles(pages, nullptr);
+    std::vector<FPDF_TEXTPAGE> textPages(pages, nullptr);
+    long long chars = 0;
+    const auto tt = Clock::now();
+    std::vector<unsigned short> textBuf;
+    for (int i = 0; i < pages; ++i) {
+        pageHandles[i] = FPDF_LoadPage(doc, i);
+        if (!pageHandles[i]) continue;
+        textPages[i] = FPDFText_LoadPage(pageHandles[i]);
+        if (!textPages[i]) continue;
+        const int n = FPDFText_CountChars(textPages[i]);
+        if (n <= 0) continue;
+        textBuf.resize((size_t)n + 1);
+        chars += std::max(0, FPDFText_GetText(textPages[i], 0, n, textBuf.data()) - 1);
+    }
+    const double textMs = MsSince(tt);
+
+    // 搜索：在已加载的文本页上查找全部匹配
+    long long hits = 0;
+    double searchMs = 0.0;
+    if (!cfg.query.empty()) {
+        const std::vector<unsigned short> needle = Utf8ToUtf16(cfg.query);
+        const auto ts = Clock::now();
+        for (int i = 0; i < pages; ++i) {
+            if (!textPages[i]) continue;
+            FPDF_SCHHANDLE sh = FPDFText_FindStart(textPages[i], needle.data(), 0, 0);
+            if (!sh) continue;
+            while (FPDFText_FindNext(sh)) ++hits;
+            FPDFText_FindClose(sh);
+        }
+        searchMs = MsSince(ts);
+    }
+
+    // 命中测试：每页 hitGrid x hitGrid 个均匀分布的点（页面坐标，左上原点）
+    long long imageHits = 0;
+    double hitMs = 0.0;
+    if (cfg.hitGrid > 0) {
+        const auto th = Clock::now();
+        for (int i = 0; i < pages; ++i) {
+            if (!pageHandles[i]) continue;
+            const double w = FPDF_GetPageWidthF(pageHandles[i]);
+            const double h = FPDF_GetPageHeightF(pageHandles[i]);
+            for (int gy = 0; gy < cfg.hitGrid; ++gy) {
+                for (int gx = 0; gx < cfg.hitGrid; ++gx) {
+                    const double x = (gx + 0.5) * w / cfg.hitGrid;
+                    const double y = (gy + 0.5) * h / cfg.hitGrid;
+                    if (PdfHitImageAt(pageHandles[i], x, y, h).imageObj) ++imageHits;
+                }
+            }
+        }
+        hitMs = MsSince(th);
+    }
+
+    // 对象引用树
+    long long nodes = 0;
+    const auto tr = Clock::now();
+    for (int i = 0; i < pages; ++i) {
+        if (!pageHandles[i]) continue;
+        PDFIUM_EX_OBJECT_TREE_NODE* root = PdfiumEx_BuildObjectTree(doc, pageHandles[i], cfg.treeDepth);
+        nodes += CountTreeNodes(root);
+        if (root) PdfiumEx_ReleaseObjectTree(root);
+    }
+    const double treeMs = MsSince(tr);
+
+    for (int i = 0; i < pages; ++i) {
+        if (textPages[i]) FPDFText_ClosePage(textPages[i]);
+        if (pageHandles[i]) FPDF_ClosePage(pageHandles[i]);
+    }
+    FPDF_CloseDocument(doc);
+
+    if (record && pages > 0) {
+        Series(r, kMetricTextExtract).samples.push_back(textMs);
+        if (!cfg.query.empty()) Series(r, kMetricSearch).samples.push_back(searchMs);
+        if (cfg.hitGrid > 0) Series(r, kMetricHitTest).samples.push_back(hitMs);
+        Series(r, kMetricObjectTree).samples.push_back(treeMs);
+        r.textChars = chars;
+        r.searchHits = hits;
+        r.imageHits = imageHits;
+        r.treeNodes = nodes;
+    }
+    return true;
+}
+
+} // namespace
+
+std::string RenderMetricName(int dpi) {
+    return "render.dpi" + std::to_string(dpi);
+}
+
+DocumentResult BenchDocument(const std::string& path, const std::string& key, const BenchConfig& config) {
+    DocumentResult r;
+    r.file = key;
+    for (int i = 0; i < config.warmup; ++i) {
+        if (!RunOnce(path, config, false, r)) return r;
+    }
+    for (int i = 0; i < config.runs; ++i) {
+        if (!RunOnce(path, config, true, r)) return r;
+    }
+    return r;
+}
+
+std::string ResultsToJson(const BenchConfig& config, const std::vector<DocumentResult>& docs) {
+    std::string out;
+    char buf[256];
+    out += "{\"tool\":\"pdfwv_bench\",\"version\":1,\"unit\":\"ms\",\"config\":{";
+    snprintf(buf, sizeof(buf), "\"runs\":%d,\"warmup\":%d,\"max_pages\":%d,\"hit_grid\":%d,\"tree_depth\":%d,\"query\":",
+             config.runs, config.warmup, config.maxPages, config.hitGrid, config.treeDepth);
+    out += buf;
+    AppendJsonString(out, config.query);
+    out += ",\"dpis\":[";
+    for (size_t i = 0; i < config.dpis.size(); ++i) {
+        if (i) out += ',';
+        out += std::to_string(config.dpis[i]);
+    }
+    snprintf(buf, sizeof(buf), "]},\"environment\":{\"hardware_threads\":%u},\"documents\":[",
+             std::thread::hardware_concurrency());
+    out += buf;
+
+    for (size_t d = 0; d < docs.size(); ++d) {
+        const DocumentResult& r = docs[d];
+        if (d) out += ',';
+        out += "\n{\"file\":";
+        AppendJsonString(out, r.file);
+        if (!r.error.empty()) {
+            out += ",\"error\":";
+            AppendJsonString(out, r.error);
+            out += '}';
+            continue;
+        }
+        snprintf(buf, sizeof(buf),
+                 ",\"pages\":%d,\"pages_measured\":%d,\"counts\":{\"text_chars\":%lld,\"search_hits\":%lld,"
+                 "\"image_hits\":%lld,\"tree_nodes\":%lld},\"metrics\":{",
+                 r.pageCount, r.pagesMeasured, r.textChars, r.searchHits, r.imageHits, r.treeNodes);
+        out += buf;
+        for (size_t m = 0; m < r.metrics.size(); ++m) {
+            if (m) out += ',';
+            AppendJsonString(out, r.metrics[m].name);
+            out += ':';
+            AppendStatsJson(out, ComputeStats(r.metrics[m].samples), r.metrics[m].samples);
+        }
+        out += '}';
+        if (!r.pageRender.empty()) {
+            // 逐页只输出中位数与标准差，避免文件过大
+            out += ",\"per_page\":[";
+            for (int p = 0; p < r.pagesMeasured; ++p) {
+                if (p) out += ',';
+                snprintf(buf, sizeof(buf), "{\"page\":%d", p + 1);
+                out += buf;
+                for (size_t k = 0; k < r.pageRender.size(); ++k) {
+                    const SampleStats st = ComputeStats(r.pageRender[k][p]);
+                    out += ',';
+                    AppendJsonString(out, RenderMetricName(config.dpis[k]));
+                    snprintf(buf, sizeof(buf), ":{\"median\":%.4f,\"stddev\":%.4f}", st.median, st.stddev);
+                    out += buf;
+                }
+                out += '}';
+            }
+            out += ']';
+        }
+        out += '}';
+    }
+    out += "\n]}\n";
+    return out;
+}
+
+} // namespace pdfwv_bench
@@ -0,0 +1,55 @@
+// 基准测试套件：对单个PDF文档重复测量打开、渲染、文本、搜索、命中测试与对象树
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace pdfwv_bench {
+
+struct BenchConfig {
+    int runs = 5;                     // 计入统计的重复次数
+    int warmup = 1;                   // 预热次数（不计入统计）
+    std::vector<int> dpis {72, 150, 300};
+    int maxPages = 0;                 // 每个文档最多测量的页数，0 表示全部
+    std::string query = "the";        // 搜索关键字（UTF-8）
+    int hitGrid = 16;                 // 每页命中测试网格边长（hitGrid x hitGrid 个点）
+    int treeDepth = 8;                // PdfiumEx_BuildObjectTree 最大深度
+    bool perPage = false;             // 输出逐页渲染中位数
+};
+
+// 一个指标的全部样本（毫秒）
+struct MetricSeries {
+    std::string name;
+    std::vector<double> samples;
+};
+
+struct DocumentResult {
+    std::string file;                 // 相对语料目录的路径，作为基线比较的键
+    std::string error;                // 非空表示文档无法测量
+    int pageCount = 0;
+    int pagesMeasured = 0;
+    std::vector<MetricSeries> metrics;
+    // 逐页渲染样本：pageRender[dpi下标][页] -> 样本
+    std::vector<std::vector<std::vector<double>>> pageRender;
+    // 结果校验计数（每次运行应一致，用于确认基线与当前测的是同一份工作量）
+    long long textChars = 0;
+    long long searchHits = 0;
+    long long imageHits = 0;
+    long long treeNodes = 0;
+};
+
+// 指标名
+inline constexpr const char* kMetricOpen = "open";
+inline constexpr const char* kMetricFirstPage = "first_page";
+inline constexpr const char* kMetricTextExtract = "text_extract";
+inline constexpr const char* kMetricSearch = "search";
+inline constexpr const char* kMetricHitTest = "hit_test";
+inline constexpr const char* kMetricObjectTree = "object_tree";
+std::string RenderMetricName(int dpi); // "render.dpi150"
+
+// 调用方负责 FPDF_InitLibraryWithConfig / FPDF_DestroyLibrary
+DocumentResult BenchDocument(const std::string& path, const std::string& key, const BenchConfig& config);
+
+std::string ResultsToJson(const BenchConfig& config, const std::vector<DocumentResult>& docs);
+
+} // namespace pdfwv_bench
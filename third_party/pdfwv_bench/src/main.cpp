@@ -0,0 +1,232 @@
+// PdfWinViewer 无界面基准测试工具
+// 用法：pdfwv_bench [选项] <目录或文件>...
+//   对语料中的每个PDF重复测量（预热 + N 次），结果以 JSON 输出（中位数、方差、原始样本）
+//   进度打印到 stderr
+// 比较模式：pdfwv_bench --baseline base.json [选项] <目录或文件>...
+//   运行后与基线逐文档、逐指标比较，输出差异表；有显著回归时退出码为 1
+
+#include "bench_compare.h"
+#include "bench_suite.h"
+
+#include <fpdfview.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace pdfwv_bench;
+
+static void PrintUsage() {
+    fprintf(stderr,
+            "usage: pdfwv_bench [options] <dir|file>...\n"
+            "  -n N            measured runs per document (default 5)\n"
+            "  -w N            warm-up runs per document (default 1)\n"
+            "  --dpi A,B,...   render resolutions (default 72,150,300)\n"
+            "  --max-pages N   measure at most N pages per document (default: all)\n"
+            "  --query TEXT    search term, UTF-8 (default \"the\"; empty disables search)\n"
+            "  --hit-grid N    hit-test N x N points per page (default 16; 0 disables)\n"
+            "  --tree-depth N  PdfiumEx_BuildObjectTree max depth (default 8)\n"
+            "  --per-page      include per-page render medians\n"
+            "  -o FILE         write JSON to FILE instead of stdout\n"
+            "comparison (regression gate):\n"
+            "  --baseline FILE     compare against a stored result; exit 1 on regressions\n"
+            "                      (run options default to the baseline's config)\n"
+            "  --current FILE      compare this stored result instead of running the suite\n"
+            "  --alpha P           significance level, one-sided Mann-Whitney U (default 0.05)\n"
+            "  --threshold PCT     median slowdown that counts as a regression (default 5)\n"
+            "  --metric-threshold NAME=PCT\n"
+            "                      per-metric threshold; NAME may end in '*' (e.g. render.*=10)\n"
+            "  --min-delta MS      ignore median differences below MS (default 0.5)\n"
+            "  --all               list unchanged rows in the diff table\n");
+}
+
+static bool HasPdfExtension(const fs::path& p) {
+    std::string ext = p.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+    return ext == ".pdf";
+}
+
+static std::vector<int> ParseIntList(const char* s) {
+    std::vector<int> out;
+    while (s && *s) {
+        char* end = nullptr;
+        const long v = strtol(s, &end, 10);
+        if (end == s) break;
+        if (v > 0) out.push_back((int)v);
+        s = *end == ',' ? end + 1 : end;
+    }
+    return out;
+}
+
+// 未在命令行显式指定的运行参数沿用基线的配置，保证两次测量的工作量一致
+static void ApplyBaselineConfig(const JsonValue& baseline, const std::vector<std::string>& explicitOpts, BenchConfig& config) {
+    const JsonValue& c = baseline["config"];
+    auto given = [&](const char* opt) { return std::find(explicitOpts.begin(), explicitOpts.end(), opt) != explicitOpts.end(); };
+    if (!given("-n") && !c["runs"].IsNull()) config.runs = std::max(1, (int)c["runs"].AsNumber());
+    if (!given("-w") && !c["warmup"].IsNull()) config.warmup = std::max(0, (int)c["warmup"].AsNumber());
+    if (!given("--max-pages") && !c["max_pages"].IsNull()) config.maxPages = std::max(0, (int)c["max_pages"].AsNumber());
+    if (!given("--hit-grid") && !c["hit_grid"].IsNull()) config.hitGrid = std::max(0, (int)c["hit_grid"].AsNumber());
+    if (!given("--tree-depth") && !c["tree_depth"].IsNull()) config.treeDepth = std::max(1, (int)c["tree_depth"].AsNumber());
+    if (!given("--query") && c["query"].type == JsonValue::Type::String) config.query = c["query"].AsString();
+    if (!given("--dpi") && !c["dpis"].array.empty()) {
+        config.dpis.clear();
+        for (const auto& d : c["dpis"].array) config.dpis.push_back((int)d.AsNumber());
+    }
+}
+
+int main(int argc, char** argv) {
+    BenchConfig config;
+    CompareOptions compare;
+    std::string outPath, baselinePath, currentPath;
+    std::vector<std::string> inputs;
+    std::vector<std::string> explicitOpts;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (a[0] == '-') explicitOpts.push_back(a);
+        if (strcmp(a, "-n") == 0 && hasValue) {
+            config.runs = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(a, "-w") == 0 && hasValue) {
+            config.warmup = std::max(0, atoi(argv[++i]));
+        } else if (strcmp(a, "--dpi") == 0 && hasValue) {
+            config.dpis = ParseIntList(argv[++i]);
+        } else if (strcmp(a, "--max-pages") == 0 && hasValue) {
+            config.maxPages = std::max(0, atoi(argv[++i]));
+        } else if (strcmp(a, "--query") == 0 && hasValue) {
+            config.query = argv[++i];
+        } else if (strcmp(a, "--hit-grid") == 0 && hasValue) {
+            config.hitGrid = std::max(0, atoi(argv[++i]));
+        } else if (strcmp(a, "--tree-depth") == 0 && hasValue) {
+            config.treeDepth = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(a, "--per-page") == 0) {
+            config.perPage = true;
+        } else if (strcmp(a, "-o") == 0 && hasValue) {
+            outPath = argv[++i];
+        } else if (strcmp(a, "--baseline") == 0 && hasValue) {
+            baselinePath = argv[++i];
+        } else if (strcmp(a, "--current") == 0 && hasValue) {
+            currentPath = argv[++i];
+        } else if (strcmp(a, "--alpha") == 0 && hasValue) {
+            compare.alpha = atof(argv[++i]);
+        } else if (strcmp(a, "--threshold") == 0 && hasValue) {
+            compare.thresholdPct = atof(argv[++i]);
+        } else if (strcmp(a, "--metric-threshold") == 0 && hasValue) {
+            const std::string spec = argv[++i];
+            const size_t eq = spec.find('=');
+            if (eq == std::string::npos || eq == 0) {
+                fprintf(stderr, "bad --metric-threshold (expected NAME=PCT): %s\n", spec.c_str());
+                return 2;
+            }
+            compare.metricThresholdPct.emplace_back(spec.substr(0, eq), atof(spec.c_str() + eq + 1));
+        } else if (strcmp(a, "--min-delta") == 0 && hasValue) {
+            compare.minDeltaMs = atof(argv[++i]);
+        } else if (strcmp(a, "--all") == 0) {
+            compare.showAll = true;
+        } else if (strcmp(a, "-h") == 0 || strcmp(a, "--help") == 0) {
+            PrintUsage();
+            return 0;
+        } else if (a[0] == '-') {
+            fprintf(stderr, "unknown option: %s\n", a);
+            PrintUsage();
+            return 2;
+        } else {
+            inputs.push_back(a);
+        }
+    }
+    if (!currentPath.empty() && baselinePath.empty()) {
+        fprintf(stderr, "--current requires --baseline\n");
+        return 2;
+    }
+    if (inputs.empty() && currentPath.empty()) {
+        PrintUsage();
+        return 2;
+    }
+
+    JsonValue baseline;
+    if (!baselinePath.empty()) {
+        std::string error;
+        if (!ParseJsonFile(baselinePath, baseline, error)) {
+            fprintf(stderr, "cannot read baseline %s: %s\n", baselinePath.c_str(), error.c_str());
+            return 2;
+        }
+        ApplyBaselineConfig(baseline, explicitOpts, config);
+    }
+
+    // 只比较两个已有结果文件
+    if (!currentPath.empty()) {
+        JsonValue current;
+        std::string error;
+        if (!ParseJsonFile(currentPath, current, error)) {
+            fprintf(stderr, "cannot read %s: %s\n", currentPath.c_str(), error.c_str());
+            return 2;
+        }
+        const CompareReport report = CompareResults(baseline, current, compare);
+        fputs(FormatDiffTable(report, compare).c_str(), stdout);
+        return report.regressions > 0 ? 1 : 0;
+    }
+
+    // (绝对路径, 相对语料根目录的键)；键用于与基线按文档对齐
+    std::vector<std::pair<std::string, std::string>> files;
+    for (const auto& in : inputs) {
+        std::error_code ec;
+        if (fs::is_directory(in, ec)) {
+            for (const auto& entry : fs::recursive_directory_iterator(in, ec)) {
+                if (!entry.is_regular_file() || !HasPdfExtension(entry.path())) continue;
+                files.emplace_back(entry.path().string(), entry.path().lexically_relative(in).generic_string());
+            }
+        } else {
+            files.emplace_back(in, fs::path(in).filename().generic_string());
+        }
+    }
+    std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) { return a.second < b.second; });
+
+    FPDF_LIBRARY_CONFIG cfg {};
+    cfg.version = 3;
+    FPDF_InitLibraryWithConfig(&cfg);
+
+    std::vector<DocumentResult> results;
+    results.reserve(files.size());
+    const auto t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < files.size(); ++i) {
+        fprintf(stderr, "[%zu/%zu] %s\n", i + 1, files.size(), files[i].second.c_str());
+        results.push_back(BenchDocument(files[i].first, files[i].second, config));
+        if (!results.back().error.empty()) fprintf(stderr, "  skipped: %s\n", results.back().error.c_str());
+    }
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    FPDF_DestroyLibrary();
+
+    const std::string json = ResultsToJson(config, results);
+    fprintf(stderr, "%zu documents, %.1f s\n", files.size(), secs);
+    // 比较模式下 stdout 留给差异表，JSON 只在指定 -o 时写出
+    if (!outPath.empty() || baselinePath.empty()) {
+        FILE* out = stdout;
+        if (!outPath.empty()) {
+            out = fopen(outPath.c_str(), "wb");
+            if (!out) {
+                fprintf(stderr, "cannot open %s\n", outPath.c_str());
+                return 2;
+            }
+        }
+        fwrite(json.data(), 1, json.size(), out);
+        if (out != stdout) fclose(out);
+    }
+    if (baselinePath.empty()) return 0;
+
+    JsonValue current;
+    std::string error;
+    if (!ParseJson(json, current, error)) {
+        fprintf(stderr, "internal error: %s\n", error.c_str());
+        return 2;
+    }
+    const CompareReport report = CompareResults(baseline, current, compare);
+    fputs(FormatDiffTable(report, compare).c_str(), stdout);
+    return report.regressions > 0 ? 1 : 0;
+}
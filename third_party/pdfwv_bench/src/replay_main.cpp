@@ -0,0 +1,97 @@
+// 交互会话回放 - 命令行工具
+// 用法：pdfwv_replay [选项] session.ndjson
+// 会话文件由查看器录制（Windows: View > Record Session...；macOS: 文件 > 录制交互会话…）
+
+#include "session_replay.h"
+
+#include <fpdfview.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using namespace pdfwv_bench;
+
+static void PrintUsage() {
+    fprintf(stderr,
+            "usage: pdfwv_replay [options] session.ndjson\n"
+            "  --pdf FILE          replay against FILE instead of the recorded document\n"
+            "  --fps N             display refresh rate for the frame budget (default 60)\n"
+            "  --speed X           timeline speed factor (default 1)\n"
+            "  --fast              no waiting: replay every event back-to-back, no coalescing\n"
+            "  --max-dropped N     exit 1 when more than N frames are dropped\n"
+            "  -o FILE             write the JSON report to FILE\n");
+}
+
+int main(int argc, char** argv) {
+    ReplayOptions options;
+    std::string sessionPath, outPath;
+    int maxDropped = -1;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (strcmp(a, "--pdf") == 0 && hasValue) {
+            options.pdfOverride = argv[++i];
+        } else if (strcmp(a, "--fps") == 0 && hasValue) {
+            options.fps = atof(argv[++i]);
+        } else if (strcmp(a, "--speed") == 0 && hasValue) {
+            options.speed = atof(argv[++i]);
+        } else if (strcmp(a, "--fast") == 0) {
+            options.realtime = false;
+        } else if (strcmp(a, "--max-dropped") == 0 && hasValue) {
+            maxDropped = atoi(argv[++i]);
+        } else if (strcmp(a, "-o") == 0 && hasValue) {
+            outPath = argv[++i];
+        } else if (strcmp(a, "-h") == 0 || strcmp(a, "--help") == 0) {
+            PrintUsage();
+            return 0;
+        } else if (a[0] == '-' || !sessionPath.empty()) {
+            fprintf(stderr, "unknown argument: %s\n", a);
+            PrintUsage();
+            return 2;
+        } else {
+            sessionPath = a;
+        }
+    }
+    if (sessionPath.empty() || options.fps <= 0.0 || options.speed <= 0.0) {
+        PrintUsage();
+        return 2;
+    }
+
+    SessionLog session;
+    int skipped = 0;
+    std::string error;
+    if (!LoadSession(sessionPath, session, skipped, error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 2;
+    }
+    if (skipped) fprintf(stderr, "%s: %d unreadable line(s) skipped\n", sessionPath.c_str(), skipped);
+    fprintf(stderr, "replaying %zu events recorded on %s\n", session.events.size(),
+            session.platform.empty() ? "unknown" : session.platform.c_str());
+
+    FPDF_LIBRARY_CONFIG cfg {};
+    cfg.version = 3;
+    FPDF_InitLibraryWithConfig(&cfg);
+    ReplayResult result;
+    const bool ok = ReplaySession(session, options, result, error);
+    FPDF_DestroyLibrary();
+    if (!ok) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 2;
+    }
+
+    fputs(FormatReplaySummary(result).c_str(), stdout);
+    if (!outPath.empty()) {
+        FILE* out = fopen(outPath.c_str(), "wb");
+        if (!out) {
+            fprintf(stderr, "cannot open %s\n", outPath.c_str());
+            return 2;
+        }
+        const std::string json = ReplayResultToJson(result, options, sessionPath);
+        fwrite(json.data(), 1, json.size(), out);
+        fclose(out);
+    }
+    return (maxDropped >= 0 && result.droppedFrames > maxDropped) ? 1 : 0;
+}
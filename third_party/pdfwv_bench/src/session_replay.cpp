@@ -0,0 +1,370 @@
+#include "session_replay.h"
+#include "bench_json.h"
+#include "bench_stats.h"
+
+#include "hit_map.h"
+#include "pdf_utils.h"
+#include "text_geometry.h"
+
+#include <fpdf_doc.h>
+#include <fpdf_edit.h>
+#include <fpdf_text.h>
+#include <fpdfview.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+namespace pdfwv_bench {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double MsSince(Clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+bool ParseEvent(const JsonValue& v, SessionEvent& e) {
+    const std::string& ev = v["ev"].AsString();
+    e.t = v["t"].AsNumber();
+    e.source = v["src"].AsString();
+    e.page = (int)v["page"].AsNumber();
+    if (ev == "viewport") {
+        e.kind = SessionEvent::Kind::Viewport;
+        e.zoom = v["zoom"].AsNumber(1.0);
+        e.scrollX = (int)v["sx"].AsNumber();
+        e.scrollY = (int)v["sy"].AsNumber();
+        e.viewW = (int)v["vw"].AsNumber();
+        e.viewH = (int)v["vh"].AsNumber();
+        e.pxPerPt = v["scale"].AsNumber(1.0);
+        e.fullPage = v["render"].AsString() == "page";
+        return e.zoom > 0.0 && e.pxPerPt > 0.0;
+    }
+    if (ev == "select") {
+        e.kind = SessionEvent::Kind::Select;
+        e.x0 = v["x0"].AsNumber();
+        e.y0 = v["y0"].AsNumber();
+        e.x1 = v["x1"].AsNumber();
+        e.y1 = v["y1"].AsNumber();
+        e.final = v["final"].AsNumber() != 0.0;
+        return true;
+    }
+    if (ev == "hit") {
+        e.kind = SessionEvent::Kind::Hit;
+        e.hitKind = v["kind"].AsString();
+        e.x0 = v["x"].AsNumber();
+        e.y0 = v["y"].AsNumber();
+        e.hit = v["hit"].AsNumber() != 0.0;
+        return true;
+    }
+    if (ev == "open") {
+        e.kind = SessionEvent::Kind::Open;
+        e.document = v["document"].AsString();
+        return true;
+    }
+    return false;
+}
+
+// 与 Main.cpp / App.mm 的 drawRect 一致：每帧 加载页 + 渲染 + 关闭页
+void RenderFrame(FPDF_DOCUMENT doc, const SessionEvent& vp) {
+    FPDF_PAGE page = FPDF_LoadPage(doc, vp.page);
+    if (!page) return;
+    const double wpt = FPDF_GetPageWidthF(page);
+    const double hpt = FPDF_GetPageHeightF(page);
+    const int pagePxW = std::max(1, (int)std::lround(wpt * vp.zoom * vp.pxPerPt));
+    const int pagePxH = std::max(1, (int)std::lround(hpt * vp.zoom * vp.pxPerPt));
+    const int flags = FPDF_ANNOT | FPDF_LCD_TEXT;
+    FPDF_BITMAP bmp = vp.fullPage
+        ? PdfRenderPageRegion(page, pagePxW, pagePxH, 0, 0, pagePxW, pagePxH, flags)
+        : PdfRenderPageRegion(page, pagePxW, pagePxH, vp.scrollX, vp.scrollY, vp.viewW, vp.viewH, flags);
+    if (bmp) FPDFBitmap_Destroy(bmp);
+    // 查看器在渲染时顺带建好本页命中表
+    PdfHitMap_Get(doc, vp.page, page);
+    FPDF_ClosePage(page);
+}
+
+void ReplayHitTest(FPDF_DOCUMENT doc, const SessionEvent& e) {
+    if (e.hitKind == "link") {
+        // 链接命中：与查看器相同，只查命中表，不调用 PDFium
+        PdfHitMapRef map = PdfHitMap_Get(doc, e.page);
+        if (map) map->HitTest((float)e.x0, (float)(map->pageHeight - e.y0));
+        return;
+    }
+    FPDF_PAGE page = FPDF_LoadPage(doc, e.page);
+    if (!page) return;
+    const double hpt = FPDF_GetPageHeightF(page);
+    if (e.hitKind == "image") {
+        PdfHitImageAt(page, e.x0, e.y0, hpt);
+    } else {
+        // 对象命中：与 detectObjectAtPoint: 相同的逐对象边界遍历
+        const float px = (float)e.x0, py = (float)(hpt - e.y0);
+        const int count = FPDFPage_CountObjects(page);
+        for (int i = 0; i < count; ++i) {
+            float l = 0, b = 0, r = 0, t = 0;
+            FPDF_PAGEOBJECT obj = FPDFPage_GetObject(page, i);
+            if (obj && FPDFPageObj_GetBounds(obj, &l, &b, &r, &t) && px >= l && px <= r && py >= b && py <= t) break;
+        }
+    }
+    FPDF_ClosePage(page);
+}
+
+// 选区：与查看器相同，起止点各定位一次插入位置并求高亮矩形；完成时取文本
+void ReplaySelection(FPDF_DOCUMENT doc, const SessionEvent& e) {
+    PdfTextGeometryRef geom = PdfTextGeometry_Get(doc, e.page);
+    if (!geom) return;
+    double wpt = 0, hpt = 0;
+    if (!FPDF_GetPageSizeByIndex(doc, e.page, &wpt, &hpt)) return;
+    const int a = geom->CaretAt((float)e.x0, (float)(hpt - e.y0));
+    const int b = geom->CaretAt((float)e.x1, (float)(hpt - e.y1));
+    if (a < 0 || b < 0) return;
+    std::vector<PdfTextRect> rects;
+    geom->SelectionRects(std::min(a, b), std::max(a, b), rects);
+    if (e.final) geom->Text(std::min(a, b), std::max(a, b));
+}
+
+void AppendNamedStats(std::string& out, const char* name, const std::vector<double>& samples) {
+    out += ",\"";
+    out += name;
+    out += "\":";
+    AppendStatsJson(out, ComputeStats(samples), samples);
+}
+
+} // namespace
+
+bool LoadSession(const std::string& path, SessionLog& out, int& skipped, std::string& error) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    out = SessionLog();
+    skipped = 0;
+    std::string line;
+    bool header = false;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+        JsonValue v;
+        std::string lineError;
+        if (!ParseJson(line, v, lineError)) {
+            ++skipped; // 录制被强制中断时最后一行可能不完整
+            continue;
+        }
+        if (!v["session"].IsNull()) {
+            out.platform = v["platform"].AsString();
+            out.document = v["document"].AsString();
+            header = true;
+            continue;
+        }
+        SessionEvent e;
+        if (ParseEvent(v, e)) out.events.push_back(std::move(e));
+        else ++skipped;
+    }
+    if (!header) {
+        error = path + ": missing session header";
+        return false;
+    }
+    // 单一录制线程写入，时间应单调；保险起见按时间稳定排序
+    std::stable_sort(out.events.begin(), out.events.end(),
+                     [](const SessionEvent& a, const SessionEvent& b) { return a.t < b.t; });
+    return true;
+}
+
+bool ReplaySession(const SessionLog& session, const ReplayOptions& options, ReplayResult& out, std::string& error) {
+    out = ReplayResult();
+    out.document = !options.pdfOverride.empty() ? options.pdfOverride : session.document;
+    if (out.document.empty()) {
+        for (const auto& e : session.events) {
+            if (e.kind == SessionEvent::Kind::Open) {
+                out.document = e.document;
+                break;
+            }
+        }
+    }
+    if (out.document.empty()) {
+        error = "session has no document, use --pdf";
+        return false;
+    }
+    FPDF_DOCUMENT doc = FPDF_LoadDocument(out.document.c_str(), nullptr);
+    if (!doc) {
+        error = "cannot open " + out.document + " (FPDF error " + std::to_string(FPDF_GetLastError()) + ")";
+        return false;
+    }
+
+    const double speed = options.speed > 0.0 ? options.speed : 1.0;
+    out.budgetMs = 1000.0 / (options.fps > 0.0 ? options.fps : 60.0);
+    out.events = (int)session.events.size();
+    if (!session.events.empty()) out.durationMs = session.events.back().t / speed;
+
+    SessionEvent viewport;
+    bool haveViewport = false;
+    const auto start = Clock::now();
+    size_t i = 0;
+    while (i < session.events.size()) {
+        const double due = session.events[i].t / speed;
+        if (options.realtime) {
+            const double now = MsSince(start);
+            if (now < due) std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(due - now));
+        }
+
+        // 主线程空闲时取出所有已到期的输入，与消息循环一样只在最后重绘一次
+        const auto frameStart = Clock::now();
+        const double batchEnd = options.realtime ? std::max(due, MsSince(start)) : due;
+        bool dirty = false;
+        int dirtyEvents = 0;
+        double firstDue = 0.0;
+        std::string source;
+        do {
+            const SessionEvent& e = session.events[i];
+            const double eventDue = e.t / speed;
+            switch (e.kind) {
+            case SessionEvent::Kind::Open:
+                if (options.pdfOverride.empty() && !e.document.empty() && e.document != out.document) {
+                    FPDF_DOCUMENT next = FPDF_LoadDocument(e.document.c_str(), nullptr);
+                    if (next) {
+                        PdfTextGeometry_InvalidateDocument(doc);
+                        PdfHitMap_InvalidateDocument(doc);
+                        FPDF_CloseDocument(doc);
+                        doc = next;
+                        out.document = e.document;
+                    }
+                }
+                break;
+            case SessionEvent::Kind::Hit: {
+                const auto t0 = Clock::now();
+                ReplayHitTest(doc, e);
+                out.hitMs.push_back(MsSince(t0));
+                break;
+            }
+            case SessionEvent::Kind::Select: {
+                const auto t0 = Clock::now();
+                ReplaySelection(doc, e);
+                out.selectMs.push_back(MsSince(t0));
+                [[fallthrough]];
+            }
+            case SessionEvent::Kind::Viewport:
+                if (e.kind == SessionEvent::Kind::Viewport) {
+                    viewport = e;
+                    haveViewport = true;
+                }
+                if (!dirtyEvents) firstDue = eventDue;
+                ++dirtyEvents;
+                dirty = true;
+                source = e.source;
+                break;
+            }
+            ++i;
+        } while (options.realtime && i < session.events.size() && session.events[i].t / speed <= batchEnd);
+
+        if (!dirty || !haveViewport) continue;
+        RenderFrame(doc, viewport);
+        const double frameMs = MsSince(frameStart);
+        ++out.frames;
+        out.coalesced += dirtyEvents - 1;
+        out.frameMs.push_back(frameMs);
+        if (options.realtime) out.latencyMs.push_back(MsSince(start) - firstDue);
+        else out.latencyMs.push_back(frameMs);
+        SourceStats& src = out.bySource[source];
+        ++src.frames;
+        src.frameMs.push_back(frameMs);
+        if (frameMs > out.budgetMs) {
+            ++out.jankyFrames;
+            ++src.janky;
+            out.droppedFrames += (int)std::ceil(frameMs / out.budgetMs) - 1;
+        }
+    }
+    out.wallMs = MsSince(start);
+    PdfTextGeometry_InvalidateDocument(doc);
+    PdfHitMap_InvalidateDocument(doc);
+    FPDF_CloseDocument(doc);
+    return true;
+}
+
+std::string ReplayResultToJson(const ReplayResult& r, const ReplayOptions& options, const std::string& sessionPath) {
+    std::string out = "{\"tool\":\"pdfwv_replay\",\"session\":";
+    AppendJsonString(out, sessionPath);
+    out += ",\"document\":";
+    AppendJsonString(out, r.document);
+    char buf[512];
+    snprintf(buf, sizeof(buf),
+             ",\"config\":{\"fps\":%.3f,\"speed\":%.3f,\"realtime\":%s}"
+             ",\"budget_ms\":%.4f,\"duration_ms\":%.3f,\"wall_ms\":%.3f"
+             ",\"events\":%d,\"frames\":%d,\"coalesced\":%d,\"janky_frames\":%d,\"dropped_frames\":%d"
+             ",\"frame_percentiles\":{\"p50\":%.4f,\"p90\":%.4f,\"p95\":%.4f,\"p99\":%.4f}",
+             options.fps, options.speed, options.realtime ? "true" : "false", r.budgetMs, r.durationMs, r.wallMs,
+             r.events, r.frames, r.coalesced, r.jankyFrames, r.droppedFrames, Percentile(r.frameMs, 50),
+             Percentile(r.frameMs, 90), Percentile(r.frameMs, 95), Percentile(r.frameMs, 99));
+    out += buf;
+
+    // 帧耗时分布：每帧占用的刷新周期数（1 = 未超预算）
+    int buckets[4] = {0, 0, 0, 0};
+    for (double ms : r.frameMs) {
+        const int intervals = std::max(1, (int)std::ceil(ms / r.budgetMs));
+        ++buckets[std::min(intervals, 4) - 1];
+    }
+    snprintf(buf, sizeof(buf), ",\"frame_intervals\":{\"1\":%d,\"2\":%d,\"3\":%d,\"4+\":%d}", buckets[0], buckets[1],
+             buckets[2], buckets[3]);
+    out += buf;
+
+    AppendNamedStats(out, "frame_ms", r.frameMs);
+    AppendNamedStats(out, "latency_ms", r.latencyMs);
+    AppendNamedStats(out, "hit_test_ms", r.hitMs);
+    AppendNamedStats(out, "selection_ms", r.selectMs);
+
+    out += ",\"sources\":{";
+    bool first = true;
+    for (const auto& [name, src] : r.bySource) {
+        if (!first) out += ',';
+        first = false;
+        AppendJsonString(out, name);
+        snprintf(buf, sizeof(buf), ":{\"frames\":%d,\"janky\":%d,\"frame_ms\":", src.frames, src.janky);
+        out += buf;
+        AppendStatsJson(out, ComputeStats(src.frameMs), src.frameMs);
+        out += '}';
+    }
+    out += "}}\n";
+    return out;
+}
+
+std::string FormatReplaySummary(const ReplayResult& r) {
+    std::string out;
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%d events over %.1f s, %d frames (budget %.2f ms), %d input events coalesced\n",
+             r.events, r.durationMs / 1000.0, r.frames, r.budgetMs, r.coalesced);
+    out += buf;
+    snprintf(buf, sizeof(buf), "frame ms    p50 %7.2f  p90 %7.2f  p99 %7.2f  max %7.2f\n", Percentile(r.frameMs, 50),
+             Percentile(r.frameMs, 90), Percentile(r.frameMs, 99), ComputeStats(r.frameMs).max);
+    out += buf;
+    snprintf(buf, sizeof(buf), "latency ms  p50 %7.2f  p90 %7.2f  p99 %7.2f  max %7.2f\n", Percentile(r.latencyMs, 50),
+             Percentile(r.latencyMs, 90), Percentile(r.latencyMs, 99), ComputeStats(r.latencyMs).max);
+    out += buf;
+    if (!r.hitMs.empty()) {
+        snprintf(buf, sizeof(buf), "hit test    p50 %7.2f  max %7.2f  (%zu)\n", Percentile(r.hitMs, 50),
+                 ComputeStats(r.hitMs).max, r.hitMs.size());
+        out += buf;
+    }
+    if (!r.selectMs.empty()) {
+        snprintf(buf, sizeof(buf), "selection   p50 %7.2f  max %7.2f  (%zu)\n", Percentile(r.selectMs, 50),
+                 ComputeStats(r.selectMs).max, r.selectMs.size());
+        out += buf;
+    }
+    snprintf(buf, sizeof(buf), "janky frames %d (%.1f%%), dropped frames %d\n", r.jankyFrames,
+             r.frames ? 100.0 * r.jankyFrames / r.frames : 0.0, r.droppedFrames);
+    out += buf;
+    if (!r.bySource.empty()) {
+        snprintf(buf, sizeof(buf), "%-22s %7s %9s %9s %7s\n", "source", "frames", "p50(ms)", "max(ms)", "janky");
+        out += buf;
+        for (const auto& [name, src] : r.bySource) {
+            snprintf(buf, sizeof(buf), "%-22s %7d %9.2f %9.2f %7d\n", name.c_str(), src.frames,
+                     Percentile(src.frameMs, 50), ComputeStats(src.frameMs).max, src.janky);
+            out += buf;
+        }
+    }
+    return out;
+}
+
+} // namespace pdfwv_bench
@@ -0,0 +1,77 @@
+// 交互会话回放：读取查看器录制的会话（platform/shared/session_recorder.h），
+// 按原始时间节奏在无界面环境中重放，统计帧耗时分布与掉帧
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace pdfwv_bench {
+
+struct SessionEvent {
+    enum class Kind { Open, Viewport, Select, Hit };
+    Kind kind = Kind::Viewport;
+    double t = 0.0;            // 相对录制开始的毫秒数
+    std::string source;        // 输入处理函数，如 WM_MOUSEWHEEL、scrollWheel:
+    int page = 0;
+    // Viewport
+    double zoom = 1.0;
+    int scrollX = 0, scrollY = 0, viewW = 0, viewH = 0;
+    double pxPerPt = 1.0;
+    bool fullPage = false;
+    // Select / Hit（页面点坐标，原点左上）
+    double x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+    bool final = false;
+    std::string hitKind;       // image / link / object
+    bool hit = false;
+    // Open
+    std::string document;
+};
+
+struct SessionLog {
+    std::string platform;
+    std::string document;      // 开始录制时打开的文档
+    std::vector<SessionEvent> events;
+};
+
+// 逐行解析，无法识别的行跳过并计入 skipped
+bool LoadSession(const std::string& path, SessionLog& out, int& skipped, std::string& error);
+
+struct ReplayOptions {
+    double fps = 60.0;         // 帧预算 = 1000 / fps
+    double speed = 1.0;        // 时间轴倍速
+    bool realtime = true;      // false：不等待，逐事件立即重放（不合并）
+    std::string pdfOverride;   // 替代会话中记录的文档路径
+};
+
+// 按输入来源统计
+struct SourceStats {
+    int frames = 0;
+    int janky = 0;
+    std::vector<double> frameMs;
+};
+
+struct ReplayResult {
+    std::string document;
+    double budgetMs = 0.0;
+    double durationMs = 0.0;        // 会话时长（按倍速换算后）
+    double wallMs = 0.0;            // 实际回放耗时
+    int events = 0;
+    int frames = 0;
+    int coalesced = 0;              // 因前一帧未完成而合并掉的视口事件
+    int jankyFrames = 0;            // 超出帧预算的帧
+    int droppedFrames = 0;          // 各帧超出预算所占的刷新周期数之和
+    std::vector<double> frameMs;    // 处理 + 渲染耗时
+    std::vector<double> latencyMs;  // 输入 -> 渲染完成（含排队等待）
+    std::vector<double> hitMs;
+    std::vector<double> selectMs;   // 每个选区事件：定位插入位置与高亮，完成时含取文本
+    std::map<std::string, SourceStats> bySource;
+};
+
+// 调用方负责 FPDF_InitLibraryWithConfig / FPDF_DestroyLibrary
+bool ReplaySession(const SessionLog& session, const ReplayOptions& options, ReplayResult& out, std::string& error);
+
+std::string ReplayResultToJson(const ReplayResult& result, const ReplayOptions& options, const std::string& sessionPath);
+std::string FormatReplaySummary(const ReplayResult& result);
+
+} // namespace pdfwv_bench
@@ -0,0 +1,350 @@
+#include "stress_gen.h"
+
+#include "pdfium_object_info.h"
+
+#include <fpdf_annot.h>
+#include <fpdf_edit.h>
+#include <fpdf_ppo.h>
+#include <fpdf_save.h>
+#include <fpdfview.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace pdfwv_bench {
+
+namespace {
+
+// xorshift32：跨平台结果一致（不使用 std::uniform_*_distribution，其实现因标准库而异）
+struct Rng {
+    uint32_t s;
+    explicit Rng(uint32_t seed) : s(seed ? seed : 0x9E3779B9u) {}
+    uint32_t Next() {
+        s ^= s << 13;
+        s ^= s >> 17;
+        s ^= s << 5;
+        return s;
+    }
+    double Uniform(double lo, double hi) { return lo + (hi - lo) * (Next() / 4294967296.0); }
+    int Below(int n) { return n > 0 ? (int)(Next() % (uint32_t)n) : 0; }
+};
+
+uint32_t Mix(uint32_t seed, uint32_t a, uint32_t b = 0) {
+    uint32_t h = seed * 0x9E3779B1u ^ (a + 0x7F4A7C15u) * 0x85EBCA77u ^ (b + 0x165667B1u) * 0xC2B2AE3Du;
+    h ^= h >> 15;
+    return h ? h : 1;
+}
+
+std::vector<unsigned short> ToWide(const std::string& ascii) {
+    std::vector<unsigned short> w(ascii.begin(), ascii.end());
+    w.push_back(0);
+    return w;
+}
+
+void AddRandomPath(FPDF_PAGE page, Rng& rng, double w, double h) {
+    const double x = rng.Uniform(0, w), y = rng.Uniform(0, h);
+    FPDF_PAGEOBJECT path = FPDFPageObj_CreateNewPath((float)x, (float)y);
+    const int kind = rng.Below(3);
+    if (kind == 0) {
+        // 折线
+        const int segs = 3 + rng.Below(12);
+        for (int i = 0; i < segs; ++i)
+            FPDFPath_LineTo(path, (float)rng.Uniform(0, w), (float)rng.Uniform(0, h));
+    } else if (kind == 1) {
+        // 贝塞尔曲线
+        const int segs = 2 + rng.Below(6);
+        for (int i = 0; i < segs; ++i)
+            FPDFPath_BezierTo(path, (float)rng.Uniform(0, w), (float)rng.Uniform(0, h), (float)rng.Uniform(0, w),
+                              (float)rng.Uniform(0, h), (float)rng.Uniform(0, w), (float)rng.Uniform(0, h));
+    } else {
+        const double rw = rng.Uniform(2, w / 4), rh = rng.Uniform(2, h / 4);
+        FPDFPath_LineTo(path, (float)(x + rw), (float)y);
+        FPDFPath_LineTo(path, (float)(x + rw), (float)(y + rh));
+        FPDFPath_LineTo(path, (float)x, (float)(y + rh));
+        FPDFPath_Close(path);
+    }
+    const bool fill = kind == 2 || rng.Below(4) == 0;
+    FPDFPageObj_SetFillColor(path, rng.Below(256), rng.Below(256), rng.Below(256), 96 + rng.Below(160));
+    FPDFPageObj_SetStrokeColor(path, rng.Below(256), rng.Below(256), rng.Below(256), 255);
+    FPDFPageObj_SetStrokeWidth(path, (float)rng.Uniform(0.25, 3.0));
+    FPDFPath_SetDrawMode(path, fill ? FPDF_FILLMODE_ALTERNATE : FPDF_FILLMODE_NONE, 1);
+    FPDFPage_InsertObject(page, path);
+}
+
+void AddFrame(FPDF_PAGE page, double w, double h, int level) {
+    FPDF_PAGEOBJECT rect = FPDFPageObj_CreateNewRect(0, 0, (float)w, (float)h);
+    FPDFPageObj_SetStrokeColor(rect, (level * 37) & 255, (level * 91) & 255, (level * 53) & 255, 255);
+    FPDFPageObj_SetStrokeWidth(rect, 2.0f);
+    FPDFPath_SetDrawMode(rect, FPDF_FILLMODE_NONE, 1);
+    FPDFPage_InsertObject(page, rect);
+}
+
+// 嵌套 Form XObject 链：第 k 层页面 = 边框 + 缩小 0.9 倍的第 k-1 层。
+// 在临时文档中逐层构建，最后一层导入目标文档，各页共享同一个 XObject。
+FPDF_XOBJECT BuildNestedXObject(FPDF_DOCUMENT dest, const StressSpec& spec, Rng& rng) {
+    FPDF_DOCUMENT scratch = FPDF_CreateNewDocument();
+    if (!scratch) return nullptr;
+    const double w = spec.pageWidth, h = spec.pageHeight;
+    for (int level = 0; level < spec.xobjectDepth; ++level) {
+        FPDF_PAGE page = FPDFPage_New(scratch, level, w, h);
+        if (!page) break;
+        AddFrame(page, w, h, level);
+        if (level == 0) {
+            for (int i = 0; i < 16; ++i) AddRandomPath(page, rng, w, h);
+        } else {
+            FPDF_XOBJECT inner = FPDF_NewXObjectFromPage(scratch, scratch, level - 1);
+            FPDF_PAGEOBJECT form = inner ? FPDF_NewFormObjectFromXObject(inner) : nullptr;
+            if (form) {
+                FPDFPageObj_Transform(form, 0.9, 0, 0, 0.9, w * 0.05, h * 0.05);
+                FPDFPage_InsertObject(page, form);
+            }
+            if (inner) FPDF_CloseXObject(inner);
+        }
+        FPDFPage_GenerateContent(page);
+        FPDF_ClosePage(page);
+    }
+    FPDF_XOBJECT top = spec.xobjectDepth > 0 ? FPDF_NewXObjectFromPage(dest, scratch, spec.xobjectDepth - 1) : nullptr;
+    FPDF_CloseDocument(scratch);
+    return top;
+}
+
+// 每张图像内容不同：渐变 + 噪声，FlateDecode 无法大幅压缩，解码成本接近真实扫描件
+void AddImage(FPDF_DOCUMENT doc, FPDF_PAGE page, const StressSpec& spec, Rng& rng, int index) {
+    const int size = std::max(8, spec.imageSize);
+    FPDF_BITMAP bmp = FPDFBitmap_Create(size, size, 0);
+    if (!bmp) return;
+    uint8_t* buf = static_cast<uint8_t*>(FPDFBitmap_GetBuffer(bmp));
+    const int stride = FPDFBitmap_GetStride(bmp);
+    const uint32_t tint = rng.Next();
+    for (int y = 0; y < size; ++y) {
+        uint8_t* row = buf + (size_t)y * stride;
+        for (int x = 0; x < size; ++x) {
+            const uint32_t n = rng.Next();
+            row[x * 4 + 0] = (uint8_t)((x * 255 / size + (tint & 0xFF)) ^ (n & 0x1F));
+            row[x * 4 + 1] = (uint8_t)((y * 255 / size + ((tint >> 8) & 0xFF)) ^ ((n >> 8) & 0x1F));
+            row[x * 4 + 2] = (uint8_t)(((x + y) * 127 / size + ((tint >> 16) & 0xFF)) ^ ((n >> 16) & 0x1F));
+            row[x * 4 + 3] = 0xFF;
+        }
+    }
+    FPDF_PAGEOBJECT img = FPDFPageObj_NewImageObj(doc);
+    if (img && FPDFImageObj_SetBitmap(nullptr, 0, img, bmp)) {
+        // 网格排布，允许重叠
+        const int cols = std::max(1, (int)std::ceil(std::sqrt((double)spec.imagesPerPage)));
+        const double cw = spec.pageWidth / cols, ch = spec.pageHeight / cols;
+        const double x = (index % cols) * cw, y = (index / cols % cols) * ch;
+        FPDFImageObj_SetMatrix(img, cw * 0.95, 0, 0, ch * 0.95, x, y);
+        FPDFPage_InsertObject(page, img);
+    } else if (img) {
+        FPDFPageObj_Destroy(img);
+    }
+    FPDFBitmap_Destroy(bmp);
+}
+
+const char* const kSyllables[] = {"ka", "lo", "mi", "ne", "ru", "so", "ta", "vi", "pe", "do", "qua", "zen"};
+
+std::string RandomLine(Rng& rng, int approxChars) {
+    std::string line;
+    while ((int)line.size() < approxChars) {
+        if (!line.empty()) line += ' ';
+        // 约 1/8 的词为 "the"，保证默认搜索词有稳定命中
+        if (rng.Below(8) == 0) {
+            line += "the";
+            continue;
+        }
+        const int syl = 1 + rng.Below(4);
+        for (int i = 0; i < syl; ++i) line += kSyllables[rng.Below((int)(sizeof(kSyllables) / sizeof(kSyllables[0])))];
+    }
+    return line;
+}
+
+void AddTextLines(FPDF_DOCUMENT doc, FPDF_PAGE page, FPDF_FONT font, const StressSpec& spec, Rng& rng) {
+    const double margin = 24.0;
+    const double lineH = (spec.pageHeight - 2 * margin) / spec.textLinesPerPage;
+    const float fontSize = (float)std::max(1.0, lineH * 0.85);
+    // Helvetica 平均字宽约 0.5em
+    const int charsPerLine = std::max(8, (int)((spec.pageWidth - 2 * margin) / (fontSize * 0.5)));
+    for (int i = 0; i < spec.textLinesPerPage; ++i) {
+        FPDF_PAGEOBJECT text = FPDFPageObj_CreateTextObj(doc, font, fontSize);
+        if (!text) continue;
+        const std::vector<unsigned short> wide = ToWide(RandomLine(rng, charsPerLine));
+        FPDFText_SetText(text, wide.data());
+        FPDFPageObj_Transform(text, 1, 0, 0, 1, margin, spec.pageHeight - margin - (i + 1) * lineH);
+        FPDFPage_InsertObject(page, text);
+    }
+}
+
+void AddLinks(FPDF_PAGE page, const StressSpec& spec, int pageIndex) {
+    const int cols = std::max(1, (int)std::ceil(std::sqrt((double)spec.linksPerPage)));
+    const double cw = spec.pageWidth / cols, ch = spec.pageHeight / cols;
+    char uri[96];
+    for (int i = 0; i < spec.linksPerPage; ++i) {
+        FPDF_ANNOTATION annot = FPDFPage_CreateAnnot(page, FPDF_ANNOT_LINK);
+        if (!annot) return;
+        const double x = (i % cols) * cw, y = (i / cols) * ch;
+        FS_RECTF rect {(float)(x + cw * 0.1), (float)(y + ch * 0.9), (float)(x + cw * 0.9), (float)(y + ch * 0.1)};
+        FPDFAnnot_SetRect(annot, &rect);
+        snprintf(uri, sizeof(uri), "https://example.invalid/stress/p%d/l%d", pageIndex + 1, i + 1);
+        FPDFAnnot_SetURI(annot, uri);
+        FPDFPage_CloseAnnot(annot);
+    }
+}
+
+// 近似平衡的书签树：每层扇出 ceil(N^(1/depth))，按广度优先编号（父条目总在子条目之前）
+bool AddOutline(FPDF_DOCUMENT doc, const StressSpec& spec) {
+    const int n = spec.outlineItems;
+    const int depth = std::max(1, spec.outlineDepth);
+    const int fanout = std::max(2, (int)std::ceil(std::pow((double)n, 1.0 / depth)));
+    std::vector<std::string> titles;
+    std::vector<int> level;
+    std::vector<int> childCount;
+    std::vector<PDFIUM_EX_OUTLINE_ENTRY> entries;
+    titles.reserve(n);
+    entries.reserve(n);
+    auto add = [&](int parent) {
+        const int i = (int)entries.size();
+        const int lv = parent < 0 ? 0 : level[parent] + 1;
+        char title[96];
+        if (parent < 0) snprintf(title, sizeof(title), "Chapter %d", i + 1);
+        else snprintf(title, sizeof(title), "%s.%d", titles[parent].c_str(), ++childCount[parent]);
+        titles.emplace_back(title);
+        level.push_back(lv);
+        childCount.push_back(0);
+        entries.push_back(PDFIUM_EX_OUTLINE_ENTRY {nullptr, parent, spec.pages > 0 ? i % spec.pages : -1});
+    };
+    for (int i = 0; i < std::min(fanout, n); ++i) add(-1);
+    for (int p = 0; p < (int)entries.size() && (int)entries.size() < n; ++p) {
+        if (level[p] + 1 >= depth) continue;
+        for (int k = 0; k < fanout && (int)entries.size() < n; ++k) add(p);
+    }
+    // 标题指针在 titles 不再增长后再填
+    for (size_t i = 0; i < entries.size(); ++i) entries[i].title = titles[i].c_str();
+    return PdfiumEx_SetOutline(doc, entries.data(), (int)entries.size()) != 0;
+}
+
+struct FileWriter : FPDF_FILEWRITE {
+    FILE* file = nullptr;
+};
+
+int WriteBlockToFile(FPDF_FILEWRITE* self, const void* data, unsigned long size) {
+    FileWriter* w = static_cast<FileWriter*>(self);
+    return fwrite(data, 1, size, w->file) == size ? 1 : 0;
+}
+
+} // namespace
+
+const std::vector<StressPreset>& StressPresets() {
+    static const std::vector<StressPreset> presets = [] {
+        std::vector<StressPreset> v;
+        StressSpec s;
+        s.pages = 20;
+        s.pathsPerPage = 5000;
+        v.push_back({"paths", "20 pages x 5000 path objects", s});
+        s = StressSpec();
+        s.pages = 10;
+        s.xobjectDepth = 48;
+        v.push_back({"xobject_nested", "10 pages, form XObjects nested 48 deep", s});
+        s = StressSpec();
+        s.pages = 12;
+        s.imagesPerPage = 4;
+        s.imageSize = 2048;
+        v.push_back({"images_large", "12 pages x 4 distinct 2048x2048 images", s});
+        s = StressSpec();
+        s.pages = 200;
+        s.outlineItems = 50000;
+        s.outlineDepth = 4;
+        v.push_back({"outline_huge", "200 pages, 50000 bookmarks, 4 levels", s});
+        s = StressSpec();
+        s.pages = 50;
+        s.textLinesPerPage = 120;
+        v.push_back({"text_dense", "50 pages x 120 lines of small text", s});
+        s = StressSpec();
+        s.pages = 20;
+        s.linksPerPage = 600;
+        v.push_back({"links_many", "20 pages x 600 URI links", s});
+        s = StressSpec();
+        s.pages = 30;
+        s.pathsPerPage = 500;
+        s.xobjectDepth = 8;
+        s.imagesPerPage = 1;
+        s.imageSize = 1024;
+        s.textLinesPerPage = 60;
+        s.linksPerPage = 40;
+        s.outlineItems = 2000;
+        v.push_back({"mixed", "30 pages mixing every feature at moderate density", s});
+        return v;
+    }();
+    return presets;
+}
+
+const StressPreset* FindStressPreset(const std::string& name) {
+    for (const auto& p : StressPresets()) {
+        if (name == p.name) return &p;
+    }
+    return nullptr;
+}
+
+bool GenerateStressPdf(const StressSpec& spec, const std::string& path, std::string& error) {
+    if (spec.pages <= 0) {
+        error = "pages must be > 0";
+        return false;
+    }
+    FPDF_DOCUMENT doc = FPDF_CreateNewDocument();
+    if (!doc) {
+        error = "FPDF_CreateNewDocument failed";
+        return false;
+    }
+
+    Rng xrng(Mix(spec.seed, 0xF0F0));
+    FPDF_XOBJECT nested = spec.xobjectDepth > 0 ? BuildNestedXObject(doc, spec, xrng) : nullptr;
+    FPDF_FONT font = spec.textLinesPerPage > 0 ? FPDFText_LoadStandardFont(doc, "Helvetica") : nullptr;
+
+    for (int p = 0; p < spec.pages; ++p) {
+        FPDF_PAGE page = FPDFPage_New(doc, p, spec.pageWidth, spec.pageHeight);
+        if (!page) {
+            error = "FPDFPage_New failed";
+            break;
+        }
+        // 每页独立的随机序列：单独调整某一项参数不会改变其他内容
+        Rng pathRng(Mix(spec.seed, p, 1));
+        for (int i = 0; i < spec.pathsPerPage; ++i) AddRandomPath(page, pathRng, spec.pageWidth, spec.pageHeight);
+        if (nested) {
+            FPDF_PAGEOBJECT form = FPDF_NewFormObjectFromXObject(nested);
+            if (form) FPDFPage_InsertObject(page, form);
+        }
+        Rng imageRng(Mix(spec.seed, p, 2));
+        for (int i = 0; i < spec.imagesPerPage; ++i) AddImage(doc, page, spec, imageRng, i);
+        if (font) {
+            Rng textRng(Mix(spec.seed, p, 3));
+            AddTextLines(doc, page, font, spec, textRng);
+        }
+        if (!FPDFPage_GenerateContent(page)) error = "FPDFPage_GenerateContent failed";
+        // 注释不属于内容流，生成内容后再添加
+        AddLinks(page, spec, p);
+        FPDF_ClosePage(page);
+        if (!error.empty()) break;
+    }
+    if (nested) FPDF_CloseXObject(nested);
+    if (font) FPDFFont_Close(font);
+
+    if (error.empty() && spec.outlineItems > 0 && !AddOutline(doc, spec)) error = "PdfiumEx_SetOutline failed";
+
+    if (error.empty()) {
+        FileWriter writer;
+        memset(static_cast<FPDF_FILEWRITE*>(&writer), 0, sizeof(FPDF_FILEWRITE));
+        writer.version = 1;
+        writer.WriteBlock = WriteBlockToFile;
+        writer.file = fopen(path.c_str(), "wb");
+        if (!writer.file) {
+            error = "cannot open " + path;
+        } else {
+            const bool saved = FPDF_SaveAsCopy(doc, &writer, FPDF_NO_INCREMENTAL) != 0;
+            if (fclose(writer.file) != 0 || !saved) error = "FPDF_SaveAsCopy failed";
+        }
+    }
+    FPDF_CloseDocument(doc);
+    return error.empty();
+}
+
+} // namespace pdfwv_bench
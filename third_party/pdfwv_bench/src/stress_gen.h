@@ -0,0 +1,37 @@
+// 合成压力测试PDF生成器：用 PDFium 编辑API生成参数化、内容确定的文档
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace pdfwv_bench {
+
+struct StressSpec {
+    int pages = 10;
+    double pageWidth = 612.0;     // pt（Letter）
+    double pageHeight = 792.0;
+    int pathsPerPage = 0;         // 随机折线/贝塞尔/矩形路径对象
+    int xobjectDepth = 0;         // 每页一个嵌套 Form XObject 链的深度
+    int imagesPerPage = 0;        // 每页图像数（各不相同，避免共享解码缓存）
+    int imageSize = 1024;         // 图像边长（像素）
+    int textLinesPerPage = 0;     // 每页文本行数（字号随行数缩小）
+    int linksPerPage = 0;         // 每页 URI 链接注释数
+    int outlineItems = 0;         // 书签总数
+    int outlineDepth = 3;         // 书签最大层级
+    uint32_t seed = 1;            // 相同参数 + 相同种子生成相同内容
+};
+
+// 预设场景（--suite 生成全部）
+struct StressPreset {
+    const char* name;
+    const char* description;
+    StressSpec spec;
+};
+const std::vector<StressPreset>& StressPresets();
+const StressPreset* FindStressPreset(const std::string& name);
+
+// 调用方负责 FPDF_InitLibraryWithConfig / FPDF_DestroyLibrary。失败时 error 给出原因。
+bool GenerateStressPdf(const StressSpec& spec, const std::string& path, std::string& error);
+
+} // namespace pdfwv_bench
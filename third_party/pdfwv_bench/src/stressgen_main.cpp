@@ -0,0 +1,126 @@
+// 合成压力测试PDF生成器 - 命令行工具
+// 用法：pdfwv_stressgen --suite <目录>                  生成全部预设场景
+//       pdfwv_stressgen [--preset 名称] [参数] -o 输出.pdf  生成单个文档（参数覆盖预设）
+
+#include "stress_gen.h"
+
+#include <fpdfview.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+namespace fs = std::filesystem;
+using namespace pdfwv_bench;
+
+static void PrintUsage() {
+    fprintf(stderr,
+            "usage: pdfwv_stressgen --suite DIR\n"
+            "       pdfwv_stressgen [--preset NAME] [options] -o out.pdf\n"
+            "  --pages N           page count\n"
+            "  --paths N           path objects per page\n"
+            "  --xobject-depth N   nested form XObject depth (one chain per page)\n"
+            "  --images N          distinct images per page\n"
+            "  --image-size PX     image edge length in pixels\n"
+            "  --text-lines N      text lines per page\n"
+            "  --links N           URI link annotations per page\n"
+            "  --outline N         bookmark count\n"
+            "  --outline-depth N   bookmark levels\n"
+            "  --seed N            content seed (same seed -> same content)\n"
+            "presets:\n");
+    for (const auto& p : StressPresets()) fprintf(stderr, "  %-16s %s\n", p.name, p.description);
+}
+
+static bool Generate(const StressSpec& spec, const std::string& path) {
+    const auto t0 = std::chrono::steady_clock::now();
+    std::string error;
+    if (!GenerateStressPdf(spec, path, error)) {
+        fprintf(stderr, "%s: %s\n", path.c_str(), error.c_str());
+        return false;
+    }
+    std::error_code ec;
+    const auto bytes = fs::file_size(path, ec);
+    fprintf(stderr, "%s: %.1f MB, %.1f s\n", path.c_str(), ec ? 0.0 : bytes / (1024.0 * 1024.0),
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+    return true;
+}
+
+int main(int argc, char** argv) {
+    StressSpec spec;
+    std::string outPath, suiteDir;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (strcmp(a, "--suite") == 0 && hasValue) {
+            suiteDir = argv[++i];
+        } else if (strcmp(a, "--preset") == 0 && hasValue) {
+            const StressPreset* preset = FindStressPreset(argv[++i]);
+            if (!preset) {
+                fprintf(stderr, "unknown preset: %s\n", argv[i]);
+                PrintUsage();
+                return 2;
+            }
+            // 预设先于其他参数生效，写在后面的参数覆盖预设
+            const uint32_t seed = spec.seed;
+            spec = preset->spec;
+            spec.seed = seed;
+        } else if (strcmp(a, "--pages") == 0 && hasValue) {
+            spec.pages = atoi(argv[++i]);
+        } else if (strcmp(a, "--paths") == 0 && hasValue) {
+            spec.pathsPerPage = atoi(argv[++i]);
+        } else if (strcmp(a, "--xobject-depth") == 0 && hasValue) {
+            spec.xobjectDepth = atoi(argv[++i]);
+        } else if (strcmp(a, "--images") == 0 && hasValue) {
+            spec.imagesPerPage = atoi(argv[++i]);
+        } else if (strcmp(a, "--image-size") == 0 && hasValue) {
+            spec.imageSize = atoi(argv[++i]);
+        } else if (strcmp(a, "--text-lines") == 0 && hasValue) {
+            spec.textLinesPerPage = atoi(argv[++i]);
+        } else if (strcmp(a, "--links") == 0 && hasValue) {
+            spec.linksPerPage = atoi(argv[++i]);
+        } else if (strcmp(a, "--outline") == 0 && hasValue) {
+            spec.outlineItems = atoi(argv[++i]);
+        } else if (strcmp(a, "--outline-depth") == 0 && hasValue) {
+            spec.outlineDepth = atoi(argv[++i]);
+        } else if (strcmp(a, "--seed") == 0 && hasValue) {
+            spec.seed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(a, "-o") == 0 && hasValue) {
+            outPath = argv[++i];
+        } else if (strcmp(a, "-h") == 0 || strcmp(a, "--help") == 0) {
+            PrintUsage();
+            return 0;
+        } else {
+            fprintf(stderr, "unknown argument: %s\n", a);
+            PrintUsage();
+            return 2;
+        }
+    }
+    if (suiteDir.empty() == outPath.empty()) {
+        PrintUsage();
+        return 2;
+    }
+
+    FPDF_LIBRARY_CONFIG cfg {};
+    cfg.version = 3;
+    FPDF_InitLibraryWithConfig(&cfg);
+
+    bool ok = true;
+    if (!suiteDir.empty()) {
+        std::error_code ec;
+        fs::create_directories(suiteDir, ec);
+        for (const auto& p : StressPresets()) {
+            StressSpec s = p.spec;
+            s.seed = spec.seed;
+            ok = Generate(s, (fs::path(suiteDir) / (std::string("stress_") + p.name + ".pdf")).string()) && ok;
+        }
+    } else {
+        ok = Generate(spec, outPath);
+    }
+
+    FPDF_DestroyLibrary();
+    return ok ? 0 : 1;
+}
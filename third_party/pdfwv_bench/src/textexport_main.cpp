@@ -0,0 +1,94 @@
+// 全文文本导出 - 命令行工具（无界面模式）
+// 用法：pdfwv_textexport [选项] input.pdf
+// 提取与查看器"导出文本"相同（共享 text_export），按页序流式写出 UTF-8；
+// 吞吐量（页/秒）打印到 stderr，stdout 可直接接下游工具
+
+#include "text_export.h"
+
+#include <fpdfview.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+static void PrintUsage() {
+    fprintf(stderr,
+            "usage: pdfwv_textexport [options] input.pdf\n"
+            "  -o FILE             write to FILE instead of stdout\n"
+            "  --boxes             one line per row: page, left, bottom, right, top, text (TSV)\n"
+            "  -j N                layout worker threads (default: hardware threads - 1)\n"
+            "  --max-in-flight N   pages read ahead of the writer (default 32)\n"
+            "  -q                  no progress on stderr\n");
+}
+
+int main(int argc, char** argv) {
+    TextExportOptions options;
+    std::string pdfPath, outPath;
+    bool quiet = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (strcmp(a, "-o") == 0 && hasValue) {
+            outPath = argv[++i];
+        } else if (strcmp(a, "--boxes") == 0) {
+            options.lineBoxes = true;
+        } else if (strcmp(a, "-j") == 0 && hasValue) {
+            options.threads = atoi(argv[++i]);
+        } else if (strcmp(a, "--max-in-flight") == 0 && hasValue) {
+            options.maxPagesInFlight = atoi(argv[++i]);
+        } else if (strcmp(a, "-q") == 0) {
+            quiet = true;
+        } else if (strcmp(a, "-h") == 0 || strcmp(a, "--help") == 0) {
+            PrintUsage();
+            return 0;
+        } else if (a[0] == '-' || !pdfPath.empty()) {
+            fprintf(stderr, "unknown argument: %s\n", a);
+            PrintUsage();
+            return 2;
+        } else {
+            pdfPath = a;
+        }
+    }
+    if (pdfPath.empty() || options.threads < 0 || options.maxPagesInFlight <= 0) {
+        PrintUsage();
+        return 2;
+    }
+
+    FILE* out = stdout;
+    if (!outPath.empty() && !(out = fopen(outPath.c_str(), "wb"))) {
+        fprintf(stderr, "cannot open %s\n", outPath.c_str());
+        return 2;
+    }
+    // 由工作线程按页序调用，同一时刻只有一个
+    auto write = [out](const char* data, size_t size) { return fwrite(data, 1, size, out) == size; };
+    int lastReported = 0;
+    auto progress = [&](const TextExportProgress& p) {
+        if (!quiet && (p.pagesRead - lastReported >= 100 || p.pagesRead == p.pageCount)) {
+            lastReported = p.pagesRead;
+            fprintf(stderr, "\r%d/%d pages, %.1f pages/s", p.pagesRead, p.pageCount, p.PagesPerSecond());
+        }
+        return true;
+    };
+
+    FPDF_LIBRARY_CONFIG cfg {};
+    cfg.version = 3;
+    FPDF_InitLibraryWithConfig(&cfg);
+    TextExportProgress result;
+    std::string error;
+    const bool ok = PdfExportText(pdfPath, options, write, progress, result, error);
+    FPDF_DestroyLibrary();
+    const bool closed = out == stdout ? fflush(out) == 0 : fclose(out) == 0;
+
+    if (!quiet && result.pageCount > 0) fputc('\n', stderr);
+    if (!ok || !closed) {
+        fprintf(stderr, "%s\n", ok ? "writing the output failed" : error.c_str());
+        return 2;
+    }
+    fprintf(stderr, "%d pages (%d unreadable), %llu chars%s, %.2f MB in %.0f ms: %.1f pages/s, %.1f MB/s\n",
+            result.pagesWritten, result.failedPages, (unsigned long long)result.chars,
+            options.lineBoxes ? (", " + std::to_string(result.lines) + " lines").c_str() : "",
+            result.bytesWritten / 1048576.0, result.elapsedMs, result.PagesPerSecond(), result.MegabytesPerSecond());
+    return 0;
+}